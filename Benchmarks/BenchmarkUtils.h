@@ -0,0 +1,236 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+/* Helpers shared by all benchmarks: random generator, timing, and creation and simulation of synthetic scenes. */
+
+#pragma once
+
+#include "BaseSimulator.h"
+#include "GenerationManager.h"
+#include "MeshGenerator.h"
+#include "ModelManager.h"
+#include "Vector3.h"
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Benchmark
+{
+	/// Simple deterministic random generator.
+	class CRandom
+	{
+		uint64_t m_state;
+	public:
+		explicit CRandom(uint64_t _seed) : m_state{ _seed } {}
+		double Next() // in [0, 1)
+		{
+			m_state = m_state * 6364136223846793005ULL + 1442695040888963407ULL;
+			return static_cast<double>(m_state >> 11) / static_cast<double>(1ULL << 53);
+		}
+		double Next(double _min, double _max) { return _min + (_max - _min) * Next(); }
+		CVector3 NextVector(double _max) { return CVector3{ Next(-_max, _max), Next(-_max, _max), Next(-_max, _max) }; }
+		CVector3 NextDirection() { return CVector3{ Next() - 0.5, Next() - 0.5, Next() - 0.5 }.Normalized(); }
+	};
+
+	/// Runs the function once to warm up and then the given number of times, and returns the average wall time of a run [s].
+	/// Each run is called through a volatile pointer, so that the compiler cannot inline it and merge identical runs.
+	template<typename F>
+	double Measure(size_t _repetitions, F&& _function)
+	{
+		using Caller = void(*)(std::remove_reference_t<F>&);
+		volatile Caller call = [](std::remove_reference_t<F>& _f) { _f(); };
+		call(_function);
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < _repetitions; ++i)
+			call(_function);
+		const auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double>(end - start).count() / static_cast<double>(_repetitions);
+	}
+
+	inline const std::string c_particleKey = "Particle", c_wallKey = "Wall", c_bondKey = "Bond", c_liquidKey = "Liquid";	// Keys of compounds of synthetic scenes.
+
+	/// Mechanical properties of materials of synthetic scenes.
+	struct SMaterials
+	{
+		double youngModulus{ 1e7 };		// Young's modulus of particles and walls.
+		double bondModulus{ 1e7 };		// Young's modulus of solid bonds.
+		double restitution{ 0.5 };		// Restitution coefficient of all interactions.
+		double staticFriction{ 0.5 };	// Static friction coefficient of all interactions.
+		double rollingFriction{ 0.01 };	// Rolling friction coefficient of all interactions.
+	};
+
+	/// Adds compounds for particles, walls, solid and liquid bonds and sets their interactions.
+	inline void AddMaterials(CSystemStructure& _scene, const SMaterials& _materials)
+	{
+		auto& db = _scene.m_MaterialDatabase;
+		for (const auto& key : { c_particleKey, c_wallKey, c_bondKey, c_liquidKey })
+		{
+			CCompound* compound = db.AddCompound(key);
+			compound->SetPropertyValue(PROPERTY_DENSITY, 2500);
+			compound->SetPropertyValue(PROPERTY_YOUNG_MODULUS, key == c_bondKey ? _materials.bondModulus : _materials.youngModulus);
+			compound->SetPropertyValue(PROPERTY_POISSON_RATIO, 0.3);
+			compound->SetPropertyValue(PROPERTY_NORMAL_STRENGTH, 1e12);
+			compound->SetPropertyValue(PROPERTY_TANGENTIAL_STRENGTH, 1e12);
+			compound->SetPropertyValue(PROPERTY_DYNAMIC_VISCOSITY, 1e-3);
+			compound->SetPropertyValue(PROPERTY_SURFACE_TENSION, 0.07);
+		}
+		for (auto* interaction : db.GetInteractions())
+		{
+			interaction->SetPropertyValue(PROPERTY_RESTITUTION_COEFFICIENT, _materials.restitution);
+			interaction->SetPropertyValue(PROPERTY_STATIC_FRICTION, _materials.staticFriction);
+			interaction->SetPropertyValue(PROPERTY_ROLLING_FRICTION, _materials.rollingFriction);
+		}
+	}
+
+	/// Returns coordinates of a cubic lattice with the given number of nodes along each axis, centered at point (0,0,0), with random shifts up to _jitter along each axis.
+	/// Nodes are ordered by x, then by y, then by z.
+	inline std::vector<CVector3> Lattice(size_t _nx, size_t _ny, size_t _nz, double _step, double _jitter, CRandom& _random)
+	{
+		std::vector<CVector3> coords;
+		coords.reserve(_nx * _ny * _nz);
+		const CVector3 offset = CVector3{ static_cast<double>(_nx - 1), static_cast<double>(_ny - 1), static_cast<double>(_nz - 1) } * _step / 2;
+		for (size_t x = 0; x < _nx; ++x)
+			for (size_t y = 0; y < _ny; ++y)
+				for (size_t z = 0; z < _nz; ++z)
+					coords.push_back(CVector3{ static_cast<double>(x), static_cast<double>(y), static_cast<double>(z) } * _step - offset + _random.NextVector(_jitter));
+		return coords;
+	}
+
+	/// Returns pairs of IDs of neighbouring nodes of a lattice, created with Lattice(), if particles at its nodes have consecutive IDs starting from _firstID.
+	inline std::vector<std::pair<unsigned, unsigned>> LatticeNeighbours(size_t _nx, size_t _ny, size_t _nz, size_t _firstID)
+	{
+		std::vector<std::pair<unsigned, unsigned>> pairs;
+		const auto ID = [&](size_t _x, size_t _y, size_t _z) { return static_cast<unsigned>(_firstID + (_x * _ny + _y) * _nz + _z); };
+		for (size_t x = 0; x < _nx; ++x)
+			for (size_t y = 0; y < _ny; ++y)
+				for (size_t z = 0; z < _nz; ++z)
+				{
+					if (x + 1 < _nx) pairs.emplace_back(ID(x, y, z), ID(x + 1, y, z));
+					if (y + 1 < _ny) pairs.emplace_back(ID(x, y, z), ID(x, y + 1, z));
+					if (z + 1 < _nz) pairs.emplace_back(ID(x, y, z), ID(x, y, z + 1));
+				}
+		return pairs;
+	}
+
+	/// Adds particles with the given coordinates, random radii in [1 - _radiusSpread; 1 + _radiusSpread] of the mean one and random velocities up to _velocity along each axis.
+	/// Returns the added particles, which get consecutive IDs if there are no gaps in IDs of the scene.
+	inline std::vector<CSphere*> AddParticles(CSystemStructure& _scene, const std::vector<CVector3>& _coords, double _radius, double _radiusSpread, double _velocity, CRandom& _random)
+	{
+		const CCompound* compound = _scene.m_MaterialDatabase.GetCompound(c_particleKey);
+		std::vector<CPhysicalObject*> objects = _scene.AddSeveralObjects(SPHERE, _coords.size());
+		std::vector<CSphere*> particles(objects.size());
+		for (size_t i = 0; i < objects.size(); ++i)
+		{
+			auto* part = dynamic_cast<CSphere*>(objects[i]);
+			const double radius = _radius * _random.Next(1 - _radiusSpread, 1 + _radiusSpread);
+			part->SetStartActivityTime(0.0);
+			part->SetEndActivityTime(DEFAULT_ACTIVITY_END);
+			part->SetRadius(radius);
+			part->SetContactRadius(radius);
+			part->SetCoordinates(0, _coords[i]);
+			part->SetCompound(compound);
+			part->SetOrientation(0, CQuaternion{ 1, 0, 0, 0 });
+			part->SetVelocity(0, _random.NextVector(_velocity));
+			particles[i] = part;
+		}
+		return particles;
+	}
+
+	/// Connects pairs of particles with bonds of the given type, which are initially unstressed.
+	inline void AddBonds(CSystemStructure& _scene, const std::vector<std::pair<unsigned, unsigned>>& _pairs, unsigned _type, double _diameter, const std::string& _compound)
+	{
+		std::vector<CPhysicalObject*> objects = _scene.AddSeveralObjects(_type, _pairs.size());
+		for (size_t i = 0; i < objects.size(); ++i)
+		{
+			auto* bond = dynamic_cast<CBond*>(objects[i]);
+			bond->SetStartActivityTime(0.0);
+			bond->SetEndActivityTime(DEFAULT_ACTIVITY_END);
+			bond->SetDiameter(_diameter);
+			bond->SetInitialLength(Length(_scene.GetObjectByIndex(_pairs[i].first)->GetCoordinates(0) - _scene.GetObjectByIndex(_pairs[i].second)->GetCoordinates(0)));
+			bond->m_nLeftObjectID = _pairs[i].first;
+			bond->m_nRightObjectID = _pairs[i].second;
+			bond->SetCompoundKey(_compound);
+			if (auto* solid = dynamic_cast<CSolidBond*>(bond))
+				solid->SetTangentialOverlap(0.0, CVector3{ 0.0 });
+		}
+	}
+
+	/// Adds a closed box with inward normals, centered at point (0,0,0).
+	inline CRealGeometry* AddBox(CSystemStructure& _scene, const CVector3& _size)
+	{
+		CTriangularMesh mesh = CMeshGenerator::Box(_size.x, _size.y, _size.z).CreateInvertedMesh();
+		mesh.SetName("Box");
+		CRealGeometry* box = _scene.AddGeometry(mesh);
+		box->SetMaterial(c_wallKey);
+		return box;
+	}
+
+	/// Synthetic scene together with managers, needed to simulate it.
+	/// Results are written into temporary files, which are removed when the scene is destroyed.
+	class CBenchmarkScene
+	{
+		/// Temporary files. Declared first, so that they are removed after the system structure has been closed.
+		struct STempFiles
+		{
+			std::string result;
+			std::string profile;
+			~STempFiles()
+			{
+				std::filesystem::remove(result);
+				std::filesystem::remove(profile);
+			}
+		} m_files;
+		std::ostringstream m_log;	// Output of the simulator.
+
+	public:
+		CSystemStructure structure;
+		CModelManager modelManager;
+		CGenerationManager generationManager;
+
+		/// Creates the scene with the given materials and fills it with _create. _name defines names of temporary files.
+		CBenchmarkScene(const std::string& _name, const std::function<void(CSystemStructure&)>& _create, const SMaterials& _materials = {})
+		{
+			const std::filesystem::path tempDir = std::filesystem::temp_directory_path();
+			m_files.result = (tempDir / (_name + ".mdem")).string();
+			m_files.profile = (tempDir / (_name + ".json")).string();
+			structure.SaveToFile(m_files.result);
+			AddMaterials(structure, _materials);
+			_create(structure);
+			structure.UpdateAllObjectsCompoundsProperties();
+			generationManager.SetSystemStructure(&structure);
+		}
+		CBenchmarkScene(const CBenchmarkScene&) = delete;
+		CBenchmarkScene& operator=(const CBenchmarkScene&) = delete;
+
+		/// Adds an active model and sets values of its parameters.
+		CModelDescriptor* AddModel(const std::string& _name, const std::vector<std::pair<std::string, double>>& _parameters = {})
+		{
+			CModelDescriptor* model = modelManager.AddActiveModel(_name);
+			for (const auto& [key, value] : _parameters)
+				model->GetModel()->SetParameterValue(key, value);
+			return model;
+		}
+
+		/// Simulates the given number of steps with the simulator, saving results only at the end. All other settings of the simulator must be made beforehand.
+		void Simulate(CBaseSimulator& _simulator, const CVector3& _gravity, double _timeStep, size_t _steps)
+		{
+			_simulator.p_out = &m_log;
+			_simulator.SetSystemStructure(&structure);
+			_simulator.SetModelManager(&modelManager);
+			_simulator.SetGenerationManager(&generationManager);
+			_simulator.SetExternalAccel(_gravity);
+			_simulator.SetInitSimulationStep(_timeStep);
+			_simulator.SetEndTime((static_cast<double>(_steps) - 0.5) * _timeStep);
+			_simulator.SetSavingStep(static_cast<double>(_steps) * _timeStep);
+			_simulator.SetProfilingFile(m_files.profile);
+			_simulator.Simulate();
+		}
+	};
+}
@@ -0,0 +1,166 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+/* Benchmark of particle-particle contact models. Compares the calculation of contacts one by one through CalculatePP()
+ * with the batched calculation through CalculatePPBatch() on the same set of contacts. Runs in a single thread. */
+
+#include "BenchmarkUtils.h"
+#include "ModelPPHertzMindlin.h"
+#include "ModelPPSimpleViscoElastic.h"
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+
+using namespace Benchmark;
+
+namespace
+{
+	/// Particles and contacts between them, stored as rows of the collision matrix.
+	struct SContacts
+	{
+		SParticleStruct particles;
+		SWallStruct walls;
+		SSolidBondStruct solidBonds;
+		SLiquidBondStruct liquidBonds;
+		std::vector<SInteractProps> props;
+		std::vector<SCollision> collisions;
+		SCollisionFields fields;
+		std::vector<std::vector<SCollision*>> matrix;
+	};
+
+	/// Creates _number particles with random velocities and about 6 contacts per particle with random overlaps.
+	void CreateContacts(SContacts& _c, size_t _number)
+	{
+		CRandom random{ 42 };
+		const double r = 1e-3;
+		for (size_t i = 0; i < _number; ++i)
+		{
+			const double radius = r * random.Next(0.8, 1.2);
+			_c.particles.AddParticle(true, CVector3{ 0 }, radius, static_cast<unsigned>(i), 1e-5, 1e-12, random.NextVector(0.1), random.NextVector(10));
+			_c.particles.AddContactRadius(radius);
+		}
+		_c.props.push_back(SInteractProps{ 0.01, 0.5, 0.3, 0.9, 1e8, 4e7, 0, 0, 0 });
+
+		const size_t contactsPerParticle = 3; // each contact is stored once, so a particle has about 6 contacts
+		_c.collisions.resize(_number * contactsPerParticle);
+		SOptionalVariables vars;
+		vars.bContactEquivalents = true;
+		vars.bContactMoments = true;
+		_c.fields.SetActive(vars, false);
+		_c.fields.Reserve(_c.collisions.size());
+		_c.matrix.resize(_number);
+		for (size_t i = 0; i < _number; ++i)
+			for (size_t j = 0; j < contactsPerParticle; ++j)
+			{
+				SCollision& coll = _c.collisions[i * contactsPerParticle + j];
+				coll.nSlot = static_cast<unsigned>(i * contactsPerParticle + j);
+				coll.nSrcID = static_cast<unsigned>(i);
+				coll.nDstID = static_cast<unsigned>((i + 1 + static_cast<size_t>(random.Next() * 100)) % _number);
+				const double r1 = _c.particles.Radius(coll.nSrcID);
+				const double r2 = _c.particles.Radius(coll.nDstID);
+				coll.dNormalOverlap = (r1 + r2) * random.Next(1e-4, 1e-2);
+				coll.vContactVector = random.NextVector(1).Normalized() * (r1 + r2 - coll.dNormalOverlap);
+				_c.fields.EquivRadius(&coll) = r1 * r2 / (r1 + r2);
+				_c.fields.EquivMass(&coll) = 0.5e-5;
+				// some contacts are sliding, some are sticking
+				coll.vTangOverlap = random.NextVector(coll.dNormalOverlap * (j == 0 ? 1.0 : 0.01));
+				_c.matrix[i].push_back(&coll);
+			}
+	}
+
+	/// Calculates all contacts one by one.
+	void CalculateSingle(const CParticleParticleModel& _model, SContacts& _c, double _timeStep)
+	{
+		for (const auto& row : _c.matrix)
+			for (auto* coll : row)
+				_model.Calculate(0, _timeStep, coll);
+	}
+
+	/// Calculates all contacts in batches, collected over consecutive rows.
+	void CalculateBatch(const CParticleParticleBatchModel& _model, SContacts& _c, double _timeStep)
+	{
+		SPPContactsBatch batch;
+		for (const auto& row : _c.matrix)
+			for (auto* coll : row)
+			{
+				batch.collisions[batch.size++] = coll;
+				if (batch.size == SPPContactsBatch::MAX_SIZE)
+				{
+					_model.CalculatePPBatch(0, _timeStep, batch);
+					batch.size = 0;
+				}
+			}
+		if (batch.size != 0)
+			_model.CalculatePPBatch(0, _timeStep, batch);
+	}
+
+	/// Returns the number of calculated contacts per second.
+	template<typename F>
+	double MeasureRate(SContacts& _c, size_t _repetitions, F&& _fun)
+	{
+		const std::vector<SCollision> initial = _c.collisions;
+		const double time = Measure(_repetitions, std::forward<F>(_fun));
+		_c.collisions = initial;
+		return static_cast<double>(_c.collisions.size()) / time;
+	}
+
+	/// Returns the maximum relative difference of forces and moments, obtained with both paths from the same state.
+	double Compare(const CParticleParticleModel& _model, const CParticleParticleBatchModel& _batchModel, SContacts& _c, double _timeStep)
+	{
+		const std::vector<SCollision> initial = _c.collisions;
+		CalculateSingle(_model, _c, _timeStep);
+		const std::vector<SCollision> single = _c.collisions;
+		std::vector<CVector3> moments1(single.size()), moments2(single.size());
+		for (size_t i = 0; i < single.size(); ++i)
+		{
+			moments1[i] = _c.fields.ResultMoment1(&single[i]);
+			moments2[i] = _c.fields.ResultMoment2(&single[i]);
+		}
+		_c.collisions = initial;
+		CalculateBatch(_batchModel, _c, _timeStep);
+		double diff = 0;
+		for (size_t i = 0; i < single.size(); ++i)
+		{
+			const auto Diff = [](const CVector3& _v1, const CVector3& _v2) { return Length(_v1 - _v2) / std::max(Length(_v1), 1e-300); };
+			diff = std::max({ diff, Diff(single[i].vTotalForce, _c.collisions[i].vTotalForce), Diff(single[i].vTangOverlap, _c.collisions[i].vTangOverlap),
+				Diff(moments1[i], _c.fields.ResultMoment1(&_c.collisions[i])), Diff(moments2[i], _c.fields.ResultMoment2(&_c.collisions[i])) });
+		}
+		_c.collisions = initial;
+		return diff;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const size_t number = argc > 1 ? std::stoul(argv[1]) : 100'000;
+	const double timeStep = 1e-7;
+
+	SContacts contacts;
+	CreateContacts(contacts, number);
+
+	std::vector<std::unique_ptr<CParticleParticleModel>> models;
+	models.emplace_back(new CModelPPHertzMindlin{});
+	models.emplace_back(new CModelPPSimpleViscoElastic{});
+
+	std::cout << "Particles: " << number << ", contacts: " << contacts.collisions.size() << std::endl;
+	std::cout << std::left << std::setw(22) << "Model" << std::right << std::setw(18) << "Single [1e6 c/s]" << std::setw(18) << "Batch [1e6 c/s]"
+		<< std::setw(10) << "Speedup" << std::setw(14) << "Max rel diff" << std::endl;
+	for (auto& model : models)
+	{
+		model->Initialize(&contacts.particles, &contacts.walls, &contacts.solidBonds, &contacts.liquidBonds, &contacts.props);
+		model->SetCollisionFields(&contacts.fields);
+		const size_t repetitions = std::max(size_t{ 3 }, size_t{ 20'000'000 } / contacts.collisions.size());
+		const auto& batchModel = dynamic_cast<const CParticleParticleBatchModel&>(*model);
+		const double single = MeasureRate(contacts, repetitions, [&] { CalculateSingle(*model, contacts, timeStep); });
+		const double batch  = MeasureRate(contacts, repetitions, [&] { CalculateBatch(batchModel, contacts, timeStep); });
+		const double diff = Compare(*model, batchModel, contacts, timeStep);
+		std::cout << std::left << std::setw(22) << model->GetName() << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(18) << single / 1e6 << std::setw(18) << batch / 1e6 << std::setw(10) << batch / single
+			<< std::setw(14) << std::scientific << std::setprecision(1) << diff << std::defaultfloat << std::endl;
+	}
+
+	return 0;
+}
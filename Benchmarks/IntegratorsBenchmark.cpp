@@ -0,0 +1,366 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+/* Accuracy and performance of time integration schemes. Each scene is simulated with the CPU simulator with leapfrog, velocity Verlet and Gear
+ * predictor-corrector schemes, as well as with leapfrog and sub-cycling of solid bonds, over a range of time steps. All interactions are elastic,
+ * without damping and friction, so the total energy must be conserved. It is calculated during the simulation as the sum of kinetic energy,
+ * elastic energy of solid bonds and of Hertzian contacts; velocities of leapfrog schemes are synchronized with coordinates by a half of the step.
+ * Reported are the max relative energy error and the wall time of each run, and, for each scheme, the shortest wall time, at which the energy error
+ * stays below the given tolerance. Scenes are generated deterministically, so no input files are needed. Results are written into temporary files,
+ * removed after each run. In the gas scene, all forces depend only on coordinates; in other scenes, solid bonds accumulate tangential and rotational
+ * deformations from relative velocities, which are consistent with displacements only for half-step velocities of leapfrog schemes.
+ * Usage: musen_integrators_bench [tolerance] [scale] [threads]. */
+
+#include "BenchmarkUtils.h"
+#include "CPUSimulator.h"
+#include "ThreadPool.h"
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace Benchmark;
+
+namespace
+{
+	const double c_radius = 1e-3;		// Radius of particles.
+	const double c_modulus = 1e7;		// Young's modulus of particles and walls.
+	const double c_poisson = 0.3;		// Poisson's ratio of all materials.
+
+	struct SSceneDescriptor
+	{
+		std::string name;
+		double bondModulus;		// Young's modulus of solid bonds.
+		double endTime;			// Simulated time interval.
+		std::vector<double> timeSteps;	// Time steps to be tested.
+		std::vector<uint32_t> substeps;	// Numbers of sub-steps of solid bonds to be tested with leapfrog.
+		size_t agglomerate;		// Particles along each edge of an agglomerate in scenes with walls; 0 if there are no walls.
+		std::function<void(CSystemStructure&, size_t, size_t)> create;	// Fills the scene with the given scale and agglomerate size.
+	};
+
+	/// Adds a cubic lattice of particles, connected with their nearest neighbours by solid bonds. All particles move with the given velocity,
+	/// on which random velocities of the given magnitude are superimposed.
+	void AddAgglomerate(CSystemStructure& _scene, size_t _n, const CVector3& _center, const CVector3& _velocity, double _vibration, CRandom& _random)
+	{
+		std::vector<CVector3> coords = Lattice(_n, _n, _n, 2.0 * c_radius, 0.01 * c_radius, _random);
+		for (auto& coord : coords)
+			coord += _center;
+		const std::vector<CSphere*> particles = AddParticles(_scene, coords, c_radius, 0.0, _vibration, _random);
+		for (auto* part : particles)
+			part->SetVelocity(0, _velocity + part->GetVelocity(0));
+		AddBonds(_scene, LatticeNeighbours(_n, _n, _n, particles.front()->m_lObjectID), SOLID_BOND, c_radius, c_bondKey);
+	}
+
+	/// A single free agglomerate, vibrating due to random initial velocities of its particles. Only solid bonds act.
+	void CreateVibration(CSystemStructure& _scene, size_t _scale, size_t /*_agglomerate*/)
+	{
+		CRandom random{ 42 };
+		const size_t n = 6 * _scale;
+		AddAgglomerate(_scene, n, CVector3{ 0 }, CVector3{ 0 }, 0.05, random);
+		const CVector3 size{ static_cast<double>(n) * 2 * c_radius };
+		_scene.SetSimulationDomain(SVolumeType{ size * -2, size * 2 });
+	}
+
+	/// Returns the distance between centers of agglomerates with the given number of particles along each edge.
+	double AgglomerateStep(size_t _agglomerate) { return (static_cast<double>(_agglomerate) * 2 + 0.5) * c_radius; }
+
+	/// Returns the size of the box in scenes with walls.
+	double CollisionsBox(size_t _scale, size_t _agglomerate) { return static_cast<double>(3 * _scale) * AgglomerateStep(_agglomerate) + c_radius; }
+
+	/// Stiff agglomerates, moving with random velocities in a closed box, colliding with each other and with walls through soft contacts.
+	/// With single-particle agglomerates, this is a gas of particles without bonds, where all forces depend only on coordinates.
+	void CreateCollisions(CSystemStructure& _scene, size_t _scale, size_t _agglomerate)
+	{
+		CRandom random{ 42 };
+		const size_t n = 3 * _scale;	// agglomerates along each axis
+		const double step = AgglomerateStep(_agglomerate);
+		const double offset = static_cast<double>(n - 1) * step / 2;
+		for (size_t i = 0; i < n * n * n; ++i)
+		{
+			const CVector3 node{ static_cast<double>(i / (n * n)), static_cast<double>(i / n % n), static_cast<double>(i % n) };
+			AddAgglomerate(_scene, _agglomerate, node * step - CVector3{ offset }, random.NextVector(0.5), 0.01, random);
+		}
+		const double box = CollisionsBox(_scale, _agglomerate);
+		AddBox(_scene, CVector3{ box });
+		_scene.SetSimulationDomain(SVolumeType{ CVector3{ -box }, CVector3{ box } });
+	}
+
+	/// CPU simulator, which calculates the total energy of the system every several steps.
+	/// Energy is evaluated at the state, at which forces have been calculated; velocities are synchronized with coordinates depending on the scheme.
+	/// Contacts are found by checking all pairs of particles, which is only feasible for small scenes; the time spent on it is measured separately.
+	class CEnergySimulator : public CCPUSimulator
+	{
+		size_t m_interval{ 1 };				// Number of steps between evaluations of energy.
+		size_t m_step{ 0 };					// Index of the current step.
+		double m_box{ 0 };					// Size of the closed box around particles, centered at (0,0,0); 0 - no walls.
+		bool m_pendingSubcycled{ false };	// Energy must be evaluated at the first sub-step of solid bonds.
+		std::vector<CVector3> m_slowForces;	// Forces, acting over the whole step with sub-cycling of solid bonds.
+		std::vector<CVector3> m_slowMoments;
+		std::vector<std::vector<unsigned>> m_bonded;	// Indices of particles connected with each particle by solid bonds.
+
+	public:
+		std::vector<double> energies;	// Evaluated values of total energy.
+		double energyTime{ 0 };			// Wall time [s] spent to evaluate energy.
+
+		void SetInterval(size_t _interval) { m_interval = std::max<size_t>(_interval, 1); }
+		void SetBox(double _size) { m_box = _size; }
+
+		void MoveParticles(bool _bPredictionStep) override
+		{
+			if (_bPredictionStep || m_step++ % m_interval != 0)
+			{
+				CCPUSimulator::MoveParticles(_bPredictionStep);
+				return;
+			}
+
+			SParticleStruct& particles = m_scene.GetRefToParticles();
+			const double dt = m_currSimulationStep;
+			const auto start = std::chrono::steady_clock::now();
+			switch (m_integrator)
+			{
+			case EIntegrator::LEAPFROG:
+				if (m_solidBondSubsteps > 1 && m_scene.GetBondsNumber() != 0)
+				{
+					// solid bonds are calculated later, at the first sub-step
+					m_slowForces.resize(particles.Size());
+					m_slowMoments.resize(particles.Size());
+					for (size_t i = 0; i < particles.Size(); ++i)
+					{
+						m_slowForces[i] = particles.Force(i);
+						m_slowMoments[i] = particles.Moment(i);
+					}
+					m_pendingSubcycled = true;
+				}
+				else
+					energies.push_back(PotentialEnergy() + KineticEnergy(0.5 * dt));
+				energyTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				CCPUSimulator::MoveParticles(_bPredictionStep);
+				break;
+			case EIntegrator::VELOCITY_VERLET:
+			{
+				// corrected velocities are known after the step as predicted ones minus a full step with the current accelerations
+				const double potential = PotentialEnergy();
+				energyTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				CCPUSimulator::MoveParticles(_bPredictionStep);
+				const auto restart = std::chrono::steady_clock::now();
+				energies.push_back(potential + KineticEnergy(-dt));
+				energyTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - restart).count();
+				break;
+			}
+			case EIntegrator::GEAR:
+				energies.push_back(PotentialEnergy() + KineticEnergy(0));
+				energyTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				CCPUSimulator::MoveParticles(_bPredictionStep);
+				break;
+			}
+		}
+
+		void CalculateForcesSB(double _timeStep) override
+		{
+			CCPUSimulator::CalculateForcesSB(_timeStep);
+			if (!m_pendingSubcycled) return;
+			m_pendingSubcycled = false;
+			const auto start = std::chrono::steady_clock::now();
+			// velocities have already got a full step of slow forces; synchronized ones get a half of it and a half of the sub-step of bonds
+			SParticleStruct& particles = m_scene.GetRefToParticles();
+			const double shift = 0.5 * m_currSimulationStep;
+			for (size_t i = 0; i < particles.Size(); ++i)
+			{
+				particles.Vel(i) -= m_slowForces[i] / particles.Mass(i) * shift;
+				particles.AnglVel(i) -= m_slowMoments[i] / particles.InertiaMoment(i) * shift;
+			}
+			energies.push_back(PotentialEnergy() + KineticEnergy(0.5 * _timeStep));
+			for (size_t i = 0; i < particles.Size(); ++i)
+			{
+				particles.Vel(i) += m_slowForces[i] / particles.Mass(i) * shift;
+				particles.AnglVel(i) += m_slowMoments[i] / particles.InertiaMoment(i) * shift;
+			}
+			energyTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+
+	private:
+		/// Returns kinetic energy of particles with velocities, shifted by current accelerations over the given time interval.
+		double KineticEnergy(double _shift) const
+		{
+			const SParticleStruct& particles = m_scene.GetRefToParticles();
+			double energy = 0;
+			for (size_t i = 0; i < particles.Size(); ++i)
+			{
+				if (!particles.Active(i)) continue;
+				const CVector3 vel = particles.Vel(i) + particles.Force(i) / particles.Mass(i) * _shift;
+				const CVector3 anglVel = particles.AnglVel(i) + particles.Moment(i) / particles.InertiaMoment(i) * _shift;
+				energy += 0.5 * particles.Mass(i) * vel.SquaredLength() + 0.5 * particles.InertiaMoment(i) * anglVel.SquaredLength();
+			}
+			return energy;
+		}
+
+		/// Returns elastic energy of solid bonds and of Hertzian particle-particle and particle-wall contacts.
+		double PotentialEnergy()
+		{
+			const SParticleStruct& particles = m_scene.GetRefToParticles();
+			const SSolidBondStruct& bonds = m_scene.GetRefToSolidBonds();
+			double energy = 0;
+			if (m_bonded.empty())
+			{
+				m_bonded.resize(particles.Size());
+				for (size_t i = 0; i < bonds.Size(); ++i)
+				{
+					m_bonded[bonds.LeftID(i)].push_back(bonds.RightID(i));
+					m_bonded[bonds.RightID(i)].push_back(bonds.LeftID(i));
+				}
+			}
+			for (size_t i = 0; i < bonds.Size(); ++i)
+			{
+				if (!bonds.Active(i)) continue;
+				const double length = bonds.InitialLength(i);
+				const double area = bonds.CrossCut(i);
+				const double inertia = bonds.AxialMoment(i);
+				const double strain = (Length(particles.Coord(bonds.LeftID(i)) - particles.Coord(bonds.RightID(i))) - length) / length;
+				energy += 0.5 * bonds.NormalStiffness(i) * area * length * strain * strain;
+				energy += 0.5 * bonds.TangentialForce(i).SquaredLength() * length / (bonds.TangentialStiffness(i) * area);
+				energy += 0.5 * bonds.NormalMoment(i).SquaredLength() * length / (2 * bonds.TangentialStiffness(i) * inertia);
+				energy += 0.5 * bonds.TangentialMoment(i).SquaredLength() * length / (bonds.NormalStiffness(i) * inertia);
+			}
+
+			// Hertzian contacts between equal materials
+			const double modulus = c_modulus / (2 * (1 - c_poisson * c_poisson));
+			const auto Hertz = [&](double _radius, double _overlap) { return _overlap > 0 ? 8. / 15. * modulus * std::sqrt(_radius) * std::pow(_overlap, 2.5) : 0.0; };
+			for (size_t i = 0; i < particles.Size(); ++i)
+			{
+				if (!particles.Active(i)) continue;
+				const double r1 = particles.ContactRadius(i);
+				for (size_t j = i + 1; j < particles.Size(); ++j)
+				{
+					if (!particles.Active(j)) continue;
+					const double r2 = particles.ContactRadius(j);
+					const double overlap = r1 + r2 - Length(particles.Coord(i) - particles.Coord(j));
+					if (overlap > 0 && !VectorContains(m_bonded[i], static_cast<unsigned>(j)))
+						energy += Hertz(r1 * r2 / (r1 + r2), overlap);
+				}
+				if (m_box != 0)
+					for (size_t k = 0; k < 3; ++k)
+						energy += Hertz(r1, r1 - (m_box / 2 - std::abs(particles.Coord(i)[k])));
+			}
+			return energy;
+		}
+	};
+
+	struct SConfig
+	{
+		CBaseSimulator::EIntegrator integrator;
+		uint32_t substeps;
+		std::string Name() const
+		{
+			switch (integrator)
+			{
+			case CBaseSimulator::EIntegrator::LEAPFROG:			return substeps > 1 ? "leapfrog-MTS" + std::to_string(substeps) : "leapfrog";
+			case CBaseSimulator::EIntegrator::VELOCITY_VERLET:	return "verlet";
+			case CBaseSimulator::EIntegrator::GEAR:				return "gear";
+			}
+			return {};
+		}
+	};
+
+	struct SResult
+	{
+		size_t particles{ 0 };
+		size_t bonds{ 0 };
+		size_t steps{ 0 };
+		double wallTime{ 0 };		// Wall time of the simulation [s].
+		double energyError{ 0 };	// Max relative deviation of the total energy from its initial value.
+	};
+
+	/// Creates the scene and simulates it with the given scheme and time step.
+	SResult Simulate(const SSceneDescriptor& _descr, size_t _scale, const SConfig& _config, double _timeStep)
+	{
+		// elastic interactions without damping and friction
+		SMaterials materials;
+		materials.youngModulus = c_modulus;
+		materials.bondModulus = _descr.bondModulus;
+		materials.restitution = 1.0;
+		materials.staticFriction = 0.0;
+		materials.rollingFriction = 0.0;
+		CBenchmarkScene run{ "musen_integrators_bench_" + _descr.name, [&](CSystemStructure& _scene) { _descr.create(_scene, _scale, _descr.agglomerate); }, materials };
+		CSystemStructure& scene = run.structure;
+		run.AddModel("ModelPPHertzMindlin");
+		run.AddModel("ModelPWHertzMindlin");
+		run.AddModel("ModelSBElastic", { { "CONSIDER_BREAKAGE", 0 } });
+		run.modelManager.SetConnectedPPContact(false);
+
+		const size_t steps = static_cast<size_t>(std::ceil(_descr.endTime / _timeStep));
+		CEnergySimulator simulator;
+		simulator.SetIntegrator(_config.integrator);
+		simulator.SetSolidBondSubsteps(_config.substeps);
+		simulator.SetInterval(steps / 200);
+		simulator.SetBox(_descr.agglomerate != 0 ? CollisionsBox(_scale, _descr.agglomerate) : 0);
+		run.Simulate(simulator, CVector3{ 0 }, _timeStep, steps);
+
+		SResult res;
+		res.particles = scene.GetNumberOfSpecificObjects(SPHERE);
+		res.bonds = scene.GetNumberOfSpecificObjects(SOLID_BOND);
+		res.steps = simulator.GetProfiler().GetSteps();
+		res.wallTime = simulator.GetProfiler().GetWallTime() - simulator.energyTime;
+		const auto& energies = simulator.energies;
+		for (const double energy : energies)
+			res.energyError = std::max(res.energyError, std::isfinite(energy) ? std::abs(energy - energies.front()) / energies.front() : std::numeric_limits<double>::infinity());
+		return res;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const double tolerance = argc > 1 ? std::stod(argv[1]) : 1e-3;
+	const size_t scale = argc > 2 ? std::max<size_t>(std::stoul(argv[2]), 1) : 1;
+	const size_t threads = argc > 3 ? std::stoul(argv[3]) : std::max(std::thread::hardware_concurrency(), 1u);
+	ThreadPool::CThreadPool::SetMaxThreadsNumber(threads);
+	RestartThreadPool();
+
+	using EIntegrator = CBaseSimulator::EIntegrator;
+	const std::vector<SSceneDescriptor> scenes{
+		{ "vibration",  1e7,  2e-3, { 5e-7, 1e-6, 2e-6, 4e-6, 8e-6 },                     { 1 },        0, CreateVibration },
+		{ "collisions", 1e10, 1e-3, { 2.5e-8, 5e-8, 1e-7, 2e-7, 4e-7, 8e-7, 1.6e-6 }, { 1, 4, 16 }, 3, CreateCollisions },
+		{ "gas",        1e10, 1e-3, { 2.5e-8, 5e-8, 1e-7, 2e-7, 4e-7, 8e-7, 1.6e-6 }, { 1 },        1, CreateCollisions },
+	};
+
+	std::cout << "Energy tolerance: " << tolerance << ", scale: " << scale << ", threads: " << GetThreadsNumber() << std::endl;
+	for (const auto& scene : scenes)
+	{
+		std::vector<SConfig> configs{ { EIntegrator::LEAPFROG, 1 }, { EIntegrator::VELOCITY_VERLET, 1 }, { EIntegrator::GEAR, 1 } };
+		for (const auto substeps : scene.substeps)
+			if (substeps > 1)
+				configs.push_back({ EIntegrator::LEAPFROG, substeps });
+
+		std::cout << std::endl << std::left << std::setw(12) << "Scene" << std::setw(16) << "Scheme" << std::right << std::setw(10) << "Particles" << std::setw(8) << "Bonds"
+			<< std::setw(10) << "Step [s]" << std::setw(9) << "Steps" << std::setw(11) << "Wall [s]" << std::setw(14) << "Energy error" << std::endl;
+		std::vector<std::pair<const SConfig*, SResult>> best;	// the fastest run of each scheme within the tolerance
+		for (const auto& config : configs)
+		{
+			best.emplace_back(&config, SResult{});
+			for (const double timeStep : scene.timeSteps)
+			{
+				const SResult res = Simulate(scene, scale, config, timeStep);
+				std::cout << std::left << std::setw(12) << scene.name << std::setw(16) << config.Name() << std::right << std::setw(10) << res.particles << std::setw(8) << res.bonds
+					<< std::setw(10) << std::setprecision(2) << timeStep << std::setw(9) << res.steps << std::fixed << std::setprecision(3) << std::setw(11) << res.wallTime
+					<< std::scientific << std::setprecision(2) << std::setw(14) << res.energyError << std::defaultfloat << std::endl;
+				if (res.energyError <= tolerance && (best.back().second.steps == 0 || res.wallTime < best.back().second.wallTime))
+					best.back().second = res;
+			}
+		}
+
+		std::cout << "Fastest runs with energy error below " << tolerance << ":" << std::endl;
+		const double reference = best.front().second.wallTime;
+		for (const auto& [config, res] : best)
+		{
+			std::cout << "  " << std::left << std::setw(16) << config->Name() << std::right;
+			if (res.steps == 0)
+				std::cout << "not reached" << std::endl;
+			else
+				std::cout << std::fixed << std::setprecision(3) << std::setw(9) << res.wallTime << " s" << std::setw(8) << std::setprecision(2) << (reference != 0 ? reference / res.wallTime : 0.0)
+					<< "x" << std::defaultfloat << std::endl;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,190 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+/* Scaling benchmark of liquid bonds. Calculates forces of capillary bridges between particles on a lattice and consolidates them into
+ * particles, as CCPUSimulator does, with different numbers of threads. The consolidation is compared with the serial loop over all bonds,
+ * and the resulting forces and moments are checked to be bitwise identical for all numbers of threads.
+ * Usage: musen_lb_bench [lattice size] [repetitions] [threads...]. */
+
+#include "AbstractDEMModel.h"
+#include "BenchmarkUtils.h"
+#include "ThreadPool.h"
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace Benchmark;
+
+namespace
+{
+	/// Simplified capillary bridge: constant capillary attraction and viscous damping of the relative motion.
+	class CModelLBBenchmark : public CLiquidBondModel
+	{
+	public:
+		void CalculateLB(double _time, double _timeStep, size_t _iLeft, size_t _iRight, size_t _iBond, SLiquidBondStruct& _bonds, unsigned* _pBrokenBondsNum) const override
+		{
+			const CVector3 bond = Particles().Coord(_iLeft) - Particles().Coord(_iRight);
+			const CVector3 normal = bond.Normalized();
+			const CVector3 rAC = bond * 0.5;
+			const double radius = Particles().Radius(_iLeft) * Particles().Radius(_iRight) / (Particles().Radius(_iLeft) + Particles().Radius(_iRight));
+			const CVector3 relVel = Particles().Vel(_iLeft) - Particles().Vel(_iRight) - (Particles().AnglVel(_iLeft) + Particles().AnglVel(_iRight)) * rAC;
+			const CVector3 normVel = normal * DotProduct(normal, relVel);
+			const double viscous = 6 * PI * _bonds.Viscosity(_iBond) * radius;
+			_bonds.NormalForce(_iBond) = normal * (-2 * PI * radius * _bonds.SurfaceTension(_iBond)) - normVel * viscous;
+			_bonds.TangentialForce(_iBond) = (normVel - relVel) * viscous;
+			_bonds.UnsymMoment(_iBond) = rAC * _bonds.TangentialForce(_iBond);
+		}
+
+		void ConsolidatePart(double _time, double _timeStep, size_t _iBond, size_t _iPart, SParticleStruct& _particles) const override
+		{
+			if (Bonds().LeftID(_iBond) == _iPart)
+			{
+				_particles.Force(_iPart) += Bonds().NormalForce(_iBond) + Bonds().TangentialForce(_iBond);
+				_particles.Moment(_iPart) -= Bonds().UnsymMoment(_iBond);
+			}
+			else if (Bonds().RightID(_iBond) == _iPart)
+			{
+				_particles.Force(_iPart) -= Bonds().NormalForce(_iBond) + Bonds().TangentialForce(_iBond);
+				_particles.Moment(_iPart) -= Bonds().UnsymMoment(_iBond);
+			}
+		}
+	};
+
+	/// Particles on a jittered cubic lattice, connected by liquid bonds with their nearest neighbours.
+	struct SScene
+	{
+		SParticleStruct particles;
+		SWallStruct walls;
+		SSolidBondStruct solidBonds;
+		SLiquidBondStruct liquidBonds;
+		std::vector<SInteractProps> props;
+		SParticlesToBonds partToBonds;
+	};
+
+	void CreateScene(SScene& _s, size_t _n)
+	{
+		CRandom random{ 42 };
+		const double r = 1e-3;
+		const auto Index = [&](size_t _x, size_t _y, size_t _z) { return (_x * _n + _y) * _n + _z; };
+		for (size_t x = 0; x < _n; ++x)
+			for (size_t y = 0; y < _n; ++y)
+				for (size_t z = 0; z < _n; ++z)
+				{
+					const CVector3 coord = CVector3{ static_cast<double>(x), static_cast<double>(y), static_cast<double>(z) } * 2.05 * r + random.NextVector(0.01 * r);
+					_s.particles.AddParticle(true, coord, r * random.Next(0.95, 1.05), static_cast<unsigned>(Index(x, y, z)), 1e-5, 1e-12, random.NextVector(0.1), random.NextVector(10));
+				}
+		for (size_t x = 0; x < _n; ++x)
+			for (size_t y = 0; y < _n; ++y)
+				for (size_t z = 0; z < _n; ++z)
+				{
+					const auto AddBond = [&](size_t _other) { _s.liquidBonds.AddLiquidBond(true, static_cast<unsigned>(_s.liquidBonds.Size()), Index(x, y, z), _other, 1e-10, 1e-3, 0.07); };
+					if (x + 1 < _n) AddBond(Index(x + 1, y, z));
+					if (y + 1 < _n) AddBond(Index(x, y + 1, z));
+					if (z + 1 < _n) AddBond(Index(x, y, z + 1));
+				}
+		_s.partToBonds.Build(_s.particles, _s.liquidBonds);
+	}
+
+	void ClearForces(SParticleStruct& _particles)
+	{
+		for (size_t i = 0; i < _particles.Size(); ++i)
+		{
+			_particles.Force(i).Init(0);
+			_particles.Moment(i).Init(0);
+		}
+	}
+
+	/// Calculates forces of all bonds.
+	void Calculate(const CLiquidBondModel& _model, SScene& _s)
+	{
+		ParallelFor(_s.liquidBonds.Size(), [&](size_t i)
+		{
+			_model.Calculate(0, 1e-6, i, _s.liquidBonds, nullptr);
+		});
+	}
+
+	/// Consolidates forces in a serial loop over all bonds.
+	void ConsolidateSerial(const CLiquidBondModel& _model, SScene& _s)
+	{
+		for (size_t i = 0; i < _s.liquidBonds.Size(); ++i)
+			if (_s.liquidBonds.Active(i))
+			{
+				_model.Consolidate(0, 1e-6, i, _s.liquidBonds.LeftID(i), _s.particles);
+				_model.Consolidate(0, 1e-6, i, _s.liquidBonds.RightID(i), _s.particles);
+			}
+	}
+
+	/// Consolidates forces in parallel over particles, using the particle-to-bond adjacency.
+	void ConsolidateParallel(const CLiquidBondModel& _model, SScene& _s)
+	{
+		ParallelFor(_s.partToBonds.Size(), [&](size_t iPart)
+		{
+			for (const unsigned* it = _s.partToBonds.Begin(iPart); it != _s.partToBonds.End(iPart); ++it)
+				if (_s.liquidBonds.Active(*it))
+					_model.Consolidate(0, 1e-6, *it, iPart, _s.particles);
+		});
+	}
+
+	/// Returns true if forces and moments of all particles are bitwise equal to the reference ones.
+	bool IsEqual(const SParticleStruct& _particles, const std::vector<CVector3>& _forces, const std::vector<CVector3>& _moments)
+	{
+		for (size_t i = 0; i < _particles.Size(); ++i)
+			if (std::memcmp(&_particles.Force(i), &_forces[i], sizeof(CVector3)) != 0 || std::memcmp(&_particles.Moment(i), &_moments[i], sizeof(CVector3)) != 0)
+				return false;
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const size_t n           = argc > 1 ? std::stoul(argv[1]) : 40;
+	const size_t repetitions = argc > 2 ? std::stoul(argv[2]) : 20;
+	std::vector<size_t> threads;
+	for (int i = 3; i < argc; ++i)
+		threads.push_back(std::stoul(argv[i]));
+	if (threads.empty())
+		for (size_t t = 1; t <= std::max(std::thread::hardware_concurrency(), 1u); t *= 2)
+			threads.push_back(t);
+
+	SScene scene;
+	CreateScene(scene, n);
+	CModelLBBenchmark model;
+	model.Initialize(&scene.particles, &scene.walls, &scene.solidBonds, &scene.liquidBonds, &scene.props);
+
+	// reference results of the serial consolidation
+	ThreadPool::CThreadPool::SetMaxThreadsNumber(1);
+	InitializeThreadPool();
+	Calculate(model, scene);
+	ClearForces(scene.particles);
+	ConsolidateSerial(model, scene);
+	std::vector<CVector3> forces(scene.particles.Size()), moments(scene.particles.Size());
+	for (size_t i = 0; i < scene.particles.Size(); ++i)
+	{
+		forces[i] = scene.particles.Force(i);
+		moments[i] = scene.particles.Moment(i);
+	}
+	const double serial = Measure(repetitions, [&] { ClearForces(scene.particles); ConsolidateSerial(model, scene); }) * 1e3;
+
+	std::cout << "Particles: " << scene.particles.Size() << ", liquid bonds: " << scene.liquidBonds.Size() << ", repetitions: " << repetitions << std::endl;
+	std::cout << "Serial consolidation: " << std::fixed << std::setprecision(3) << serial << " ms" << std::defaultfloat << std::endl;
+	std::cout << std::setw(8) << "Threads" << std::setw(14) << "Calculate ms" << std::setw(16) << "Consolidate ms" << std::setw(10) << "Speedup"
+		<< std::setw(18) << "Speedup vs serial" << std::setw(11) << "Identical" << std::endl;
+
+	double baseline = 0;
+	for (const size_t t : threads)
+	{
+		ThreadPool::CThreadPool::SetMaxThreadsNumber(t);
+		RestartThreadPool();
+		const double calculate = Measure(repetitions, [&] { Calculate(model, scene); }) * 1e3;
+		const double consolidate = Measure(repetitions, [&] { ClearForces(scene.particles); ConsolidateParallel(model, scene); }) * 1e3;
+		if (baseline == 0) baseline = consolidate;
+		std::cout << std::setw(8) << GetThreadsNumber() << std::fixed << std::setprecision(3) << std::setw(14) << calculate << std::setw(16) << consolidate
+			<< std::setprecision(2) << std::setw(10) << baseline / consolidate << std::setw(18) << serial / consolidate
+			<< std::setw(11) << (IsEqual(scene.particles, forces, moments) ? "yes" : "no") << std::defaultfloat << std::endl;
+	}
+
+	return 0;
+}
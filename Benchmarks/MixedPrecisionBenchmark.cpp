@@ -0,0 +1,166 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+/* Accuracy and performance of mixed precision of contact models. Each scene is simulated with the CPU simulator twice: with contact models
+ * in double precision and in mixed precision, where per-contact values and candidate pairs of verlet lists are evaluated in single precision.
+ * Reported are the throughput of contacts and, as accuracy measures, the drift of kinetic energy in elastic scenes without damping and friction,
+ * and the max deviation of final coordinates from the run in double precision, related to the radius of particles.
+ * Scenes are generated deterministically, so no input files are needed. Results are written into temporary files, removed after each run.
+ * Usage: musen_mixed_precision_bench [steps] [scale] [threads]. */
+
+#include "BenchmarkUtils.h"
+#include "CPUSimulator.h"
+#include "ThreadPool.h"
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace Benchmark;
+
+namespace
+{
+	const double c_radius = 1e-3;	// Mean radius of particles.
+
+	struct SSceneDescriptor
+	{
+		std::string name;
+		std::vector<std::pair<std::string, std::vector<std::pair<std::string, double>>>> models;	// Names of active models with values of their parameters.
+		bool elastic;			// Whether there is no damping and friction, so that the kinetic energy must be conserved.
+		CVector3 gravity{ 0 };	// External acceleration.
+		double timeStep;		// Simulation time step.
+		std::function<void(CSystemStructure&, size_t)> create;	// Fills the scene with the given scale.
+	};
+
+	/// Adds particles on a jittered cubic lattice with random radii in [0.95; 1.05] of the mean one and random velocities, and a closed box around them.
+	void AddLatticeInBox(CSystemStructure& _scene, size_t _n, double _step, double _velocity, double _box)
+	{
+		CRandom random{ 42 };
+		AddParticles(_scene, Lattice(_n, _n, _n, _step, 0.01 * c_radius, random), c_radius, 0.05, _velocity, random);
+		AddBox(_scene, CVector3{ _box });
+		_scene.SetSimulationDomain(SVolumeType{ CVector3{ -_box }, CVector3{ _box } });
+	}
+
+	/// Dilute particles with random velocities in a closed box, colliding with each other and with walls.
+	void CreateGas(CSystemStructure& _scene, size_t _scale)
+	{
+		const size_t n = 6 * _scale;
+		const double step = 3.0 * c_radius;
+		AddLatticeInBox(_scene, n, step, 1.0, static_cast<double>(n) * step);
+	}
+
+	/// Dense packing of particles, settling under gravity in a closed box.
+	void CreatePacking(CSystemStructure& _scene, size_t _scale)
+	{
+		const size_t n = 8 * _scale;
+		const double step = 1.98 * c_radius;
+		AddLatticeInBox(_scene, n, step, 0.1, static_cast<double>(n) * step + 2 * c_radius);
+	}
+
+	/// Returns the total kinetic energy of all particles at the given time point.
+	double KineticEnergy(const CSystemStructure& _scene, double _time)
+	{
+		double energy = 0;
+		for (const auto* part : _scene.GetAllSpheres(_time))
+			energy += 0.5 * part->GetMass() * SquaredLength(part->GetVelocity(_time)) + 0.5 * part->GetInertiaMoment() * SquaredLength(part->GetAngleVelocity(_time));
+		return energy;
+	}
+
+	struct SResult
+	{
+		size_t particles{ 0 };
+		double stepsPerSecond{ 0 };
+		double contactsPerSecond{ 0 };
+		double sharePP{ 0 };				// Share of particle-particle forces in the total wall time.
+		double sharePW{ 0 };				// Share of particle-wall forces in the total wall time.
+		double energyDrift{ 0 };			// Relative change of the kinetic energy.
+		std::vector<CVector3> coords;		// Final coordinates of particles.
+	};
+
+	/// Creates the scene and simulates it for the given number of steps with contact models in double or in mixed precision.
+	SResult Simulate(const SSceneDescriptor& _descr, size_t _steps, size_t _scale, bool _mixed)
+	{
+		// elastic interactions have no damping and no friction
+		SMaterials materials;
+		if (_descr.elastic)
+		{
+			materials.restitution = 1.0;
+			materials.staticFriction = 0.0;
+			materials.rollingFriction = 0.0;
+		}
+		CBenchmarkScene run{ "musen_mixed_bench_" + _descr.name, [&](CSystemStructure& _scene) { _descr.create(_scene, _scale); }, materials };
+		CSystemStructure& scene = run.structure;
+		const double energyBeg = KineticEnergy(scene, 0);
+		for (const auto& [name, parameters] : _descr.models)
+			run.AddModel(name, parameters);
+
+		CCPUSimulator simulator;
+		simulator.SetMixedPrecisionFlag(_mixed);
+		run.Simulate(simulator, _descr.gravity, _descr.timeStep, _steps);
+
+		SResult res;
+		res.particles = scene.GetNumberOfSpecificObjects(SPHERE);
+		const CStepProfiler& profiler = simulator.GetProfiler();
+		const double wallTime = profiler.GetWallTime();
+		const size_t contacts = profiler.GetPhase(CStepProfiler::EPhase::FORCES_PP).contacts + profiler.GetPhase(CStepProfiler::EPhase::FORCES_PW).contacts;
+		res.stepsPerSecond = static_cast<double>(profiler.GetSteps()) / wallTime;
+		res.contactsPerSecond = static_cast<double>(contacts) / wallTime;
+		res.sharePP = profiler.GetPhase(CStepProfiler::EPhase::FORCES_PP).wallTime / wallTime;
+		res.sharePW = profiler.GetPhase(CStepProfiler::EPhase::FORCES_PW).wallTime / wallTime;
+		const double endTime = simulator.GetCurrentTime();
+		res.energyDrift = std::abs(KineticEnergy(scene, endTime) - energyBeg) / energyBeg;
+		for (const auto* part : scene.GetAllSpheres(endTime))
+			res.coords.push_back(part->GetCoordinates(endTime));
+		return res;
+	}
+
+	/// Returns the max distance between coordinates of the same particles, related to the mean radius of particles.
+	double MaxDeviation(const std::vector<CVector3>& _coords1, const std::vector<CVector3>& _coords2)
+	{
+		double res = 0;
+		for (size_t i = 0; i < std::min(_coords1.size(), _coords2.size()); ++i)
+			res = std::max(res, Length(_coords1[i] - _coords2[i]) / c_radius);
+		return res;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const size_t steps = argc > 1 ? std::stoul(argv[1]) : 5000;
+	const size_t scale = argc > 2 ? std::max<size_t>(std::stoul(argv[2]), 1) : 2;
+	const size_t threads = argc > 3 ? std::stoul(argv[3]) : std::max(std::thread::hardware_concurrency(), 1u);
+	ThreadPool::CThreadPool::SetMaxThreadsNumber(threads);
+	RestartThreadPool();
+
+	const std::vector<std::pair<std::string, double>> viscoElastic{ { "NORMAL_FORCE_COEFF", 1e3 }, { "NORMAL_DAMPING_PARAMETER", 0 } };
+	const std::vector<SSceneDescriptor> scenes{
+		{ "gas-HM",     { { "ModelPPHertzMindlin", {} }, { "ModelPWHertzMindlin", {} } },                             true,  CVector3{ 0 },           1e-6, CreateGas },
+		{ "gas-SVE",    { { "ModelPPSimpleViscoElastic", viscoElastic }, { "ModelPWSimpleViscoElastic", viscoElastic } }, true,  CVector3{ 0 },           1e-6, CreateGas },
+		{ "packing-HM", { { "ModelPPHertzMindlin", {} }, { "ModelPWHertzMindlin", {} } },                             false, CVector3{ 0, 0, -9.81 }, 1e-6, CreatePacking },
+	};
+
+	std::cout << "Steps: " << steps << ", scale: " << scale << ", threads: " << GetThreadsNumber() << std::endl;
+	std::cout << std::left << std::setw(12) << "Scene" << std::setw(11) << "Precision" << std::right << std::setw(10) << "Particles" << std::setw(10) << "Steps/s"
+		<< std::setw(12) << "1e6 Cont/s" << std::setw(8) << "PP%" << std::setw(8) << "PW%" << std::setw(10) << "Speedup" << std::setw(14) << "Energy drift" << std::setw(14) << "Max dev/R" << std::endl;
+	for (const auto& scene : scenes)
+	{
+		const SResult resDouble = Simulate(scene, steps, scale, false);
+		const SResult resMixed = Simulate(scene, steps, scale, true);
+		for (const auto* res : { &resDouble, &resMixed })
+		{
+			std::cout << std::left << std::setw(12) << scene.name << std::setw(11) << (res == &resDouble ? "double" : "mixed") << std::right << std::setw(10) << res->particles
+				<< std::fixed << std::setprecision(1) << std::setw(10) << res->stepsPerSecond << std::setprecision(2) << std::setw(12) << res->contactsPerSecond / 1e6
+				<< std::setprecision(1) << std::setw(8) << res->sharePP * 100 << std::setw(8) << res->sharePW * 100
+				<< std::setprecision(2) << std::setw(10) << res->contactsPerSecond / resDouble.contactsPerSecond << std::scientific;
+			if (scene.elastic)
+				std::cout << std::setw(14) << res->energyDrift;
+			else
+				std::cout << std::setw(14) << "-";
+			std::cout << std::setw(14) << MaxDeviation(res->coords, resDouble.coords) << std::defaultfloat << std::endl;
+		}
+	}
+
+	return 0;
+}
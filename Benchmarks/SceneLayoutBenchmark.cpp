@@ -0,0 +1,220 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+/* Benchmark of the memory layout of particles in the simplified scene. Runs the loops of CCPUSimulator::MoveParticles and a particle-particle
+ * force kernel with consolidation, written once against the accessors of SParticleStruct, on two storages: the array-of-structures layout,
+ * which was used before (all kinematic and contact data of a particle in one structure), and the current SParticleStruct with a separate
+ * aligned array for each field. Both runs must give bitwise identical results.
+ * Usage: musen_layout_bench [particles number] [repetitions] [threads]. */
+
+#include "BenchmarkUtils.h"
+#include "SceneTypes.h"
+#include "ThreadPool.h"
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace Benchmark;
+
+namespace
+{
+	/// Previous array-of-structures layout of particles with the same accessors as SParticleStruct.
+	class CParticlesAoS
+	{
+		struct SContactInformation
+		{
+			CVector3	coord;
+			double		contactRadius{};
+			CVector3	coordVerlet;
+		};
+		struct SKinematics
+		{
+			double		radius{};
+			double		mass{};
+			double		inertiaMoment{};
+			CVector3	vel;
+			CVector3	anglVel;
+			CVector3	force;
+			CVector3	moment;
+		};
+		std::vector<uint8_t> active;
+		std::vector<SContactInformation> contactInfo;
+		std::vector<SKinematics> kinematicsInfo;
+
+	public:
+		uint8_t Active(size_t i) const { return active[i]; }
+		CVector3& Coord(size_t i) { return contactInfo[i].coord; }
+		double& ContactRadius(size_t i) { return contactInfo[i].contactRadius; }
+		double& Radius(size_t i) { return kinematicsInfo[i].radius; }
+		double& Mass(size_t i) { return kinematicsInfo[i].mass; }
+		double& InertiaMoment(size_t i) { return kinematicsInfo[i].inertiaMoment; }
+		CVector3& Vel(size_t i) { return kinematicsInfo[i].vel; }
+		CVector3& AnglVel(size_t i) { return kinematicsInfo[i].anglVel; }
+		CVector3& Force(size_t i) { return kinematicsInfo[i].force; }
+		CVector3& Moment(size_t i) { return kinematicsInfo[i].moment; }
+		size_t Size() const { return active.size(); }
+
+		void AddParticle(bool _active, const CVector3& _coord, double _radius, unsigned _initIndex, double _mass, double _inertiaMoment, const CVector3& _vel, const CVector3& _anglVel)
+		{
+			active.push_back(_active);
+			contactInfo.push_back(SContactInformation{ _coord, _radius, CVector3{ 0 } });
+			kinematicsInfo.push_back(SKinematics{ _radius, _mass, _inertiaMoment, _vel, _anglVel, CVector3{ 0 }, CVector3{ 0 } });
+		}
+	};
+
+	/// Contact partners of each particle in compressed sparse row format; each contact is stored for both partners.
+	struct SNeighbours
+	{
+		std::vector<unsigned> offsets;
+		std::vector<unsigned> indices;
+	};
+
+	/// Places particles on a jittered cubic lattice with a slight overlap of neighbours and fills the list of contacts.
+	template<typename P>
+	void CreateParticles(P& _particles, SNeighbours& _neighbours, size_t _number)
+	{
+		CRandom random{ 42 };
+		const double r = 1e-3;
+		size_t n = 1;
+		while (n * n * n < _number) ++n;
+		const auto Index = [&](size_t _x, size_t _y, size_t _z) { return (_x * n + _y) * n + _z; };
+		for (size_t x = 0; x < n; ++x)
+			for (size_t y = 0; y < n; ++y)
+				for (size_t z = 0; z < n; ++z)
+				{
+					const CVector3 coord = CVector3{ static_cast<double>(x), static_cast<double>(y), static_cast<double>(z) } * 1.99 * r + random.NextVector(0.001 * r);
+					_particles.AddParticle(true, coord, r, static_cast<unsigned>(Index(x, y, z)), 1e-5, 4e-12, random.NextVector(0.1), random.NextVector(10));
+				}
+		_neighbours.offsets.assign(1, 0);
+		_neighbours.indices.clear();
+		for (size_t x = 0; x < n; ++x)
+			for (size_t y = 0; y < n; ++y)
+				for (size_t z = 0; z < n; ++z)
+				{
+					for (int dx = -1; dx <= 1; ++dx)
+						for (int dy = -1; dy <= 1; ++dy)
+							for (int dz = -1; dz <= 1; ++dz)
+							{
+								if (std::abs(dx) + std::abs(dy) + std::abs(dz) != 1) continue;
+								const size_t nx = x + dx, ny = y + dy, nz = z + dz;
+								if (nx < n && ny < n && nz < n)
+									_neighbours.indices.push_back(static_cast<unsigned>(Index(nx, ny, nz)));
+							}
+					_neighbours.offsets.push_back(static_cast<unsigned>(_neighbours.indices.size()));
+				}
+	}
+
+	/// The same loops as in CCPUSimulator::MoveParticles for isotropic particles.
+	template<typename P>
+	void MoveParticles(P& _particles, const CVector3& _acceleration, double _timeStep)
+	{
+		ParallelFor(_particles.Size(), [&](size_t i)
+		{
+			if (!_particles.Active(i)) return;
+			_particles.Force(i) += _acceleration * _particles.Mass(i);
+		});
+		ParallelFor(_particles.Size(), [&](size_t i)
+		{
+			if (!_particles.Active(i)) return;
+			_particles.Vel(i) += _particles.Force(i) / _particles.Mass(i) * _timeStep;
+			_particles.AnglVel(i) += _particles.Moment(i) / _particles.InertiaMoment(i) * _timeStep;
+			_particles.Coord(i) += _particles.Vel(i) * _timeStep;
+		});
+	}
+
+	/// Elastic contact with viscous damping of the relative velocity at the contact point, as in the Hertz-Mindlin family of models.
+	/// Every particle sums forces of all its contacts.
+	template<typename P>
+	void CalculateForcesPP(P& _particles, const SNeighbours& _neighbours)
+	{
+		ParallelFor(_particles.Size(), [&](size_t i)
+		{
+			CVector3 force{ 0 }, moment{ 0 };
+			for (unsigned k = _neighbours.offsets[i]; k < _neighbours.offsets[i + 1]; ++k)
+			{
+				const unsigned j = _neighbours.indices[k];
+				const CVector3 contactVector = _particles.Coord(j) - _particles.Coord(i);
+				const double distance = contactVector.Length();
+				const double overlap = _particles.ContactRadius(i) + _particles.ContactRadius(j) - distance;
+				if (overlap <= 0) continue;
+				const CVector3 normal = contactVector / distance;
+				const double equivRadius = _particles.Radius(i) * _particles.Radius(j) / (_particles.Radius(i) + _particles.Radius(j));
+				const double equivMass = _particles.Mass(i) * _particles.Mass(j) / (_particles.Mass(i) + _particles.Mass(j));
+				const CVector3 rc1 = normal * (_particles.Radius(i) - overlap / 2);
+				const CVector3 rc2 = normal * (overlap / 2 - _particles.Radius(j));
+				const CVector3 relVel = _particles.Vel(j) + _particles.AnglVel(j) * rc2 - _particles.Vel(i) - _particles.AnglVel(i) * rc1;
+				const double normVel = DotProduct(normal, relVel);
+				const CVector3 tangVel = relVel - normal * normVel;
+				const double kn = 2e8 * std::sqrt(equivRadius * overlap);
+				const double damping = 2 * std::sqrt(equivMass * kn);
+				const CVector3 normForce = normal * (-kn * overlap + damping * normVel);
+				const CVector3 tangForce = tangVel * damping;
+				force += normForce + tangForce;
+				moment += rc1 * tangForce;
+			}
+			_particles.Force(i) = force;
+			_particles.Moment(i) = moment;
+		});
+	}
+
+	/// Returns true if coordinates, velocities and forces of all particles are bitwise equal.
+	bool IsEqual(CParticlesAoS& _aos, SParticleStruct& _soa)
+	{
+		for (size_t i = 0; i < _soa.Size(); ++i)
+			if (std::memcmp(&_aos.Coord(i), &_soa.Coord(i), sizeof(CVector3)) != 0 || std::memcmp(&_aos.Vel(i), &_soa.Vel(i), sizeof(CVector3)) != 0
+				|| std::memcmp(&_aos.AnglVel(i), &_soa.AnglVel(i), sizeof(CVector3)) != 0 || std::memcmp(&_aos.Force(i), &_soa.Force(i), sizeof(CVector3)) != 0
+				|| std::memcmp(&_aos.Moment(i), &_soa.Moment(i), sizeof(CVector3)) != 0)
+				return false;
+		return true;
+	}
+
+	struct SResult
+	{
+		double move{ 0 };	// [ms]
+		double forces{ 0 };	// [ms]
+	};
+
+	template<typename P>
+	SResult Run(P& _particles, const SNeighbours& _neighbours, size_t _repetitions)
+	{
+		const CVector3 gravity{ 0, 0, -9.81 };
+		const double timeStep = 1e-8;
+		SResult res;
+		res.forces = Measure(_repetitions, [&] { CalculateForcesPP(_particles, _neighbours); }) * 1e3;
+		res.move   = Measure(_repetitions, [&] { MoveParticles(_particles, gravity, timeStep); }) * 1e3;
+		return res;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const size_t number      = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+	const size_t repetitions = argc > 2 ? std::stoul(argv[2]) : 20;
+	const size_t threads     = argc > 3 ? std::stoul(argv[3]) : 0;
+	if (threads != 0)
+		ThreadPool::CThreadPool::SetMaxThreadsNumber(threads);
+	InitializeThreadPool();
+
+	CParticlesAoS aos;
+	SParticleStruct soa;
+	SNeighbours neighbours;
+	CreateParticles(aos, neighbours, number);
+	CreateParticles(soa, neighbours, number);
+
+	std::cout << "Particles: " << soa.Size() << ", contacts: " << neighbours.indices.size() / 2 << ", repetitions: " << repetitions << ", threads: " << GetThreadsNumber() << std::endl;
+	std::cout << std::left << std::setw(26) << "Layout" << std::right << std::setw(20) << "MoveParticles ms" << std::setw(22) << "CalculateForcesPP ms" << std::endl;
+	const SResult resAoS = Run(aos, neighbours, repetitions);
+	const SResult resSoA = Run(soa, neighbours, repetitions);
+	const auto Print = [](const std::string& _name, const SResult& _res)
+	{
+		std::cout << std::left << std::setw(26) << _name << std::right << std::fixed << std::setprecision(3) << std::setw(20) << _res.move << std::setw(22) << _res.forces << std::defaultfloat << std::endl;
+	};
+	Print("array of structures", resAoS);
+	Print("array per field, aligned", resSoA);
+	std::cout << "Speedup: MoveParticles " << std::setprecision(3) << resAoS.move / resSoA.move << ", CalculateForcesPP " << resAoS.forces / resSoA.forces << std::endl;
+	std::cout << "Results identical: " << (IsEqual(aos, soa) ? "yes" : "no") << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,383 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+/* Headless benchmark of the whole simulation loop. Synthesizes canonical scenes in memory, simulates each of them for a fixed number
+ * of steps with the CPU simulator and different numbers of threads, and reports the performance together with the breakdown by phases
+ * and, for scenes with walls, the statistics of particle-wall contact detection per step.
+ * Each run is repeated with deterministic summation of forces to measure its overhead and to check that its results are bitwise identical for all numbers of threads;
+ * the exit code is non-zero if they are not.
+ * Scenes are generated deterministically, so no input files are needed. Results are written into temporary files, removed after each run.
+ * Usage: musen_bench [steps] [scale] [threads...]. */
+
+#include "BenchmarkUtils.h"
+#include "CPUSimulator.h"
+#include "MeshGenerator.h"
+#include "ThreadPool.h"
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+using namespace Benchmark;
+
+namespace
+{
+	const double c_radius = 1e-3;	// Mean radius of particles.
+
+	struct SSceneDescriptor
+	{
+		std::string name;
+		std::vector<std::string> models;					// Names of active models.
+		CVector3 gravity{ 0 };								// External acceleration.
+		std::function<void(CSystemStructure&, size_t)> create;	// Fills the scene with the given scale.
+	};
+
+	/// Adds particles on a jittered cubic lattice with random radii in [0.95; 1.05] of the mean one and random velocities.
+	void AddLattice(CSystemStructure& _scene, size_t _nx, size_t _ny, size_t _nz, double _step, double _velocity, CRandom& _random)
+	{
+		AddParticles(_scene, Lattice(_nx, _ny, _nz, _step, 0.01 * c_radius, _random), c_radius, 0.05, _velocity, _random);
+	}
+
+	/// Random dense packing of particles, settling under gravity in a closed box.
+	void CreatePacking(CSystemStructure& _scene, size_t _scale)
+	{
+		CRandom random{ 42 };
+		const size_t n = 8 * _scale;
+		const double step = 1.98 * c_radius;
+		const CVector3 size = CVector3{ static_cast<double>(n) * step + 2 * c_radius };
+		AddLattice(_scene, n, n, n, step, 0.1, random);
+		AddBox(_scene, size);
+		_scene.SetSimulationDomain(SVolumeType{ size * -1, size });
+	}
+
+	/// Network of particles on a cubic lattice, connected by solid bonds with their nearest neighbours.
+	void CreateAgglomerates(CSystemStructure& _scene, size_t _scale)
+	{
+		CRandom random{ 42 };
+		const size_t n = 8 * _scale;
+		const double step = 2.0 * c_radius;
+		AddLattice(_scene, n, n, n, step, 0.05, random);
+		AddBonds(_scene, LatticeNeighbours(n, n, n, 0), SOLID_BOND, c_radius, c_bondKey);
+		const CVector3 size = CVector3{ static_cast<double>(n) * step };
+		_scene.SetSimulationDomain(SVolumeType{ size * -2, size * 2 });
+	}
+
+	/// Rotating drum, given as a triangular mesh, half-filled with particles.
+	void CreateDrum(CSystemStructure& _scene, size_t _scale)
+	{
+		CRandom random{ 42 };
+		const size_t n = 12 * _scale;
+		const double step = 2.05 * c_radius;
+		const double radius = static_cast<double>(n) * step * 0.8;
+		const double height = static_cast<double>(n / 2) * step + 2 * c_radius;
+		std::vector<CVector3> coords;
+		for (const auto& c : Lattice(n, n, n / 2, step, 0.01 * c_radius, random))
+			if (c.y < 0 && std::hypot(c.x, c.y) < radius - 1.5 * c_radius)
+				coords.push_back(c);
+		AddParticles(_scene, coords, c_radius, 0.05, 0.0, random);
+
+		CTriangularMesh mesh = CMeshGenerator::Cylinder(radius, height, 128).CreateInvertedMesh();
+		mesh.SetName("Drum");
+		CRealGeometry* drum = _scene.AddGeometry(mesh);
+		drum->SetMaterial(c_wallKey);
+		drum->Motion()->SetMotionType(CGeometryMotion::EMotionType::TIME_DEPENDENT);
+		CGeometryMotion::STimeMotionInterval interval;
+		interval.timeBeg = 0;
+		interval.timeEnd = 1e3;
+		interval.motion.rotationVelocity = CVector3{ 0, 0, 2 * PI };
+		drum->Motion()->AddTimeInterval(interval);
+		_scene.SetSimulationDomain(SVolumeType{ CVector3{ -2 * radius, -2 * radius, -height }, CVector3{ 2 * radius, 2 * radius, height } });
+	}
+
+	/// Particles with random velocities in a box with periodic boundaries in all directions.
+	void CreatePBC(CSystemStructure& _scene, size_t _scale)
+	{
+		CRandom random{ 42 };
+		const size_t n = 8 * _scale;
+		const double step = 2.1 * c_radius;
+		AddLattice(_scene, n, n, n, step, 0.5, random);
+		const CVector3 half = CVector3{ static_cast<double>(n) * step / 2 };
+		SPBC pbc;
+		pbc.SetDefaultValues();
+		pbc.bEnabled = pbc.bX = pbc.bY = pbc.bZ = true;
+		pbc.SetDomain(half * -1, half);
+		_scene.SetPBC(pbc);
+		_scene.SetSimulationDomain(SVolumeType{ half * -2, half * 2 });
+	}
+
+	/// Particles in a box with periodic boundaries along x and y, sheared with a linear velocity profile along z, so that particles continuously cross the boundaries.
+	void CreateShear(CSystemStructure& _scene, size_t _scale)
+	{
+		CRandom random{ 42 };
+		const size_t n = 8 * _scale;
+		const double step = 2.1 * c_radius;
+		AddLattice(_scene, n, n, n, step, 0.05, random);
+		const CVector3 half = CVector3{ static_cast<double>(n) * step / 2 };
+		for (auto* part : _scene.GetAllSpheres(0))
+			part->SetVelocity(0, part->GetVelocity(0) + CVector3{ 2.0 * part->GetCoordinates(0).z / half.z, 0, 0 });
+		SPBC pbc;
+		pbc.SetDefaultValues();
+		pbc.bEnabled = pbc.bX = pbc.bY = true;
+		pbc.SetDomain(half * -1, half);
+		_scene.SetPBC(pbc);
+		_scene.SetSimulationDomain(SVolumeType{ half * -2, half * 2 });
+	}
+
+	/// Particles on a cubic lattice, connected by liquid bridges with their nearest neighbours.
+	void CreateLiquidBonds(CSystemStructure& _scene, size_t _scale)
+	{
+		CRandom random{ 42 };
+		const size_t n = 8 * _scale;
+		const double step = 2.05 * c_radius;
+		AddLattice(_scene, n, n, n, step, 0.05, random);
+		AddBonds(_scene, LatticeNeighbours(n, n, n, 0), LIQUID_BOND, c_radius, c_liquidKey);
+		const CVector3 size = CVector3{ static_cast<double>(n) * step };
+		_scene.SetSimulationDomain(SVolumeType{ size * -2, size * 2 });
+	}
+
+	/// Bed of particles on a cubic lattice, connected by solid and liquid bonds, which moves downwards and gradually leaves the simulation domain.
+	void CreateDischarge(CSystemStructure& _scene, size_t _scale)
+	{
+		CRandom random{ 42 };
+		const size_t n = 8 * _scale;
+		const double step = 2.0 * c_radius;
+		AddLattice(_scene, n, n, n, step, 0.0, random);
+		for (auto* part : _scene.GetAllSpheres(0))
+			part->SetVelocity(0, CVector3{ 0, 0, -10 });
+		AddBonds(_scene, LatticeNeighbours(n, n, n, 0), SOLID_BOND, c_radius, c_bondKey);
+		AddBonds(_scene, LatticeNeighbours(n, n, n, 0), LIQUID_BOND, c_radius, c_liquidKey);
+		const CVector3 size = CVector3{ static_cast<double>(n) * step };
+		_scene.SetSimulationDomain(SVolumeType{ CVector3{ -size.x, -size.y, -size.z / 2 }, size });
+	}
+
+	/// Conical hopper with an open outlet, filled with particles, which flow downwards and leave the simulation domain through the outlet.
+	void CreateHopper(CSystemStructure& _scene, size_t _scale)
+	{
+		CRandom random{ 42 };
+		const size_t n = 12 * _scale;
+		const double step = 2.05 * c_radius;
+		const double height = static_cast<double>(n) * step;
+		const double radiusTop = height / 2 + 2 * c_radius;
+		const double radiusOutlet = radiusTop / 4;
+		const auto RadiusAt = [&](double _z) { return radiusOutlet + (radiusTop - radiusOutlet) * (_z / height + 0.5); };
+		std::vector<CVector3> coords;
+		for (const auto& c : Lattice(n, n, n, step, 0.01 * c_radius, random))
+			if (std::hypot(c.x, c.y) < RadiusAt(c.z) - 1.5 * c_radius)
+				coords.push_back(c);
+		AddParticles(_scene, coords, c_radius, 0.05, 0.0, random);
+		for (auto* part : _scene.GetAllSpheres(0))
+			part->SetVelocity(0, CVector3{ 0, 0, -0.5 });
+
+		// side surface of a cone frustum from the outlet at the bottom to the top, split into rings, with normals directed inwards
+		const size_t segments = 96, rings = 8;
+		const auto Vertex = [&](size_t _ring, size_t _segment)
+		{
+			const double z = height * (static_cast<double>(_ring) / rings - 0.5);
+			const double a = 2 * PI * static_cast<double>(_segment % segments) / segments;
+			return CVector3{ RadiusAt(z) * std::cos(a), RadiusAt(z) * std::sin(a), z };
+		};
+		CTriangularMesh mesh;
+		mesh.SetName("Hopper");
+		for (size_t j = 0; j < rings; ++j)
+			for (size_t i = 0; i < segments; ++i)
+			{
+				mesh.AddTriangle(CTriangle{ Vertex(j, i), Vertex(j + 1, i), Vertex(j + 1, i + 1) });
+				mesh.AddTriangle(CTriangle{ Vertex(j, i), Vertex(j + 1, i + 1), Vertex(j, i + 1) });
+			}
+		_scene.AddGeometry(mesh)->SetMaterial(c_wallKey);
+		_scene.SetSimulationDomain(SVolumeType{ CVector3{ -2 * radiusTop, -2 * radiusTop, -height }, CVector3{ 2 * radiusTop, 2 * radiusTop, height } });
+	}
+
+	/// Returns the peak resident memory of the process [bytes], or 0 if it is unknown.
+	size_t PeakMemory()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return counters.PeakWorkingSetSize;
+#else
+		std::ifstream file{ "/proc/self/status" };
+		std::string line;
+		while (std::getline(file, line))
+			if (line.compare(0, 6, "VmHWM:") == 0)
+				return std::stoull(line.substr(6)) * 1024;
+#endif
+		return 0;
+	}
+
+	/// Resets the peak resident memory to the current value, if the OS allows it.
+	void ResetPeakMemory()
+	{
+#ifndef _WIN32
+		std::ofstream file{ "/proc/self/clear_refs" };
+		if (file) file << "5";
+#endif
+	}
+
+	struct SResult
+	{
+		size_t particles{ 0 };
+		size_t bonds{ 0 };
+		double stepsPerSecond{ 0 };
+		double contactsPerSecond{ 0 };
+		size_t peakMemory{ 0 };
+		double checksum{ 0 };		// Sum of final coordinates of all particles, to compare results of different runs.
+		uint64_t hash{ 0 };			// Hash of bits of final coordinates and velocities of all particles, to check that results of different runs are identical.
+		size_t steps{ 0 };
+		size_t threads{ 0 };
+		CStepProfiler::SDetectionPW detectionPW;	// Statistics of particle-wall contact detection.
+		std::array<double, CStepProfiler::PHASES_NUMBER> shares{};	// Shares of phases in the total wall time.
+	};
+
+	/// Creates the scene and simulates it for the given number of steps with the current number of threads.
+	SResult Simulate(const SSceneDescriptor& _descr, size_t _steps, size_t _scale, bool _deterministic)
+	{
+		ResetPeakMemory();
+		CBenchmarkScene run{ "musen_bench_" + _descr.name, [&](CSystemStructure& _scene) { _descr.create(_scene, _scale); } };
+		CSystemStructure& scene = run.structure;
+		for (const auto& model : _descr.models)
+			run.AddModel(model);
+		CCPUSimulator simulator;
+		simulator.SetDeterministicForcesFlag(_deterministic);
+		run.Simulate(simulator, _descr.gravity, 1e-5, _steps);
+
+		SResult res;
+		res.peakMemory = PeakMemory();
+		res.particles = scene.GetNumberOfSpecificObjects(SPHERE);
+		res.bonds = scene.GetNumberOfSpecificObjects(SOLID_BOND) + scene.GetNumberOfSpecificObjects(LIQUID_BOND);
+		const CStepProfiler& profiler = simulator.GetProfiler();
+		const double wallTime = profiler.GetWallTime();
+		const size_t contacts = profiler.GetPhase(CStepProfiler::EPhase::FORCES_PP).contacts + profiler.GetPhase(CStepProfiler::EPhase::FORCES_PW).contacts;
+		res.steps = profiler.GetSteps();
+		res.threads = profiler.GetThreads();
+		res.detectionPW = profiler.GetDetectionPW();
+		res.stepsPerSecond = static_cast<double>(profiler.GetSteps()) / wallTime;
+		res.contactsPerSecond = static_cast<double>(contacts) / wallTime;
+		for (size_t i = 0; i < CStepProfiler::PHASES_NUMBER; ++i)
+			res.shares[i] = profiler.GetPhase(static_cast<CStepProfiler::EPhase>(i)).wallTime / wallTime;
+		const double endTime = simulator.GetCurrentTime();
+		res.hash = 14695981039346656037ull;
+		const auto Hash = [&](const CVector3& _v)
+		{
+			for (const double value : { _v.x, _v.y, _v.z })
+			{
+				uint64_t bits;
+				std::memcpy(&bits, &value, sizeof(bits));
+				res.hash = (res.hash ^ bits) * 1099511628211ull;
+			}
+		};
+		for (const auto* part : scene.GetAllSpheres(endTime))
+		{
+			const CVector3 c = part->GetCoordinates(endTime);
+			res.checksum += c.x + c.y + c.z;
+			Hash(c);
+			Hash(part->GetVelocity(endTime));
+		}
+		return res;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const size_t steps = argc > 1 ? std::stoul(argv[1]) : 200;
+	const size_t scale = argc > 2 ? std::max<size_t>(std::stoul(argv[2]), 1) : 2;
+	std::vector<size_t> threads;
+	for (int i = 3; i < argc; ++i)
+		threads.push_back(std::stoul(argv[i]));
+	if (threads.empty())
+		for (size_t t = 1; t <= std::max(std::thread::hardware_concurrency(), 1u); t *= 2)
+			threads.push_back(t);
+
+	const std::vector<SSceneDescriptor> scenes{
+		{ "packing",     { "ModelPPHertzMindlin", "ModelPWHertzMindlin" },   CVector3{ 0, 0, -9.81 }, CreatePacking },
+		{ "agglomerate", { "ModelPPHertzMindlin", "ModelSBElastic" },        CVector3{ 0 },           CreateAgglomerates },
+		{ "drum",        { "ModelPPHertzMindlin", "ModelPWHertzMindlin" },   CVector3{ 0, -9.81, 0 }, CreateDrum },
+		{ "pbc",         { "ModelPPHertzMindlin" },                          CVector3{ 0 },           CreatePBC },
+		{ "shear",       { "ModelPPHertzMindlin" },                          CVector3{ 0 },           CreateShear },
+		{ "liquid",      { "ModelPPHertzMindlin", "ModelLBCapilarViscous" }, CVector3{ 0 },           CreateLiquidBonds },
+		{ "discharge",   { "ModelPPHertzMindlin", "ModelSBElastic", "ModelLBCapilarViscous" }, CVector3{ 0 }, CreateDischarge },
+		{ "hopper",      { "ModelPPHertzMindlin", "ModelPWHertzMindlin" },   CVector3{ 0, 0, -9.81 }, CreateHopper },
+	};
+
+	// phases to show in the breakdown
+	const std::vector<std::pair<CStepProfiler::EPhase, std::string>> phases{
+		{ CStepProfiler::EPhase::VERLET_REBUILD,    "Verlet%" },
+		{ CStepProfiler::EPhase::CONTACT_DETECTION, "Detect%" },
+		{ CStepProfiler::EPhase::FORCES_PP,         "PP%" },
+		{ CStepProfiler::EPhase::FORCES_PW,         "PW%" },
+		{ CStepProfiler::EPhase::FORCES_SB,         "SB%" },
+		{ CStepProfiler::EPhase::FORCES_LB,         "LB%" },
+		{ CStepProfiler::EPhase::MOVE_OBJECTS,      "Move%" },
+		{ CStepProfiler::EPhase::SAVE_DATA,         "Save%" },
+	};
+
+	std::cout << "Steps: " << steps << ", scale: " << scale << std::endl;
+	std::cout << std::left << std::setw(13) << "Scene" << std::right << std::setw(8) << "Threads" << std::setw(10) << "Particles" << std::setw(8) << "Bonds"
+		<< std::setw(10) << "Steps/s" << std::setw(12) << "1e6 Cont/s" << std::setw(10) << "Speedup" << std::setw(10) << "Peak MB";
+	for (const auto& phase : phases)
+		std::cout << std::setw(9) << phase.second;
+	std::cout << std::setw(16) << "Checksum" << std::endl;
+
+	std::vector<std::pair<std::string, SResult>> resultsPW; // runs with particle-wall contacts
+	std::vector<std::tuple<std::string, SResult, SResult>> resultsDet; // runs with default and deterministic summation of forces
+	for (const auto& scene : scenes)
+	{
+		double baseline = 0;
+		for (const size_t t : threads)
+		{
+			ThreadPool::CThreadPool::SetMaxThreadsNumber(t);
+			RestartThreadPool();
+			const SResult res = Simulate(scene, steps, scale, false);
+			resultsDet.emplace_back(scene.name, res, Simulate(scene, steps, scale, true));
+			if (baseline == 0) baseline = res.stepsPerSecond;
+			std::cout << std::left << std::setw(13) << scene.name << std::right << std::setw(8) << GetThreadsNumber() << std::setw(10) << res.particles << std::setw(8) << res.bonds
+				<< std::fixed << std::setprecision(1) << std::setw(10) << res.stepsPerSecond << std::setprecision(2) << std::setw(12) << res.contactsPerSecond / 1e6
+				<< std::setw(10) << res.stepsPerSecond / baseline << std::setprecision(1) << std::setw(10) << static_cast<double>(res.peakMemory) / (1024 * 1024);
+			for (const auto& phase : phases)
+				std::cout << std::setw(9) << res.shares[static_cast<size_t>(phase.first)] * 100;
+			std::cout << std::scientific << std::setprecision(8) << std::setw(16) << res.checksum << std::defaultfloat << std::endl;
+			if (res.detectionPW.candidates != 0)
+				resultsPW.emplace_back(scene.name, res);
+		}
+	}
+
+	// statistics of particle-wall contact detection per step
+	std::cout << std::endl << std::left << std::setw(13) << "PW detection" << std::right << std::setw(8) << "Threads" << std::setw(14) << "Candidates"
+		<< std::setw(12) << "Tested" << std::setw(12) << "Contacts" << std::setw(14) << "Allocations" << std::endl;
+	for (const auto& [name, res] : resultsPW)
+	{
+		const double steps = static_cast<double>(std::max<size_t>(res.steps, 1));
+		std::cout << std::left << std::setw(13) << name << std::right << std::setw(8) << res.threads << std::fixed << std::setprecision(1)
+			<< std::setw(14) << static_cast<double>(res.detectionPW.candidates) / steps << std::setw(12) << static_cast<double>(res.detectionPW.tested) / steps
+			<< std::setw(12) << static_cast<double>(res.detectionPW.contacts) / steps << std::setprecision(3) << std::setw(14) << static_cast<double>(res.detectionPW.allocations) / steps
+			<< std::defaultfloat << std::endl;
+	}
+
+	// deterministic summation of forces: overhead and equality of results to the run with the first number of threads
+	std::cout << std::endl << std::left << std::setw(13) << "Deterministic" << std::right << std::setw(8) << "Threads" << std::setw(10) << "Steps/s"
+		<< std::setw(11) << "Overhead%" << std::setw(14) << "Default same" << std::setw(20) << "Deterministic same" << std::setw(18) << "Hash" << std::endl;
+	bool reproducible = true;
+	for (size_t i = 0; i < resultsDet.size(); ++i)
+	{
+		const auto& [name, def, det] = resultsDet[i];
+		const auto& first = resultsDet[i - i % threads.size()];
+		const bool sameDet = std::get<2>(first).hash == det.hash;
+		reproducible &= sameDet;
+		std::cout << std::left << std::setw(13) << name << std::right << std::setw(8) << det.threads << std::fixed << std::setprecision(1)
+			<< std::setw(10) << det.stepsPerSecond << std::setw(11) << (def.stepsPerSecond / det.stepsPerSecond - 1) * 100
+			<< std::setw(14) << (std::get<1>(first).hash == def.hash ? "yes" : "no") << std::setw(20) << (sameDet ? "yes" : "no") << std::hex << std::setw(18) << det.hash << std::dec << std::defaultfloat << std::endl;
+	}
+
+	return reproducible ? 0 : 1;
+}
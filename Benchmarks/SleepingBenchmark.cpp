@@ -0,0 +1,185 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+/* Performance of sleeping of quasi-static particles on filling of a box followed by settling of the bed. Particles are released from a column
+ * of lattice layers above the floor of the box, so that lower layers form the bed while upper ones are still falling onto it. The scene is simulated
+ * with the CPU simulator without and with sleeping. Reported are the fraction of awake particles and the wall time of each interval of simulated
+ * time in both runs, the total speedup and the state of the final bed. The scene is generated deterministically, so no input files are needed.
+ * Results are written into temporary files, removed after each run.
+ * Usage: musen_sleeping_bench [scale] [threads] [sleep velocity] [sleep acceleration] [sleep steps]. */
+
+#include "BenchmarkUtils.h"
+#include "CPUSimulator.h"
+#include "ThreadPool.h"
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace Benchmark;
+
+namespace
+{
+	const double c_radius = 2e-3;		// Radius of particles.
+	const double c_lateralStep = 2.6 * c_radius;	// Distance between particles in a layer.
+	const double c_verticalStep = 3.0 * c_radius;	// Distance between layers.
+	const size_t c_layers = 12;			// Number of layers of particles.
+	const double c_timeStep = 2e-6;		// Simulation time step.
+	const double c_endTime = 0.6;		// Simulated time interval.
+	const double c_interval = 0.025;	// Interval of simulated time, over which the statistics is gathered.
+
+	/// Parameters of a run.
+	struct SConfig
+	{
+		bool sleeping{ false };
+		double velocity{ 0 };
+		double acceleration{ 0 };
+		uint32_t steps{ 0 };
+	};
+
+	/// Statistics of an interval of simulated time.
+	struct SInterval
+	{
+		double wallTime{ 0 };		// Wall time spent on the interval [s].
+		double awakeFraction{ 0 };	// Fraction of awake particles at the end of the interval.
+	};
+
+	/// Final state of the bed.
+	struct SResult
+	{
+		size_t particles{ 0 };
+		double wallTime{ 0 };			// Wall time of the simulation [s].
+		double meanHeight{ 0 };			// Mean height of particles over the floor [m].
+		double maxHeight{ 0 };			// Max height of particles over the floor [m].
+		double kineticEnergy{ 0 };		// Translational kinetic energy of all particles [J].
+		std::array<double, CStepProfiler::PHASES_NUMBER> phases{};	// Wall time of each phase of the simulation step [s].
+		std::vector<SInterval> intervals;
+	};
+
+	/// Returns the size of the box along horizontal axes.
+	double BoxWidth(size_t _n) { return static_cast<double>(_n) * c_lateralStep + 0.4 * c_radius; }
+	/// Returns the height of the box.
+	double BoxHeight() { return static_cast<double>(c_layers + 2) * c_verticalStep; }
+
+	/// Layers of n x n particles with slightly disturbed positions and velocities above the floor of a closed box.
+	void CreateScene(CSystemStructure& _scene, size_t _n)
+	{
+		CRandom random{ 42 };
+		const double width = BoxWidth(_n);
+		const double height = BoxHeight();
+		std::vector<CVector3> coords(_n * _n * c_layers);
+		for (size_t i = 0; i < coords.size(); ++i)
+		{
+			const double x = static_cast<double>(i % _n) + 0.5 + random.Next(-0.05, 0.05);
+			const double y = static_cast<double>(i / _n % _n) + 0.5 + random.Next(-0.05, 0.05);
+			const double z = static_cast<double>(i / (_n * _n)) + 0.5;
+			coords[i] = CVector3{ x * c_lateralStep - width / 2, y * c_lateralStep - width / 2, z * c_verticalStep - height / 2 };
+		}
+		for (auto* part : AddParticles(_scene, coords, c_radius, 0.0, 0.0, random))
+			part->SetVelocity(0, CVector3{ random.Next(-0.01, 0.01), random.Next(-0.01, 0.01), 0 });
+		AddBox(_scene, CVector3{ width, width, height });
+		_scene.SetSimulationDomain(SVolumeType{ CVector3{ -width, -width, -height }, CVector3{ width, width, height } });
+	}
+
+	/// CPU simulator, which gathers the wall time and the number of sleeping particles over intervals of simulated time.
+	class CSleepingSimulator : public CCPUSimulator
+	{
+		double m_nextSample{ c_interval };
+		std::chrono::steady_clock::time_point m_lastSample{ std::chrono::steady_clock::now() };
+
+	public:
+		std::vector<SInterval> intervals;
+
+		void MoveParticles(bool _bPredictionStep) override
+		{
+			CCPUSimulator::MoveParticles(_bPredictionStep);
+			if (m_currentTime + m_currSimulationStep < m_nextSample * (1 - 1e-9)) return;
+			const auto now = std::chrono::steady_clock::now();
+			const double particles = static_cast<double>(m_scene.GetRealParticlesNumber() - m_nInactiveParticles);
+			intervals.push_back(SInterval{ std::chrono::duration<double>(now - m_lastSample).count(), particles != 0 ? 1 - static_cast<double>(m_nSleepingParticles) / particles : 0 });
+			m_lastSample = now;
+			m_nextSample += c_interval;
+		}
+	};
+
+	/// Creates the scene and simulates it with the given parameters.
+	SResult Simulate(size_t _scale, const SConfig& _config)
+	{
+		// damped frictional interactions
+		SMaterials materials;
+		materials.youngModulus = 5e6;
+		materials.restitution = 0.3;
+		materials.staticFriction = 0.5;
+		materials.rollingFriction = 0.1;
+		CBenchmarkScene run{ "musen_sleeping_bench", [&](CSystemStructure& _scene) { CreateScene(_scene, 8 * _scale); }, materials };
+		CSystemStructure& scene = run.structure;
+		run.AddModel("ModelPPHertzMindlin");
+		run.AddModel("ModelPWHertzMindlin");
+
+		CSleepingSimulator simulator;
+		simulator.SetSleepingFlag(_config.sleeping);
+		if (_config.velocity != 0)
+			simulator.SetSleepVelocity(_config.velocity);
+		if (_config.acceleration != 0)
+			simulator.SetSleepAcceleration(_config.acceleration);
+		if (_config.steps != 0)
+			simulator.SetSleepSteps(_config.steps);
+		run.Simulate(simulator, CVector3{ 0, 0, -GRAVITY_CONSTANT }, c_timeStep, static_cast<size_t>(std::round(c_endTime / c_timeStep)));
+
+		SResult res;
+		res.particles = scene.GetNumberOfSpecificObjects(SPHERE);
+		res.wallTime = simulator.GetProfiler().GetWallTime();
+		res.intervals = simulator.intervals;
+		for (size_t i = 0; i < CStepProfiler::PHASES_NUMBER; ++i)
+			res.phases[i] = simulator.GetProfiler().GetPhase(static_cast<CStepProfiler::EPhase>(i)).wallTime;
+		const double floor = -BoxHeight() / 2;
+		const auto& particles = simulator.GetPointerToSimplifiedScene().GetRefToParticles();
+		for (size_t i = 0; i < particles.Size(); ++i)
+		{
+			const double height = particles.Coord(i).z - floor;
+			res.meanHeight += height / static_cast<double>(particles.Size());
+			res.maxHeight = std::max(res.maxHeight, height);
+			res.kineticEnergy += 0.5 * particles.Mass(i) * particles.Vel(i).SquaredLength();
+		}
+		return res;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const size_t scale = argc > 1 ? std::max<size_t>(std::stoul(argv[1]), 1) : 1;
+	const size_t threads = argc > 2 ? std::stoul(argv[2]) : std::max(std::thread::hardware_concurrency(), 1u);
+	SConfig sleeping{ true };
+	sleeping.velocity = argc > 3 ? std::stod(argv[3]) : 0;
+	sleeping.acceleration = argc > 4 ? std::stod(argv[4]) : 0;
+	sleeping.steps = argc > 5 ? static_cast<uint32_t>(std::stoul(argv[5])) : 0;
+	ThreadPool::CThreadPool::SetMaxThreadsNumber(threads);
+	RestartThreadPool();
+
+	std::cout << "Scale: " << scale << ", threads: " << GetThreadsNumber() << std::endl;
+	const SResult ref = Simulate(scale, SConfig{});
+	const SResult res = Simulate(scale, sleeping);
+
+	std::cout << std::endl << std::right << std::setw(10) << "Time [s]" << std::setw(10) << "Awake" << std::setw(14) << "Wall ref [s]" << std::setw(16) << "Wall sleep [s]" << std::setw(10) << "Speedup" << std::endl;
+	for (size_t i = 0; i < std::min(ref.intervals.size(), res.intervals.size()); ++i)
+		std::cout << std::fixed << std::setprecision(3) << std::setw(10) << static_cast<double>(i + 1) * c_interval << std::setw(9) << std::setprecision(1) << res.intervals[i].awakeFraction * 100 << "%"
+			<< std::setprecision(3) << std::setw(14) << ref.intervals[i].wallTime << std::setw(16) << res.intervals[i].wallTime << std::setprecision(2) << std::setw(9)
+			<< (res.intervals[i].wallTime != 0 ? ref.intervals[i].wallTime / res.intervals[i].wallTime : 0.0) << "x" << std::defaultfloat << std::endl;
+
+	std::cout << std::endl << std::left << std::setw(12) << "Run" << std::right << std::setw(10) << "Particles" << std::setw(11) << "Wall [s]" << std::setw(16) << "Mean height [m]"
+		<< std::setw(15) << "Max height [m]" << std::setw(18) << "Kinetic energy [J]" << std::endl;
+	for (const auto& [name, r] : { std::pair<std::string, const SResult&>{ "reference", ref }, std::pair<std::string, const SResult&>{ "sleeping", res } })
+		std::cout << std::left << std::setw(12) << name << std::right << std::setw(10) << r.particles << std::fixed << std::setprecision(3) << std::setw(11) << r.wallTime
+			<< std::scientific << std::setprecision(4) << std::setw(16) << r.meanHeight << std::setw(15) << r.maxHeight << std::setw(18) << r.kineticEnergy << std::defaultfloat << std::endl;
+	std::cout << std::endl << std::left << std::setw(20) << "Phase" << std::right << std::setw(12) << "Ref [s]" << std::setw(12) << "Sleep [s]" << std::endl;
+	for (size_t i = 0; i < CStepProfiler::PHASES_NUMBER; ++i)
+		if (ref.phases[i] != 0 || res.phases[i] != 0)
+			std::cout << std::left << std::setw(20) << CStepProfiler::GetPhaseName(static_cast<CStepProfiler::EPhase>(i)) << std::right << std::fixed << std::setprecision(3)
+				<< std::setw(12) << ref.phases[i] << std::setw(12) << res.phases[i] << std::defaultfloat << std::endl;
+	std::cout << "Total speedup: " << std::fixed << std::setprecision(2) << (res.wallTime != 0 ? ref.wallTime / res.wallTime : 0.0) << "x" << std::endl;
+
+	return 0;
+}
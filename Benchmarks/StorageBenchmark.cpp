@@ -0,0 +1,129 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+/* Benchmark of the storage of time-dependent data. Writes the same synthetic time points of many objects with different formats of
+ * data blocks and measures the throughput of writing and of reading of random time points, as well as the size of the file. */
+
+#include "BenchmarkUtils.h"
+#include "DemStorage.h"
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace Benchmark;
+
+namespace
+{
+	struct SFormat
+	{
+		std::string name;
+		bool columnar;
+		CColumnarBlock::ECodec codec;
+		bool singlePrecision;
+	};
+
+	struct SResult
+	{
+		double writeTime{ 0 };	// [s]
+		double readTime{ 0 };	// [s]
+		uint64_t fileSize{ 0 };	// [bytes]
+		double maxDiff{ 0 };	// Max relative difference of read coordinates.
+	};
+
+	const size_t c_valuesPerObject = 16; // coordinates, velocity, angular velocity, force, orientation
+
+	/// Returns coordinates of the object at the time point.
+	CVector3 Coord(size_t _object, size_t _timePoint)
+	{
+		return CVector3{ 1e-3 * static_cast<double>(_object % 100), 1e-3 * static_cast<double>(_object / 100 % 100), 1e-3 * static_cast<double>(_object / 10000) } + CVector3{ 1e-5 * static_cast<double>(_timePoint) };
+	}
+
+	SResult Run(const SFormat& _format, const std::string& _file, size_t _objects, size_t _timePoints, size_t _reads)
+	{
+		SResult res;
+		CRandom random{ 42 };
+		std::filesystem::remove(_file);
+
+		// write
+		{
+			CDemStorage storage;
+			storage.SetBlockFormat(_format.columnar, _format.codec, _format.singlePrecision);
+			storage.CreateNewFile(_file);
+			const auto start = std::chrono::steady_clock::now();
+			for (size_t t = 0; t < _timePoints; ++t)
+			{
+				storage.PrepareTimePointForWrite(static_cast<double>(t) * 1e-3, static_cast<int>(_objects));
+				const CTimePointW* timePoint = storage.GetTimePointW();
+				for (size_t i = 0; i < _objects; ++i)
+				{
+					const int id = static_cast<int>(i);
+					timePoint->SetCoord(id, Coord(i, t));
+					timePoint->SetVel(id, random.NextVector(0.1));
+					timePoint->SetAngleVel(id, random.NextVector(10));
+					timePoint->SetForce(id, random.NextVector(1e-3));
+					timePoint->SetOrientation(id, CQuaternion{ random.NextVector(1) }.Normalized());
+				}
+			}
+			storage.FlushToDisk(true);
+			storage.FinalTruncate();
+			res.writeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+		res.fileSize = std::filesystem::file_size(_file);
+
+		// read random time points
+		{
+			CDemStorage storage;
+			storage.OpenFile(_file);
+			storage.LoadFromFile();
+			const auto start = std::chrono::steady_clock::now();
+			for (size_t r = 0; r < _reads; ++r)
+			{
+				const auto t = static_cast<size_t>(random.Next() * static_cast<double>(_timePoints));
+				storage.PrepareTimePointForRead(static_cast<double>(t) * 1e-3, static_cast<int>(_objects));
+				const CTimePointR* timePoint = storage.GetTimePointR();
+				for (size_t i = 0; i < _objects; ++i)
+					res.maxDiff = std::max(res.maxDiff, Length(timePoint->GetCoord(static_cast<int>(i)) - Coord(i, t)) / Length(Coord(i, t)));
+			}
+			res.readTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		std::filesystem::remove(_file);
+		return res;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const size_t objects    = argc > 1 ? std::stoul(argv[1]) : 100'000;
+	const size_t timePoints = argc > 2 ? std::stoul(argv[2]) : 20;
+	const size_t reads      = argc > 3 ? std::stoul(argv[3]) : 20;
+	const std::string file = (std::filesystem::temp_directory_path() / "musen_storage_bench.mdem").string();
+
+	const std::vector<SFormat> formats{
+		{ "protobuf + zlib",        false, CColumnarBlock::ECodec::ZLIB, false },
+		{ "columnar",               true,  CColumnarBlock::ECodec::NONE, false },
+		{ "columnar + zlib",        true,  CColumnarBlock::ECodec::ZLIB, false },
+		{ "columnar float",         true,  CColumnarBlock::ECodec::NONE, true },
+		{ "columnar float + zlib",  true,  CColumnarBlock::ECodec::ZLIB, true },
+	};
+
+	const double dataSize = static_cast<double>(objects * timePoints * c_valuesPerObject * sizeof(double)) / (1024 * 1024);
+	const double readSize = static_cast<double>(objects * reads * c_valuesPerObject * sizeof(double)) / (1024 * 1024);
+	std::cout << "Objects: " << objects << ", time points: " << timePoints << ", random reads: " << reads << ", data: " << dataSize << " MB" << std::endl;
+	std::cout << std::left << std::setw(24) << "Format" << std::right << std::setw(12) << "Write MB/s" << std::setw(12) << "Read MB/s"
+		<< std::setw(14) << "Read ms/tp" << std::setw(12) << "File MB" << std::setw(10) << "Ratio" << std::setw(14) << "Max rel diff" << std::endl;
+	for (const auto& format : formats)
+	{
+		const SResult res = Run(format, file, objects, timePoints, reads);
+		const double fileSize = static_cast<double>(res.fileSize) / (1024 * 1024);
+		std::cout << std::left << std::setw(24) << format.name << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(12) << dataSize / res.writeTime << std::setw(12) << readSize / res.readTime << std::setw(14) << res.readTime / static_cast<double>(reads) * 1e3
+			<< std::setw(12) << fileSize << std::setprecision(2) << std::setw(10) << dataSize / fileSize
+			<< std::setw(14) << std::scientific << std::setprecision(1) << res.maxDiff << std::defaultfloat << std::endl;
+	}
+
+	return 0;
+}
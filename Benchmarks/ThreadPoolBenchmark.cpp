@@ -0,0 +1,212 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+/* Micro-benchmark of the parallel loop engine. Compares the work-stealing thread pool with the previously used
+ * queue-based pool with static strided distribution of indices, on uniform and skewed workloads.
+ * Also compares parallel reductions with the previously used serial loops and temporary buffers on 1M particles. */
+
+#include "BenchmarkUtils.h"
+#include "ThreadPool.h"
+#include "ThreadSafeQueue.h"
+#include "ThreadTask.h"
+#include "Vector3.h"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+
+using namespace Benchmark;
+
+namespace
+{
+	/// Reproduction of the legacy thread pool: a queue of tasks, each thread gets every N-th index.
+	class CLegacyThreadPool
+	{
+		ThreadPool::CThreadSafeQueue<std::unique_ptr<ThreadPool::IThreadTask>> m_workQueue;
+		std::vector<std::thread> m_threads;
+
+	public:
+		explicit CLegacyThreadPool(size_t _threads)
+		{
+			for (size_t i = 0; i < _threads; ++i)
+				m_threads.emplace_back([this]
+				{
+					std::unique_ptr<ThreadPool::IThreadTask> task{ nullptr };
+					while (m_workQueue.WaitPop(task))
+						task->Execute();
+				});
+		}
+
+		~CLegacyThreadPool()
+		{
+			m_workQueue.Invalidate();
+			for (auto& thread : m_threads)
+				thread.join();
+		}
+
+		void SubmitParallelJobs(size_t _count, const std::function<void(size_t)>& _fun)
+		{
+			using FunType = std::function<void()>;
+			const size_t threadsNumber = m_threads.size();
+			const size_t tasksPerThread = _count / threadsNumber;
+			const size_t additionalTasks = _count % threadsNumber;
+
+			int counter{ 0 };
+			std::mutex waitMutex;
+			std::unique_lock<std::mutex> lock(waitMutex);
+			std::condition_variable waitEvent;
+
+			for (size_t iThread = 0; iThread < threadsNumber; ++iThread)
+			{
+				size_t size = tasksPerThread;
+				if (additionalTasks > iThread) ++size;
+				if (size == 0) break;
+				counter++;
+				FunType task = [iThread, threadsNumber, size, &_fun, &counter, &waitEvent, &waitMutex]()
+				{
+					for (size_t j = 0; j < size; ++j)
+						_fun(threadsNumber * j + iThread);
+					std::unique_lock<std::mutex> lockTask(waitMutex);
+					if (--counter == 0)
+						waitEvent.notify_all();
+				};
+				m_workQueue.Push(std::make_unique<ThreadPool::CThreadTask<const FunType>>(std::move(task)));
+			}
+
+			while (counter != 0)
+				waitEvent.wait(lock);
+		}
+	};
+
+	/// Some floating point work of the given length.
+	double Work(size_t _i, size_t _length)
+	{
+		double res = static_cast<double>(_i);
+		for (size_t k = 0; k < _length; ++k)
+			res = std::sqrt(res + static_cast<double>(k));
+		return res;
+	}
+
+	/// Returns the average time of a single parallel loop in microseconds.
+	template<typename F>
+	double MeasureLoop(size_t _repetitions, F&& _loop)
+	{
+		return Measure(_repetitions, std::forward<F>(_loop)) * 1e6;
+	}
+
+	void PrintResult(const std::string& _name, size_t _count, double _legacy, double _new)
+	{
+		std::cout << std::left << std::setw(28) << _name << std::right << std::setw(10) << _count
+			<< std::setw(14) << std::fixed << std::setprecision(1) << _legacy
+			<< std::setw(14) << _new
+			<< std::setw(10) << std::setprecision(2) << _legacy / _new << std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const size_t threads = argc > 1 ? std::stoul(argv[1]) : 0;
+	ThreadPool::CThreadPool::SetMaxThreadsNumber(threads == 0 ? ThreadPool::CThreadPool::GetAllowedThreadsNumber() : threads);
+	InitializeThreadPool();
+	CLegacyThreadPool legacy(GetThreadsNumber());
+
+	std::cout << "Threads: " << GetThreadsNumber() << std::endl;
+	std::cout << std::left << std::setw(28) << "Workload" << std::right << std::setw(10) << "Count"
+		<< std::setw(14) << "Legacy [us]" << std::setw(14) << "New [us]" << std::setw(10) << "Speedup" << std::endl;
+
+	for (const size_t count : { size_t{ 100 }, size_t{ 10'000 }, size_t{ 1'000'000 } })
+	{
+		std::vector<double> res(count);
+		const size_t repetitions = std::max(size_t{ 5 }, size_t{ 2'000'000 } / count);
+
+		// empty body: pure overhead of the loop engine
+		const auto empty = [&](size_t i) { res[i] = static_cast<double>(i); };
+		PrintResult("Empty body", count,
+			MeasureLoop(repetitions, [&] { legacy.SubmitParallelJobs(count, empty); }),
+			MeasureLoop(repetitions, [&] { ParallelFor(count, empty); }));
+
+		// uniform work for each index
+		const auto uniform = [&](size_t i) { res[i] = Work(i, 20); };
+		PrintResult("Uniform", count,
+			MeasureLoop(repetitions, [&] { legacy.SubmitParallelJobs(count, uniform); }),
+			MeasureLoop(repetitions, [&] { ParallelFor(count, uniform); }));
+
+		// growing work: typical for lists of neighbors sorted by index
+		const auto linear = [&](size_t i) { res[i] = Work(i, 40 * i / count); };
+		PrintResult("Skewed (linear)", count,
+			MeasureLoop(repetitions, [&] { legacy.SubmitParallelJobs(count, linear); }),
+			MeasureLoop(repetitions, [&] { ParallelFor(count, linear); }));
+
+		// a dense cluster: 5 % of indices carry most of the work
+		const auto cluster = [&](size_t i) { res[i] = Work(i, i < count / 20 ? 400 : 2); };
+		PrintResult("Skewed (dense cluster)", count,
+			MeasureLoop(repetitions, [&] { legacy.SubmitParallelJobs(count, cluster); }),
+			MeasureLoop(repetitions, [&] { ParallelFor(count, cluster); }));
+	}
+
+	// reductions over particles, as used to select the time step and to check the need to update Verlet lists
+	{
+		const size_t count = 1'000'000;
+		const size_t repetitions = 20;
+		std::vector<double> masses(count);
+		std::vector<CVector3> forces(count), vels(count), coords(count), verletCoords(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const double x = static_cast<double>(i);
+			masses[i] = 1e-5 * (1 + std::sin(x) * 0.1);
+			forces[i] = CVector3{ std::sin(x), std::cos(x), 1e-3 * std::sin(3 * x) } * 1e-4;
+			vels[i] = CVector3{ std::cos(2 * x), std::sin(5 * x), 0.5 };
+			coords[i] = CVector3{ x, 0, 0 } * 1e-3;
+			verletCoords[i] = coords[i] + CVector3{ std::sin(7 * x), 0, 0 } * 1e-6;
+		}
+		double sink = 0;
+		const auto MaxStep = [&](size_t i) { return std::pow(masses[i], 2.) / forces[i].SquaredLength(); };
+		const auto Displacement = [&](size_t i) { return SquaredLength(coords[i] - verletCoords[i]); };
+		const auto Velocity = [&](size_t i) { return vels[i].SquaredLength(); };
+
+		PrintResult("Min time step", count,
+			MeasureLoop(repetitions, [&]
+			{
+				double res = std::numeric_limits<double>::max();
+				for (size_t i = 0; i < count; ++i)
+					res = std::min(res, MaxStep(i));
+				sink += res;
+			}),
+			MeasureLoop(repetitions, [&] { sink += ParallelMin(count, std::numeric_limits<double>::max(), MaxStep); }));
+
+		std::vector<double> buffer;
+		PrintResult("Max displacement", count,
+			MeasureLoop(repetitions, [&]
+			{
+				buffer.resize(count);
+				ParallelFor(count, [&](size_t i) { buffer[i] = Displacement(i); });
+				sink += *std::max_element(buffer.begin(), buffer.end());
+			}),
+			MeasureLoop(repetitions, [&] { sink += ParallelMax(count, 0.0, Displacement); }));
+
+		PrintResult("Max velocity", count,
+			MeasureLoop(repetitions, [&]
+			{
+				std::vector<double> partials(GetThreadsNumber(), 0);
+				ParallelFor(count, [&](size_t i) { partials[GetCurrentThreadIndex()] = std::max(partials[GetCurrentThreadIndex()], Velocity(i)); });
+				sink += *std::max_element(partials.begin(), partials.end());
+			}),
+			MeasureLoop(repetitions, [&] { sink += ParallelMax(count, 0.0, Velocity); }));
+
+		PrintResult("Sum", count,
+			MeasureLoop(repetitions, [&]
+			{
+				double res = 0;
+				for (size_t i = 0; i < count; ++i)
+					res += Velocity(i);
+				sink += res;
+			}),
+			MeasureLoop(repetitions, [&] { sink += ParallelSum(count, 0.0, Velocity); }));
+
+		if (sink == 0) std::cout << std::endl; // keep the results alive
+	}
+
+	return 0;
+}
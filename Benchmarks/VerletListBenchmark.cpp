@@ -0,0 +1,393 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+/* Benchmark of the contact detection grid. Compares the dense and the sparse cell grids of the verlet list
+ * on a dense packing, which fills the whole simulation domain, and on sparse scenes, where particles occupy a small part of it.
+ * Then compares the full rebuild with the incremental update in a quasi-static process, where only a small part of particles
+ * moves far between updates, and checks that no close pairs of particles are missing in the incrementally updated lists.
+ * Finally measures rebuilds of polydisperse beds with different ratios of particle sizes in a tall domain, where the number of cells
+ * is limited, so that cells contain many particles and are checked with sweep-and-prune. And measures rebuilds in a mixer with a finely
+ * meshed drum and blades, which rotate between updates, so that all walls are rebinned each time.
+ * At last simulates steps of a rotating drum and of a mixer with rotating blades, where only one geometry moves: compares the coupled
+ * update, where each trigger leads to the full rebuild, with the separate update of particle-wall lists of moved geometries,
+ * and checks that no close particle-wall pairs are missing. */
+
+#include "BenchmarkUtils.h"
+#include "VerletList.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace Benchmark;
+
+namespace
+{
+	struct SSceneDescriptor
+	{
+		std::string name;
+		SVolumeType domain;		// simulation domain
+		SVolumeType bulk;		// volume filled with particles
+		double radius;			// mean radius of particles
+	};
+
+	/// Fills the scene with particles on a jittered lattice inside the bulk volume and adds a bottom wall.
+	/// If the size ratio is given, radii are distributed log-uniformly between radius / ratio and radius.
+	void CreateScene(CSimplifiedScene& _scene, const SSceneDescriptor& _descr, double _sizeRatio = 0)
+	{
+		auto& particles = _scene.GetRefToParticles();
+		auto& walls = _scene.GetRefToWalls();
+		particles.Resize(0);
+		walls.Resize(0);
+		CRandom random{ 42 };
+		const double step = 2.1 * _descr.radius;
+		const CVector3 size = _descr.bulk.coordEnd - _descr.bulk.coordBeg;
+		const auto nx = static_cast<unsigned>(size.x / step), ny = static_cast<unsigned>(size.y / step), nz = static_cast<unsigned>(size.z / step);
+		for (unsigned x = 0; x < nx; ++x)
+			for (unsigned y = 0; y < ny; ++y)
+				for (unsigned z = 0; z < nz; ++z)
+				{
+					const double r = _sizeRatio > 1 ? _descr.radius * std::pow(_sizeRatio, -random.Next()) : _descr.radius * (0.9 + 0.2 * random.Next());
+					const CVector3 jitter = CVector3{ random.Next(), random.Next(), random.Next() } * 0.05 * _descr.radius;
+					const CVector3 coord = _descr.bulk.coordBeg + CVector3{ x + 0.5, y + 0.5, z + 0.5 } * step + jitter;
+					particles.AddParticle(true, coord, r, static_cast<unsigned>(particles.Size()), 1, 1, CVector3{ 0 }, CVector3{ 0 });
+					particles.AddContactRadius(r);
+				}
+		const CVector3& b = _descr.domain.coordBeg;
+		const CVector3& e = _descr.domain.coordEnd;
+		walls.AddWall(true, 0, CVector3{ b.x, b.y, b.z }, CVector3{ e.x, b.y, b.z }, CVector3{ e.x, e.y, b.z }, CVector3{ 0, 0, 1 }, CVector3{ 0 }, CVector3{ 0 }, CVector3{ 0 });
+		walls.AddWall(true, 1, CVector3{ b.x, b.y, b.z }, CVector3{ e.x, e.y, b.z }, CVector3{ b.x, e.y, b.z }, CVector3{ 0, 0, 1 }, CVector3{ 0 }, CVector3{ 0 }, CVector3{ 0 });
+	}
+
+	struct SResult
+	{
+		double time;		// time of a single update [ms]
+		size_t contactsPP;	// number of possible particle-particle contacts
+		size_t contactsPW;	// number of possible particle-wall contacts
+	};
+
+	SResult Measure(CSimplifiedScene& _scene, const SSceneDescriptor& _descr, EVerletGridType _type, size_t _repetitions)
+	{
+		CVerletList list{ _scene };
+		list.InitializeList();
+		list.SetGridType(_type);
+		list.SetSceneInfo(_descr.domain, _scene.GetMinParticleContactRadius(), _scene.GetMaxParticleContactRadius(), DEFAULT_MAX_CELLS, DEFAULT_VERLET_DISTANCE_COEFF, false);
+		SResult res{ Benchmark::Measure(_repetitions, [&] { list.UpdateList(0); }) * 1e3, 0, 0 };
+		for (const auto& row : list.m_PPList) res.contactsPP += row.size();
+		for (const auto& row : list.m_PWList) res.contactsPW += row.size();
+		return res;
+	}
+
+	struct SIncrementalResult
+	{
+		double time;		// time of a single update [ms]
+		size_t missed;		// number of close pairs of particles, which are not in the list
+	};
+
+	/// Returns the number of pairs of particles closer than the given gap, which are missing in the list.
+	size_t CountMissedPairs(CSimplifiedScene& _scene, const SSceneDescriptor& _descr, const CVerletList& _list, double _gap)
+	{
+		CVerletList reference{ _scene };
+		reference.InitializeList();
+		reference.SetSceneInfo(_descr.domain, _scene.GetMinParticleContactRadius(), _scene.GetMaxParticleContactRadius(), DEFAULT_MAX_CELLS, DEFAULT_VERLET_DISTANCE_COEFF, false);
+		reference.UpdateList(0);
+		const auto& particles = _scene.GetRefToParticles();
+		size_t missed = 0;
+		for (unsigned i = 0; i < reference.m_PPList.size(); ++i)
+			for (const unsigned j : reference.m_PPList[i])
+				if (Length(particles.Coord(i) - particles.Coord(j)) <= particles.ContactRadius(i) + particles.ContactRadius(j) + _gap)
+					if (std::find(_list.m_PPList[i].begin(), _list.m_PPList[i].end(), j) == _list.m_PPList[i].end())
+						++missed;
+		return missed;
+	}
+
+	/// Rotates the wall around axis Y, which goes through the point (_center, 0, _center), by the angle.
+	void RotateWall(SWallStruct& _walls, size_t _i, double _center, double _angle)
+	{
+		const double c = std::cos(_angle), s = std::sin(_angle);
+		const auto Rotate = [&](const CVector3& _v, double _shift) { return CVector3{ _shift + c * (_v.x - _shift) - s * (_v.z - _shift), _v.y, _shift + s * (_v.x - _shift) + c * (_v.z - _shift) }; };
+		const SWallStruct::SCoordinates& coords = _walls.Coordinates(_i);
+		_walls.Coordinates(_i) = SWallStruct::SCoordinates{ Rotate(coords.vert1, _center), Rotate(coords.vert2, _center), Rotate(coords.vert3, _center) };
+		_walls.NormalVector(_i) = Rotate(_walls.NormalVector(_i), 0);
+	}
+
+	/// Creates a mixer: a drum with axis Y, meshed with the given number of segments along its circumference and length, with four blades,
+	/// and fills its lower half with particles on a jittered lattice.
+	void CreateMixer(CSimplifiedScene& _scene, double _radius, double _length, size_t _nCircumf, size_t _nAxial, double _partRadius)
+	{
+		auto& particles = _scene.GetRefToParticles();
+		auto& walls = _scene.GetRefToWalls();
+		particles.Resize(0);
+		walls.Resize(0);
+		const double center = 1.1 * _radius; // the domain starts at zero
+		const auto AddQuad = [&](const CVector3& _v1, const CVector3& _v2, const CVector3& _v3, const CVector3& _v4)
+		{
+			const CVector3 normal = ((_v2 - _v1) * (_v3 - _v1)).Normalized();
+			walls.AddWall(true, static_cast<unsigned>(walls.Size()), _v1, _v2, _v3, normal, CVector3{ 0 }, CVector3{ 0 }, CVector3{ 0 });
+			walls.AddWall(true, static_cast<unsigned>(walls.Size()), _v1, _v3, _v4, normal, CVector3{ 0 }, CVector3{ 0 }, CVector3{ 0 });
+		};
+		const auto Point = [&](double _r, double _angle, double _y) { return CVector3{ center + _r * std::cos(_angle), _y, center + _r * std::sin(_angle) }; };
+		const double dA = 2 * PI / static_cast<double>(_nCircumf), dY = _length / static_cast<double>(_nAxial);
+		for (size_t i = 0; i < _nCircumf; ++i)
+			for (size_t j = 0; j < _nAxial; ++j)
+				AddQuad(Point(_radius, i * dA, j * dY), Point(_radius, i * dA, (j + 1) * dY), Point(_radius, (i + 1) * dA, (j + 1) * dY), Point(_radius, (i + 1) * dA, j * dY));
+		const size_t nDrumWalls = walls.Size();
+		const size_t nRadial = _nAxial / 2;
+		const double dR = 0.9 * _radius / static_cast<double>(nRadial);
+		for (size_t k = 0; k < 4; ++k)
+			for (size_t i = 0; i < nRadial; ++i)
+				for (size_t j = 0; j < _nAxial; ++j)
+				{
+					const double a = PI / 4 + k * PI / 2;
+					AddQuad(Point(i * dR, a, j * dY), Point((i + 1) * dR, a, j * dY), Point((i + 1) * dR, a, (j + 1) * dY), Point(i * dR, a, (j + 1) * dY));
+				}
+		_scene.m_vGeometryWalls = { 0, nDrumWalls, walls.Size() }; // drum and blades
+
+		CRandom random{ 42 };
+		const double step = 2.1 * _partRadius;
+		for (double x = center - _radius; x < center + _radius; x += step)
+			for (double y = step; y < _length - step; y += step)
+				for (double z = center - _radius; z < center; z += step)
+				{
+					const CVector3 coord = CVector3{ x, y, z } + CVector3{ random.Next(), random.Next(), random.Next() } * 0.05 * _partRadius;
+					const double rc = std::hypot(coord.x - center, coord.z - center);
+					if (rc > _radius - step) continue; // outside the drum
+					if (std::fabs(coord.x - coord.z) < step || std::fabs(coord.x + coord.z - 2 * center) < step) continue; // on blades
+					const double r = _partRadius * (0.9 + 0.2 * random.Next());
+					particles.AddParticle(true, coord, r, static_cast<unsigned>(particles.Size()), 1, 1, CVector3{ 0 }, CVector3{ 0 });
+					particles.AddContactRadius(r);
+				}
+	}
+
+	/// Rotates walls of the mixer before each update, so that they move by a fraction of verlet distance on the drum, and returns the time of a single update.
+	SResult MeasureMixer(CSimplifiedScene& _scene, const SVolumeType& _domain, double _radius, EVerletGridType _type, size_t _updates)
+	{
+		auto& walls = _scene.GetRefToWalls();
+		CVerletList list{ _scene };
+		list.InitializeList();
+		list.SetGridType(_type);
+		list.SetSceneInfo(_domain, _scene.GetMinParticleContactRadius(), _scene.GetMaxParticleContactRadius(), DEFAULT_MAX_CELLS, DEFAULT_VERLET_DISTANCE_COEFF, false);
+		list.UpdateList(0); // warm up
+		const double angle = 0.5 * DEFAULT_VERLET_DISTANCE_COEFF * _scene.GetMinParticleContactRadius() / _radius;
+		double time = 0;
+		for (size_t i = 0; i < _updates; ++i)
+		{
+			for (size_t iWall = 0; iWall < walls.Size(); ++iWall)
+				RotateWall(walls, iWall, _domain.coordEnd.x / 2, angle);
+			const auto start = std::chrono::steady_clock::now();
+			list.UpdateList(0);
+			time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		SResult res{ time / static_cast<double>(_updates), 0, 0 };
+		for (const auto& row : list.m_PPList) res.contactsPP += row.size();
+		for (const auto& row : list.m_PWList) res.contactsPW += row.size();
+		return res;
+	}
+
+	struct SMovingResult
+	{
+		double time;		// time of a single step [ms]
+		size_t rebuilds;	// number of full rebuilds
+		size_t updatesPW;	// number of updates of particle-wall lists only
+		size_t missed;		// number of close particle-wall pairs, which are not in the list
+	};
+
+	/// Returns the number of pairs of particles and walls closer than the given gap, which are missing in the list.
+	size_t CountMissedWalls(CSimplifiedScene& _scene, const SVolumeType& _domain, const CVerletList& _list, double _gap)
+	{
+		CVerletList reference{ _scene };
+		reference.InitializeList();
+		reference.SetSceneInfo(_domain, _scene.GetMinParticleContactRadius(), _scene.GetMaxParticleContactRadius(), DEFAULT_MAX_CELLS, DEFAULT_VERLET_DISTANCE_COEFF, false);
+		reference.UpdateList(0);
+		const auto& particles = _scene.GetRefToParticles();
+		const auto& walls = _scene.GetRefToWalls();
+		size_t missed = 0;
+		for (unsigned i = 0; i < reference.m_PWList.size(); ++i)
+			for (const unsigned w : reference.m_PWList[i])
+				if (IsSphereIntersectTriangle(walls.Coordinates(w), walls.NormalVector(w), particles.Coord(i), particles.ContactRadius(i) + _gap).first != EIntersectionType::NO_CONTACT)
+					if (std::find(_list.m_PWList[i].begin(), _list.m_PWList[i].end(), w) == _list.m_PWList[i].end())
+						++missed;
+		return missed;
+	}
+
+	/// Simulates steps of the mixer, where either the drum or the blades rotate and particles move slowly with constant velocities.
+	/// If the update is coupled, each trigger leads to the full rebuild, as if walls of all geometries moved with the maximum velocity.
+	SMovingResult MeasureMoving(CSimplifiedScene& _scene, const SVolumeType& _domain, double _radius, EVerletGridType _type, bool _rotateDrum, bool _coupled, size_t _steps)
+	{
+		auto& particles = _scene.GetRefToParticles();
+		auto& walls = _scene.GetRefToWalls();
+		const double verletDistance = DEFAULT_VERLET_DISTANCE_COEFF * _scene.GetMinParticleContactRadius();
+		CVerletList list{ _scene };
+		list.InitializeList();
+		list.SetGridType(_type);
+		list.SetSceneInfo(_domain, _scene.GetMinParticleContactRadius(), _scene.GetMaxParticleContactRadius(), DEFAULT_MAX_CELLS, DEFAULT_VERLET_DISTANCE_COEFF, false);
+		list.UpdateList(0);
+		_scene.SaveVerletCoords();
+
+		// per step, particles move by up to 0.004 and the rotating walls by up to 0.02 of verlet distance
+		const double dt = 1e-4;
+		const double wallVelocity = 0.02 * verletDistance / dt;
+		const double angle = wallVelocity * dt / _radius;
+		const size_t iGeometry = _rotateDrum ? 0 : 1;
+		std::vector<double> velocities(2, 0.0);
+		velocities[iGeometry] = wallVelocity;
+		if (_coupled)
+			velocities.assign(2, wallVelocity);
+		CRandom random{ 7 };
+		std::vector<CVector3> partVelocities(particles.Size());
+		for (auto& v : partVelocities)
+			v = random.NextDirection() * 0.004 * verletDistance * random.Next() / dt;
+
+		SMovingResult res{ 0, 0, 0, 0 };
+		double wallDistance = 0; // distance passed by the rotating walls since they were placed in the grid
+		for (size_t iStep = 0; iStep < _steps; ++iStep)
+		{
+			for (size_t i = 0; i < particles.Size(); ++i)
+				particles.Coord(i) += partVelocities[i] * dt;
+			for (size_t w = _scene.m_vGeometryWalls[iGeometry]; w < _scene.m_vGeometryWalls[iGeometry + 1]; ++w)
+				RotateWall(walls, w, _domain.coordEnd.x / 2, angle);
+			wallDistance += wallVelocity * dt;
+			const auto start = std::chrono::steady_clock::now();
+			if (list.IsNeedToBeUpdated(dt, _scene.GetMaxPartVerletDistance(), velocities))
+			{
+				if (_coupled)
+					list.ResetCurrentData();
+				if (list.UpdateList(0))
+				{
+					_scene.SaveVerletCoords();
+					++res.rebuilds;
+				}
+				else
+					++res.updatesPW;
+				wallDistance = 0; // the rotating geometry is updated at each trigger, since particles are the same for all geometries
+			}
+			res.time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			// all pairs closer than the remaining part of verlet distance must be in the list
+			if (iStep % 50 == 49)
+				res.missed += CountMissedWalls(_scene, _domain, list, verletDistance - _scene.GetMaxPartVerletDistance() - wallDistance);
+		}
+		res.time /= static_cast<double>(_steps);
+		return res;
+	}
+
+	/// Simulates a quasi-static process: before each update, the given fraction of particles moves by 0.3 of verlet distance, the rest slightly.
+	SIncrementalResult MeasureIncremental(CSimplifiedScene& _scene, const SSceneDescriptor& _descr, EVerletGridType _type, bool _incremental, double _movedFraction, size_t _updates)
+	{
+		CreateScene(_scene, _descr);
+		auto& particles = _scene.GetRefToParticles();
+		const double verletDistance = DEFAULT_VERLET_DISTANCE_COEFF * _scene.GetMinParticleContactRadius();
+		CVerletList list{ _scene };
+		list.InitializeList();
+		list.SetGridType(_type);
+		list.SetSceneInfo(_descr.domain, _scene.GetMinParticleContactRadius(), _scene.GetMaxParticleContactRadius(), DEFAULT_MAX_CELLS, DEFAULT_VERLET_DISTANCE_COEFF, false);
+		list.SetIncrementalUpdate(_incremental);
+		list.UpdateList(0);
+		_scene.SaveVerletCoords();
+
+		CRandom random{ 7 };
+		double time = 0;
+		for (size_t iUpdate = 0; iUpdate < _updates; ++iUpdate)
+		{
+			for (size_t i = 0; i < particles.Size(); ++i)
+				particles.Coord(i) += random.NextDirection() * verletDistance * (random.Next() < _movedFraction ? 0.3 : 0.001);
+			const auto start = std::chrono::steady_clock::now();
+			if (list.UpdateList(0))
+				_scene.SaveVerletCoords();
+			time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+		// particles have moved by less than a quarter of verlet distance since they were updated, so all pairs closer than half of it must be found
+		return SIncrementalResult{ time / static_cast<double>(_updates), CountMissedPairs(_scene, _descr, list, verletDistance / 2) };
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const size_t threads = argc > 1 ? std::stoul(argv[1]) : 0;
+	ThreadPool::CThreadPool::SetMaxThreadsNumber(threads == 0 ? ThreadPool::CThreadPool::GetAllowedThreadsNumber() : threads);
+	InitializeThreadPool();
+
+	const double r = 0.5e-3;
+	const std::vector<SSceneDescriptor> scenes{
+		{ "Dense packing",     { CVector3{ 0 }, CVector3{ 0.04 } },                   { CVector3{ 0 }, CVector3{ 0.04 } },                       r },
+		{ "Silo (empty head)", { CVector3{ 0 }, CVector3{ 0.04, 0.04, 1.0 } },        { CVector3{ 0 }, CVector3{ 0.04, 0.04, 0.02 } },           r },
+		{ "Long chute",        { CVector3{ 0 }, CVector3{ 1.0, 0.05, 0.5 } },         { CVector3{ 0 }, CVector3{ 1.0, 0.05, 0.005 } },           r },
+		{ "Small heap in box", { CVector3{ 0 }, CVector3{ 0.5 } },                    { CVector3{ 0.2, 0.2, 0 }, CVector3{ 0.23, 0.23, 0.03 } }, r },
+	};
+
+	std::cout << "Threads: " << GetThreadsNumber() << std::endl;
+	std::cout << std::left << std::setw(20) << "Scene" << std::right << std::setw(10) << "Particles"
+		<< std::setw(12) << "Dense [ms]" << std::setw(12) << "Sparse [ms]" << std::setw(10) << "Speedup"
+		<< std::setw(12) << "PP dense" << std::setw(12) << "PP sparse" << std::setw(10) << "PW dense" << std::setw(10) << "PW sparse" << std::endl;
+
+	CSimplifiedScene scene;
+	for (const auto& descr : scenes)
+	{
+		CreateScene(scene, descr);
+		const size_t repetitions = std::max(size_t{ 3 }, size_t{ 1'000'000 } / scene.GetRefToParticles().Size());
+		const SResult dense = Measure(scene, descr, EVerletGridType::DENSE, repetitions);
+		const SResult sparse = Measure(scene, descr, EVerletGridType::SPARSE, repetitions);
+		std::cout << std::left << std::setw(20) << descr.name << std::right << std::setw(10) << scene.GetRefToParticles().Size()
+			<< std::setw(12) << std::fixed << std::setprecision(2) << dense.time << std::setw(12) << sparse.time
+			<< std::setw(10) << std::setprecision(2) << dense.time / sparse.time
+			<< std::setw(12) << dense.contactsPP << std::setw(12) << sparse.contactsPP
+			<< std::setw(10) << dense.contactsPW << std::setw(10) << sparse.contactsPW << std::endl;
+	}
+
+	std::cout << std::endl << "Quasi-static process, " << scenes.front().name << std::endl;
+	std::cout << std::left << std::setw(20) << "Grid" << std::right << std::setw(10) << "Moved %"
+		<< std::setw(12) << "Full [ms]" << std::setw(14) << "Incr. [ms]" << std::setw(10) << "Speedup" << std::setw(10) << "Missed" << std::endl;
+	for (const auto type : { EVerletGridType::DENSE, EVerletGridType::SPARSE })
+		for (const double fraction : { 0.001, 0.01, 0.05, 0.2 })
+		{
+			const SIncrementalResult full = MeasureIncremental(scene, scenes.front(), type, false, fraction, 20);
+			const SIncrementalResult incr = MeasureIncremental(scene, scenes.front(), type, true, fraction, 20);
+			std::cout << std::left << std::setw(20) << (type == EVerletGridType::DENSE ? "dense" : "sparse") << std::right << std::setw(10) << std::setprecision(1) << fraction * 100
+				<< std::setw(12) << std::setprecision(2) << full.time << std::setw(14) << incr.time << std::setw(10) << full.time / incr.time
+				<< std::setw(10) << full.missed + incr.missed << std::endl;
+		}
+
+	const SSceneDescriptor bed{ "Polydisperse bed", { CVector3{ 0 }, CVector3{ 0.1, 0.1, 0.3 } }, { CVector3{ 0 }, CVector3{ 0.1, 0.1, 0.01 } }, r };
+	std::cout << std::endl << bed.name << ", dense grid" << std::endl;
+	std::cout << std::left << std::setw(20) << "Size ratio" << std::right << std::setw(10) << "Particles" << std::setw(12) << "Time [ms]" << std::setw(12) << "PP" << std::endl;
+	for (const double ratio : { 1.0, 2.0, 4.0, 8.0 })
+	{
+		CreateScene(scene, bed, ratio);
+		const SResult res = Measure(scene, bed, EVerletGridType::DENSE, 5);
+		std::cout << std::left << std::setw(20) << std::setprecision(0) << ratio << std::right << std::setw(10) << scene.GetRefToParticles().Size()
+			<< std::setw(12) << std::setprecision(2) << res.time << std::setw(12) << res.contactsPP << std::endl;
+	}
+
+	const double drumRadius = 0.05, drumLength = 0.1;
+	const SVolumeType mixerDomain{ CVector3{ 0 }, CVector3{ 2.2 * drumRadius, drumLength, 2.2 * drumRadius } };
+	std::cout << std::endl << "Rotating mixer" << std::endl;
+	std::cout << std::left << std::setw(20) << "Grid" << std::right << std::setw(10) << "Particles" << std::setw(10) << "Walls"
+		<< std::setw(12) << "Time [ms]" << std::setw(12) << "PP" << std::setw(10) << "PW" << std::endl;
+	for (const auto type : { EVerletGridType::DENSE, EVerletGridType::SPARSE })
+	{
+		CreateMixer(scene, drumRadius, drumLength, 600, 100, 1e-3);
+		const SResult res = MeasureMixer(scene, mixerDomain, drumRadius, type, 10);
+		std::cout << std::left << std::setw(20) << (type == EVerletGridType::DENSE ? "dense" : "sparse") << std::right << std::setw(10) << scene.GetRefToParticles().Size()
+			<< std::setw(10) << scene.GetRefToWalls().Size() << std::setw(12) << std::setprecision(2) << res.time << std::setw(12) << res.contactsPP << std::setw(10) << res.contactsPW << std::endl;
+	}
+
+	const size_t movingSteps = 1000;
+	std::cout << std::endl << "Moving geometries, " << movingSteps << " steps" << std::endl;
+	std::cout << std::left << std::setw(20) << "Case" << std::right << std::setw(10) << "Grid" << std::setw(10) << "Update"
+		<< std::setw(10) << "Rebuilds" << std::setw(10) << "PW only" << std::setw(12) << "Step [ms]" << std::setw(10) << "Missed" << std::endl;
+	for (const bool rotateDrum : { true, false })
+		for (const auto type : { EVerletGridType::DENSE, EVerletGridType::SPARSE })
+			for (const bool coupled : { true, false })
+			{
+				CreateMixer(scene, drumRadius, drumLength, 600, 100, 1e-3);
+				const SMovingResult res = MeasureMoving(scene, mixerDomain, drumRadius, type, rotateDrum, coupled, movingSteps);
+				std::cout << std::left << std::setw(20) << (rotateDrum ? "Rotating drum" : "Mixer blades") << std::right << std::setw(10) << (type == EVerletGridType::DENSE ? "dense" : "sparse")
+					<< std::setw(10) << (coupled ? "coupled" : "separate") << std::setw(10) << res.rebuilds << std::setw(10) << res.updatesPW
+					<< std::setw(12) << std::setprecision(3) << res.time << std::setw(10) << res.missed << std::endl;
+			}
+
+	return 0;
+}
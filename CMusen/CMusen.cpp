@@ -31,6 +31,7 @@ void PrintArgumentsInfo()
 	std::cout << "Optional arguments:" << std::endl;
 	std::cout << "-t, -threads    maximum number of threads available for the program" << std::endl;
 	std::cout << "-a, -affinity   hexadecimal mask of cores pin threads to them" << std::endl;
+	std::cout << "-p, -profile    path to file to write profiling results of simulations (.json or .csv)" << std::endl;
 	std::cout << std::endl;
 	std::cout << "Information:" << std::endl;
 	std::cout << "-v, -version    print information about current version" << std::endl;
@@ -106,7 +107,7 @@ void SetThreadsList(const std::string& _arg)
 	ThreadPool::CThreadPool::SetUserCPUList(listCPUs);
 }
 
-void RunMusen(const std::string& _arg)
+void RunMusen(const std::string& _arg, const std::string& _profileFile)
 {
 	InitializeThreadPool();
 
@@ -121,9 +122,11 @@ void RunMusen(const std::string& _arg)
 
 	size_t counter = 0;
 	CScriptRunner ScriptRunner;
-	for (const auto& job : scriptAnalyzer.Jobs())
+	for (auto job : scriptAnalyzer.Jobs())
 	{
 		std::cout << std::endl << "//////////////////// Start processing job: " << 1 + counter++ << " ////////////////////" << std::endl;
+		if (job.profileFileName.empty())
+			job.profileFileName = _profileFile;
 		ScriptRunner.RunScriptJob(job);
 	}
 }
@@ -156,8 +159,9 @@ int main(int argc, const char *argv[])
 		SetMaxThreads(parser.IsArgumentExist("t") ? parser.GetArgument("t") : parser.GetArgument("threads"));
 	if (parser.IsArgumentExist("affinity") || parser.IsArgumentExist("a"))
 		SetThreadsList(parser.IsArgumentExist("a") ? parser.GetArgument("a") : parser.GetArgument("affinity"));
+	const std::string profileFile = parser.IsArgumentExist("p") ? parser.GetArgument("p") : parser.IsArgumentExist("profile") ? parser.GetArgument("profile") : "";
 	if (parser.IsArgumentExist("script") || parser.IsArgumentExist("s"))
-		RunMusen(parser.IsArgumentExist("s") ? parser.GetArgument("s") : parser.GetArgument("script"));
+		RunMusen(parser.IsArgumentExist("s") ? parser.GetArgument("s") : parser.GetArgument("script"), profileFile);
 
 	return 0;
 }
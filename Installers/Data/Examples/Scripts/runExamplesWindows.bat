@@ -7,4 +7,10 @@ set CMUSEN_PATH="C:\\Program Files\\MUSEN\\CMUSEN.exe"
 :: %CMUSEN_PATH% -s="Example 4 - Packing generation.txt"
 :: %CMUSEN_PATH% -s="Example 5 - Packing generation new PSD.txt"
 :: %CMUSEN_PATH% -s="Example 6 - Multiple jobs.txt"
-%CMUSEN_PATH% -s="Example 7 - Modified material parameters.txt"
\ No newline at end of file
+:: %CMUSEN_PATH% -s="Example 7 - Modified material parameters.txt"
+
+:: Reproducibility check: the simulation with one thread and with all available threads must give identical results.
+%CMUSEN_PATH% -t=1 -s="Example 8 - Reproducible simulation.txt"
+move /Y Result_Reproducible.mdem Result_Reproducible_1thread.mdem
+%CMUSEN_PATH% -s="Example 8 - Reproducible simulation.txt"
+%CMUSEN_PATH% -s="Example 9 - Compare results.txt"
\ No newline at end of file
@@ -57,10 +57,16 @@ void CModelLBCapilarViscous::CalculateLB(double _time, double _timeStep, size_t
 	}*/
 }
 
-void CModelLBCapilarViscous::ConsolidatePart(double _time, double _timeStep, size_t _iBond, SParticleStruct& _particles) const
+void CModelLBCapilarViscous::ConsolidatePart(double _time, double _timeStep, size_t _iBond, size_t _iPart, SParticleStruct& _particles) const
 {
-	//_particles.Force(Bonds().LeftID(_iBond)) += Bonds().NormalForce(_iBond) + Bonds().TangentialForce(_iBond);
-	//_particles.Force(Bonds().RightID(_iBond)) -= Bonds().NormalForce(_iBond) + Bonds().TangentialForce(_iBond);
-	//_particles.Moment(Bonds().LeftID(_iBond)) -= Bonds().UnsymMoment(_iBond);
-	//_particles.Moment(Bonds().RightID(_iBond)) -= Bonds().UnsymMoment(_iBond);
+	//if (Bonds().LeftID(_iBond) == _iPart)
+	//{
+	//	_particles.Force(_iPart) += Bonds().NormalForce(_iBond) + Bonds().TangentialForce(_iBond);
+	//	_particles.Moment(_iPart) -= Bonds().UnsymMoment(_iBond);
+	//}
+	//else if (Bonds().RightID(_iBond) == _iPart)
+	//{
+	//	_particles.Force(_iPart) -= Bonds().NormalForce(_iBond) + Bonds().TangentialForce(_iBond);
+	//	_particles.Moment(_iPart) -= Bonds().UnsymMoment(_iBond);
+	//}
 }
@@ -11,5 +11,5 @@ public:
 	CModelLBCapilarViscous();
 
 	void CalculateLB(double _time, double _timeStep, size_t _iLeft, size_t _iRight, size_t _iBond, SLiquidBondStruct& _bonds, unsigned* _pBrokenBondsNum) const override;
-	void ConsolidatePart(double _time, double _timeStep, size_t _iBond, SParticleStruct& _particles) const override;
+	void ConsolidatePart(double _time, double _timeStep, size_t _iBond, size_t _iPart, SParticleStruct& _particles) const override;
 };
\ No newline at end of file
@@ -14,6 +14,8 @@ CModelPPChealNess::CModelPPChealNess()
 	m_name          = "Cheal-Ness";
 	m_uniqueKey     = "B18A4SSSS6D4D44B925A8A04D0D1008";
 	m_hasGPUSupport = true;
+	m_requieredVariables.bContactEquivalents = true;
+	m_requieredVariables.bContactMoments = true;
 
 	/* 0*/ AddParameter("MIN_THICKNESS"  , "Minimal liquid thickness [m]", 1e-5);
 	/* 1*/ AddParameter("MAX_THICKNESS"  , "Maximal liquid thickness [m]", 5e-3);
@@ -47,12 +49,12 @@ void CModelPPChealNess::CalculatePP(double _time, double _timeStep, size_t _iSrc
 	const CVector3 tangRelVel    = relVel - normLenVel;
 
 	// radius of the contact area
-	const double contactAreaRadius = std::sqrt(_collision->dEquivRadius * normOverlap);
+	const double contactAreaRadius = std::sqrt(CollisionFields().EquivRadius(_collision) * normOverlap);
 
 	// normal force with damping
 	const double Kn = 2 * _interactProp.dEquivYoungModulus * contactAreaRadius;
 	const double normContactForceLen = -normOverlap * Kn * 2. / 3.;
-	const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * normRelVelLen * std::sqrt(Kn * _collision->dEquivMass);
+	const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * normRelVelLen * std::sqrt(Kn * CollisionFields().EquivMass(_collision));
 	const CVector3 normForce = normVector * (normContactForceLen + normDampingForceLen);
 
 	// rotate old tangential overlap
@@ -65,7 +67,7 @@ void CModelPPChealNess::CalculatePP(double _time, double _timeStep, size_t _iSrc
 	// tangential force with damping
 	const double Kt = 8 * _interactProp.dEquivShearModulus * contactAreaRadius;
 	const CVector3 tangShearForce = tangOverlap * Kt;
-	const CVector3 tangDampingForce = tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * _collision->dEquivMass));
+	const CVector3 tangDampingForce = tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * CollisionFields().EquivMass(_collision)));
 
 	// check slipping condition and calculate total tangential force
 	CVector3 tangForce;
@@ -111,20 +113,20 @@ void CModelPPChealNess::CalculatePP(double _time, double _timeStep, size_t _iSrc
 
 	// store results in collision
 	_collision->vTangOverlap   = tangOverlap;
-	_collision->vTangForce     = tangForce;
+	if (CollisionFields().TangForceExist()) CollisionFields().TangForce(_collision) = tangForce;
 	_collision->vTotalForce    = totalForce;
-	_collision->vResultMoment1 = moment1;
-	_collision->vResultMoment2 = moment2;
+	CollisionFields().ResultMoment1(_collision) = moment1;
+	CollisionFields().ResultMoment2(_collision) = moment2;
 }
 
 void CModelPPChealNess::ConsolidateSrc(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) += _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment1;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment1(_collision);
 }
 
 void CModelPPChealNess::ConsolidateDst(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) -= _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment2;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment2(_collision);
 }
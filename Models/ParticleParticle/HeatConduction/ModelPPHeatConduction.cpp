@@ -6,6 +6,8 @@ CModelPPHeatConduction::CModelPPHeatConduction()
 	m_uniqueKey = "B18A46C2786D4D44B925A8A04D0D1098";
 	m_helpFileName = "/Contact Models/HeatConduction.pdf";
 	m_requieredVariables.bThermals = true;
+	m_requieredVariables.bContactEquivalents = true;
+	m_requieredVariables.bContactHeatFlux = true;
 	m_hasGPUSupport = true;
 
 	/* 0 */ AddParameter("CONDUCTION_SCALING_FACTOR", "Scaling factor for conductivity [-]"      , 1.0 );
@@ -27,23 +29,23 @@ void CModelPPHeatConduction::CalculatePP(double _time, double _timeStep, size_t
 
 	// From https://doi.org/10.1016/j.oceram.2021.100182, Equations 6-8.
 	// Equations are rewritten to use equivalent radius and optimized for performance.
-	const double scaledOverlap = _collision->dNormalOverlap / (4 * _collision->dEquivRadius);
+	const double scaledOverlap = _collision->dNormalOverlap / (4 * CollisionFields().EquivRadius(_collision));
 	double effectiveResistivityFactor = 1.0;
 	if (scaledOverlap <= m_parameters[2].value)
 		effectiveResistivityFactor = m_parameters[1].value;
 	else if (scaledOverlap < m_parameters[3].value)
 		effectiveResistivityFactor = m_parameters[1].value + (1 - m_parameters[1].value) / (m_parameters[3].value - m_parameters[2].value) * (scaledOverlap - m_parameters[2].value);
 
-	const double contactRadius = 2 * sqrt(_collision->dEquivRadius * _collision->dNormalOverlap);
-	_collision->dHeatFlux = 2 * contactRadius * m_parameters[0].value * effectiveResistivityFactor * contactThermalConductivity * (dstTemperature - srcTemperature);
+	const double contactRadius = 2 * sqrt(CollisionFields().EquivRadius(_collision) * _collision->dNormalOverlap);
+	CollisionFields().HeatFlux(_collision) = 2 * contactRadius * m_parameters[0].value * effectiveResistivityFactor * contactThermalConductivity * (dstTemperature - srcTemperature);
 }
 
 void CModelPPHeatConduction::ConsolidateSrc(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
-	_particles.HeatFlux(_iPart) += _collision->dHeatFlux;
+	_particles.HeatFlux(_iPart) += CollisionFields().HeatFlux(_collision);
 }
 
 void CModelPPHeatConduction::ConsolidateDst(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
-	_particles.HeatFlux(_iPart) -= _collision->dHeatFlux;
+	_particles.HeatFlux(_iPart) -= CollisionFields().HeatFlux(_collision);
 }
@@ -10,6 +10,9 @@ CModelPPHertz::CModelPPHertz()
 	m_uniqueKey     = "B7CBEB0657884100930E6C68E2C438EB";
 	m_helpFileName  = "/Contact Models/Hertz.pdf";
 	m_hasGPUSupport = false;
+	m_requieredVariables.bContactEquivalents = true;
+	m_requieredVariables.bContactMoments = true;
+	m_requieredVariables.bContactTangForce = true;
 }
 
 void CModelPPHertz::CalculatePP(double _time, double _timeStep, size_t _iSrc, size_t _iDst, const SInteractProps& _interactProp, SCollision* _collision) const
@@ -34,7 +37,7 @@ void CModelPPHertz::CalculatePP(double _time, double _timeStep, size_t _iSrc, si
 	const CVector3 tangOverlap = tangRelVel * _timeStep;
 
 	// radius of the contact area
-	const double contactAreaRadius = std::sqrt(_collision->dEquivRadius * normOverlap);
+	const double contactAreaRadius = std::sqrt(CollisionFields().EquivRadius(_collision) * normOverlap);
 
 	// normal force
 	const double Kn = 2 * _interactProp.dEquivYoungModulus * contactAreaRadius;
@@ -42,9 +45,10 @@ void CModelPPHertz::CalculatePP(double _time, double _timeStep, size_t _iSrc, si
 	const CVector3 normForce = normVector * normForceLen;
 
 	// rotate old tangential overlap
-	CVector3 tangOverlapRot = _collision->vTangForce - normVector * DotProduct(normVector, _collision->vTangForce);
+	const CVector3& oldTangForce = CollisionFields().TangForce(_collision);
+	CVector3 tangOverlapRot = oldTangForce - normVector * DotProduct(normVector, oldTangForce);
 	if (tangOverlapRot.IsSignificant())
-		tangOverlapRot *= _collision->vTangForce.Length() / tangOverlapRot.Length();
+		tangOverlapRot *= oldTangForce.Length() / tangOverlapRot.Length();
 
 	// tangential force
 	const double Kt = 8 * _interactProp.dEquivShearModulus * contactAreaRadius;
@@ -67,19 +71,19 @@ void CModelPPHertz::CalculatePP(double _time, double _timeStep, size_t _iSrc, si
 
 	// store results in collision
 	_collision->vTotalForce    = totalForce;
-	_collision->vTangForce     = tangForce;
-	_collision->vResultMoment1 = moment1;
-	_collision->vResultMoment2 = moment2;
+	CollisionFields().TangForce(_collision) = tangForce;
+	CollisionFields().ResultMoment1(_collision) = moment1;
+	CollisionFields().ResultMoment2(_collision) = moment2;
 }
 
 void CModelPPHertz::ConsolidateSrc(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) += _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment1;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment1(_collision);
 }
 
 void CModelPPHertz::ConsolidateDst(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) -= _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment2;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment2(_collision);
 }
@@ -10,6 +10,9 @@ CModelPPHertzMindlin::CModelPPHertzMindlin()
 	m_uniqueKey     = "B18A46C2786D4D44B925A8A04D0D1008";
 	m_helpFileName  = "/Contact Models/HertzMindlin.pdf";
 	m_hasGPUSupport = true;
+	m_hasMixedPrecisionSupport = true;
+	m_requieredVariables.bContactEquivalents = true;
+	m_requieredVariables.bContactMoments = true;
 }
 
 void CModelPPHertzMindlin::CalculatePP(double _time, double _timeStep, size_t _iSrc, size_t _iDst, const SInteractProps& _interactProp, SCollision* _collision) const
@@ -30,12 +33,12 @@ void CModelPPHertzMindlin::CalculatePP(double _time, double _timeStep, size_t _i
 	const CVector3 tangRelVel    = relVel - normRelVel;
 
 	// radius of the contact area
-	const double contactAreaRadius = std::sqrt(_collision->dEquivRadius * _collision->dNormalOverlap);
+	const double contactAreaRadius = std::sqrt(CollisionFields().EquivRadius(_collision) * _collision->dNormalOverlap);
 
 	// normal force with damping
 	const double Kn = 2 * _interactProp.dEquivYoungModulus * contactAreaRadius;
 	const double normContactForceLen = -_collision->dNormalOverlap * Kn * 2. / 3.;
-	const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * normRelVelLen * std::sqrt(Kn * _collision->dEquivMass);
+	const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * normRelVelLen * std::sqrt(Kn * CollisionFields().EquivMass(_collision));
 	const CVector3 normForce = normVector * (normContactForceLen + normDampingForceLen);
 
 	// rotate old tangential overlap
@@ -48,7 +51,7 @@ void CModelPPHertzMindlin::CalculatePP(double _time, double _timeStep, size_t _i
 	// tangential force with damping
 	const double Kt = 8 * _interactProp.dEquivShearModulus * contactAreaRadius;
 	const CVector3 tangShearForce = tangOverlap * Kt;
-	const CVector3 tangDampingForce = tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * _collision->dEquivMass));
+	const CVector3 tangDampingForce = tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * CollisionFields().EquivMass(_collision)));
 
 	// check slipping condition and calculate total tangential force
 	CVector3 tangForce;
@@ -73,20 +76,177 @@ void CModelPPHertzMindlin::CalculatePP(double _time, double _timeStep, size_t _i
 
 	// store results in collision
 	_collision->vTangOverlap   = tangOverlap;
-	_collision->vTangForce     = tangForce;
+	if (CollisionFields().TangForceExist()) CollisionFields().TangForce(_collision) = tangForce;
 	_collision->vTotalForce    = totalForce;
-	_collision->vResultMoment1 = moment1;
-	_collision->vResultMoment2 = moment2;
+	CollisionFields().ResultMoment1(_collision) = moment1;
+	CollisionFields().ResultMoment2(_collision) = moment2;
+}
+
+void CModelPPHertzMindlin::CalculatePPBatch(double _time, double _timeStep, const SPPContactsBatch& _batch) const
+{
+	CalculatePPBatchT<double>(_timeStep, _batch);
+}
+
+void CModelPPHertzMindlin::CalculatePPBatchMixed(double _time, double _timeStep, const SPPContactsBatch& _batch) const
+{
+	CalculatePPBatchT<float>(_timeStep, _batch);
+}
+
+template<typename T>
+void CModelPPHertzMindlin::CalculatePPBatchT(double _timeStep, const SPPContactsBatch& _batch) const
+{
+	constexpr size_t N = SPPContactsBatch::MAX_SIZE;
+	constexpr T minValue = MinValueHelper<T>::min_value(); // the same as used in CVector3::IsSignificant()
+	const size_t n = _batch.size;
+	const T timeStep = static_cast<T>(_timeStep);
+	SCollisionFields& fields = CollisionFields();
+
+	// gather properties of contacts
+	T overlap[N], equivRadius[N], equivMass[N], tangOverlapOld[3][N], cv[3][N];
+	T vel1[3][N], vel2[3][N], anglVel1[3][N], anglVel2[3][N], radius1[N], radius2[N];
+	T youngModulus[N], shearModulus[N], alpha[N], slidingFriction[N], rollingFriction[N];
+	for (size_t i = 0; i < n; ++i)
+	{
+		const SCollision* collision = _batch.collisions[i];
+		const SInteractProps& prop = InteractionProperty(collision->nInteractProp);
+		const size_t iSrc = collision->nSrcID;
+		const size_t iDst = collision->nDstID;
+		const CVector3& v1 = Particles().Vel(iSrc);
+		const CVector3& v2 = Particles().Vel(iDst);
+		const CVector3& w1 = Particles().AnglVel(iSrc);
+		const CVector3& w2 = Particles().AnglVel(iDst);
+		overlap[i]           = static_cast<T>(collision->dNormalOverlap);
+		equivRadius[i]       = static_cast<T>(fields.EquivRadius(collision));
+		equivMass[i]         = static_cast<T>(fields.EquivMass(collision));
+		radius1[i]           = static_cast<T>(Particles().Radius(iSrc));
+		radius2[i]           = static_cast<T>(Particles().Radius(iDst));
+		youngModulus[i]      = static_cast<T>(prop.dEquivYoungModulus);
+		shearModulus[i]      = static_cast<T>(prop.dEquivShearModulus);
+		alpha[i]             = static_cast<T>(prop.dAlpha);
+		slidingFriction[i]   = static_cast<T>(prop.dSlidingFriction);
+		rollingFriction[i]   = static_cast<T>(prop.dRollingFriction);
+		tangOverlapOld[0][i] = static_cast<T>(collision->vTangOverlap.x);   tangOverlapOld[1][i] = static_cast<T>(collision->vTangOverlap.y);   tangOverlapOld[2][i] = static_cast<T>(collision->vTangOverlap.z);
+		cv[0][i]             = static_cast<T>(collision->vContactVector.x); cv[1][i]             = static_cast<T>(collision->vContactVector.y); cv[2][i]             = static_cast<T>(collision->vContactVector.z);
+		vel1[0][i]           = static_cast<T>(v1.x);                        vel1[1][i]           = static_cast<T>(v1.y);                        vel1[2][i]           = static_cast<T>(v1.z);
+		vel2[0][i]           = static_cast<T>(v2.x);                        vel2[1][i]           = static_cast<T>(v2.y);                        vel2[2][i]           = static_cast<T>(v2.z);
+		anglVel1[0][i]       = static_cast<T>(w1.x);                        anglVel1[1][i]       = static_cast<T>(w1.y);                        anglVel1[2][i]       = static_cast<T>(w1.z);
+		anglVel2[0][i]       = static_cast<T>(w2.x);                        anglVel2[1][i]       = static_cast<T>(w2.y);                        anglVel2[2][i]       = static_cast<T>(w2.z);
+	}
+
+	// the same calculations as in CalculatePP(), written component-wise and without branches to be vectorized
+	T tangOverlapRes[3][N], tangForceRes[3][N], totalForceRes[3][N], moment1Res[3][N], moment2Res[3][N];
+	for (size_t i = 0; i < n; ++i)
+	{
+		const T r1 = radius1[i];
+		const T r2 = radius2[i];
+		const T w1x = anglVel1[0][i], w1y = anglVel1[1][i], w1z = anglVel1[2][i];
+		const T w2x = anglVel2[0][i], w2y = anglVel2[1][i], w2z = anglVel2[2][i];
+
+		const T k1 = r1 / (r1 + r2);
+		const T k2 = -r2 / (r1 + r2);
+		const T rc1x = cv[0][i] * k1, rc1y = cv[1][i] * k1, rc1z = cv[2][i] * k1;
+		const T rc2x = cv[0][i] * k2, rc2y = cv[1][i] * k2, rc2z = cv[2][i] * k2;
+		const T cvLen = std::sqrt(cv[0][i] * cv[0][i] + cv[1][i] * cv[1][i] + cv[2][i] * cv[2][i]);
+		const T nx = cvLen != 0 ? cv[0][i] / cvLen : T(0);
+		const T ny = cvLen != 0 ? cv[1][i] / cvLen : T(0);
+		const T nz = cvLen != 0 ? cv[2][i] / cvLen : T(0);
+
+		// normal and tangential relative velocity
+		const T relVelX = (vel2[0][i] + (w2y * rc2z - w2z * rc2y)) - (vel1[0][i] + (w1y * rc1z - w1z * rc1y));
+		const T relVelY = (vel2[1][i] + (w2z * rc2x - w2x * rc2z)) - (vel1[1][i] + (w1z * rc1x - w1x * rc1z));
+		const T relVelZ = (vel2[2][i] + (w2x * rc2y - w2y * rc2x)) - (vel1[2][i] + (w1x * rc1y - w1y * rc1x));
+		const T normRelVelLen = nx * relVelX + ny * relVelY + nz * relVelZ;
+		const T tangRelVelX = relVelX - nx * normRelVelLen;
+		const T tangRelVelY = relVelY - ny * normRelVelLen;
+		const T tangRelVelZ = relVelZ - nz * normRelVelLen;
+
+		// radius of the contact area
+		const T contactAreaRadius = std::sqrt(equivRadius[i] * overlap[i]);
+
+		// normal force with damping
+		const T Kn = T(2) * youngModulus[i] * contactAreaRadius;
+		const T normContactForceLen = -overlap[i] * Kn * T(2) / T(3);
+		const T normDampingForceLen = -static_cast<T>(_2_SQRT_5_6) * alpha[i] * normRelVelLen * std::sqrt(Kn * equivMass[i]);
+		const T normForceLen = normContactForceLen + normDampingForceLen;
+
+		// rotate old tangential overlap
+		const T toX = tangOverlapOld[0][i], toY = tangOverlapOld[1][i], toZ = tangOverlapOld[2][i];
+		const T toDot = nx * toX + ny * toY + nz * toZ;
+		T rotX = toX - nx * toDot;
+		T rotY = toY - ny * toDot;
+		T rotZ = toZ - nz * toDot;
+		const bool rotSignificant = (std::fabs(rotX) > minValue) | (std::fabs(rotY) > minValue) | (std::fabs(rotZ) > minValue);
+		const T rotScale = std::sqrt(toX * toX + toY * toY + toZ * toZ) / std::sqrt(rotX * rotX + rotY * rotY + rotZ * rotZ);
+		rotX = rotSignificant ? rotX * rotScale : rotX;
+		rotY = rotSignificant ? rotY * rotScale : rotY;
+		rotZ = rotSignificant ? rotZ * rotScale : rotZ;
+		// calculate new tangential overlap
+		T tangOverlapX = rotX + tangRelVelX * timeStep;
+		T tangOverlapY = rotY + tangRelVelY * timeStep;
+		T tangOverlapZ = rotZ + tangRelVelZ * timeStep;
+
+		// tangential force with damping
+		const T Kt = T(8) * shearModulus[i] * contactAreaRadius;
+		const T tangShearX = tangOverlapX * Kt, tangShearY = tangOverlapY * Kt, tangShearZ = tangOverlapZ * Kt;
+		const T tangDampingCoeff = -static_cast<T>(_2_SQRT_5_6) * alpha[i] * std::sqrt(Kt * equivMass[i]);
+
+		// check slipping condition and calculate total tangential force
+		const T tangShearForceLen = std::sqrt(tangShearX * tangShearX + tangShearY * tangShearY + tangShearZ * tangShearZ);
+		const T frictionForceLen = slidingFriction[i] * std::abs(normForceLen);
+		const bool slipping = tangShearForceLen > frictionForceLen;
+		const T slipForceX = tangShearX * frictionForceLen / tangShearForceLen;
+		const T slipForceY = tangShearY * frictionForceLen / tangShearForceLen;
+		const T slipForceZ = tangShearZ * frictionForceLen / tangShearForceLen;
+		const T tangForceX = slipping ? slipForceX : tangShearX + tangRelVelX * tangDampingCoeff;
+		const T tangForceY = slipping ? slipForceY : tangShearY + tangRelVelY * tangDampingCoeff;
+		const T tangForceZ = slipping ? slipForceZ : tangShearZ + tangRelVelZ * tangDampingCoeff;
+		tangOverlapX = slipping ? slipForceX / Kt : tangOverlapX;
+		tangOverlapY = slipping ? slipForceY / Kt : tangOverlapY;
+		tangOverlapZ = slipping ? slipForceZ / Kt : tangOverlapZ;
+
+		// rolling torque
+		const bool w1Significant = (std::fabs(w1x) > minValue) | (std::fabs(w1y) > minValue) | (std::fabs(w1z) > minValue);
+		const bool w2Significant = (std::fabs(w2x) > minValue) | (std::fabs(w2y) > minValue) | (std::fabs(w2z) > minValue);
+		const T roll1 = -rollingFriction[i] * std::abs(normContactForceLen) * r1 / std::sqrt(w1x * w1x + w1y * w1y + w1z * w1z);
+		const T roll2 = -rollingFriction[i] * std::abs(normContactForceLen) * r2 / std::sqrt(w2x * w2x + w2y * w2y + w2z * w2z);
+
+		// final forces and moments
+		const T crossX = ny * tangForceZ - nz * tangForceY;
+		const T crossY = nz * tangForceX - nx * tangForceZ;
+		const T crossZ = nx * tangForceY - ny * tangForceX;
+		tangOverlapRes[0][i] = tangOverlapX;              tangOverlapRes[1][i] = tangOverlapY;              tangOverlapRes[2][i] = tangOverlapZ;
+		tangForceRes[0][i]   = tangForceX;                tangForceRes[1][i]   = tangForceY;                tangForceRes[2][i]   = tangForceZ;
+		totalForceRes[0][i]  = nx * normForceLen + tangForceX; totalForceRes[1][i] = ny * normForceLen + tangForceY; totalForceRes[2][i] = nz * normForceLen + tangForceZ;
+		moment1Res[0][i]     = crossX * r1 + (w1Significant ? w1x * roll1 : T(0));
+		moment1Res[1][i]     = crossY * r1 + (w1Significant ? w1y * roll1 : T(0));
+		moment1Res[2][i]     = crossZ * r1 + (w1Significant ? w1z * roll1 : T(0));
+		moment2Res[0][i]     = crossX * r2 + (w2Significant ? w2x * roll2 : T(0));
+		moment2Res[1][i]     = crossY * r2 + (w2Significant ? w2y * roll2 : T(0));
+		moment2Res[2][i]     = crossZ * r2 + (w2Significant ? w2z * roll2 : T(0));
+	}
+
+	// store results in collisions, always in double precision
+	const bool storeTangForce = fields.TangForceExist();
+	for (size_t i = 0; i < n; ++i)
+	{
+		SCollision* collision = _batch.collisions[i];
+		collision->vTangOverlap         = CVector3{ tangOverlapRes[0][i], tangOverlapRes[1][i], tangOverlapRes[2][i] };
+		collision->vTotalForce          = CVector3{ totalForceRes[0][i], totalForceRes[1][i], totalForceRes[2][i] };
+		fields.ResultMoment1(collision) = CVector3{ moment1Res[0][i], moment1Res[1][i], moment1Res[2][i] };
+		fields.ResultMoment2(collision) = CVector3{ moment2Res[0][i], moment2Res[1][i], moment2Res[2][i] };
+		if (storeTangForce)
+			fields.TangForce(collision) = CVector3{ tangForceRes[0][i], tangForceRes[1][i], tangForceRes[2][i] };
+	}
 }
 
 void CModelPPHertzMindlin::ConsolidateSrc(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) += _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment1;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment1(_collision);
 }
 
 void CModelPPHertzMindlin::ConsolidateDst(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) -= _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment2;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment2(_collision);
 }
@@ -9,6 +9,8 @@ CModelPPHertzMindlinLiquid::CModelPPHertzMindlinLiquid()
 	m_name          = "Hertz-MindlinLiquid";
 	m_uniqueKey     = "B18A46C2786D4D44B925AASS4D0D1008";
 	m_hasGPUSupport = false;
+	m_requieredVariables.bContactEquivalents = true;
+	m_requieredVariables.bContactMoments = true;
 
 	/* 0*/ AddParameter("MIN_THICKNESS"    , "Min. thickness of liquid [m]", 1e-5);
 	/* 1*/ AddParameter("CONTACT_ANGLE"    , "Contact angle [grad]"        , 70  );
@@ -50,9 +52,9 @@ void CModelPPHertzMindlinLiquid::CalculatePP(double _time, double _timeStep, siz
 	const double tempLn = std::log(bondVolume);
 	const double B = (-0.34 * tempLn - 0.96) * contactAngle * contactAngle - 0.019 * tempLn + 0.48;
 	const double C = 0.0042 * tempLn + 0.078;
-	const CVector3 capForce = normVector * (PI *_collision->dEquivRadius * surfaceTension * (std::exp(A * bondLength + B) + C));
-	const CVector3 normViscForce = normRelVel * (6 * PI * viscosity * _collision->dEquivRadius * _collision->dEquivRadius / bondLength);
-	const CVector3 tangForceLiq = tangRelVel * (6 * PI * viscosity * _collision->dEquivRadius * (8. / 15. * std::log(_collision->dEquivRadius / bondLength) + 0.9588));
+	const CVector3 capForce = normVector * (PI *CollisionFields().EquivRadius(_collision) * surfaceTension * (std::exp(A * bondLength + B) + C));
+	const CVector3 normViscForce = normRelVel * (6 * PI * viscosity * CollisionFields().EquivRadius(_collision) * CollisionFields().EquivRadius(_collision) / bondLength);
+	const CVector3 tangForceLiq = tangRelVel * (6 * PI * viscosity * CollisionFields().EquivRadius(_collision) * (8. / 15. * std::log(CollisionFields().EquivRadius(_collision) / bondLength) + 0.9588));
 	const CVector3 momentLiq = rAC * tangForceLiq;
 
 	// dry contact
@@ -60,12 +62,12 @@ void CModelPPHertzMindlinLiquid::CalculatePP(double _time, double _timeStep, siz
 	if (realOverlap >= 0)
 	{
 		// contact radius
-		const double contactRadius = std::sqrt(_collision->dEquivRadius * realOverlap);
+		const double contactRadius = std::sqrt(CollisionFields().EquivRadius(_collision) * realOverlap);
 
 		// normal force with damping
 		const double Kn = 2 * _interactProp.dEquivYoungModulus * contactRadius;
 		const double normContactForceDryLen = -2 / 3. * realOverlap * Kn;
-		const double normDampingForceDryLen = -_2_SQRT_5_6 * _interactProp.dAlpha * normRelVelLen * std::sqrt(Kn * _collision->dEquivMass);
+		const double normDampingForceDryLen = -_2_SQRT_5_6 * _interactProp.dAlpha * normRelVelLen * std::sqrt(Kn * CollisionFields().EquivMass(_collision));
 		normForceDry = normVector * (normContactForceDryLen + normDampingForceDryLen);
 
 		// rotate old tangential overlap
@@ -78,7 +80,7 @@ void CModelPPHertzMindlinLiquid::CalculatePP(double _time, double _timeStep, siz
 		// tangential force with damping
 		const double Kt = 8 * _interactProp.dEquivShearModulus * contactRadius;
 		tangShearForceDry = tangOverlap * Kt;
-		tangDampingForceDry = tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * _collision->dEquivMass));
+		tangDampingForceDry = tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * CollisionFields().EquivMass(_collision)));
 
 		// check slipping condition and calculate total tangential force
 		const double tangShearForceDryLen = tangShearForceDry.Length();
@@ -106,20 +108,20 @@ void CModelPPHertzMindlinLiquid::CalculatePP(double _time, double _timeStep, siz
 
 	// store results in collision
 	_collision->vTangOverlap   = tangOverlap;
-	_collision->vTangForce     = tangForce;
+	if (CollisionFields().TangForceExist()) CollisionFields().TangForce(_collision) = tangForce;
 	_collision->vTotalForce    = totalForce;
-	_collision->vResultMoment1 = moment1;
-	_collision->vResultMoment2 = moment2;
+	CollisionFields().ResultMoment1(_collision) = moment1;
+	CollisionFields().ResultMoment2(_collision) = moment2;
 }
 
 void CModelPPHertzMindlinLiquid::ConsolidateSrc(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) += _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment1;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment1(_collision);
 }
 
 void CModelPPHertzMindlinLiquid::ConsolidateDst(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) -= _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment2;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment2(_collision);
 }
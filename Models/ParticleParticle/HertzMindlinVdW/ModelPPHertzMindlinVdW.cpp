@@ -10,6 +10,8 @@ CModelPPHertzMindlinVdW::CModelPPHertzMindlinVdW()
 	m_uniqueKey     = "B18A46C2786D4D44B925A8V04D0D1008";
 	m_helpFileName  = "/Contact Models/HertzMindlinVdW.pdf";
 	m_hasGPUSupport = true;
+	m_requieredVariables.bContactEquivalents = true;
+	m_requieredVariables.bContactMoments = true;
 }
 
 void CModelPPHertzMindlinVdW::CalculatePP(double _time, double _timeStep, size_t _iSrc, size_t _iDst, const SInteractProps& _interactProp, SCollision* _collision) const
@@ -27,9 +29,9 @@ void CModelPPHertzMindlinVdW::CalculatePP(double _time, double _timeStep, size_t
 	const double hamakerConstant = 24 * PI * Dmin * Dmin * _interactProp.dEquivSurfaceEnergy;
 	double VdWForceLen;
 	if (surfaceDistance <= Dmin)
-		VdWForceLen = hamakerConstant * (2 * _collision->dEquivRadius) / (12 * Dmin * Dmin);
+		VdWForceLen = hamakerConstant * (2 * CollisionFields().EquivRadius(_collision)) / (12 * Dmin * Dmin);
 	else
-		VdWForceLen = hamakerConstant * (2 * _collision->dEquivRadius) / (12 * pow(surfaceDistance + Dmin, 2));
+		VdWForceLen = hamakerConstant * (2 * CollisionFields().EquivRadius(_collision)) / (12 * pow(surfaceDistance + Dmin, 2));
 
 	if (surfaceDistance < 0) // contact between surfaces
 	{
@@ -45,12 +47,12 @@ void CModelPPHertzMindlinVdW::CalculatePP(double _time, double _timeStep, size_t
 		const CVector3 tangRelVel    = relVel - normRelVel;
 
 		// radius of the contact area
-		const double contactAreaRadius = std::sqrt(_collision->dEquivRadius * normOverlap);
+		const double contactAreaRadius = std::sqrt(CollisionFields().EquivRadius(_collision) * normOverlap);
 
 		// normal force with damping
 		const double Kn = 2 * _interactProp.dEquivYoungModulus * contactAreaRadius;
 		const double normContactForceLen = -normOverlap * Kn * 2. / 3.;
-		const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * normRelVelLen * std::sqrt(Kn * _collision->dEquivMass);
+		const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * normRelVelLen * std::sqrt(Kn * CollisionFields().EquivMass(_collision));
 		const CVector3 normForce = normVector * (normContactForceLen + normDampingForceLen + VdWForceLen);
 
 		// rotate old tangential overlap
@@ -63,7 +65,7 @@ void CModelPPHertzMindlinVdW::CalculatePP(double _time, double _timeStep, size_t
 		// tangential force with damping
 		const double Kt = 8 * _interactProp.dEquivShearModulus * contactAreaRadius;
 		const CVector3 tangShearForce = tangOverlap * Kt;
-		const CVector3 tangDampingForce = tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * _collision->dEquivMass));
+		const CVector3 tangDampingForce = tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * CollisionFields().EquivMass(_collision)));
 
 		// check slipping condition and calculate total tangential force
 		CVector3 tangForce;
@@ -88,10 +90,10 @@ void CModelPPHertzMindlinVdW::CalculatePP(double _time, double _timeStep, size_t
 
 		// store results in collision
 		_collision->vTangOverlap   = tangOverlap;
-		_collision->vTangForce     = tangForce;
+		if (CollisionFields().TangForceExist()) CollisionFields().TangForce(_collision) = tangForce;
 		_collision->vTotalForce    = totalForce;
-		_collision->vResultMoment1 = moment1;
-		_collision->vResultMoment2 = moment2;
+		CollisionFields().ResultMoment1(_collision) = moment1;
+		CollisionFields().ResultMoment2(_collision) = moment2;
 	}
 	else // only long range force
 	{
@@ -100,21 +102,21 @@ void CModelPPHertzMindlinVdW::CalculatePP(double _time, double _timeStep, size_t
 
 		// store results in collision
 		_collision->vTangOverlap.Init(0);
-		_collision->vTangForce.Init(0);
+		if (CollisionFields().TangForceExist()) CollisionFields().TangForce(_collision).Init(0);
 		_collision->vTotalForce = normVector * VdWForceLen;
-		_collision->vResultMoment1.Init(0);
-		_collision->vResultMoment2.Init(0);
+		CollisionFields().ResultMoment1(_collision).Init(0);
+		CollisionFields().ResultMoment2(_collision).Init(0);
 	}
 }
 
 void CModelPPHertzMindlinVdW::ConsolidateSrc(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) += _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment1;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment1(_collision);
 }
 
 void CModelPPHertzMindlinVdW::ConsolidateDst(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) -= _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment2;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment2(_collision);
 }
\ No newline at end of file
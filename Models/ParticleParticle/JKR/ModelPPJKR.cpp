@@ -10,6 +10,8 @@ CModelPPJKR::CModelPPJKR()
 	m_uniqueKey     = "8AC39F3E9D054A548CEB9CD44ACFE751";
 	m_helpFileName  = "/Contact Models/JKR.pdf";
 	m_hasGPUSupport = true;
+	m_requieredVariables.bContactEquivalents = true;
+	m_requieredVariables.bContactMoments = true;
 }
 
 void CModelPPJKR::CalculatePP(double _time, double _timeStep, size_t _iSrc, size_t _iDst, const SInteractProps& _interactProp, SCollision* _collision) const
@@ -30,13 +32,13 @@ void CModelPPJKR::CalculatePP(double _time, double _timeStep, size_t _iSrc, size
 	const CVector3 tangRelVel    = relVel - normRelVel;
 
 	// radius of the contact area
-	const double contactAreaRadius = std::sqrt(_collision->dEquivRadius * _collision->dNormalOverlap);
+	const double contactAreaRadius = std::sqrt(CollisionFields().EquivRadius(_collision) * _collision->dNormalOverlap);
 
 	// normal force with damping
 	const double Kn = 2 * _interactProp.dEquivYoungModulus * contactAreaRadius;
-	const double normContactForceLen = -1 * (4. * std::pow(contactAreaRadius, 3.) * _interactProp.dEquivYoungModulus / (3. * _collision->dEquivRadius) -
+	const double normContactForceLen = -1 * (4. * std::pow(contactAreaRadius, 3.) * _interactProp.dEquivYoungModulus / (3. * CollisionFields().EquivRadius(_collision)) -
 		std::sqrt(8 * PI * _interactProp.dEquivYoungModulus * _interactProp.dEquivSurfaceEnergy * std::pow(contactAreaRadius, 3.)));
-	const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * normRelVelLen * std::sqrt(Kn * _collision->dEquivMass);
+	const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * normRelVelLen * std::sqrt(Kn * CollisionFields().EquivMass(_collision));
 	const CVector3 normForce = normVector * (normContactForceLen + normDampingForceLen);
 
 	// rotate old tangential overlap
@@ -49,7 +51,7 @@ void CModelPPJKR::CalculatePP(double _time, double _timeStep, size_t _iSrc, size
 	// tangential force with damping
 	const double Kt = 8 * _interactProp.dEquivShearModulus * contactAreaRadius;
 	const CVector3 tangShearForce = tangOverlap * Kt;
-	const CVector3 tangDampingForce = tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * _collision->dEquivMass));
+	const CVector3 tangDampingForce = tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * CollisionFields().EquivMass(_collision)));
 
 	// check slipping condition and calculate total tangential force
 	CVector3 tangForce;
@@ -74,20 +76,20 @@ void CModelPPJKR::CalculatePP(double _time, double _timeStep, size_t _iSrc, size
 
 	// store results in collision
 	_collision->vTangOverlap   = tangOverlap;
-	_collision->vTangForce     = tangForce;
+	if (CollisionFields().TangForceExist()) CollisionFields().TangForce(_collision) = tangForce;
 	_collision->vTotalForce    = totalForce;
-	_collision->vResultMoment1 = moment1;
-	_collision->vResultMoment2 = moment2;
+	CollisionFields().ResultMoment1(_collision) = moment1;
+	CollisionFields().ResultMoment2(_collision) = moment2;
 }
 
 void CModelPPJKR::ConsolidateSrc(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) += _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment1;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment1(_collision);
 }
 
 void CModelPPJKR::ConsolidateDst(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) -= _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment2;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment2(_collision);
 }
@@ -10,6 +10,8 @@ CModelPPLinearElastic::CModelPPLinearElastic()
 	m_uniqueKey     = "B18A46C2786D4D44B925A8A04DAD1008";
 	m_helpFileName  = "/Contact Models/LinearElastic.pdf";
 	m_hasGPUSupport = true;
+	m_requieredVariables.bContactEquivalents = true;
+	m_requieredVariables.bContactMoments = true;
 
 	/* 0*/ AddParameter("Kn", "Normal stiffness [N/m]"    , 1e+3);
 	/* 1*/ AddParameter("Kt", "Tangential stiffness [N/m]", 1e+3);
@@ -38,7 +40,7 @@ void CModelPPLinearElastic::CalculatePP(double _time, double _timeStep, size_t _
 
 	// normal force with damping
 	const double normContactForceLen = -_collision->dNormalOverlap * Kn;
-	const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * normRelVelLen * std::sqrt(Kn * _collision->dEquivMass);
+	const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * normRelVelLen * std::sqrt(Kn * CollisionFields().EquivMass(_collision));
 	const CVector3 normForce = normVector * (normContactForceLen + normDampingForceLen);
 
 	// rotate old tangential overlap
@@ -50,7 +52,7 @@ void CModelPPLinearElastic::CalculatePP(double _time, double _timeStep, size_t _
 
 	// tangential force with damping
 	const CVector3 tangShearForce = tangOverlap * Kt;
-	const CVector3 tangDampingForce = tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * _collision->dEquivMass));
+	const CVector3 tangDampingForce = tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * CollisionFields().EquivMass(_collision)));
 
 	// check slipping condition and calculate total tangential force
 	CVector3 tangForce;
@@ -75,20 +77,20 @@ void CModelPPLinearElastic::CalculatePP(double _time, double _timeStep, size_t _
 
 	// store results in collision
 	_collision->vTangOverlap   = tangOverlap;
-	_collision->vTangForce     = tangForce;
+	if (CollisionFields().TangForceExist()) CollisionFields().TangForce(_collision) = tangForce;
 	_collision->vTotalForce    = totalForce;
-	_collision->vResultMoment1 = moment1;
-	_collision->vResultMoment2 = moment2;
+	CollisionFields().ResultMoment1(_collision) = moment1;
+	CollisionFields().ResultMoment2(_collision) = moment2;
 }
 
 void CModelPPLinearElastic::ConsolidateSrc(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) += _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment1;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment1(_collision);
 }
 
 void CModelPPLinearElastic::ConsolidateDst(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) -= _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment2;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment2(_collision);
 }
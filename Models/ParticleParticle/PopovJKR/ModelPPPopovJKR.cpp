@@ -9,6 +9,8 @@ CModelPPPopovJKR::CModelPPPopovJKR()
 	m_name         = "Popov-JKR";
 	m_uniqueKey    = "7A4C0DAF1F6D44AE925F4DD84563E36F";
 	m_helpFileName = "/Contact Models/PopovJKR.pdf";
+	m_requieredVariables.bContactEquivalents = true;
+	m_requieredVariables.bContactMoments = true;
 }
 
 void CModelPPPopovJKR::CalculatePP(double _time, double _timeStep, size_t _iSrc, size_t _iDst, const SInteractProps& _interactProp, SCollision* _collision) const
@@ -29,14 +31,14 @@ void CModelPPPopovJKR::CalculatePP(double _time, double _timeStep, size_t _iSrc,
 	const CVector3 tangRelVel    = relVel - normRelVel;
 
 	// radius of the contact area
-	const double contactAreaRadius = std::sqrt(_collision->dEquivRadius * _collision->dNormalOverlap);
+	const double contactAreaRadius = std::sqrt(CollisionFields().EquivRadius(_collision) * _collision->dNormalOverlap);
 
 	// normal force with damping
 	const double Kn = 2 * _interactProp.dEquivYoungModulus * contactAreaRadius;
-	const double adhForce = 3. / 2. * _interactProp.dEquivSurfaceTension * PI * _collision->dEquivRadius;
-	const double SAdh = std::pow(0.4626 * std::pow(_interactProp.dEquivSurfaceTension / _interactProp.dEquivYoungModulus, 2) * _collision->dEquivRadius, 1. /3.);
+	const double adhForce = 3. / 2. * _interactProp.dEquivSurfaceTension * PI * CollisionFields().EquivRadius(_collision);
+	const double SAdh = std::pow(0.4626 * std::pow(_interactProp.dEquivSurfaceTension / _interactProp.dEquivYoungModulus, 2) * CollisionFields().EquivRadius(_collision), 1. /3.);
 	const double normContactForceLen = -adhForce * (-1 + 0.12 * std::pow(_collision->dNormalOverlap / SAdh + 1, 5. / 3.));
-	const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * normRelVelLen * std::sqrt(Kn * _collision->dEquivMass);
+	const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * normRelVelLen * std::sqrt(Kn * CollisionFields().EquivMass(_collision));
 	const CVector3 normForce = normVector * (normContactForceLen + normDampingForceLen);
 
 	// rotate old tangential overlap
@@ -49,7 +51,7 @@ void CModelPPPopovJKR::CalculatePP(double _time, double _timeStep, size_t _iSrc,
 	// tangential force with damping
 	const double Kt = 8 * _interactProp.dEquivShearModulus * contactAreaRadius;
 	const CVector3 tangShearForce = tangOverlap * Kt;
-	const CVector3 tangDampingForce = tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * _collision->dEquivMass));
+	const CVector3 tangDampingForce = tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * CollisionFields().EquivMass(_collision)));
 
 	// check slipping condition and calculate total tangential force
 	CVector3 tangForce;
@@ -74,20 +76,20 @@ void CModelPPPopovJKR::CalculatePP(double _time, double _timeStep, size_t _iSrc,
 
 	// store results in collision
 	_collision->vTangOverlap   = tangOverlap;
-	_collision->vTangForce     = tangForce;
+	if (CollisionFields().TangForceExist()) CollisionFields().TangForce(_collision) = tangForce;
 	_collision->vTotalForce    = totalForce;
-	_collision->vResultMoment1 = moment1;
-	_collision->vResultMoment2 = moment2;
+	CollisionFields().ResultMoment1(_collision) = moment1;
+	CollisionFields().ResultMoment2(_collision) = moment2;
 }
 
 void CModelPPPopovJKR::ConsolidateSrc(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) += _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment1;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment1(_collision);
 }
 
 void CModelPPPopovJKR::ConsolidateDst(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) -= _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment2;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment2(_collision);
 }
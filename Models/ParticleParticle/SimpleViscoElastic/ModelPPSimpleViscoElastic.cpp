@@ -10,6 +10,7 @@ CModelPPSimpleViscoElastic::CModelPPSimpleViscoElastic()
 	m_uniqueKey     = "5B1DBC037BAE488086159B7731E1D68F";
 	m_helpFileName  = "/Contact Models/SimpleViscoElastic.pdf";
 	m_hasGPUSupport = true;
+	m_hasMixedPrecisionSupport = true;
 
 	/* 0*/ AddParameter("NORMAL_FORCE_COEFF"      , "Coefficient of normal force", 1);
 	/* 1*/ AddParameter("NORMAL_DAMPING_PARAMETER", "Damping parameter"          , 0);
@@ -36,6 +37,62 @@ void CModelPPSimpleViscoElastic::CalculatePP(double _time, double _timeStep, siz
 	_collision->vTotalForce = normForce;
 }
 
+void CModelPPSimpleViscoElastic::CalculatePPBatch(double _time, double _timeStep, const SPPContactsBatch& _batch) const
+{
+	CalculatePPBatchT<double>(_batch);
+}
+
+void CModelPPSimpleViscoElastic::CalculatePPBatchMixed(double _time, double _timeStep, const SPPContactsBatch& _batch) const
+{
+	CalculatePPBatchT<float>(_batch);
+}
+
+template<typename T>
+void CModelPPSimpleViscoElastic::CalculatePPBatchT(const SPPContactsBatch& _batch) const
+{
+	// model parameters
+	const T Kn = static_cast<T>(m_parameters[0].value);
+	const T mu = static_cast<T>(m_parameters[1].value);
+
+	constexpr size_t N = SPPContactsBatch::MAX_SIZE;
+	const size_t n = _batch.size;
+
+	// gather properties of contacts; relative velocities are obtained in double precision
+	T overlap[N], cv[3][N], relVel[3][N];
+	for (size_t i = 0; i < n; ++i)
+	{
+		const SCollision* collision = _batch.collisions[i];
+		const CVector3& vel1 = Particles().Vel(collision->nSrcID);
+		const CVector3& vel2 = Particles().Vel(collision->nDstID);
+		overlap[i] = static_cast<T>(collision->dNormalOverlap);
+		cv[0][i] = static_cast<T>(collision->vContactVector.x);	cv[1][i] = static_cast<T>(collision->vContactVector.y);	cv[2][i] = static_cast<T>(collision->vContactVector.z);
+		relVel[0][i] = static_cast<T>(vel2.x - vel1.x);			relVel[1][i] = static_cast<T>(vel2.y - vel1.y);			relVel[2][i] = static_cast<T>(vel2.z - vel1.z);
+	}
+
+	// the same calculations as in CalculatePP(), written component-wise to be vectorized
+	T forceRes[3][N];
+	for (size_t i = 0; i < n; ++i)
+	{
+		const T cvLen = std::sqrt(cv[0][i] * cv[0][i] + cv[1][i] * cv[1][i] + cv[2][i] * cv[2][i]);
+		const T nx = cvLen != 0 ? cv[0][i] / cvLen : T(0);
+		const T ny = cvLen != 0 ? cv[1][i] / cvLen : T(0);
+		const T nz = cvLen != 0 ? cv[2][i] / cvLen : T(0);
+
+		// relative velocity (normal)
+		const T normRelVelLen = nx * relVel[0][i] + ny * relVel[1][i] + nz * relVel[2][i];
+
+		// normal force with damping
+		const T normForceLen = -overlap[i] * Kn + mu * normRelVelLen;
+		forceRes[0][i] = nx * normForceLen;
+		forceRes[1][i] = ny * normForceLen;
+		forceRes[2][i] = nz * normForceLen;
+	}
+
+	// store results in collisions, always in double precision
+	for (size_t i = 0; i < n; ++i)
+		_batch.collisions[i]->vTotalForce = CVector3{ forceRes[0][i], forceRes[1][i], forceRes[2][i] };
+}
+
 void CModelPPSimpleViscoElastic::ConsolidateSrc(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) += _collision->vTotalForce;
@@ -5,15 +5,21 @@
 #pragma once
 #include "AbstractDEMModel.h"
 
-class CModelPPSimpleViscoElastic : public CParticleParticleModel
+class CModelPPSimpleViscoElastic : public CParticleParticleModel, public CParticleParticleBatchModel
 {
 public:
 	CModelPPSimpleViscoElastic();
 
 	void CalculatePP(double _time, double _timeStep, size_t _iSrc, size_t _iDst, const SInteractProps& _interactProp, SCollision* _collision) const override;
+	void CalculatePPBatch(double _time, double _timeStep, const SPPContactsBatch& _batch) const override;
+	void CalculatePPBatchMixed(double _time, double _timeStep, const SPPContactsBatch& _batch) const override;
 	void ConsolidateSrc(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const override;
 	void ConsolidateDst(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const override;
 
 	void SetParametersGPU(const std::vector<double>& _parameters, const SPBC& _pbc) override;
 	void CalculatePPGPU(double _time, double _timeStep, const SInteractProps _interactProps[], const SGPUParticles& _particles, SGPUCollisions& _collisions) override;
+
+private:
+	// Calculates the batch of contacts, evaluating all per-contact values with the scalar type T.
+	template<typename T> void CalculatePPBatchT(const SPPContactsBatch& _batch) const;
 };
\ No newline at end of file
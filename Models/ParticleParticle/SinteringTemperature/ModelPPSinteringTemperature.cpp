@@ -7,6 +7,8 @@ CModelPPSinteringTemperature::CModelPPSinteringTemperature()
 	m_uniqueKey                    = "A41AB40D3A074FE9AAE0B0ADB27XBFBA";
 	m_requieredVariables.bThermals = true;
 	m_hasGPUSupport                = true;
+	m_requieredVariables.bContactEquivalents = true;
+	m_requieredVariables.bContactInitOverlap = true;
 
 	/* 0*/ AddParameter("GRAINBOUND_DIFFUSION", "Grain-boundary thickness times diffusion coefficient [??]", 1.3e-8  );
 	/* 1*/ AddParameter("VISCOUS_PARAMETER"   , "Viscous parameter for tangential force (eta) [-]"         , 0.01    );
@@ -28,7 +30,7 @@ void CModelPPSinteringTemperature::CalculatePP(double _time, double _timeStep, s
 
 	const CVector3 normVector = _collision->vContactVector.Normalized();
 	const double temperatureK   = (Particles().Temperature(_iSrc) + Particles().Temperature(_iDst)) / 2;
-	const double maxNormOverlap = maxOverlapCoeff * 2 * _collision->dEquivRadius;
+	const double maxNormOverlap = maxOverlapCoeff * 2 * CollisionFields().EquivRadius(_collision);
 
 	// normal and tangential relative velocity
 	// TODO: switch and remove -1?
@@ -41,7 +43,7 @@ void CModelPPSinteringTemperature::CalculatePP(double _time, double _timeStep, s
 	if (_time == 0.0)
 	{
 		_collision->vTangOverlap.Init(0);
-		_collision->dInitNormalOverlap = _collision->dNormalOverlap;
+		CollisionFields().InitNormalOverlap(_collision) = _collision->dNormalOverlap;
 	}
 
 	CVector3 totalForce;
@@ -50,17 +52,17 @@ void CModelPPSinteringTemperature::CalculatePP(double _time, double _timeStep, s
 	{
 		// reset normal and tangential overlaps
 		_collision->vTangOverlap.Init(0);
-		_collision->dInitNormalOverlap = _collision->dNormalOverlap;
+		CollisionFields().InitNormalOverlap(_collision) = _collision->dNormalOverlap;
 
 		const double diffusionParameter = atomicVolume / (BOLTZMANN_CONSTANT * temperatureK) * grainBoundTimesDiff * std::exp(-activationEnergy / (GAS_CONSTANT * temperatureK));
 
 		// Bouvard and McMeeking's model
-		const double squaredContactRadius = 4 * _collision->dEquivRadius * _collision->dNormalOverlap;
+		const double squaredContactRadius = 4 * CollisionFields().EquivRadius(_collision) * _collision->dNormalOverlap;
 
 		// forces
-		const CVector3 sinteringForce = normVector * 1.125 * PI * 2 * _collision->dEquivRadius * _interactProp.dEquivSurfaceEnergy;
+		const CVector3 sinteringForce = normVector * 1.125 * PI * 2 * CollisionFields().EquivRadius(_collision) * _interactProp.dEquivSurfaceEnergy;
 		const CVector3 viscousForce   = normRelVel * (-PI * std::pow(squaredContactRadius, 2) / 8 / diffusionParameter);
-		const CVector3 tangForce      = tangRelVel * (-viscousParameter * PI * squaredContactRadius * std::pow(2 * _collision->dEquivRadius, 2) / 8 / diffusionParameter);
+		const CVector3 tangForce      = tangRelVel * (-viscousParameter * PI * squaredContactRadius * std::pow(2 * CollisionFields().EquivRadius(_collision), 2) / 8 / diffusionParameter);
 
 		// total force
 		totalForce = sinteringForce + viscousForce + tangForce;
@@ -69,14 +71,14 @@ void CModelPPSinteringTemperature::CalculatePP(double _time, double _timeStep, s
 	else if (temperatureK <= minTemperature)
 	{
 		// radius of the contact area
-		const double contactAreaRadius = std::sqrt(_collision->dEquivRadius * _collision->dNormalOverlap);
+		const double contactAreaRadius = std::sqrt(CollisionFields().EquivRadius(_collision) * _collision->dNormalOverlap);
 
 		// normal force with damping
 		const double Kn = 2 * _interactProp.dEquivYoungModulus * contactAreaRadius;
-		const double deltaNormOverlap = _collision->dNormalOverlap >= maxNormOverlap ? maxNormOverlap : _collision->dInitNormalOverlap;
+		const double deltaNormOverlap = _collision->dNormalOverlap >= maxNormOverlap ? maxNormOverlap : CollisionFields().InitNormalOverlap(_collision);
 		const double normContactForceLen = -(_collision->dNormalOverlap - deltaNormOverlap) * Kn * 2. / 3.;
 		// TODO: why -1?
-		const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * -1 * normRelVelLen * std::sqrt(Kn * _collision->dEquivMass);
+		const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * -1 * normRelVelLen * std::sqrt(Kn * CollisionFields().EquivMass(_collision));
 		const CVector3 normForce = normVector * (normContactForceLen + normDampingForceLen);
 
 		// rotate old tangential overlap
@@ -91,7 +93,7 @@ void CModelPPSinteringTemperature::CalculatePP(double _time, double _timeStep, s
 		const double Kt = 8 * _interactProp.dEquivShearModulus * contactAreaRadius;
 		const CVector3 tangShearForce = tangOverlap * Kt;
 		// TODO: why -1?
-		const CVector3 tangDampingForce = -1 * tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * _collision->dEquivMass));
+		const CVector3 tangDampingForce = -1 * tangRelVel * (-_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * CollisionFields().EquivMass(_collision)));
 		const CVector3 tangForce = tangShearForce + tangDampingForce;
 
 		// total force
@@ -104,16 +106,16 @@ void CModelPPSinteringTemperature::CalculatePP(double _time, double _timeStep, s
 	{
 		// reset normal and tangential overlaps
 		_collision->vTangOverlap.Init(0);
-		_collision->dInitNormalOverlap = _collision->dNormalOverlap;
+		CollisionFields().InitNormalOverlap(_collision) = _collision->dNormalOverlap;
 
 		// radius of the contact area
-		const double contactAreaRadius = std::sqrt(_collision->dEquivRadius * _collision->dNormalOverlap);
+		const double contactAreaRadius = std::sqrt(CollisionFields().EquivRadius(_collision) * _collision->dNormalOverlap);
 
 		// normal force with damping
 		const double Kn = 2 * _interactProp.dEquivYoungModulus * contactAreaRadius;
 		const double normContactForceLen = -(_collision->dNormalOverlap - maxNormOverlap) * Kn * 2. / 3.;
 		// TODO: why -1?
-		const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * -1 * normRelVelLen * std::sqrt(Kn * _collision->dEquivMass);
+		const double normDampingForceLen = -_2_SQRT_5_6 * _interactProp.dAlpha * -1 * normRelVelLen * std::sqrt(Kn * CollisionFields().EquivMass(_collision));
 		const CVector3 normForce = normVector * (normContactForceLen + normDampingForceLen);
 
 		// total force
@@ -10,6 +10,7 @@ CModelPPSintering::CModelPPSintering()
 	m_uniqueKey     = "A41AB40D3A074FE9AAE0B0ADB27ABFBA";
 	m_helpFileName  = "/Contact Models/Sintering.pdf";
 	m_hasGPUSupport = true;
+	m_requieredVariables.bContactEquivalents = true;
 
 	/* 0*/ AddParameter("DIFFUSION"        , "Diffusion parameter [??]"                        , 1.28e-34);
 	/* 1*/ AddParameter("VISCOUS_PARAMETER", "Viscous parameter for tangential force (eta) [-]", 0.01);
@@ -29,12 +30,12 @@ void CModelPPSintering::CalculatePP(double _time, double _timeStep, size_t _iSrc
 	const CVector3 tangRelVel = relVel - normRelVel;
 
 	// Bouvard and McMeeking's model
-	const double squaredContactRadius = 4 * _collision->dEquivRadius * _collision->dNormalOverlap;
+	const double squaredContactRadius = 4 * CollisionFields().EquivRadius(_collision) * _collision->dNormalOverlap;
 
 	// forces
-	const CVector3 sinteringForce = normVector * 1.125 * PI * 2 * _collision->dEquivRadius * _interactProp.dEquivSurfaceEnergy;
+	const CVector3 sinteringForce = normVector * 1.125 * PI * 2 * CollisionFields().EquivRadius(_collision) * _interactProp.dEquivSurfaceEnergy;
 	const CVector3 viscousForce   = normRelVel * (-PI * std::pow(squaredContactRadius, 2) / 8 / diffusionParam);
-	const CVector3 tangForce      = tangRelVel * (-viscousParam * PI * squaredContactRadius * std::pow(2 * _collision->dEquivRadius, 2) / 8 / diffusionParam);
+	const CVector3 tangForce      = tangRelVel * (-viscousParam * PI * squaredContactRadius * std::pow(2 * CollisionFields().EquivRadius(_collision), 2) / 8 / diffusionParam);
 	const CVector3 totalForce     = sinteringForce + viscousForce + tangForce;
 
 	// store results in collision
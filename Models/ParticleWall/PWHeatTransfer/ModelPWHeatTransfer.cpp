@@ -10,6 +10,7 @@ CModelPWHeatTransfer::CModelPWHeatTransfer()
 	m_uniqueKey                    = "E51F4196FE24495191EA9A1A8E794925";
 	m_helpFileName                 = "";
 	m_requieredVariables.bThermals = true;
+	m_requieredVariables.bContactHeatFlux = true;
 	m_hasGPUSupport                = true;
 
 	/* 0 */ AddParameter("WALL_TEMPERATURE"   , "Constant temperature of the wall [K]", 1173);
@@ -33,10 +34,10 @@ void CModelPWHeatTransfer::CalculatePW(double _time, double _timeStep, size_t _i
 	const double normOverlap = partRadius - rcLen;
 	if (normOverlap < 0) return;
 
-	_collision->dHeatFlux = PI * partRadius * normOverlap * heatTransferCoeff * resistivityFactor * (wallTemperature - partTemperature);
+	CollisionFields().HeatFlux(_collision) = PI * partRadius * normOverlap * heatTransferCoeff * resistivityFactor * (wallTemperature - partTemperature);
 }
 
 void CModelPWHeatTransfer::ConsolidatePart(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
-	_particles.HeatFlux(_iPart) += _collision->dHeatFlux;
+	_particles.HeatFlux(_iPart) += CollisionFields().HeatFlux(_collision);
 }
@@ -10,54 +10,71 @@ CModelPWHertzMindlin::CModelPWHertzMindlin()
 	m_uniqueKey     = "906949ACFFAE4B8C8B1B65509930EA6D";
 	m_helpFileName  = "/Contact Models/HertzMindlin.pdf";
 	m_hasGPUSupport = true;
+	m_hasMixedPrecisionSupport = true;
+	m_requieredVariables.bContactMoments = true;
 }
 
 void CModelPWHertzMindlin::CalculatePW(double _time, double _timeStep, size_t _iWall, size_t _iPart, const SInteractProps& _interactProp, SCollision* _collision) const
 {
-	const double   partRadius  = Particles().Radius(_iPart);
-	const CVector3 partAnglVel = Particles().AnglVel(_iPart);
-	const CVector3 normVector  = Walls().NormalVector(_iWall);
+	CalculatePWT<double>(_timeStep, _iWall, _iPart, _interactProp, _collision);
+}
+
+void CModelPWHertzMindlin::CalculatePWMixed(double _time, double _timeStep, size_t _iWall, size_t _iPart, const SInteractProps& _interactProp, SCollision* _collision) const
+{
+	CalculatePWT<float>(_timeStep, _iWall, _iPart, _interactProp, _collision);
+}
 
+template<typename T>
+void CModelPWHertzMindlin::CalculatePWT(double _timeStep, size_t _iWall, size_t _iPart, const SInteractProps& _interactProp, SCollision* _collision) const
+{
+	using V = CBasicVector3<T>;
+
+	// relative position and normal overlap are obtained from absolute coordinates in double precision
 	const CVector3 rc     = CPU_GET_VIRTUAL_COORDINATE(Particles().Coord(_iPart)) - _collision->vContactVector;
 	const double   rcLen  = rc.Length();
-	const CVector3 rcNorm = rc / rcLen;
+	if (Particles().Radius(_iPart) - rcLen < 0) return;
+
+	const T partRadius  = static_cast<T>(Particles().Radius(_iPart));
+	const V partAnglVel = static_cast<V>(Particles().AnglVel(_iPart));
+	const V normVector  = static_cast<V>(Walls().NormalVector(_iWall));
+	const V rcNorm      = static_cast<V>(rc / rcLen);
 
 	// normal overlap
-	const double normOverlap = partRadius - rcLen;
-	if (normOverlap < 0) return;
+	const T normOverlap = static_cast<T>(Particles().Radius(_iPart) - rcLen);
 
 	// normal and tangential relative velocity
-	const CVector3 rotVel        = !Walls().RotVel(_iWall).IsZero() ? (_collision->vContactVector - Walls().RotCenter(_iWall)) * Walls().RotVel(_iWall) : CVector3{ 0 };
-	const CVector3 relVel        = Particles().Vel(_iPart) - Walls().Vel(_iWall) + rotVel + rcNorm * partAnglVel * partRadius;
-	const double   normRelVelLen = DotProduct(normVector, relVel);
-	const CVector3 normRelVel    = normRelVelLen * normVector;
-	const CVector3 tangRelVel    = relVel - normRelVel;
+	const V rotVel        = !Walls().RotVel(_iWall).IsZero() ? static_cast<V>((_collision->vContactVector - Walls().RotCenter(_iWall)) * Walls().RotVel(_iWall)) : V{ 0 };
+	const V relVel        = static_cast<V>(Particles().Vel(_iPart) - Walls().Vel(_iWall)) + rotVel + rcNorm * partAnglVel * partRadius;
+	const T normRelVelLen = DotProduct(normVector, relVel);
+	const V normRelVel    = normRelVelLen * normVector;
+	const V tangRelVel    = relVel - normRelVel;
 
 	// radius of the contact area
-	const double contactAreaRadius = std::sqrt(partRadius * normOverlap);
+	const T contactAreaRadius = std::sqrt(partRadius * normOverlap);
 
 	// normal force with damping
-	const double Kn = 2 * _interactProp.dEquivYoungModulus * contactAreaRadius;
-	const double normContactForceLen = 2. / 3. * normOverlap * Kn * std::abs(DotProduct(rcNorm, normVector));
-	const double normDampingForceLen = _2_SQRT_5_6 * _interactProp.dAlpha * normRelVelLen * std::sqrt(Kn * Particles().Mass(_iPart));
-	const CVector3 normForce = normVector * (normContactForceLen + normDampingForceLen);
+	const T Kn = T(2) * static_cast<T>(_interactProp.dEquivYoungModulus) * contactAreaRadius;
+	const T normContactForceLen = T(2) / T(3) * normOverlap * Kn * std::abs(DotProduct(rcNorm, normVector));
+	const T normDampingForceLen = static_cast<T>(_2_SQRT_5_6) * static_cast<T>(_interactProp.dAlpha) * normRelVelLen * std::sqrt(Kn * static_cast<T>(Particles().Mass(_iPart)));
+	const V normForce = normVector * (normContactForceLen + normDampingForceLen);
 
 	// rotate old tangential overlap
-	CVector3 tangOverlapRot = _collision->vTangOverlap - normVector * DotProduct(normVector, _collision->vTangOverlap);
+	const V tangOverlapOld = static_cast<V>(_collision->vTangOverlap);
+	V tangOverlapRot = tangOverlapOld - normVector * DotProduct(normVector, tangOverlapOld);
 	if (tangOverlapRot.IsSignificant())
-		tangOverlapRot *= _collision->vTangOverlap.Length() / tangOverlapRot.Length();
+		tangOverlapRot *= tangOverlapOld.Length() / tangOverlapRot.Length();
 	// calculate new tangential overlap
-	CVector3 tangOverlap = tangOverlapRot + tangRelVel * _timeStep;
+	V tangOverlap = tangOverlapRot + tangRelVel * static_cast<T>(_timeStep);
 
 	// tangential force with damping
-	const double Kt = 8 * _interactProp.dEquivShearModulus * contactAreaRadius;
-	const CVector3 tangShearForce = -Kt * tangOverlap;
-	const CVector3 tangDampingForce = tangRelVel * (_2_SQRT_5_6 * _interactProp.dAlpha * std::sqrt(Kt * Particles().Mass(_iPart)));
+	const T Kt = T(8) * static_cast<T>(_interactProp.dEquivShearModulus) * contactAreaRadius;
+	const V tangShearForce = -Kt * tangOverlap;
+	const V tangDampingForce = tangRelVel * (static_cast<T>(_2_SQRT_5_6) * static_cast<T>(_interactProp.dAlpha) * std::sqrt(Kt * static_cast<T>(Particles().Mass(_iPart))));
 
 	// check slipping condition and calculate total tangential force
-	CVector3 tangForce;
-	const double tangShearForceLen = tangShearForce.Length();
-	const double frictionForceLen = _interactProp.dSlidingFriction * std::abs(normContactForceLen + normDampingForceLen);
+	V tangForce;
+	const T tangShearForceLen = tangShearForce.Length();
+	const T frictionForceLen = static_cast<T>(_interactProp.dSlidingFriction) * std::abs(normContactForceLen + normDampingForceLen);
 	if (tangShearForceLen > frictionForceLen)
 	{
 		tangForce   = tangShearForce * frictionForceLen / tangShearForceLen;
@@ -67,23 +84,23 @@ void CModelPWHertzMindlin::CalculatePW(double _time, double _timeStep, size_t _i
 		tangForce   = tangShearForce + tangDampingForce;
 
 	// rolling torque
-	const CVector3 rollingTorque = partAnglVel.IsSignificant() ? partAnglVel * (-_interactProp.dRollingFriction * std::abs(normContactForceLen) * partRadius / partAnglVel.Length()) : CVector3{ 0 };
+	const V rollingTorque = partAnglVel.IsSignificant() ? partAnglVel * (-static_cast<T>(_interactProp.dRollingFriction) * std::abs(normContactForceLen) * partRadius / partAnglVel.Length()) : V{ 0 };
 
 	// final forces and moments
-	const CVector3 totalForce = normForce + tangForce;
-	const CVector3 moment     = normVector * tangForce * -partRadius + rollingTorque;
-
-	// store results in collision
-	_collision->vTangOverlap   = tangOverlap;
-	_collision->vTangForce     = tangForce;
-	_collision->vTotalForce    = totalForce;
-	_collision->vResultMoment1 = moment;
+	const V totalForce = normForce + tangForce;
+	const V moment     = normVector * tangForce * -partRadius + rollingTorque;
+
+	// store results in collision, always in double precision
+	_collision->vTangOverlap   = static_cast<CVector3>(tangOverlap);
+	if (CollisionFields().TangForceExist()) CollisionFields().TangForce(_collision) = static_cast<CVector3>(tangForce);
+	_collision->vTotalForce    = static_cast<CVector3>(totalForce);
+	CollisionFields().ResultMoment1(_collision) = static_cast<CVector3>(moment);
 }
 
 void CModelPWHertzMindlin::ConsolidatePart(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) += _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment1;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment1(_collision);
 }
 
 void CModelPWHertzMindlin::ConsolidateWall(double _time, double _timeStep, size_t _iWall, SWallStruct& _walls, const SCollision* _collision) const
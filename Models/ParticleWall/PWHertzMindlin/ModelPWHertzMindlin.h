@@ -12,9 +12,14 @@ public:
 	CModelPWHertzMindlin();
 
 	void CalculatePW(double _time, double _timeStep, size_t _iWall, size_t _iPart, const SInteractProps& _interactProp, SCollision* _collision) const override;
+	void CalculatePWMixed(double _time, double _timeStep, size_t _iWall, size_t _iPart, const SInteractProps& _interactProp, SCollision* _collision) const override;
 	void ConsolidatePart(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const override;
 	void ConsolidateWall(double _time, double _timeStep, size_t _iWall, SWallStruct& _walls, const SCollision* _collision) const override;
 
 	void SetParametersGPU(const std::vector<double>& _parameters, const SPBC& _pbc) override;
 	void CalculatePWGPU(double _time, double _timeStep, const SInteractProps _interactProps[], const SGPUParticles& _particles, const SGPUWalls& _walls, SGPUCollisions& _collisions) override;
+
+private:
+	// Calculates the contact, evaluating all per-contact values with the scalar type T.
+	template<typename T> void CalculatePWT(double _timeStep, size_t _iWall, size_t _iPart, const SInteractProps& _interactProp, SCollision* _collision) const;
 };
\ No newline at end of file
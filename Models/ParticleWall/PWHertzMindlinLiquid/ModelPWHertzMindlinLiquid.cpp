@@ -9,6 +9,7 @@ CModelPWHertzMindlinLiquid::CModelPWHertzMindlinLiquid()
 	m_name          = "Hertz-MindlinLiquid";
 	m_uniqueKey     = "906949ACFFAE4B8C8B1B62209930EA6D";
 	m_hasGPUSupport = true;
+	m_requieredVariables.bContactMoments = true;
 
 	/* 0*/ AddParameter("MIN_THICKNESS"    , "Min. thickness of liquid [m]", 1e-5);
 	/* 1*/ AddParameter("CONTACT_ANGLE"    , "Contact angle [grad]"        , 70  );
@@ -102,15 +103,15 @@ void CModelPWHertzMindlinLiquid::CalculatePW(double _time, double _timeStep, siz
 
 	// store results in collision
 	_collision->vTangOverlap   = tangOverlap;
-	_collision->vTangForce     = tangForce;
+	if (CollisionFields().TangForceExist()) CollisionFields().TangForce(_collision) = tangForce;
 	_collision->vTotalForce    = totalForce;
-	_collision->vResultMoment1 = moment1;
+	CollisionFields().ResultMoment1(_collision) = moment1;
 }
 
 void CModelPWHertzMindlinLiquid::ConsolidatePart(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) += _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment1;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment1(_collision);
 }
 
 void CModelPWHertzMindlinLiquid::ConsolidateWall(double _time, double _timeStep, size_t _iWall, SWallStruct& _walls, const SCollision* _collision) const
@@ -10,6 +10,7 @@ CModelPWJKR::CModelPWJKR()
 	m_uniqueKey    = "470A5893541D4204A7F1F2C993C667FB";
 	m_helpFileName = "/Contact Models/JKR.pdf";
 	m_hasGPUSupport = true;
+	m_requieredVariables.bContactMoments = true;
 }
 
 void CModelPWJKR::CalculatePW(double _time, double _timeStep, size_t _iWall, size_t _iPart, const SInteractProps& _interactProp, SCollision* _collision) const
@@ -77,15 +78,15 @@ void CModelPWJKR::CalculatePW(double _time, double _timeStep, size_t _iWall, siz
 
 	// store results in collision
 	_collision->vTangOverlap   = tangOverlap;
-	_collision->vTangForce     = tangForce;
+	if (CollisionFields().TangForceExist()) CollisionFields().TangForce(_collision) = tangForce;
 	_collision->vTotalForce    = totalForce;
-	_collision->vResultMoment1 = moment;
+	CollisionFields().ResultMoment1(_collision) = moment;
 }
 
 void CModelPWJKR::ConsolidatePart(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) += _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment1;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment1(_collision);
 }
 
 void CModelPWJKR::ConsolidateWall(double _time, double _timeStep, size_t _iWall, SWallStruct& _walls, const SCollision* _collision) const
@@ -9,6 +9,7 @@ CModelPWPopovJKR::CModelPWPopovJKR()
 	m_name = "Popov-JKR";
 	m_uniqueKey = "5048D3D96D3843949F5B427DF9FCCEDF";
 	m_helpFileName = "/Contact Models/PopovJKR.pdf";
+	m_requieredVariables.bContactMoments = true;
 }
 
 void CModelPWPopovJKR::CalculatePW(double _time, double _timeStep, size_t _iWall, size_t _iPart, const SInteractProps& _interactProp, SCollision* _collision) const
@@ -76,15 +77,15 @@ void CModelPWPopovJKR::CalculatePW(double _time, double _timeStep, size_t _iWall
 
 	// store results in collision
 	_collision->vTangOverlap   = tangOverlap;
-	_collision->vTangForce     = tangForce;
+	if (CollisionFields().TangForceExist()) CollisionFields().TangForce(_collision) = tangForce;
 	_collision->vTotalForce    = totalForce;
-	_collision->vResultMoment1 = moment;
+	CollisionFields().ResultMoment1(_collision) = moment;
 }
 
 void CModelPWPopovJKR::ConsolidatePart(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
 {
 	_particles.Force(_iPart) += _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment1;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment1(_collision);
 }
 
 void CModelPWPopovJKR::ConsolidateWall(double _time, double _timeStep, size_t _iWall, SWallStruct& _walls, const SCollision* _collision) const
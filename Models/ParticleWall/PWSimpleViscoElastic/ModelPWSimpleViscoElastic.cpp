@@ -10,6 +10,7 @@ CModelPWSimpleViscoElastic::CModelPWSimpleViscoElastic()
 	m_uniqueKey     = "522836B77298445A8FFD02CA55FFF717";
 	m_helpFileName  = "/Contact Models/SimpleViscoElastic.pdf";
 	m_hasGPUSupport = true;
+	m_hasMixedPrecisionSupport = true;
 
 	/* 0*/ AddParameter("NORMAL_FORCE_COEFF"      , "Coefficient of normal force", 1);
 	/* 1*/ AddParameter("NORMAL_DAMPING_PARAMETER", "Damping parameter"          , 0);
@@ -17,32 +18,46 @@ CModelPWSimpleViscoElastic::CModelPWSimpleViscoElastic()
 
 void CModelPWSimpleViscoElastic::CalculatePW(double _time, double _timeStep, size_t _iWall, size_t _iPart, const SInteractProps& _interactProp, SCollision* _collision) const
 {
-	// model parameters
-	const double Kn = m_parameters[0].value;
-	const double mu = m_parameters[1].value;
+	CalculatePWT<double>(_iWall, _iPart, _collision);
+}
 
-	const CVector3 normVector = Walls().NormalVector(_iWall);
+void CModelPWSimpleViscoElastic::CalculatePWMixed(double _time, double _timeStep, size_t _iWall, size_t _iPart, const SInteractProps& _interactProp, SCollision* _collision) const
+{
+	CalculatePWT<float>(_iWall, _iPart, _collision);
+}
 
+template<typename T>
+void CModelPWSimpleViscoElastic::CalculatePWT(size_t _iWall, size_t _iPart, SCollision* _collision) const
+{
+	using V = CBasicVector3<T>;
+
+	// model parameters
+	const T Kn = static_cast<T>(m_parameters[0].value);
+	const T mu = static_cast<T>(m_parameters[1].value);
+
+	// relative position and normal overlap are obtained from absolute coordinates in double precision
 	const CVector3 rc     = CPU_GET_VIRTUAL_COORDINATE(Particles().Coord(_iPart)) - _collision->vContactVector;
 	const double   rcLen  = rc.Length();
-	const CVector3 rcNorm = rc / rcLen;
+	if (Particles().Radius(_iPart) - rcLen < 0) return;
+
+	const V normVector = static_cast<V>(Walls().NormalVector(_iWall));
+	const V rcNorm     = static_cast<V>(rc / rcLen);
 
 	// normal overlap
-	const double normOverlap =  Particles().Radius(_iPart) - rcLen;
-	if (normOverlap < 0) return;
+	const T normOverlap = static_cast<T>(Particles().Radius(_iPart) - rcLen);
 
 	// normal and tangential relative velocity
-	const CVector3 rotVel      = !Walls().RotVel(_iWall).IsZero() ? (_collision->vContactVector - Walls().RotCenter(_iWall)) * Walls().RotVel(_iWall) : CVector3{ 0 };
-	const CVector3 relVel      = Particles().Vel(_iPart) - Walls().Vel(_iWall) + rotVel;
-	const double normRelVelLen = DotProduct(normVector, relVel);
+	const V rotVel      = !Walls().RotVel(_iWall).IsZero() ? static_cast<V>((_collision->vContactVector - Walls().RotCenter(_iWall)) * Walls().RotVel(_iWall)) : V{ 0 };
+	const V relVel      = static_cast<V>(Particles().Vel(_iPart) - Walls().Vel(_iWall)) + rotVel;
+	const T normRelVelLen = DotProduct(normVector, relVel);
 
 	// normal force with damping
-	const double normContactForceLen = normOverlap * Kn * std::abs(DotProduct(rcNorm, normVector));
-	const double normDampingForceLen = -mu * normRelVelLen;
-	const CVector3 normForce = normVector * (normContactForceLen + normDampingForceLen);
+	const T normContactForceLen = normOverlap * Kn * std::abs(DotProduct(rcNorm, normVector));
+	const T normDampingForceLen = -mu * normRelVelLen;
+	const V normForce = normVector * (normContactForceLen + normDampingForceLen);
 
-	// store results in collision
-	_collision->vTotalForce = normForce;
+	// store results in collision, always in double precision
+	_collision->vTotalForce = static_cast<CVector3>(normForce);
 }
 
 void CModelPWSimpleViscoElastic::ConsolidatePart(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
@@ -21,6 +21,7 @@ CModelPP::CModelPP()
 	m_name = "Model name";
 	/// TODO: Set alphanumeric identifier of your model, which must be unique among all existing models
 	m_uniqueKey = "UNIQUE_IDENTIFIER";
+	m_requieredVariables.bContactMoments = true;
 
 	/// TODO: Setup parameters of your model here if any
 	AddParameter("PARAM_NAME_WITHOUT_SPACES", "User friendly parameter description", 13);
@@ -49,7 +50,7 @@ void CModelPP::ConsolidateSrc(double _time, double _timeStep, size_t _iPart, SPa
 	// TODO: Write your consolidation step here.
 	// This example is for calculation of forces and moments.
 	_particles.Force(_iPart) += _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment1;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment1(_collision);
 }
 
 void CModelPP::ConsolidateDst(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const
@@ -57,5 +58,5 @@ void CModelPP::ConsolidateDst(double _time, double _timeStep, size_t _iPart, SPa
 	// TODO: Write your consolidation step here.
 	// This example is for calculation of forces and moments.
 	_particles.Force(_iPart) -= _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment2;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment2(_collision);
 }
@@ -21,6 +21,7 @@ CModelPW::CModelPW()
 	m_name = "Model name";
 	/// TODO: Set alphanumeric identifier of your model, which must be unique among all existing models
 	m_uniqueKey = "UNIQUE_IDENTIFIER";
+	m_requieredVariables.bContactMoments = true;
 
 	/// TODO: Setup parameters of your model here if any
 	AddParameter("PARAM_NAME_WITHOUT_SPACES", "User friendly parameter description", 13);
@@ -49,7 +50,7 @@ void CModelPW::ConsolidatePart(double _time, double _timeStep, size_t _iPart, SP
 	// TODO: Write your consolidation step here.
 	// This example is for calculation of forces and moments.
 	_particles.Force(_iPart) += _collision->vTotalForce;
-	_particles.Moment(_iPart) += _collision->vResultMoment1;
+	_particles.Moment(_iPart) += CollisionFields().ResultMoment1(_collision);
 }
 
 void CModelPW::ConsolidateWall(double _time, double _timeStep, size_t _iWall, SWallStruct& _walls, const SCollision* _collision) const
@@ -0,0 +1,153 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+#include "VerletDistanceTuner.h"
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+	const double c_golden = (std::sqrt(5.0) - 1) / 2; // inverse golden ratio
+}
+
+void CVerletDistanceTuner::Reset(double _coeff)
+{
+	m_status = SStatus{};
+	m_deviations = 0;
+	m_started = false;
+	StartSearch(std::log(_coeff / SEARCH_RANGE), std::log(_coeff * SEARCH_RANGE));
+}
+
+void CVerletDistanceTuner::AddPhaseTime(EPhase _phase, double _time)
+{
+	m_phases[static_cast<size_t>(_phase)] += _time;
+}
+
+void CVerletDistanceTuner::AddDisregardedTime(double _time)
+{
+	m_disregardedTime += _time;
+}
+
+double CVerletDistanceTuner::Update(double _currentTime)
+{
+	const auto now = clock_type::now();
+	if (m_started && ++m_rebuilds < WINDOW_REBUILDS) return m_status.coeff;
+	const double simTime = _currentTime - m_windowStartTime;
+	if (m_started && simTime <= 0) return m_status.coeff;
+
+	if (m_started)
+	{
+		// phases are not reported by the simulator, consider the whole time
+		if (m_phases[static_cast<size_t>(EPhase::CONTACTS)] == 0 && m_phases[static_cast<size_t>(EPhase::FORCES)] == 0)
+			m_phases[static_cast<size_t>(EPhase::REBUILD)] = std::chrono::duration<double>(now - m_windowStartWallTime).count() - m_disregardedTime;
+		for (size_t i = 0; i < PHASES_NUMBER; ++i)
+			m_status.phases[i] = m_phases[i] / simTime;
+		m_status.cost = std::accumulate(m_status.phases.begin(), m_status.phases.end(), 0.0);
+		m_status.evaluations++;
+		Evaluate(m_status.cost);
+	}
+
+	// start new window
+	m_started = true;
+	m_rebuilds = 0;
+	m_windowStartTime = _currentTime;
+	m_windowStartWallTime = now;
+	m_disregardedTime = 0;
+	m_phases.fill(0);
+	return m_status.coeff;
+}
+
+void CVerletDistanceTuner::StartSearch(double _a, double _b)
+{
+	m_status.state = EState::SEARCH;
+	m_a = _a;
+	m_b = _b;
+	m_x1 = m_b - c_golden * (m_b - m_a);
+	m_x2 = m_a + c_golden * (m_b - m_a);
+	m_f1Valid = m_f2Valid = false;
+	m_evaluated = EPoint::LEFT;
+	m_status.coeff = std::exp(m_x1);
+	m_status.lowerCoeff = std::exp(m_a);
+	m_status.upperCoeff = std::exp(m_b);
+}
+
+void CVerletDistanceTuner::Evaluate(double _cost)
+{
+	if (m_status.state == EState::HOLD)
+	{
+		if (std::fabs(_cost - m_status.optimalCost) > HYSTERESIS * m_status.optimalCost)
+			m_deviations++;
+		else
+			m_deviations = 0;
+		if (m_deviations >= HYSTERESIS_WINDOWS) // conditions have changed, search again
+		{
+			m_deviations = 0;
+			const double x = std::log(m_status.coeff);
+			StartSearch(x - std::log(RESTART_RANGE), x + std::log(RESTART_RANGE));
+		}
+		return;
+	}
+
+	if (m_evaluated == EPoint::LEFT)
+	{
+		m_f1 = _cost;
+		m_f1Valid = true;
+	}
+	else
+	{
+		m_f2 = _cost;
+		m_f2Valid = true;
+	}
+
+	if (!m_f2Valid) // evaluate the second inner point in the beginning
+	{
+		m_evaluated = EPoint::RIGHT;
+		m_status.coeff = std::exp(m_x2);
+		return;
+	}
+
+	SearchStep();
+}
+
+void CVerletDistanceTuner::SearchStep()
+{
+	// shrink the interval, keeping the better point inside
+	double xBest, fBest;
+	if (m_f1 < m_f2)
+	{
+		m_b = m_x2;
+		m_x2 = m_x1;
+		m_f2 = m_f1;
+		m_x1 = m_b - c_golden * (m_b - m_a);
+		m_f1Valid = false;
+		m_evaluated = EPoint::LEFT;
+		xBest = m_x2;
+		fBest = m_f2;
+	}
+	else
+	{
+		m_a = m_x1;
+		m_x1 = m_x2;
+		m_f1 = m_f2;
+		m_x2 = m_a + c_golden * (m_b - m_a);
+		m_f2Valid = false;
+		m_evaluated = EPoint::RIGHT;
+		xBest = m_x1;
+		fBest = m_f1;
+	}
+	m_status.lowerCoeff = std::exp(m_a);
+	m_status.upperCoeff = std::exp(m_b);
+
+	// the interval is small enough - keep the best found coefficient
+	if (m_b - m_a < TOLERANCE)
+	{
+		m_status.state = EState::HOLD;
+		m_status.coeff = std::exp(xBest);
+		m_status.optimalCost = fBest;
+		m_deviations = 0;
+		return;
+	}
+
+	m_status.coeff = std::exp(m_evaluated == EPoint::LEFT ? m_x1 : m_x2);
+}
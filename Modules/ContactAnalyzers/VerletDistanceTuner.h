@@ -0,0 +1,84 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+
+/* Online tuning of the verlet distance coefficient.
+ * Wall-clock time of the phases, which depend on the verlet distance (rebuild of lists, contact detection, force calculation), is accumulated
+ * over a window of several rebuilds and divided by the simulated time of this window. This gives the cost of the current coefficient.
+ * The optimal coefficient is found with golden-section search on a logarithmic scale. After convergence, the coefficient is kept until
+ * the cost deviates from the reference value for several windows in a row; then the search restarts around the current coefficient. */
+class CVerletDistanceTuner
+{
+public:
+	enum class EPhase : size_t { REBUILD = 0, CONTACTS = 1, FORCES = 2 };
+	enum class EState { SEARCH, HOLD };
+
+	static constexpr size_t PHASES_NUMBER = 3;
+
+	struct SStatus
+	{
+		EState state{ EState::SEARCH };
+		double coeff{ 0 };							// Current coefficient.
+		double lowerCoeff{ 0 };						// Current search interval.
+		double upperCoeff{ 0 };
+		double cost{ 0 };							// Cost of the last window: seconds of wall time per second of simulated time; 0 if nothing measured yet.
+		double optimalCost{ 0 };					// Reference cost of the chosen coefficient.
+		std::array<double, PHASES_NUMBER> phases{};	// Contribution of each phase to the cost of the last window.
+		size_t evaluations{ 0 };					// Number of evaluated windows in total.
+	};
+
+private:
+	using clock_type = std::chrono::steady_clock;
+
+	static constexpr size_t WINDOW_REBUILDS = 10;	// Number of rebuilds of verlet lists in one measurement window.
+	static constexpr double SEARCH_RANGE = 4.0;		// Initial search interval is [c / range, c * range].
+	static constexpr double RESTART_RANGE = 2.0;	// Search interval after restart.
+	static constexpr double TOLERANCE = 0.05;		// Relative width of the search interval to stop the search.
+	static constexpr double HYSTERESIS = 0.25;		// Relative deviation of the cost from the reference to consider it changed.
+	static constexpr size_t HYSTERESIS_WINDOWS = 2;	// Number of consecutive windows with changed cost to restart the search.
+
+	enum class EPoint { LEFT, RIGHT };
+
+	// golden-section search in terms of logarithm of the coefficient
+	double m_a{ 0 }, m_b{ 0 };		// search interval
+	double m_x1{ 0 }, m_x2{ 0 };	// inner points
+	double m_f1{ 0 }, m_f2{ 0 };	// costs in inner points
+	bool m_f1Valid{ false }, m_f2Valid{ false };
+	EPoint m_evaluated{ EPoint::LEFT };	// inner point, which is currently being evaluated
+
+	SStatus m_status;
+	size_t m_deviations{ 0 };		// number of consecutive windows with the changed cost
+
+	// current measurement window
+	bool m_started{ false };
+	size_t m_rebuilds{ 0 };
+	double m_windowStartTime{ 0 };
+	clock_type::time_point m_windowStartWallTime;
+	double m_disregardedTime{ 0 };
+	std::array<double, PHASES_NUMBER> m_phases{};
+
+public:
+	// Starts a new search around the given coefficient.
+	void Reset(double _coeff);
+	// Adds wall time [s] spent in the phase.
+	void AddPhaseTime(EPhase _phase, double _time);
+	// Adds wall time [s], which must not be considered, e.g. time for saving.
+	void AddDisregardedTime(double _time);
+	// Must be called at each rebuild of verlet lists. Returns the coefficient to be used further.
+	double Update(double _currentTime);
+
+	const SStatus& GetStatus() const { return m_status; }
+
+private:
+	// Starts the search on the given interval of logarithms.
+	void StartSearch(double _a, double _b);
+	// Processes the cost of the last window and selects the next coefficient.
+	void Evaluate(double _cost);
+	// Makes one step of golden-section search, when both inner points are evaluated.
+	void SearchStep();
+};
@@ -4,6 +4,25 @@
 
 #include "VerletList.h"
 #include <cfloat>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+
+const std::array<CVerletList::SNeighbor, 13> CVerletList::c_neighbors{ {
+	{  0,  0,  1 },
+	{  0,  1,  0 },
+	{  1,  0,  0 },
+	{  0,  1,  1 },
+	{  1,  1,  0 },
+	{  1,  0,  1 },
+	{  1,  1,  1 },
+	{ -1,  0,  1 },
+	{ -1, -1,  1 },
+	{  0, -1,  1 },
+	{  1, -1,  1 },
+	{  1, -1,  0 },
+	{  1, -1, -1 },
+} };
 
 CVerletList::CVerletList(CSimplifiedScene& _Scene): m_Scene(_Scene),
 	m_nThreadsNumber(GetThreadsNumber()),
@@ -16,24 +35,25 @@ CVerletList::CVerletList(CSimplifiedScene& _Scene): m_Scene(_Scene),
 	m_dMaxParticleRadius = 0;
 	m_dMinParticleRadius = 0;
 	m_dVerletDistance = 0;
+	m_dVerletDistancePW = 0;
+	m_dVerletWallRatio = DEFAULT_VERLET_WALL_RATIO;
 
-	m_dMaxTheorWallDistance = DEFAULT_TEOR_DISTANCE;
-	m_LastCPUTime = 0;
-	m_DisregardingTimeInterval = 0;
-	m_dLastRealTime = 0;
-	m_nAutoVerletDistNumerator = 0;
+	m_dMaxTheorPBCDistance = DEFAULT_TEOR_DISTANCE;
 	m_bConnectedPPContact = false;
 	m_nCellsMax = DEFAULT_MAX_CELLS;
 	m_dVerletDistanceCoeff = DEFAULT_VERLET_DISTANCE_COEFF;
 	m_bAutoAdjustVerletDistance = true;
+	m_gridType = EVerletGridType::DENSE;
+	m_bIncrementalUpdate = false;
+	m_bIncrementalValid = false;
+	m_nIncrementalUpdates = 0;
+	m_nActiveSolidBonds = 0;
+	m_bListsValid = false;
+	m_bUpdateWallsOnly = false;
 }
 
 void CVerletList::InitializeList()
 {
-	m_PerformHistory.clear();
-	m_LastCPUTime = 0;
-	m_DisregardingTimeInterval = 0;
-	m_nAutoVerletDistNumerator = 0;
 	m_dVerletDistance = 0;
 	m_nThreadsNumber = GetThreadsNumber();
 }
@@ -66,17 +86,38 @@ void CVerletList::SetSceneInfo(const SVolumeType& _simDomain, double _dMinPartRa
 	{
 		m_dVerletDistanceCoeff = _dVerletCoeff;
 		m_dVerletDistance = m_dVerletDistanceCoeff * m_dMinParticleRadius;
+		m_tuner.Reset(m_dVerletDistanceCoeff);
 		bRecalculate = true;
 	}
 	if (m_bAutoAdjustVerletDistance != _bAutoAdjust)
 	{
 		m_bAutoAdjustVerletDistance = _bAutoAdjust;
+		m_tuner.Reset(m_dVerletDistanceCoeff);
 		bRecalculate = true;
 	}
 	if (bRecalculate)
 		RecalculateGrid();
 }
 
+void CVerletList::SetGridType(EVerletGridType _type)
+{
+	if (m_gridType == _type) return;
+	m_gridType = _type;
+	RecalculateGrid();
+}
+
+void CVerletList::SetIncrementalUpdate(bool _bIncremental)
+{
+	m_bIncrementalUpdate = _bIncremental;
+	m_bIncrementalValid = false;
+}
+
+void CVerletList::SetWallDistanceRatio(double _dRatio)
+{
+	if (m_dVerletWallRatio == _dRatio) return;
+	m_dVerletWallRatio = _dRatio;
+	RecalculateGrid();
+}
 
 void CVerletList::EmptyGrid()
 {
@@ -144,6 +185,7 @@ void CVerletList::RecalculateGrid()
 {
 	EmptyGrid();
 	ResetCurrentData();
+	m_dVerletDistancePW = m_dVerletWallRatio * m_dVerletDistance;
 
 	double dCurrCellSize = 2 * m_dMaxParticleRadius +  m_dVerletDistance;
 	if (dCurrCellSize == 0)	return;
@@ -152,7 +194,7 @@ void CVerletList::RecalculateGrid()
 	if (m_Scene.m_PBC.bEnabled)
 	{
 		m_workDomain = m_SimDomain;
-		const double delta = m_dVerletDistance + 2 * m_dMaxParticleRadius;
+		const double delta = std::max(m_dVerletDistance, m_dVerletDistancePW) + 2 * m_dMaxParticleRadius;
 		const CVector3 pbcSides{ (double)m_Scene.m_PBC.bX, (double)m_Scene.m_PBC.bY, (double)m_Scene.m_PBC.bZ };
 		for (size_t i = 0; i < 3; ++i)
 			if (pbcSides[i] != 0.0)
@@ -162,7 +204,9 @@ void CVerletList::RecalculateGrid()
 			}
 	}
 
+	const bool bSparse = m_gridType == EVerletGridType::SPARSE;
 	const double dAverLength = (m_workDomain.coordEnd.x - m_workDomain.coordBeg.x + m_workDomain.coordEnd.y - m_workDomain.coordBeg.y + m_workDomain.coordEnd.z - m_workDomain.coordBeg.z) / 3;
+	const double dMaxLength = std::max({ m_workDomain.coordEnd.x - m_workDomain.coordBeg.x, m_workDomain.coordEnd.y - m_workDomain.coordBeg.y, m_workDomain.coordEnd.z - m_workDomain.coordBeg.z });
 	do
 	{
 		m_vGrid.emplace_back();
@@ -171,11 +215,16 @@ void CVerletList::RecalculateGrid()
 		gl.dMaxPartRadius = (gl.dCellSize -  m_dVerletDistance) / 2;
 		dCurrCellSize /= 2; // proceed to the next grid
 		gl.dMinPartRadius = (dCurrCellSize -  m_dVerletDistance) / 2;
-		if (dAverLength / gl.dCellSize > m_nCellsMax)
+		if (!bSparse && dAverLength / gl.dCellSize > m_nCellsMax)
 		{
 			gl.dCellSize = dAverLength / m_nCellsMax;
 			dCurrCellSize = 0; // to stop loop afterwards
 		}
+		else if (bSparse && dMaxLength / gl.dCellSize > MAX_SPARSE_CELLS)
+		{
+			gl.dCellSize = dMaxLength / MAX_SPARSE_CELLS;
+			dCurrCellSize = 0; // to stop loop afterwards
+		}
 
 		gl.nCellsX = static_cast<unsigned>(floor((m_workDomain.coordEnd.x - m_workDomain.coordBeg.x) / gl.dCellSize)) + 1;
 		gl.nCellsY = static_cast<unsigned>(floor((m_workDomain.coordEnd.y - m_workDomain.coordBeg.y) / gl.dCellSize)) + 1;
@@ -185,6 +234,8 @@ void CVerletList::RecalculateGrid()
 		if (gl.nCellsY < 1) gl.nCellsY = 1;
 		if (gl.nCellsZ < 1) gl.nCellsZ = 1;
 
+		if (bSparse) continue; // cells are created on demand
+
 		gl.grid.resize(gl.nCellsX);
 		for (unsigned x = 0; x < gl.nCellsX; ++x)
 		{
@@ -197,19 +248,46 @@ void CVerletList::RecalculateGrid()
 	m_vGrid.back().dMinPartRadius = 0;
 }
 
-bool CVerletList::IsNeedToBeUpdated(double _dTimeStep, double _dMaxPartDist, double _dMaxWallVel)
+bool CVerletList::IsNeedToBeUpdated(double _dTimeStep, double _dMaxPartDist, const std::vector<double>& _vMaxGeometryVel)
 {
-	m_dMaxTheorWallDistance += _dMaxWallVel * _dTimeStep;
 	if (m_Scene.m_PBC.bEnabled)
-		m_dMaxTheorWallDistance += 2 * std::max({ fabs(m_Scene.m_PBC.vVel.x), fabs(m_Scene.m_PBC.vVel.y), fabs(m_Scene.m_PBC.vVel.z) });
-	return _dMaxPartDist+ std::max(m_dMaxTheorWallDistance, _dMaxPartDist) >= m_dVerletDistance;
+		m_dMaxTheorPBCDistance += 2 * std::max({ fabs(m_Scene.m_PBC.vVel.x), fabs(m_Scene.m_PBC.vVel.y), fabs(m_Scene.m_PBC.vVel.z) });
+	// particle-wall contacts of each geometry
+	m_vMaxTheorGeometryDistance.resize(_vMaxGeometryVel.size(), 0);
+	m_vGeometryUpdateFlags.resize(_vMaxGeometryVel.size(), 0);
+	bool bUpdatePW = false;
+	for (size_t i = 0; i < _vMaxGeometryVel.size(); ++i)
+	{
+		m_vMaxTheorGeometryDistance[i] += _vMaxGeometryVel[i] * _dTimeStep;
+		m_vGeometryUpdateFlags[i] = _dMaxPartDist + m_vMaxTheorGeometryDistance[i] >= m_dVerletDistancePW;
+		bUpdatePW |= m_vGeometryUpdateFlags[i] != 0;
+	}
+	// particle-particle contacts
+	const bool bUpdatePP = _dMaxPartDist + std::max(m_dMaxTheorPBCDistance, _dMaxPartDist) >= m_dVerletDistance;
+	m_bUpdateWallsOnly = !bUpdatePP && bUpdatePW;
+	return bUpdatePP || bUpdatePW;
 }
 
-void CVerletList::UpdateList(double _dCurrTime)
+bool CVerletList::UpdateList(double _dCurrTime)
 {
 	if(m_bAutoAdjustVerletDistance)
 		AutoAdjustVerletDistance(_dCurrTime);
-	m_Scene.AddVirtualParticles(m_dVerletDistance);
+	const bool bUpdateWallsOnly = m_bUpdateWallsOnly;
+	m_bUpdateWallsOnly = false;
+	if (bUpdateWallsOnly && UpdateListWalls())
+		return false;
+	if (m_bIncrementalValid && UpdateListIncremental())
+	{
+		UpdateListWalls();
+		return false;
+	}
+	RebuildList();
+	return true;
+}
+
+void CVerletList::RebuildList()
+{
+	m_Scene.AddVirtualParticles(std::max(m_dVerletDistance, m_dVerletDistancePW));
 	ClearOldPositions();
 	RecalcPositions();
 	m_PPList.resize(m_vParticles.Size());
@@ -239,67 +317,150 @@ void CVerletList::UpdateList(double _dCurrTime)
 
 	for (auto& gridLevel : m_vGrid)
 	{
-		ParallelFor(gridLevel.nCellsX * gridLevel.nCellsY * gridLevel.nCellsZ, [&](size_t i)
-		{
-			const unsigned x = static_cast<unsigned>(floor(double(i) / gridLevel.nCellsZ / gridLevel.nCellsY));
-			const unsigned y = static_cast<unsigned>(floor(double(i - x * gridLevel.nCellsZ * gridLevel.nCellsY) / gridLevel.nCellsZ));
-			const unsigned z = static_cast<unsigned>(i) - x* gridLevel.nCellsZ* gridLevel.nCellsY - y* gridLevel.nCellsZ;
-			CheckCollisionPP(gridLevel, x, y, z, x, y, z, true);
-			CheckCollisionPW(gridLevel, gridLevel.grid[x][y][z]);
-			if (gridLevel.grid[x][y][z].vMainPartIDs.size() > 10 &&  gridLevel.grid[x][y][z].vSecondaryPartIDs.empty())
+		PresortCells(gridLevel);
+		if (m_gridType == EVerletGridType::DENSE)
+			ParallelFor(gridLevel.nCellsX * gridLevel.nCellsY * gridLevel.nCellsZ, [&](size_t i)
 			{
-				CheckCollisionPPSorted(gridLevel, x, y, z, x, y, z + 1, ESortCoord::Z);
-				CheckCollisionPPSorted(gridLevel, x, y, z, x, y + 1, z, ESortCoord::Y);
-				CheckCollisionPPSorted(gridLevel, x, y, z, x + 1, y, z, ESortCoord::X);
-				CheckCollisionPPSorted(gridLevel, x, y, z, x + 1, y + 1, z, ESortCoord::XY);
-				CheckCollisionPPSorted(gridLevel, x, y, z, x + 1, y + 1, z + 1, ESortCoord::XY);
-				CheckCollisionPPSorted(gridLevel, x, y, z, x, y + 1, z + 1, ESortCoord::YZ);
-				CheckCollisionPPSorted(gridLevel, x, y, z, x + 1, y, z + 1, ESortCoord::XZ);
-
-				if (x > 0)
-					CheckCollisionPPSorted(gridLevel, x, y, z, x - 1, y, z + 1, ESortCoord::Z);
-				if (y > 0)
-				{
-					if (x > 0)
-						CheckCollisionPPSorted(gridLevel, x, y, z, x - 1, y - 1, z + 1, ESortCoord::Z);
-					CheckCollisionPPSorted(gridLevel, x, y, z, x, y - 1, z + 1, ESortCoord::Z);
-					CheckCollisionPPSorted(gridLevel, x, y, z, x + 1, y - 1, z + 1, ESortCoord::XZ);
-					CheckCollisionPPSorted(gridLevel, x, y, z, x + 1, y - 1, z, ESortCoord::X);
-					if (z > 0)
-						CheckCollisionPPSorted(gridLevel, x, y, z, x + 1, y - 1, z - 1, ESortCoord::X);
-				}
-			}
-			else
+				const unsigned x = static_cast<unsigned>(floor(double(i) / gridLevel.nCellsZ / gridLevel.nCellsY));
+				const unsigned y = static_cast<unsigned>(floor(double(i - x * gridLevel.nCellsZ * gridLevel.nCellsY) / gridLevel.nCellsZ));
+				const unsigned z = static_cast<unsigned>(i) - x* gridLevel.nCellsZ* gridLevel.nCellsY - y* gridLevel.nCellsZ;
+				CheckCell(gridLevel, x, y, z, gridLevel.grid[x][y][z]);
+			});
+		else // only occupied cells
+			ParallelFor(gridLevel.vKeys.size(), [&](size_t i)
 			{
-				CheckCollisionPP(gridLevel, x, y, z, x, y, z + 1);
-				CheckCollisionPP(gridLevel, x, y, z, x, y + 1, z);
-				CheckCollisionPP(gridLevel, x, y, z, x + 1, y, z);
-				CheckCollisionPP(gridLevel, x, y, z, x, y + 1, z + 1);
-				CheckCollisionPP(gridLevel, x, y, z, x + 1, y + 1, z);
-				CheckCollisionPP(gridLevel, x, y, z, x + 1, y, z + 1);
-				CheckCollisionPP(gridLevel, x, y, z, x + 1, y + 1, z + 1);
-
-				if (x > 0)
-					CheckCollisionPP(gridLevel, x, y, z, x - 1, y, z + 1);
-				if (y > 0)
-				{
-					if (x > 0)
-						CheckCollisionPP(gridLevel, x, y, z, x - 1, y - 1, z + 1);
-					CheckCollisionPP(gridLevel, x, y, z, x, y - 1, z + 1);
-					CheckCollisionPP(gridLevel, x, y, z, x + 1, y - 1, z + 1);
-					CheckCollisionPP(gridLevel, x, y, z, x + 1, y - 1, z);
-					if (z > 0)
-						CheckCollisionPP(gridLevel, x, y, z, x + 1, y - 1, z - 1);
-				}
-			}
-
-		});
+				const uint64_t key = gridLevel.vKeys[i];
+				const unsigned x = static_cast<unsigned>(key / gridLevel.nCellsZ / gridLevel.nCellsY);
+				const unsigned y = static_cast<unsigned>(key / gridLevel.nCellsZ % gridLevel.nCellsY);
+				const unsigned z = static_cast<unsigned>(key % gridLevel.nCellsZ);
+				CheckCell(gridLevel, x, y, z, gridLevel.vCells[i]);
+			});
 	}
 	ReassignVirtualContacts(); // shift virtual-real contacts as real-real
 	RemoveSBContacts();
 	m_Scene.RemoveVirtualParticles();
 	SortList();
-	m_dMaxTheorWallDistance = 0;
+	m_dMaxTheorPBCDistance = 0;
+	std::fill(m_vMaxTheorGeometryDistance.begin(), m_vMaxTheorGeometryDistance.end(), 0);
+	std::fill(m_vGeometryUpdateFlags.begin(), m_vGeometryUpdateFlags.end(), 0);
+	m_bListsValid = true;
+
+	// with PBC, virtual particles are regenerated at each update, so only the full rebuild is possible
+	m_bIncrementalValid = m_bIncrementalUpdate && !m_Scene.m_PBC.bEnabled;
+	m_nIncrementalUpdates = 0;
+	if (m_bIncrementalValid && !m_bConnectedPPContact)
+		m_nActiveSolidBonds = CountActiveSolidBonds();
+}
+
+bool CVerletList::UpdateListIncremental()
+{
+	const size_t nParticles = m_vParticles.Size();
+	if (m_nIncrementalUpdates >= INCREMENTAL_MAX_UPDATES) return false;
+	if (nParticles != m_vGridLevel.size() || nParticles != m_PPList.size()) return false;
+	// contacts of particles with broken bonds must be added to the lists
+	if (!m_bConnectedPPContact && CountActiveSolidBonds() != m_nActiveSolidBonds) return false;
+
+	// select particles, which have moved far from their positions in the grid; all of them must keep their activity
+	const double dMaxShift = INCREMENTAL_MOVE_FRACTION * m_dVerletDistance;
+	m_vMovedFlags.resize(nParticles);
+	const size_t nChangedActivity = ParallelSum(nParticles, size_t{ 0 }, [&](size_t i)
+	{
+		m_vMovedFlags[i] = m_vParticles.Active(i) && SquaredLength(m_vParticles.Coord(i) - m_vParticles.CoordVerlet(i)) >= dMaxShift * dMaxShift;
+		return static_cast<size_t>(m_vParticles.Active(i) != (m_vGridLevel[i] != NOT_IN_GRID));
+	});
+	if (nChangedActivity != 0) return false;
+	m_vMovedIDs.clear();
+	for (size_t i = 0; i < nParticles; ++i)
+		if (m_vMovedFlags[i])
+			m_vMovedIDs.push_back(static_cast<unsigned>(i));
+	if (static_cast<double>(m_vMovedIDs.size()) > INCREMENTAL_MAX_MOVED * static_cast<double>(nParticles)) return false;
+
+	// move particles between cells, keeping cells sorted by indices of particles
+	for (const unsigned i : m_vMovedIDs)
+		for (unsigned iGrid = 0; iGrid <= m_vGridLevel[i]; ++iGrid)
+		{
+			SGridLevel& gridLevel = m_vGrid[iGrid];
+			unsigned nOldX, nOldY, nOldZ, nNewX, nNewY, nNewZ;
+			GetCellIndices(gridLevel, m_vParticles.CoordVerlet(i), nOldX, nOldY, nOldZ);
+			GetCellIndices(gridLevel, m_vParticles.Coord(i), nNewX, nNewY, nNewZ);
+			if (nOldX == nNewX && nOldY == nNewY && nOldZ == nNewZ) continue;
+			SGridCell* pOldCell = GetCell(gridLevel, nOldX, nOldY, nOldZ);
+			SGridCell* pNewCell = GetCell(gridLevel, nNewX, nNewY, nNewZ);
+			if (!pNewCell) return false; // the cell is not occupied in the sparse grid
+			auto& vOldIDs = iGrid == m_vGridLevel[i] ? pOldCell->vMainPartIDs : pOldCell->vSecondaryPartIDs;
+			auto& vNewIDs = iGrid == m_vGridLevel[i] ? pNewCell->vMainPartIDs : pNewCell->vSecondaryPartIDs;
+			vOldIDs.erase(std::find(vOldIDs.begin(), vOldIDs.end(), i));
+			vNewIDs.insert(std::upper_bound(vNewIDs.begin(), vNewIDs.end(), i), i);
+		}
+	for (const unsigned i : m_vMovedIDs)
+		m_vParticles.CoordVerlet(i) = m_vParticles.Coord(i);
+
+	// remove all possible contacts of moved particles
+	ParallelFor(nParticles, [&](size_t i)
+	{
+		if (m_vMovedFlags[i])
+			m_PPList[i].clear();
+		else
+			m_PPList[i].erase(std::remove_if(m_PPList[i].begin(), m_PPList[i].end(), [&](unsigned _id) { return m_vMovedFlags[_id] != 0; }), m_PPList[i].end());
+	});
+
+	// find possible contacts of moved particles; all particles are considered at their verlet coordinates, as they are placed in the grid
+	m_vNewContacts.resize(m_vMovedIDs.size());
+	ParallelFor(m_vMovedIDs.size(), [&](size_t k)
+	{
+		const unsigned i = m_vMovedIDs[k];
+		std::vector<unsigned>& vContacts = m_vNewContacts[k];
+		vContacts.clear();
+		const CVector3 vPos1 = m_vParticles.CoordVerlet(i);
+		const double dTemp1 = m_dVerletDistance + m_vParticles.ContactRadius(i);
+		const auto CheckParticles = [&](const std::vector<unsigned>& _vIDs)
+		{
+			for (const unsigned j : _vIDs)
+				if (j != i && !(m_vMovedFlags[j] && j < i)) // contacts between two moved particles are found by the smaller one
+					if (SquaredLength(vPos1 - m_vParticles.CoordVerlet(j)) <= std::pow(dTemp1 + m_vParticles.ContactRadius(j), 2))
+						vContacts.push_back(j);
+		};
+		// larger particles are main on coarser grid levels; smaller ones are secondary on the level of this particle
+		for (unsigned iGrid = 0; iGrid <= m_vGridLevel[i]; ++iGrid)
+		{
+			unsigned nX, nY, nZ;
+			GetCellIndices(m_vGrid[iGrid], vPos1, nX, nY, nZ);
+			for (int dx = -1; dx <= 1; ++dx)
+				for (int dy = -1; dy <= 1; ++dy)
+					for (int dz = -1; dz <= 1; ++dz)
+					{
+						const SGridCell* pCell = GetCell(m_vGrid[iGrid], static_cast<int>(nX) + dx, static_cast<int>(nY) + dy, static_cast<int>(nZ) + dz);
+						if (!pCell) continue;
+						CheckParticles(pCell->vMainPartIDs);
+						if (iGrid == m_vGridLevel[i])
+							CheckParticles(pCell->vSecondaryPartIDs);
+					}
+		}
+	});
+	// contacts are stored by the particle with the smaller index
+	for (size_t k = 0; k < m_vMovedIDs.size(); ++k)
+		for (const unsigned j : m_vNewContacts[k])
+			m_PPList[std::min(m_vMovedIDs[k], j)].push_back(std::max(m_vMovedIDs[k], j));
+	RemoveSBContacts();
+
+	// contacts with walls are recalculated only for moved particles; walls remain in the grid at their verlet coordinates
+	ParallelFor(m_vMovedIDs.size(), [&](size_t k)
+	{
+		const unsigned i = m_vMovedIDs[k];
+		m_PWList[i].clear();
+		const SGridLevel& gridLevel = m_vGrid[m_vGridLevel[i]];
+		if (m_vParticles.ContactRadius(i) <= gridLevel.dMinPartRadius) return; // the same condition as in CheckCollisionPW()
+		unsigned nX, nY, nZ;
+		GetCellIndices(gridLevel, m_vParticles.CoordVerlet(i), nX, nY, nZ);
+		const SGridCell* pCell = GetCell(gridLevel, nX, nY, nZ);
+		for (const unsigned w : pCell->vWallIDs)
+			if (IsSphereIntersectTriangle(m_vWalls.Coordinates(w), m_vWalls.NormalVector(w), m_vParticles.CoordVerlet(i), m_vParticles.ContactRadius(i) + m_dVerletDistancePW).first != EIntersectionType::NO_CONTACT)
+				m_PWList[i].push_back(w);
+	});
+
+	m_dMaxTheorPBCDistance = 0;
+	++m_nIncrementalUpdates;
+	return true;
 }
 
 void CVerletList::RemoveSBContacts()
@@ -333,245 +494,332 @@ void CVerletList::RemoveSBContacts()
 
 }
 
-void CVerletList::AddDisregardingTimeInterval(const clock_t& _interval)
+size_t CVerletList::CountActiveSolidBonds() const
 {
-	m_DisregardingTimeInterval += _interval;
+	const auto& bonds = m_Scene.GetRefToSolidBonds();
+	return ParallelSum(bonds.Size(), size_t{ 0 }, [&](size_t i) { return static_cast<size_t>(bonds.Active(i)); });
 }
 
-void CVerletList::AutoAdjustVerletDistance(double _dCurrentTime)
+void CVerletList::AddDisregardingTimeInterval(double _interval)
 {
-	if (m_vParticles.Empty()) return; // no recalculation if there is no particles
-	if (m_LastCPUTime == 0) // first step
-	{
-		m_LastCPUTime = clock();
-		m_dLastRealTime = _dCurrentTime;
-	}
-	else
-	{
-		SCalcPerfmMetric newMetric;
-		newMetric.dCalcTimeCoeff = (_dCurrentTime - m_dLastRealTime) / (clock() - m_LastCPUTime - m_DisregardingTimeInterval); // do not take into account time for saving
-		newMetric.dVerletDistance = m_dVerletDistance;
-		newMetric.dAnalysisTime = _dCurrentTime;
-		m_DisregardingTimeInterval = 0;
-		unsigned nTemp = 0;
-		while (nTemp < m_PerformHistory.size()) // overwrite existing value
-			if (m_PerformHistory[nTemp].dVerletDistance == m_dVerletDistance)
-			{
-				m_PerformHistory[nTemp] = newMetric;
-				break;
-			}
-			else
-				nTemp++;
-		if (nTemp >= m_PerformHistory.size()) // add only this value was not in array
-			m_PerformHistory.push_back(newMetric);
+	m_tuner.AddDisregardedTime(_interval);
+}
 
-		m_LastCPUTime = clock();
-		m_dLastRealTime = _dCurrentTime;
+void CVerletList::AddPhaseTime(CVerletDistanceTuner::EPhase _phase, double _time)
+{
+	m_tuner.AddPhaseTime(_phase, _time);
+}
 
-		if (m_PerformHistory.size() < 3) // minimal amount of values which should be in the array
-		{
-			m_dVerletDistance = m_dVerletDistance * 1.1;
-			RecalculateGrid();
-		}
-		else
-		{
-			if (m_nAutoVerletDistNumerator != 0)
-				m_nAutoVerletDistNumerator--;
-			else
-			{
-				m_nAutoVerletDistNumerator = 10; // parameter 10 seems to bee meaningful
-				std::sort(m_PerformHistory.begin(), m_PerformHistory.end(), [](const SCalcPerfmMetric& a, const SCalcPerfmMetric& b) { return a.dVerletDistance < b.dVerletDistance; });
-				auto iter = std::max_element(m_PerformHistory.begin(), m_PerformHistory.end(), [](const SCalcPerfmMetric& a, const SCalcPerfmMetric& b) { return a.dCalcTimeCoeff < b.dCalcTimeCoeff; });
-				size_t nIndex = iter - m_PerformHistory.begin();
-				if (nIndex == 0)
-				{
-					m_dVerletDistance = m_PerformHistory[0].dVerletDistance*0.8;
-					RecalculateGrid();
-				}
-				else if (nIndex == m_PerformHistory.size() - 1)
-				{
-					m_dVerletDistance = m_PerformHistory[nIndex].dVerletDistance*1.2;
-					RecalculateGrid();
-				}
-				else
-				{
-					if ((m_PerformHistory[nIndex + 1].dVerletDistance - m_PerformHistory[nIndex - 1].dVerletDistance) / m_PerformHistory[nIndex - 1].dVerletDistance > 5e-2)
-					{
-						m_dVerletDistance = (m_PerformHistory[nIndex + 1].dVerletDistance + m_PerformHistory[nIndex].dVerletDistance) / 2;
-						RecalculateGrid();
-					}
-				}
-			}
-			// clear analysis history by removing too old entry
-			if (m_PerformHistory.size() > 10)
-			{
-				std::sort(m_PerformHistory.begin(), m_PerformHistory.end(), [](const SCalcPerfmMetric& a, const SCalcPerfmMetric& b) { return a.dAnalysisTime > b.dAnalysisTime; });
-				m_PerformHistory.pop_back();
-			}
-		}
-	}
+void CVerletList::AutoAdjustVerletDistance(double _dCurrentTime)
+{
+	if (m_vParticles.Empty()) return; // no recalculation if there is no particles
+	const double dCoeff = m_tuner.Update(_dCurrentTime);
+	const double dDistance = dCoeff * m_dMinParticleRadius;
+	if (dDistance == m_dVerletDistance) return;
+	m_dVerletDistance = dDistance;
+	RecalculateGrid();
 }
 
 void CVerletList::ReassignVirtualContacts()
 {
 	if (m_Scene.GetVirtualParticlesNumber() == 0) return;
 	const size_t realPartNum = m_Scene.GetRealParticlesNumber();
-	for (size_t i = 0; i < m_Scene.GetVirtualParticlesNumber(); i++)
+	// each thread adds contacts only to its own real particles, so contacts of each particle are added in the order of virtual particles
+	ParallelFor([&](size_t iThread)
 	{
-		const size_t iVirt = i + realPartNum;
-		// for PP contacts
-		for (size_t j = 0; j < m_PPList[iVirt].size(); j++)
+		for (size_t i = 0; i < m_Scene.GetVirtualParticlesNumber(); i++)
 		{
-			const unsigned nRealID1 = m_PPList[iVirt][j];
+			const size_t iVirt = i + realPartNum;
 			const unsigned nRealID2 = m_vParticles.InitIndex(iVirt);
-			uint8_t nVirtShiftPart2 = m_Scene.m_vPBCVirtShift[i];
-			if (nRealID1 < nRealID2)
+			// for PP contacts
+			for (size_t j = 0; j < m_PPList[iVirt].size(); j++)
 			{
-				m_PPList[nRealID1].push_back(nRealID2);
-				m_PPVirtShift[nRealID1].push_back(nVirtShiftPart2);
+				const unsigned nRealID1 = m_PPList[iVirt][j];
+				uint8_t nVirtShiftPart2 = m_Scene.m_vPBCVirtShift[i];
+				if (nRealID1 < nRealID2)
+				{
+					if (nRealID1 % m_nThreadsNumber != iThread) continue;
+					m_PPList[nRealID1].push_back(nRealID2);
+					m_PPVirtShift[nRealID1].push_back(nVirtShiftPart2);
+				}
+				else
+				{
+					if (nRealID2 % m_nThreadsNumber != iThread) continue;
+					m_PPList[nRealID2].push_back(nRealID1);
+					m_PPVirtShift[nRealID2].push_back(InverseVirtShift(nVirtShiftPart2));
+				}
 			}
-			else
+			// for PW contacts
+			if (nRealID2 % m_nThreadsNumber != iThread) continue;
+			for (size_t j = 0; j < m_PWList[iVirt].size(); j++)
 			{
-				m_PPList[nRealID2].push_back(nRealID1);
-				m_PPVirtShift[nRealID2].push_back(InverseVirtShift(nVirtShiftPart2));
+				m_PWList[nRealID2].push_back(m_PWList[iVirt][j]);
+				m_PWVirtShift[nRealID2].push_back(m_PWVirtShift[iVirt][j]);
 			}
 		}
-		// for PW contacts
-		const size_t iReal = m_vParticles.InitIndex(iVirt);
-		for (size_t j = 0; j < m_PWList[iVirt].size(); j++)
-		{
-			m_PWList[iReal].push_back(m_PWList[iVirt][j]);
-			m_PWVirtShift[iReal].push_back(m_PWVirtShift[iVirt][j]);
-		}
-	}
+	});
 	m_PPList.resize(realPartNum);
 	m_PWList.resize(realPartNum);
 	m_PPVirtShift.resize(realPartNum);
 	m_PWVirtShift.resize(realPartNum);
 }
 
-void CVerletList::InsertParticlesToVector(std::vector<SEntry>& _vec, const std::vector<unsigned>& _partIDs, ESortCoord _dim, ESortDir _dir) const
+uint64_t CVerletList::CellKey(const SGridLevel& _gridLevel, uint64_t _nX, uint64_t _nY, uint64_t _nZ)
 {
-	_vec.reserve(_partIDs.size());
-	for (const unsigned id : _partIDs)
+	return (_nX * _gridLevel.nCellsY + _nY) * _gridLevel.nCellsZ + _nZ;
+}
+
+const CVerletList::SGridCell* CVerletList::GetCell(const SGridLevel& _gridLevel, int _nX, int _nY, int _nZ) const
+{
+	if (_nX < 0 || _nY < 0 || _nZ < 0) return nullptr;
+	if (_nX >= static_cast<int>(_gridLevel.nCellsX) || _nY >= static_cast<int>(_gridLevel.nCellsY) || _nZ >= static_cast<int>(_gridLevel.nCellsZ)) return nullptr;
+	if (m_gridType == EVerletGridType::DENSE)
+		return &_gridLevel.grid[_nX][_nY][_nZ];
+	const uint64_t key = CellKey(_gridLevel, _nX, _nY, _nZ);
+	const auto it = std::lower_bound(_gridLevel.vKeys.begin(), _gridLevel.vKeys.end(), key);
+	if (it == _gridLevel.vKeys.end() || *it != key) return nullptr;
+	return &_gridLevel.vCells[it - _gridLevel.vKeys.begin()];
+}
+
+CVerletList::SGridCell* CVerletList::GetCell(SGridLevel& _gridLevel, int _nX, int _nY, int _nZ)
+{
+	return const_cast<SGridCell*>(static_cast<const CVerletList&>(*this).GetCell(_gridLevel, _nX, _nY, _nZ));
+}
+
+void CVerletList::GetCellIndices(const SGridLevel& _gridLevel, const CVector3& _coord, unsigned& _nX, unsigned& _nY, unsigned& _nZ) const
+{
+	const CVector3 relCoord = (_coord - m_workDomain.coordBeg) / _gridLevel.dCellSize;
+	if (m_gridType == EVerletGridType::DENSE)
 	{
-		const double radius = _dir == ESortDir::Right ? m_vParticles.ContactRadius(id) : -m_vParticles.ContactRadius(id);
-		switch (_dim)
+		// limit from above for the case if the particle lays outside the domain (like newly generated)
+		_nX = std::min(static_cast<unsigned>(floor(relCoord.x)), _gridLevel.nCellsX - 1);
+		_nY = std::min(static_cast<unsigned>(floor(relCoord.y)), _gridLevel.nCellsY - 1);
+		_nZ = std::min(static_cast<unsigned>(floor(relCoord.z)), _gridLevel.nCellsZ - 1);
+	}
+	else
+	{
+		// limit from both sides for the case if the particle lays outside the domain (like newly generated)
+		const auto index = [](double _coord, unsigned _number) { return static_cast<unsigned>(std::min(std::max(floor(_coord), 0.0), static_cast<double>(_number - 1))); };
+		_nX = index(relCoord.x, _gridLevel.nCellsX);
+		_nY = index(relCoord.y, _gridLevel.nCellsY);
+		_nZ = index(relCoord.z, _gridLevel.nCellsZ);
+	}
+}
+
+void CVerletList::CheckCell(const SGridLevel& _gridLevel, unsigned _nX, unsigned _nY, unsigned _nZ, const SGridCell& _gridCell)
+{
+	if (_gridCell.vMainPartIDs.empty() && _gridCell.vSecondaryPartIDs.empty()) return;
+
+	if (_gridLevel.bSorted)
+		CheckCollisionPPSorted(_gridLevel, _gridCell, _gridCell, _gridLevel.nSortAxis, true);
+	else
+		CheckCollisionPP(_gridCell, _gridCell, true);
+	CheckCollisionPW(_gridLevel, _gridCell);
+	for (const SNeighbor& n : c_neighbors)
+	{
+		const SGridCell* pNeighbor = GetCell(_gridLevel, static_cast<int>(_nX) + n.dx, static_cast<int>(_nY) + n.dy, static_cast<int>(_nZ) + n.dz);
+		if (!pNeighbor) continue;
+		if (_gridLevel.bSorted)
 		{
-		case ESortCoord::X : _vec.emplace_back(id, m_vParticles.Coord(id).x + radius); break;
-		case ESortCoord::Y : _vec.emplace_back(id, m_vParticles.Coord(id).y + radius); break;
-		case ESortCoord::Z : _vec.emplace_back(id, m_vParticles.Coord(id).z + radius); break;
-		case ESortCoord::XY: _vec.emplace_back(id, (m_vParticles.Coord(id).x + m_vParticles.Coord(id).y) * 0.5 + radius); break;
-		case ESortCoord::XZ: _vec.emplace_back(id, (m_vParticles.Coord(id).x + m_vParticles.Coord(id).z) * 0.5 + radius); break;
-		case ESortCoord::YZ: _vec.emplace_back(id, (m_vParticles.Coord(id).y + m_vParticles.Coord(id).z) * 0.5 + radius); break;
+			// sweep along the axis, in which the neighbor is shifted, so that only particles close to the common boundary are checked
+			const int shift[3]{ n.dx, n.dy, n.dz };
+			const unsigned axis = shift[_gridLevel.nSortAxis] != 0 ? _gridLevel.nSortAxis : n.dx != 0 ? 0 : n.dy != 0 ? 1 : 2;
+			CheckCollisionPPSorted(_gridLevel, _gridCell, *pNeighbor, axis);
 		}
+		else
+			CheckCollisionPP(_gridCell, *pNeighbor);
 	}
-	std::sort(_vec.begin(), _vec.end());
 }
 
-void CVerletList::CheckCollisionPPSorted(const SGridLevel& _gridLevel, unsigned _nX1, unsigned _nY1, unsigned _nZ1, unsigned _nX2, unsigned _nY2, unsigned _nZ2, ESortCoord _dim)
+template<>
+CVerletList::SSortedCell<double>& CVerletList::SGridCell::Sorted<double>()
+{
+	return sorted;
+}
+
+template<>
+CVerletList::SSortedCell<float>& CVerletList::SGridCell::Sorted<float>()
 {
-	if (_nX2 >= _gridLevel.nCellsX || _nY2 >= _gridLevel.nCellsY || _nZ2 >= _gridLevel.nCellsZ) return;
+	return sortedMixed;
+}
+
+void CVerletList::PresortCells(SGridLevel& _gridLevel)
+{
+	if (m_bMixedPrecision)
+		PresortCellsT<float>(_gridLevel);
+	else
+		PresortCellsT<double>(_gridLevel);
+}
+
+template<typename T>
+void CVerletList::PresortCellsT(SGridLevel& _gridLevel)
+{
+	const size_t nCells = CellsNumber(_gridLevel);
+	const auto Cell = [&](size_t _i) -> SGridCell& { return CellByIndex(_gridLevel, _i); };
+
+	_gridLevel.bSorted = ParallelMax(nCells, size_t{ 0 }, [&](size_t i) { return Cell(i).vMainPartIDs.size(); }) > SORTED_MIN_PARTICLES;
+	if (!_gridLevel.bSorted) return;
+
+	// in single precision, coordinates are shifted to the working domain to keep them small
+	const bool bMixed = !std::is_same<T, double>::value;
+	const CVector3 origin = bMixed ? m_workDomain.coordBeg : CVector3{ 0 };
 
-	std::vector<SEntry> setMainRSorted, setMainLSorted;
-	InsertParticlesToVector(setMainRSorted, _gridLevel.grid[_nX1][_nY1][_nZ1].vMainPartIDs, _dim, ESortDir::Right);
-	InsertParticlesToVector(setMainLSorted, _gridLevel.grid[_nX2][_nY2][_nZ2].vMainPartIDs, _dim, ESortDir::Left);
-	for (auto it1 = setMainRSorted.crbegin(); it1 != setMainRSorted.crend(); ++it1) //main-main
+	// gather main particles of each cell and sum up squared deviations of their coordinates from the mean ones in the cell
+	const CVector3 deviation = ParallelSum(nCells, CVector3{ 0 }, [&](size_t i)
 	{
-		const double temp1 = m_dVerletDistance + m_vParticles.ContactRadius(it1->id);
-		auto iter2 = setMainLSorted.cbegin();
-		for (; iter2 != setMainLSorted.cend(); ++iter2)
-			if (iter2->val - it1->val <= m_dVerletDistance)
+		SGridCell& cell = Cell(i);
+		std::vector<SSortedParticle<T>>& particles = cell.Sorted<T>().particles;
+		particles.clear();
+		CVector3 sum{ 0 }, sum2{ 0 };
+		for (const unsigned id : cell.vMainPartIDs)
+		{
+			const CVector3& coord = m_vParticles.Coord(id);
+			particles.push_back(SSortedParticle<T>{ static_cast<CBasicVector3<T>>(coord - origin), static_cast<T>(m_vParticles.ContactRadius(id)), id });
+			sum += coord;
+			sum2 += EntryWiseProduct(coord, coord);
+		}
+		return particles.empty() ? CVector3{ 0 } : sum2 - EntryWiseProduct(sum, sum) / static_cast<double>(particles.size());
+	});
+	_gridLevel.nSortAxis = deviation.x >= deviation.y && deviation.x >= deviation.z ? 0 : deviation.y >= deviation.z ? 1 : 2;
+
+	// in single precision, all distances are enlarged by a margin, which exceeds rounding errors of coordinates, radii and their sums,
+	// so that all pairs found in double precision are found as well; the extra pairs are farther than the verlet distance only by the margin
+	_gridLevel.dSortMargin = 0;
+	if (bMixed)
+	{
+		const double maxExtent = ParallelMax(nCells, 0.0, [&](size_t i)
+		{
+			double res = 0;
+			for (const unsigned id : Cell(i).vMainPartIDs)
 			{
-				if (SquaredLength(m_vParticles.Coord(it1->id) - m_vParticles.Coord(iter2->id)) <= std::pow(temp1 + m_vParticles.ContactRadius(iter2->id), 2))
-					AddPossibleContactPP(it1->id, iter2->id);
+				const CVector3 rel = m_vParticles.Coord(id) - origin;
+				res = std::max(res, std::max({ std::fabs(rel.x), std::fabs(rel.y), std::fabs(rel.z) }) + m_vParticles.ContactRadius(id));
 			}
-			else
-				break;
-		if (iter2 == setMainLSorted.cbegin()) break;
+			return res;
+		});
+		_gridLevel.dSortMargin = 16 * FLT_EPSILON * (maxExtent + m_dVerletDistance);
 	}
+	const T margin = static_cast<T>(_gridLevel.dSortMargin);
+	const T verletDistance = static_cast<T>(m_dVerletDistance);
 
-	// THIS ALGORITHM IS NOT WELL TESTED FOR MULTIGRID APPROACH
-	/*for (auto iter1 = sSetMain1.rbegin(); iter1 != sSetMain1.rend(); iter1++) //main-secondary
+	ParallelFor(nCells, [&](size_t i)
 	{
-		SParticleStruct& part1 = (*m_vParticles.(iter1->ID);
-		const double dTemp1 = m_dVerletDistance + part1.dContactRadius;
-		auto iter2 = sSetSecond2.begin();
-
-		for (; iter2 != sSetSecond2.end(); iter2++)
+		SGridCell& gridCell = Cell(i);
+		SSortedCell<T>& cell = gridCell.Sorted<T>();
+		for (unsigned axis = 0; axis < 3; ++axis)
 		{
-			SParticleStruct& part2 = (*m_vParticles.(iter2->ID);
-			if (iter2->dVal - iter1->dVal <= m_dVerletDistance)
+			std::vector<SSortedEntry<T>>& entries = cell.entries[axis];
+			entries.clear();
+			for (unsigned k = 0; k < cell.particles.size(); ++k)
 			{
-				if (SquaredLength(part1.vCoord - part2.vCoord) <= std::pow(dTemp1 + part2.dContactRadius, 2))
-					AddPossibleContactPP(iter1->ID, iter2->ID);
+				const SSortedParticle<T>& p = cell.particles[k];
+				entries.push_back(SSortedEntry<T>{ p.coord[axis] - p.radius - margin, p.coord[axis] + p.radius + verletDistance + margin, k });
 			}
-			else
-				break;
+			std::sort(entries.begin(), entries.end());
 		}
-		if (iter2 == sSetSecond2.begin()) break;
-	}
+	});
+}
 
-	for (auto iter1 = sSetMain2.begin(); iter1 != sSetMain2.end(); iter1++) // secondary-main
-	{
-		SParticleStruct& part1 = (*m_vParticles.(iter1->ID);
-		const double dTemp1 = m_dVerletDistance + part1.dContactRadius;
-		auto iter2 = sSetSecond2.begin();
+void CVerletList::CheckCollisionPPSorted(const SGridLevel& _gridLevel, const SGridCell& _cell1, const SGridCell& _cell2, unsigned _axis, bool _bSameCell /*= false*/)
+{
+	if (m_bMixedPrecision)
+		CheckCollisionPPSortedT<float>(_gridLevel, _cell1, _cell2, _axis, _bSameCell);
+	else
+		CheckCollisionPPSortedT<double>(_gridLevel, _cell1, _cell2, _axis, _bSameCell);
+}
 
-		for (; iter2 != sSetSecond2.end(); iter2++)
+template<typename T>
+void CVerletList::CheckCollisionPPSortedT(const SGridLevel& _gridLevel, const SGridCell& _cell1, const SGridCell& _cell2, unsigned _axis, bool _bSameCell)
+{
+	const std::vector<SSortedParticle<T>>& p1 = _cell1.Sorted<T>().particles;
+	const std::vector<SSortedParticle<T>>& p2 = _cell2.Sorted<T>().particles;
+	const std::vector<SSortedEntry<T>>& v1 = _cell1.Sorted<T>().entries[_axis];
+	const std::vector<SSortedEntry<T>>& v2 = _cell2.Sorted<T>().entries[_axis];
+	const T margin = static_cast<T>(_gridLevel.dSortMargin);
+	const T verletDistance = static_cast<T>(m_dVerletDistance);
+	const auto Check = [&](const SSortedEntry<T>& _e1, const SSortedEntry<T>& _e2)
+	{
+		const SSortedParticle<T>& part1 = p1[_e1.index];
+		const SSortedParticle<T>& part2 = p2[_e2.index];
+		const T dist = verletDistance + part1.radius + part2.radius + margin;
+		if (SquaredLength(part1.coord - part2.coord) <= dist * dist)
 		{
-			SParticleStruct& part2 = (*m_vParticles.(iter2->ID);
-			if (iter2->dVal - iter1->dVal <= m_dVerletDistance)
-			{
-				if (SquaredLength(part1.vCoord - part2.vCoord) <= std::pow(dTemp1 + part2.dContactRadius, 2))
-					AddPossibleContactPP(iter1->ID, iter2->ID);
-			}
+			if (_bSameCell && part2.id < part1.id)
+				AddPossibleContactPP(part2.id, part1.id);
 			else
-				break;
+				AddPossibleContactPP(part1.id, part2.id);
 		}
-		if (iter2 == sSetSecond2.begin()) break;
-	}
+	};
 
-	for (unsigned i = 0; i < _gridLevel.grid[_nX2][_nY2][_nZ2].vMainPartIDs.size(); ++i)
+	if (_bSameCell) // main-main in the same cell: each particle is checked with subsequent ones, which projections overlap with its own
+		for (size_t i = 0; i < v1.size(); ++i)
+			for (size_t j = i + 1; j < v1.size() && v1[j].lo <= v1[i].hi; ++j)
+				Check(v1[i], v1[j]);
+	else // main-main in neighboring cells: each pair with overlapping projections is found once, by the entry with smaller or equal lower bound
 	{
-		unsigned p1 = _gridLevel.grid[_nX2][_nY2][_nZ2].vMainPartIDs[i];
-		SParticleStruct& part1 = m_vParticles.(p1)
-		const double dTemp1 = m_dVerletDistance + part1.dContactRadius;
-		for (unsigned j = 0; j < _gridLevel.grid[_nX1][_nY1][_nZ1].vSecondaryPartIDs.size(); ++j)
+		size_t iBeg = 0, jBeg = 0;
+		for (size_t i = 0; i < v1.size(); ++i)
 		{
-			unsigned p2 = _gridLevel.grid[_nX1][_nY1][_nZ1].vSecondaryPartIDs[j];
-			if (SquaredLength(part1.vCoord - m_vParticles.vCoord(p2)) <= pow(dTemp1 + m_vParticles.dContactRadius(p2), 2))
-				AddPossibleContactPP(p2, p1);
+			while (jBeg < v2.size() && v2[jBeg].lo < v1[i].lo) ++jBeg;
+			for (size_t j = jBeg; j < v2.size() && v2[j].lo <= v1[i].hi; ++j)
+				Check(v1[i], v2[j]);
+		}
+		for (size_t j = 0; j < v2.size(); ++j)
+		{
+			while (iBeg < v1.size() && v1[iBeg].lo <= v2[j].lo) ++iBeg;
+			for (size_t i = iBeg; i < v1.size() && v1[i].lo <= v2[j].hi; ++i)
+				Check(v1[i], v2[j]);
 		}
 	}
-	return;*/
+
+	CheckCollisionPPSecondary(_cell1, _cell2, _bSameCell);
 }
 
-void CVerletList::CheckCollisionPP(const SGridLevel& _gridLevel, unsigned _nX1, unsigned _nY1, unsigned _nZ1, unsigned _nX2, unsigned _nY2, unsigned _nZ2, bool _bSameCell /*= false*/)
+void CVerletList::CheckCollisionPPSecondary(const SGridCell& _cell1, const SGridCell& _cell2, bool _bSameCell)
 {
-	if (_nX2 >= _gridLevel.nCellsX || _nY2 >= _gridLevel.nCellsY || _nZ2 >= _gridLevel.nCellsZ) return;
-	const SGridCell& cell1 = _gridLevel.grid[_nX1][_nY1][_nZ1];
-	const SGridCell& cell2 = _gridLevel.grid[_nX2][_nY2][_nZ2];
-	for (unsigned i = 0; i < cell1.vMainPartIDs.size(); ++i)
+	const auto Check = [&](unsigned _iPart1, unsigned _iPart2, bool _bOrdered)
 	{
-		const unsigned p1 = cell1.vMainPartIDs[i];
+		const double dist = m_dVerletDistance + m_vParticles.ContactRadius(_iPart1) + m_vParticles.ContactRadius(_iPart2);
+		if (SquaredLength(m_vParticles.Coord(_iPart1) - m_vParticles.Coord(_iPart2)) <= dist * dist)
+		{
+			if (_bOrdered && _iPart2 < _iPart1)
+				AddPossibleContactPP(_iPart2, _iPart1);
+			else
+				AddPossibleContactPP(_iPart1, _iPart2);
+		}
+	};
+
+	for (const unsigned p1 : _cell1.vMainPartIDs) // main-secondary
+		for (const unsigned p2 : _cell2.vSecondaryPartIDs)
+			Check(p1, p2, _bSameCell);
+	if (!_bSameCell) // secondary-main
+		for (const unsigned p1 : _cell2.vMainPartIDs)
+			for (const unsigned p2 : _cell1.vSecondaryPartIDs)
+				Check(p2, p1, false);
+}
+
+void CVerletList::CheckCollisionPP(const SGridCell& _cell1, const SGridCell& _cell2, bool _bSameCell /*= false*/)
+{
+	for (unsigned i = 0; i < _cell1.vMainPartIDs.size(); ++i)
+	{
+		const unsigned p1 = _cell1.vMainPartIDs[i];
 		const double dTemp1 = m_dVerletDistance + m_vParticles.ContactRadius(p1);
 		const CVector3 vPos1 = m_vParticles.Coord(p1);
 		unsigned nStartIndex = 0;
 		if (_bSameCell)
 			nStartIndex = i + 1;
-		for (unsigned j = nStartIndex; j < cell2.vMainPartIDs.size(); ++j) //main-main
+		for (unsigned j = nStartIndex; j < _cell2.vMainPartIDs.size(); ++j) //main-main
 		{
-			unsigned p2 = cell2.vMainPartIDs[j];
+			unsigned p2 = _cell2.vMainPartIDs[j];
 			if (SquaredLength(vPos1 - m_vParticles.Coord(p2)) <= std::pow(dTemp1 + m_vParticles.ContactRadius(p2), 2))
 				if (( _bSameCell ) && ( p2 < p1))
 					AddPossibleContactPP(p2, p1);
 				else
 					AddPossibleContactPP(p1, p2);
 		}
-		for (unsigned j = 0; j < cell2.vSecondaryPartIDs.size(); ++j) // main-secondary
+		for (unsigned j = 0; j < _cell2.vSecondaryPartIDs.size(); ++j) // main-secondary
 		{
-			unsigned p2 = cell2.vSecondaryPartIDs[j];
+			unsigned p2 = _cell2.vSecondaryPartIDs[j];
 			if (SquaredLength(vPos1 - m_vParticles.Coord(p2)) <= pow(dTemp1 + m_vParticles.ContactRadius(p2), 2))
 				if ((_bSameCell) && (p2 < p1))
 					AddPossibleContactPP(p2, p1);
@@ -581,14 +829,14 @@ void CVerletList::CheckCollisionPP(const SGridLevel& _gridLevel, unsigned _nX1,
 	}
 
 	if (!_bSameCell) // secondary-main
-		for (unsigned i = 0; i < cell2.vMainPartIDs.size(); ++i)
+		for (unsigned i = 0; i < _cell2.vMainPartIDs.size(); ++i)
 		{
-			unsigned p1 = cell2.vMainPartIDs[i];
+			unsigned p1 = _cell2.vMainPartIDs[i];
 			const CVector3 vPos1 = m_vParticles.Coord(p1);
 			const double dTemp1 = m_dVerletDistance + m_vParticles.ContactRadius(p1);
-			for (unsigned j = 0; j < cell1.vSecondaryPartIDs.size(); ++j)
+			for (unsigned j = 0; j < _cell1.vSecondaryPartIDs.size(); ++j)
 			{
-				unsigned p2 = cell1.vSecondaryPartIDs[j];
+				unsigned p2 = _cell1.vSecondaryPartIDs[j];
 				if (SquaredLength(vPos1 - m_vParticles.Coord(p2)) <= pow(dTemp1 + m_vParticles.ContactRadius(p2), 2))
 					AddPossibleContactPP(p2, p1);
 			}
@@ -604,7 +852,7 @@ void CVerletList::CheckCollisionPW(const SGridLevel& _gridLevel, const SGridCell
 		for (unsigned iWall = 0; iWall < _gridCell.vWallIDs.size(); ++iWall)
 		{
 			const unsigned w = _gridCell.vWallIDs[iWall];
-			if (IsSphereIntersectTriangle(m_vWalls.Coordinates(w), m_vWalls.NormalVector(w), m_vParticles.Coord(p), m_vParticles.ContactRadius(p) + m_dVerletDistance).first != EIntersectionType::NO_CONTACT)
+			if (IsSphereIntersectTriangle(m_vWalls.Coordinates(w), m_vWalls.NormalVector(w), m_vParticles.Coord(p), m_vParticles.ContactRadius(p) + m_dVerletDistancePW).first != EIntersectionType::NO_CONTACT)
 				AddPossibleContactPW(p, w);
 		}
 	}
@@ -652,18 +900,28 @@ void CVerletList::RecalcParticlesPositions()
 	size_t nParticles= m_vParticles.Size();
 	// Here index of grid layers for each specific particle is calculated. Otherwise one particle can be considered twice
 	// if it is directly comes to the boundary of grid size
-	std::vector<unsigned> vGridLevel(nParticles);
+	std::vector<unsigned>& vGridLevel = m_vGridLevel;
+	vGridLevel.assign(nParticles, 0);
 	ParallelFor(m_vParticles.Size(), [&](size_t i)
 	{
 		if (m_vParticles.Active(i))
+		{
 			for (unsigned iGrid = 0; iGrid < m_vGrid.size(); iGrid++)
 				if (m_vGrid[iGrid].dMaxPartRadius + DBL_EPSILON >= m_vParticles.ContactRadius(i) && m_vGrid[iGrid].dMinPartRadius - DBL_EPSILON < m_vParticles.ContactRadius(i))
 				{
 					vGridLevel[i] = iGrid;
 					break;
 				}
+		}
+		else
+			vGridLevel[i] = NOT_IN_GRID;
 	});
 
+	if (m_gridType == EVerletGridType::SPARSE)
+	{
+		RecalcSparseParticlesPositions(vGridLevel);
+		return;
+	}
 
 	for (size_t iGrid = 0; iGrid < m_vGrid.size(); ++iGrid)
 	{
@@ -675,11 +933,11 @@ void CVerletList::RecalcParticlesPositions()
 		{
 			if (m_vParticles.Active(i))
 			{
-				const CVector3 relCoord = (m_vParticles.Coord(i) - m_workDomain.coordBeg) / gridLevel.dCellSize;
-				// limit from above for the case if the particle lays outside the domain (like newly generated)
-				vIDx[i] = std::min(static_cast<unsigned>(floor(relCoord.x)), gridLevel.nCellsX - 1);
-				vIDy[i] = std::min(static_cast<unsigned>(floor(relCoord.y)), gridLevel.nCellsY - 1);
-				vIDz[i] = std::min(static_cast<unsigned>(floor(relCoord.z)), gridLevel.nCellsZ - 1);
+				unsigned nX, nY, nZ;
+				GetCellIndices(gridLevel, m_vParticles.Coord(i), nX, nY, nZ);
+				vIDx[i] = nX;
+				vIDy[i] = nY;
+				vIDz[i] = nZ;
 				vTotalIndex[i] = vIDx[i] * gridLevel.nCellsY*gridLevel.nCellsZ + vIDy[i] * gridLevel.nCellsZ + vIDz[i];
 			}
 			else
@@ -701,56 +959,354 @@ void CVerletList::RecalcParticlesPositions()
 }
 
 
-void CVerletList::RecalcWallsPositions()
+void CVerletList::RecalcSparseParticlesPositions(const std::vector<unsigned>& _vGridLevel)
 {
-	ParallelFor(m_vGrid.size(), [&](size_t iGrid)
+	const size_t nParticles = m_vParticles.Size();
+	for (size_t iGrid = 0; iGrid < m_vGrid.size(); ++iGrid)
 	{
-		for (unsigned iWall = 0; iWall < m_vWalls.Size(); ++iWall)
+		SGridLevel& gridLevel = m_vGrid[iGrid];
+
+		// calculate linear indices of cells for particles, which are considered on this level
+		m_vCellEntries.resize(nParticles);
+		ParallelFor(nParticles, [&](size_t i)
 		{
-			SGridLevel& gridLevel = m_vGrid[iGrid];
+			m_vCellEntries[i].id = static_cast<unsigned>(i);
+			if (m_vParticles.Active(i) && _vGridLevel[i] >= iGrid)
+			{
+				unsigned nX, nY, nZ;
+				GetCellIndices(gridLevel, m_vParticles.Coord(i), nX, nY, nZ);
+				m_vCellEntries[i].key = CellKey(gridLevel, nX, nY, nZ);
+			}
+			else
+				m_vCellEntries[i].key = std::numeric_limits<uint64_t>::max();
+		});
+		m_vCellEntries.erase(std::remove_if(m_vCellEntries.begin(), m_vCellEntries.end(), [](const SCellEntry& _e) { return _e.key == std::numeric_limits<uint64_t>::max(); }), m_vCellEntries.end());
 
-			const CVector3 minCoord = (m_vWalls.MinCoord(iWall) - m_workDomain.coordBeg) / gridLevel.dCellSize;
-			int nMinX = static_cast<int>(floor(minCoord.x));
-			int nMinY = static_cast<int>(floor(minCoord.y));
-			int nMinZ = static_cast<int>(floor(minCoord.z));
+		// group particles by cells; the sorting is stable, so particles stay ordered by indices within each cell
+		SortCellEntries();
 
-			if (nMinX >= static_cast<int>(gridLevel.nCellsX) || nMinY >= static_cast<int>(gridLevel.nCellsY) || nMinZ >= static_cast<int>(gridLevel.nCellsZ)) continue;
+		// gather occupied cells
+		std::vector<size_t> vBegins;
+		for (size_t i = 0; i < m_vCellEntries.size(); ++i)
+			if (i == 0 || m_vCellEntries[i].key != m_vCellEntries[i - 1].key)
+			{
+				gridLevel.vKeys.push_back(m_vCellEntries[i].key);
+				vBegins.push_back(i);
+			}
+		vBegins.push_back(m_vCellEntries.size());
+		if (gridLevel.vCells.size() < gridLevel.vKeys.size())
+			gridLevel.vCells.resize(gridLevel.vKeys.size());
 
-			const CVector3 maxCoord = (m_vWalls.MaxCoord(iWall) - m_workDomain.coordBeg) / gridLevel.dCellSize;
-			int nMaxX = static_cast<int>(ceil(maxCoord.x)) + 1;
-			int nMaxY = static_cast<int>(ceil(maxCoord.y)) + 1;
-			int nMaxZ = static_cast<int>(ceil(maxCoord.z)) + 1;
+		ParallelFor(gridLevel.vKeys.size(), [&](size_t iCell)
+		{
+			SGridCell& cell = gridLevel.vCells[iCell];
+			for (size_t i = vBegins[iCell]; i < vBegins[iCell + 1]; ++i)
+			{
+				const unsigned id = m_vCellEntries[i].id;
+				if (_vGridLevel[id] == iGrid)
+					cell.vMainPartIDs.push_back(id);
+				else
+					cell.vSecondaryPartIDs.push_back(id);
+			}
+		});
+	}
+}
 
-			if (nMaxX < 0 || nMaxY < 0 || nMaxZ < 0) continue;
+void CVerletList::SortCellEntries()
+{
+	uint64_t maxKey = 0;
+	for (const auto& entry : m_vCellEntries)
+		maxKey = std::max(maxKey, entry.key);
 
-			nMaxX = std::min(nMaxX, static_cast<int>(gridLevel.nCellsX) - 1);
-			nMaxY = std::min(nMaxY, static_cast<int>(gridLevel.nCellsY) - 1);
-			nMaxZ = std::min(nMaxZ, static_cast<int>(gridLevel.nCellsZ) - 1);
+	// least significant digit first, only as many digits as needed for the largest key
+	m_vCellEntriesTmp.resize(m_vCellEntries.size());
+	for (unsigned shift = 0; shift < 64 && (maxKey >> shift) != 0; shift += 8)
+	{
+		std::array<size_t, 257> offsets{};
+		for (const auto& entry : m_vCellEntries)
+			++offsets[((entry.key >> shift) & 0xFF) + 1];
+		for (size_t i = 1; i < offsets.size(); ++i)
+			offsets[i] += offsets[i - 1];
+		for (const auto& entry : m_vCellEntries)
+			m_vCellEntriesTmp[offsets[(entry.key >> shift) & 0xFF]++] = entry;
+		m_vCellEntries.swap(m_vCellEntriesTmp);
+	}
+}
 
-			nMinX = std::max(nMinX, 0);
-			nMinY = std::max(nMinY, 0);
-			nMinZ = std::max(nMinZ, 0);
+template<typename F>
+void CVerletList::ForEachWallCell(SGridLevel& _gridLevel, const SWallStruct::SCoordinates& _coords, F&& _function) const
+{
+	const CVector3 minCoord = (_coords.minCoord - m_workDomain.coordBeg) / _gridLevel.dCellSize;
+	int nMinX = static_cast<int>(floor(minCoord.x));
+	int nMinY = static_cast<int>(floor(minCoord.y));
+	int nMinZ = static_cast<int>(floor(minCoord.z));
+
+	if (nMinX >= static_cast<int>(_gridLevel.nCellsX) || nMinY >= static_cast<int>(_gridLevel.nCellsY) || nMinZ >= static_cast<int>(_gridLevel.nCellsZ)) return;
+
+	const CVector3 maxCoord = (_coords.maxCoord - m_workDomain.coordBeg) / _gridLevel.dCellSize;
+	int nMaxX = static_cast<int>(ceil(maxCoord.x)) + 1;
+	int nMaxY = static_cast<int>(ceil(maxCoord.y)) + 1;
+	int nMaxZ = static_cast<int>(ceil(maxCoord.z)) + 1;
+
+	if (nMaxX < 0 || nMaxY < 0 || nMaxZ < 0) return;
+
+	// a particle can reach the wall only if the wall intersects its cell, extended by the max radius of particles and the verlet distance;
+	// cells on the boundary of the grid can contain particles outside the domain, so they are always taken
+	const double margin = _gridLevel.dMaxPartRadius + m_dVerletDistancePW;
+	const CVector3 minNear = (_coords.minCoord - m_workDomain.coordBeg - CVector3{ margin }) / _gridLevel.dCellSize;
+	const CVector3 maxNear = (_coords.maxCoord - m_workDomain.coordBeg + CVector3{ margin }) / _gridLevel.dCellSize;
+
+	// verlet distance of walls may exceed the size of a cell
+	nMinX = std::min(nMinX - 1, static_cast<int>(floor(minNear.x)));
+	nMinY = std::min(nMinY - 1, static_cast<int>(floor(minNear.y)));
+	nMinZ = std::min(nMinZ - 1, static_cast<int>(floor(minNear.z)));
+	nMaxX = std::max(nMaxX, static_cast<int>(floor(maxNear.x)));
+	nMaxY = std::max(nMaxY, static_cast<int>(floor(maxNear.y)));
+	nMaxZ = std::max(nMaxZ, static_cast<int>(floor(maxNear.z)));
+
+	nMaxX = std::min(nMaxX, static_cast<int>(_gridLevel.nCellsX) - 1);
+	nMaxY = std::min(nMaxY, static_cast<int>(_gridLevel.nCellsY) - 1);
+	nMaxZ = std::min(nMaxZ, static_cast<int>(_gridLevel.nCellsZ) - 1);
+
+	nMinX = std::max(nMinX, 0);
+	nMinY = std::max(nMinY, 0);
+	nMinZ = std::max(nMinZ, 0);
+
+	const auto IsNear1D = [](int _n, double _min, double _max, unsigned _cellsNumber)
+	{
+		return _n == 0 || _n + 1 == static_cast<int>(_cellsNumber) || (_n + 1 >= _min && _n <= _max);
+	};
+	// for walls, which are small in two directions, the bounding box is close to the wall itself, so separating axes are not checked
+	const CVector3 size = (_coords.maxCoord - _coords.minCoord) / _gridLevel.dCellSize;
+	const bool bCheckAxes = (size.x > 1) + (size.y > 1) + (size.z > 1) >= 2;
+	const CVector3 halfSize{ _gridLevel.dCellSize / 2 + margin };
+	const auto IsNear = [&](int _nX, int _nY, int _nZ)
+	{
+		if (!bCheckAxes) return true;
+		if (_nX == 0 || _nY == 0 || _nZ == 0 || _nX + 1 == static_cast<int>(_gridLevel.nCellsX) || _nY + 1 == static_cast<int>(_gridLevel.nCellsY) || _nZ + 1 == static_cast<int>(_gridLevel.nCellsZ))
+			return true;
+		const CVector3 center = m_workDomain.coordBeg + CVector3{ _nX + 0.5, _nY + 0.5, _nZ + 0.5 } * _gridLevel.dCellSize;
+		return IsBoxIntersectTriangle(center, halfSize, _coords);
+	};
+
+	if (m_gridType == EVerletGridType::DENSE)
+	{
+		for (int x = nMinX; x <= nMaxX; ++x)
+		{
+			if (!IsNear1D(x, minNear.x, maxNear.x, _gridLevel.nCellsX)) continue;
+			for (int y = nMinY; y <= nMaxY; ++y)
+			{
+				if (!IsNear1D(y, minNear.y, maxNear.y, _gridLevel.nCellsY)) continue;
+				for (int z = nMinZ; z <= nMaxZ; ++z)
+					if (IsNear1D(z, minNear.z, maxNear.z, _gridLevel.nCellsZ) && IsNear(x, y, z))
+						_function(CellKey(_gridLevel, x, y, z), _gridLevel.grid[x][y][z]);
+			}
+		}
+		return;
+	}
+
+	// occupied cells in the range of X
+	const auto& keys = _gridLevel.vKeys;
+	const auto beg = std::lower_bound(keys.begin(), keys.end(), CellKey(_gridLevel, nMinX, 0, 0));
+	const auto end = std::lower_bound(beg, keys.end(), CellKey(_gridLevel, nMaxX + 1, 0, 0));
+	if (beg == end) return;
+
+	const uint64_t nBoxCells = static_cast<uint64_t>(nMaxX - nMinX + 1) * (nMaxY - nMinY + 1) * (nMaxZ - nMinZ + 1);
+	if (nBoxCells < static_cast<uint64_t>(end - beg)) // small wall - look up each cell of its bounding box
+	{
+		for (int x = nMinX; x <= nMaxX; ++x)
+			for (int y = nMinY; y <= nMaxY; ++y)
+				for (int z = nMinZ; z <= nMaxZ; ++z)
+				{
+					if (!IsNear1D(x, minNear.x, maxNear.x, _gridLevel.nCellsX) || !IsNear1D(y, minNear.y, maxNear.y, _gridLevel.nCellsY) || !IsNear1D(z, minNear.z, maxNear.z, _gridLevel.nCellsZ)) continue;
+					const uint64_t key = CellKey(_gridLevel, x, y, z);
+					const auto it = std::lower_bound(beg, end, key);
+					if (it != end && *it == key && IsNear(x, y, z))
+						_function(static_cast<size_t>(it - keys.begin()), _gridLevel.vCells[it - keys.begin()]);
+				}
+	}
+	else // large wall - check each occupied cell
+	{
+		for (auto it = beg; it != end; ++it)
+		{
+			const int x = static_cast<int>(*it / _gridLevel.nCellsZ / _gridLevel.nCellsY);
+			const int y = static_cast<int>(*it / _gridLevel.nCellsZ % _gridLevel.nCellsY);
+			const int z = static_cast<int>(*it % _gridLevel.nCellsZ);
+			if (y >= nMinY && y <= nMaxY && z >= nMinZ && z <= nMaxZ
+				&& IsNear1D(x, minNear.x, maxNear.x, _gridLevel.nCellsX) && IsNear1D(y, minNear.y, maxNear.y, _gridLevel.nCellsY) && IsNear1D(z, minNear.z, maxNear.z, _gridLevel.nCellsZ)
+				&& IsNear(x, y, z))
+				_function(static_cast<size_t>(it - keys.begin()), _gridLevel.vCells[it - keys.begin()]);
+		}
+	}
+}
+
+template<typename F>
+void CVerletList::ForEachWallCellParallel(SGridLevel& _gridLevel, const std::vector<unsigned>& _vWallIDs, F&& _function)
+{
+	const size_t nThreads = GetThreadsNumber();
+	const size_t nWalls = _vWallIDs.size();
+	if (nThreads == 1)
+	{
+		for (const unsigned iWall : _vWallIDs)
+			ForEachWallCell(_gridLevel, m_vWallCoordsVerlet[iWall], [&](size_t, SGridCell& _cell) { _function(_cell, iWall); });
+		return;
+	}
+
+	m_vWallCellEntries.resize(nThreads * nThreads);
+	const size_t cellsPerThread = CellsNumber(_gridLevel) / nThreads + 1;
+	// each thread bins its own range of walls and distributes found cells into buckets of threads, which will process them
+	ParallelFor([&](size_t iThread)
+	{
+		std::vector<SCellEntry>* buckets = &m_vWallCellEntries[iThread * nThreads];
+		for (size_t i = 0; i < nThreads; ++i)
+			buckets[i].clear();
+		for (size_t k = iThread * nWalls / nThreads; k < (iThread + 1) * nWalls / nThreads; ++k)
+			ForEachWallCell(_gridLevel, m_vWallCoordsVerlet[_vWallIDs[k]], [&](size_t _iCell, SGridCell&)
+			{
+				buckets[_iCell / cellsPerThread].push_back(SCellEntry{ _iCell, _vWallIDs[k] });
+			});
+	});
+	// each thread processes its own range of cells, taking buckets in the order of threads, so walls come to each cell in the order of the list, as in serial binning
+	ParallelFor([&](size_t iThread)
+	{
+		for (size_t i = 0; i < nThreads; ++i)
+			for (const SCellEntry& entry : m_vWallCellEntries[i * nThreads + iThread])
+				_function(CellByIndex(_gridLevel, entry.key), entry.id);
+	});
+}
 
-			if (nMinX > 0) nMinX--;
-			if (nMinY > 0) nMinY--;
-			if (nMinZ > 0) nMinZ--;
+void CVerletList::RecalcWallsPositions()
+{
+	const size_t nWalls = m_vWalls.Size();
+	m_vWallCoordsVerlet.resize(nWalls);
+	ParallelFor(nWalls, [&](size_t i)
+	{
+		m_vWallCoordsVerlet[i] = m_vWalls.Coordinates(i);
+	});
+	if (m_vAllWallIDs.size() != nWalls)
+	{
+		m_vAllWallIDs.resize(nWalls);
+		std::iota(m_vAllWallIDs.begin(), m_vAllWallIDs.end(), 0);
+	}
+	for (auto& gridLevel : m_vGrid)
+		ForEachWallCellParallel(gridLevel, m_vAllWallIDs, [&](SGridCell& _cell, unsigned _iWall) { _cell.vWallIDs.push_back(_iWall); });
+}
 
-			for (int x = nMinX; x <= nMaxX; ++x)
-				for (int y = nMinY; y <= nMaxY; ++y)
-					for (int z = nMinZ; z <= nMaxZ; ++z)
-						gridLevel.grid[x][y][z].vWallIDs.push_back(iWall);
+bool CVerletList::UpdateListWalls()
+{
+	const size_t nParticles = m_vParticles.Size();
+	const size_t nGeometries = m_vGeometryUpdateFlags.size();
+	const std::vector<size_t>& vGeometryWalls = m_Scene.m_vGeometryWalls;
+	// with PBC, virtual particles are regenerated at each update, so only the full rebuild is possible
+	if (!m_bListsValid || m_Scene.m_PBC.bEnabled) return false;
+	if (nParticles != m_vGridLevel.size() || nParticles != m_PWList.size() || m_vWalls.Size() != m_vWallCoordsVerlet.size()) return false;
+	if (vGeometryWalls.size() != nGeometries + 1 || vGeometryWalls.back() != m_vWalls.Size()) return false;
+
+	// select walls of geometries, which have moved far from their positions in the grid
+	m_vMovedWallFlags.assign(m_vWalls.Size(), 0);
+	m_vMovedWallIDs.clear();
+	for (size_t iGeom = 0; iGeom < nGeometries; ++iGeom)
+	{
+		if (!m_vGeometryUpdateFlags[iGeom]) continue;
+		for (size_t w = vGeometryWalls[iGeom]; w < vGeometryWalls[iGeom + 1]; ++w)
+		{
+			m_vMovedWallFlags[w] = 1;
+			m_vMovedWallIDs.push_back(static_cast<unsigned>(w));
 		}
+		m_vGeometryUpdateFlags[iGeom] = 0;
+		m_vMaxTheorGeometryDistance[iGeom] = 0;
+	}
+	if (m_vMovedWallIDs.empty()) return true;
+
+	// remove contacts with moved walls; the rest of contacts of each particle stays sorted
+	m_vPWKeptNumber.resize(nParticles);
+	ParallelFor(nParticles, [&](size_t i)
+	{
+		std::vector<unsigned>& vWalls = m_PWList[i];
+		vWalls.erase(std::remove_if(vWalls.begin(), vWalls.end(), [&](unsigned _id) { return m_vMovedWallFlags[_id] != 0; }), vWalls.end());
+		m_vPWKeptNumber[i] = static_cast<unsigned>(vWalls.size());
+	});
+
+	// moved walls are placed into the grid at their current coordinates
+	ParallelFor(m_vMovedWallIDs.size(), [&](size_t k)
+	{
+		m_vWallCoordsVerlet[m_vMovedWallIDs[k]] = m_vWalls.Coordinates(m_vMovedWallIDs[k]);
 	});
+	// remove moved walls from all cells at once; the rest of walls of each cell stays sorted
+	for (auto& gridLevel : m_vGrid)
+	{
+		m_vCellWallsKeptNumber.resize(CellsNumber(gridLevel));
+		ParallelFor(m_vCellWallsKeptNumber.size(), [&](size_t iCell)
+		{
+			std::vector<unsigned>& vWalls = CellByIndex(gridLevel, iCell).vWallIDs;
+			vWalls.erase(std::remove_if(vWalls.begin(), vWalls.end(), [&](unsigned _id) { return m_vMovedWallFlags[_id] != 0; }), vWalls.end());
+			m_vCellWallsKeptNumber[iCell] = static_cast<unsigned>(vWalls.size());
+		});
+
+		// place moved walls and check them with main particles of each cell, as in CheckCollisionPW();
+		// each particle is main in one cell only, so its contacts are added by one thread in the order of walls
+		ForEachWallCellParallel(gridLevel, m_vMovedWallIDs, [&](SGridCell& _cell, unsigned _iWall)
+		{
+			_cell.vWallIDs.push_back(_iWall);
+			for (const unsigned p : _cell.vMainPartIDs)
+				if (m_vParticles.ContactRadius(p) > gridLevel.dMinPartRadius)
+					if (IsSphereIntersectTriangle(m_vWalls.Coordinates(_iWall), m_vWalls.NormalVector(_iWall), m_vParticles.CoordVerlet(p), m_vParticles.ContactRadius(p) + m_dVerletDistancePW).first != EIntersectionType::NO_CONTACT)
+						m_PWList[p].push_back(_iWall);
+		});
+		ParallelFor(m_vCellWallsKeptNumber.size(), [&](size_t iCell)
+		{
+			std::vector<unsigned>& vWalls = CellByIndex(gridLevel, iCell).vWallIDs;
+			if (vWalls.size() != m_vCellWallsKeptNumber[iCell])
+				std::inplace_merge(vWalls.begin(), vWalls.begin() + m_vCellWallsKeptNumber[iCell], vWalls.end());
+		});
+	}
+	ParallelFor(nParticles, [&](size_t i)
+	{
+		std::vector<unsigned>& vWalls = m_PWList[i];
+		if (vWalls.size() != m_vPWKeptNumber[i])
+			std::inplace_merge(vWalls.begin(), vWalls.begin() + m_vPWKeptNumber[i], vWalls.end());
+	});
+
+	return true;
+}
+
+size_t CVerletList::CellsNumber(const SGridLevel& _gridLevel) const
+{
+	if (m_gridType == EVerletGridType::DENSE)
+		return static_cast<size_t>(_gridLevel.nCellsX) * _gridLevel.nCellsY * _gridLevel.nCellsZ;
+	return _gridLevel.vKeys.size();
+}
+
+CVerletList::SGridCell& CVerletList::CellByIndex(SGridLevel& _gridLevel, size_t _index) const
+{
+	if (m_gridType == EVerletGridType::SPARSE)
+		return _gridLevel.vCells[_index];
+	const size_t nYZ = static_cast<size_t>(_gridLevel.nCellsY) * _gridLevel.nCellsZ;
+	return _gridLevel.grid[_index / nYZ][_index % nYZ / _gridLevel.nCellsZ][_index % _gridLevel.nCellsZ];
 }
 
 void CVerletList::ResetCurrentData()
 {
-	m_dMaxTheorWallDistance = DEFAULT_TEOR_DISTANCE;
+	m_dMaxTheorPBCDistance = DEFAULT_TEOR_DISTANCE;
+	m_bIncrementalValid = false;
+	m_bListsValid = false;
 }
 
 void CVerletList::ClearOldPositions()
 {
 	for (size_t i = 0; i < m_vGrid.size(); ++i)
+	{
+		if (m_gridType == EVerletGridType::SPARSE)
+		{
+			ParallelFor(m_vGrid[i].vKeys.size(), [&](size_t iCell)
+			{
+				m_vGrid[i].vCells[iCell].vMainPartIDs.clear();
+				m_vGrid[i].vCells[iCell].vSecondaryPartIDs.clear();
+				m_vGrid[i].vCells[iCell].vWallIDs.clear();
+			});
+			m_vGrid[i].vKeys.clear();
+			continue;
+		}
 		ParallelFor(m_vGrid[i].nCellsX, [&](size_t x)
 		{
 			for (unsigned y = 0; y < m_vGrid[i].nCellsY; ++y)
@@ -761,34 +1317,65 @@ void CVerletList::ClearOldPositions()
 					m_vGrid[i].grid[x][y][z].vWallIDs.clear();
 				}
 		});
+	}
 }
 
-void CVerletList::GetPWContacts(size_t _iP, std::vector<EIntersectionType>& _vIntersectionType, std::vector<CVector3>& _vContactPoint) const
+void CVerletList::ClearWallsPositions()
 {
-	if (m_PWList[_iP].empty()) return;
-
-	_vIntersectionType.resize(m_PWList[_iP].size());
-	_vContactPoint.resize(m_PWList[_iP].size());
-
-	CVector3 vPartCoord;
-	std::vector<bool> bVirtualContacts(m_PWList[_iP].size(), false); // true for all virtual contacts
-	for (size_t i = 0; i < m_PWList[_iP].size(); ++i)
+	for (auto& gridLevel : m_vGrid)
 	{
-		if(!m_PWVirtShift.empty() && (m_PWVirtShift[_iP][i] != 0)) // virtual contact
+		if (m_gridType == EVerletGridType::SPARSE)
 		{
-			vPartCoord = GetVirtualProperty(m_vParticles.Coord(_iP), m_PWVirtShift[_iP][i], m_Scene.m_PBC );
-			bVirtualContacts[i] = true;
+			ParallelFor(gridLevel.vKeys.size(), [&](size_t iCell)
+			{
+				gridLevel.vCells[iCell].vWallIDs.clear();
+			});
+			continue;
 		}
-		else
-			vPartCoord = m_vParticles.Coord(_iP);
+		ParallelFor(gridLevel.nCellsX, [&](size_t x)
+		{
+			for (unsigned y = 0; y < gridLevel.nCellsY; ++y)
+				for (unsigned z = 0; z < gridLevel.nCellsZ; ++z)
+					gridLevel.grid[x][y][z].vWallIDs.clear();
+		});
+	}
+}
 
+size_t CVerletList::GetPWContacts(size_t _iP, std::vector<EIntersectionType>& _vIntersectionType, std::vector<CVector3>& _vContactPoint, std::vector<unsigned>& _vSelected) const
+{
+	const size_t nCandidates = m_PWList[_iP].size();
+	if (nCandidates == 0) return 0;
+
+	_vIntersectionType.assign(nCandidates, EIntersectionType::NO_CONTACT);
+	_vContactPoint.resize(nCandidates);
+	_vSelected.resize(nCandidates);
+
+	const auto IsVirtual = [&](size_t i) { return !m_PWVirtShift.empty() && m_PWVirtShift[_iP][i] != 0; };
+	const auto PartCoord = [&](size_t i) { return IsVirtual(i) ? GetVirtualProperty(m_vParticles.Coord(_iP), m_PWVirtShift[_iP][i], m_Scene.m_PBC) : m_vParticles.Coord(_iP); };
+
+	// cull candidates with cheap tests over the whole list, without branches; exact tests are performed only for the selected ones
+	size_t nSelected = 0;
+	for (size_t i = 0; i < nCandidates; ++i)
+	{
 		const size_t w = m_PWList[_iP][i];
-		std::tie(_vIntersectionType[i], _vContactPoint[i]) = IsSphereIntersectTriangle(m_vWalls.Coordinates(w), m_vWalls.NormalVector(w), vPartCoord, m_vParticles.ContactRadius(_iP));
+		_vSelected[nSelected] = static_cast<unsigned>(i);
+		nSelected += IsSphereNearTriangle(m_vWalls.Coordinates(w), m_vWalls.NormalVector(w), PartCoord(i), m_vParticles.ContactRadius(_iP));
+	}
+	for (size_t k = 0; k < nSelected; ++k)
+	{
+		const size_t i = _vSelected[k];
+		const size_t w = m_PWList[_iP][i];
+		std::tie(_vIntersectionType[i], _vContactPoint[i]) = IsSphereIntersectTriangle(m_vWalls.Coordinates(w), m_vWalls.NormalVector(w), PartCoord(i), m_vParticles.ContactRadius(_iP));
 	}
 
-	for (size_t i = 0; i < _vContactPoint.size() - 1; ++i)
+	// only selected candidates can be in contact, so the rest is skipped in further checks
+	for (size_t k = 0; k + 1 < nSelected; ++k)
+	{
+		const size_t i = _vSelected[k];
 		if (_vIntersectionType[i] != EIntersectionType::NO_CONTACT)
-			for (size_t j = i + 1; j < _vContactPoint.size(); ++j)
+			for (size_t l = k + 1; l < nSelected; ++l)
+			{
+				const size_t j = _vSelected[l];
 				if (_vIntersectionType[j] != EIntersectionType::NO_CONTACT && SquaredLength(m_vWalls.NormalVector(m_PWList[_iP][i]) - m_vWalls.NormalVector(m_PWList[_iP][j])) < 1e-6) // simplified unique calculation check
 					switch (_vIntersectionType[i])
 					{
@@ -809,11 +1396,22 @@ void CVerletList::GetPWContacts(size_t _iP, std::vector<EIntersectionType>& _vIn
 						break;
 					default: ;
 					}
+			}
+	}
+
+	if (!m_PWVirtShift.empty())
+		for (size_t k = 0; k < nSelected; ++k)
+		{
+			const size_t i = _vSelected[k];
+			if (IsVirtual(i) && _vIntersectionType[i] != EIntersectionType::NO_CONTACT)
+				for (size_t l = 0; l < nSelected; ++l) // additional check that there is no contact between one wall and real and virtual particles
+				{
+					const size_t j = _vSelected[l];
+					if (j != i && _vIntersectionType[j] != EIntersectionType::NO_CONTACT && !IsVirtual(j) && m_PWList[_iP][j] == m_PWList[_iP][i])
+						_vIntersectionType[i] = EIntersectionType::NO_CONTACT;
+				}
+		}
 
-	for (size_t i = 0; i < m_PWList[_iP].size(); ++i)
-		if (bVirtualContacts[i])
-			for (size_t j = 0; j < m_PWList[_iP].size(); ++j) // additional check that there is no contact between one wall and real and virtual particles
-				if (j != i && _vIntersectionType[j] != EIntersectionType::NO_CONTACT && bVirtualContacts[j] == 0 && m_PWList[_iP][j] == m_PWList[_iP][i])
-					_vIntersectionType[i] = EIntersectionType::NO_CONTACT;
+	return nSelected;
 }
 
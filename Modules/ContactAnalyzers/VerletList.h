@@ -7,16 +7,20 @@
 #include "ThreadPool.h"
 #include "SimplifiedScene.h"
 #include "GeometricFunctions.h"
-
-struct SCalcPerfmMetric
-{
-	double dAnalysisTime; // last time when analysis has been done
-	double dVerletDistance;
-	double dCalcTimeCoeff;
-};
+#include "VerletDistanceTuner.h"
+#include <array>
+#include <limits>
 
 #define DEFAULT_TEOR_DISTANCE			1e+12
 #define DEFAULT_VERLET_DISTANCE_COEFF	2
+#define DEFAULT_VERLET_WALL_RATIO		1
+
+// Type of the spatial index used to find possible contacts.
+enum class EVerletGridType : unsigned
+{
+	DENSE  = 0,	// Regular array of all cells. The number of cells in each direction is limited.
+	SPARSE = 1,	// Sorted array of occupied cells only. The size of cells is not limited by their number.
+};
 
 class CVerletList
 {
@@ -37,36 +41,80 @@ public:
 	size_t m_nThreadsNumber;	/// Number of available parallel threads.
 
 private:
+	// Main particle of a cell, copied for sweep-and-prune.
+	template<typename T>
+	struct SSortedParticle
+	{
+		CBasicVector3<T> coord;	// coordinates of the particle; in single precision relative to the origin of the working domain
+		T radius;				// contact radius of the particle
+		unsigned id;			// index of the particle
+	};
+	// Projection of a main particle of a cell onto one of the coordinate axes.
+	template<typename T>
+	struct SSortedEntry
+	{
+		T lo;			// coordinate minus contact radius
+		T hi;			// coordinate plus contact radius plus verlet distance
+		unsigned index;	// index of the particle in SSortedCell::particles
+		friend bool operator<(const SSortedEntry& _e1, const SSortedEntry& _e2)
+		{
+			return _e1.lo < _e2.lo;
+		}
+	};
+	// Main particles of a cell and their projections onto axes X, Y, Z sorted by lower bounds.
+	template<typename T>
+	struct SSortedCell
+	{
+		std::vector<SSortedParticle<T>> particles;
+		std::array<std::vector<SSortedEntry<T>>, 3> entries;
+	};
+
 	struct SGridCell
 	{
 		std::vector<unsigned> vMainPartIDs; // particles which are large and p-p collisions directly calculated on this level
 		std::vector<unsigned> vSecondaryPartIDs; // smaller particles which interactions are calculated on lower levels
 		std::vector<unsigned> vWallIDs; // memory which has been allocated for walls
+		// main particles sorted for sweep-and-prune in double and in single precision; filled only if the level uses sweep-and-prune
+		SSortedCell<double> sorted;
+		SSortedCell<float> sortedMixed;
+		template<typename T> SSortedCell<T>& Sorted();
+		template<typename T> const SSortedCell<T>& Sorted() const { return const_cast<SGridCell*>(this)->Sorted<T>(); }
 	};
 
 	struct SGridLevel
 	{
-		std::vector<std::vector<std::vector<SGridCell>>> grid;
+		std::vector<std::vector<std::vector<SGridCell>>> grid;	// all cells of the dense grid
+		std::vector<uint64_t> vKeys;	// sorted linear indices of occupied cells of the sparse grid
+		std::vector<SGridCell> vCells;	// occupied cells of the sparse grid in the same order as keys; can be longer to keep allocated memory
 		double dCellSize;		// cell size in current grid
 		double dMaxPartRadius;	// max radius of particles are being placed into this grid
 		double dMinPartRadius;	// min radius of particles are being considered in contacts in this grid
 		unsigned nCellsX;		// number of cells in direction X
 		unsigned nCellsY;		// number of cells in direction Y
 		unsigned nCellsZ;		// number of cells in direction Z
+		bool bSorted{ false };	// whether contacts of main particles are searched with sweep-and-prune over presorted cells
+		unsigned nSortAxis{ 0 };	// axis, along which main particles are spread most within cells
+		double dSortMargin{ 0 };	// margin added to all distances of sweep-and-prune in single precision to cover rounding errors
 	};
 
-	struct SEntry
+	struct SCellEntry
 	{
-		unsigned id;
-		double val;
-		SEntry(unsigned _id, double _val) : id{ _id }, val{ _val }{}
-		friend bool operator<(const SEntry& _e1, const SEntry& _e2)
-		{
-			return _e1.val < _e2.val;
-		}
+		uint64_t key;	// linear index of the cell
+		unsigned id;	// index of the particle
 	};
-	enum class ESortCoord : unsigned { X , Y , Z, XY, YZ, XZ };
-	enum class ESortDir : unsigned { Left, Right };
+
+	struct SNeighbor
+	{
+		int dx, dy, dz;
+	};
+	static const std::array<SNeighbor, 13> c_neighbors;			// half-shell of neighboring cells, in order they are checked
+
+	static constexpr size_t SORTED_MIN_PARTICLES = 10;	// Sweep-and-prune is used on grid levels, where at least one cell contains more main particles.
+	static constexpr uint32_t MAX_SPARSE_CELLS = (1u << 21) - 1;	// Maximum number of cells of the sparse grid in each direction, so that the linear index fits into 63 bits.
+	static constexpr unsigned NOT_IN_GRID = std::numeric_limits<unsigned>::max();	// Grid level of particles, which are not placed into the grid.
+	static constexpr double INCREMENTAL_MOVE_FRACTION = 0.25;	// Particles, which moved by more than this fraction of verlet distance, are updated in incremental mode.
+	static constexpr double INCREMENTAL_MAX_MOVED = 0.25;		// Max fraction of moved particles, at which the incremental update is still used instead of the full one.
+	static constexpr size_t INCREMENTAL_MAX_UPDATES = 50;		// Max number of incremental updates between two full rebuilds.
 
 	SParticleStruct& m_vParticles;
 	const SWallStruct& m_vWalls;
@@ -75,20 +123,45 @@ private:
 	double m_dMaxParticleRadius;
 	double m_dMinParticleRadius;
 	double m_dVerletDistance;
-	double m_dMaxTheorWallDistance; // the maximal theoretical distance which has been overcome by particles
+	double m_dVerletDistancePW;		// verlet distance of particle-wall contacts
+	double m_dVerletWallRatio;		/// Ratio of verlet distance of particle-wall contacts to the one of particle-particle contacts.
+	double m_dMaxTheorPBCDistance;	// the maximal theoretical distance which has been overcome by periodic boundaries; is set to a large value to force the update
 	bool m_bConnectedPPContact; // consider contact between already connected particles
+	bool m_bMixedPrecision{ false };	/// If set to true - pairs of main particles are checked in single precision during sweep-and-prune.
 	std::vector<SGridLevel> m_vGrid;
 	uint32_t m_nCellsMax;					/// Maximum allowed number of cells in each direction.
 	double m_dVerletDistanceCoeff;		/// A coefficient to calculate verlet distance.
 	bool m_bAutoAdjustVerletDistance;	/// If set to true - the verlet distance will be automatically adjusted during the simulation.
+	EVerletGridType m_gridType;			/// Type of the used spatial index.
+	std::vector<SCellEntry> m_vCellEntries;		/// Buffers to sort particles by cells of the sparse grid.
+	std::vector<SCellEntry> m_vCellEntriesTmp;
+	std::vector<std::vector<SCellEntry>> m_vWallCellEntries;	/// Buffers to bin walls in parallel: cells found by each thread for each range of cells.
+	std::vector<unsigned> m_vAllWallIDs;		/// Indices of all walls, to place them into the grid.
+	std::vector<unsigned> m_vGridLevel;			/// Grid level, on which each particle is main, as of the last update; NOT_IN_GRID for inactive particles.
+
+	// data for incremental update
+	bool m_bIncrementalUpdate;			/// If set to true - only particles, which moved far from their positions in the grid, are updated, if possible.
+	bool m_bIncrementalValid;			/// Whether the grid and the lists are consistent with the verlet coordinates of particles, so that the incremental update can be applied.
+	size_t m_nIncrementalUpdates;		/// Number of incremental updates since the last full rebuild.
+	size_t m_nActiveSolidBonds;			/// Number of active solid bonds at the last full rebuild.
+	std::vector<uint8_t> m_vMovedFlags;				/// Flags of particles, which are updated in the current incremental update.
+	std::vector<unsigned> m_vMovedIDs;				/// Indices of particles, which are updated in the current incremental update.
+	std::vector<std::vector<unsigned>> m_vNewContacts;	/// New possible contacts of each updated particle.
+
+	// data for update of particle-wall contacts of moving geometries
+	bool m_bListsValid;				/// Whether the grid and the lists are consistent with the current particles, so that particle-wall contacts can be updated separately.
+	bool m_bUpdateWallsOnly;		/// Whether only particle-wall contacts of some geometries are outdated at the current update.
+	std::vector<double> m_vMaxTheorGeometryDistance;	/// The maximal theoretical distance overcome by walls of each geometry since they were placed into the grid.
+	std::vector<uint8_t> m_vGeometryUpdateFlags;		/// Geometries, whose walls must be placed into the grid again at the current update.
+	std::vector<SWallStruct::SCoordinates> m_vWallCoordsVerlet;	/// Coordinates of walls, at which they were placed into the grid.
+	std::vector<uint8_t> m_vMovedWallFlags;			/// Flags of walls, which are placed into the grid again at the current update.
+	std::vector<unsigned> m_vMovedWallIDs;			/// Indices of walls, which are placed into the grid again at the current update.
+	std::vector<unsigned> m_vPWKeptNumber;			/// Number of particle-wall contacts of each particle, which are kept at the current update.
+	std::vector<unsigned> m_vCellWallsKeptNumber;	/// Number of walls of each cell, which are kept at the current update.
 
 	CSimplifiedScene& m_Scene;
 
-	clock_t m_LastCPUTime;
-	clock_t m_DisregardingTimeInterval;	// This time interval will not be taken into account during adjustment of verlet distance.
-	double m_dLastRealTime; // last time of real process
-	unsigned m_nAutoVerletDistNumerator; // AutoUpdate verlet distance called after each 10 recalculation steps
-	std::vector<SCalcPerfmMetric> m_PerformHistory; // performance history
+	CVerletDistanceTuner m_tuner;	// Auto-adjustment of verlet distance.
 
 public:
 	CVerletList(CSimplifiedScene& _Scene);
@@ -96,27 +169,74 @@ public:
 	void SetPointers(const std::vector<SWallStruct>& _vWalls );
 	void SetSceneInfo(const SVolumeType& _simDomain, double _dMinPartRadius, double _dMaxPartRadius, uint32_t _dMaxCellsNumber, double _dVerletCoeff, bool _bAutoAdjust);
 	void SetConnectedPPContact(bool _bPPContact) { m_bConnectedPPContact = _bPPContact;  }
+	void SetGridType(EVerletGridType _type);
+	EVerletGridType GetGridType() const { return m_gridType; }
 
 	void ResetCurrentData(); // set current data as not actual
-	bool IsNeedToBeUpdated(double _dTimeStep, double _dMaxPartDist, double _dMaxWallVel); // Returns true if verlet list needs to be updated at the current step.
-	void UpdateList(double _dCurrTime);
-	void GetPWContacts(size_t _iP, std::vector<EIntersectionType>& _vIntersectionType, std::vector<CVector3>& _vContactPoint) const;
+	void SetIncrementalUpdate(bool _bIncremental);
+	bool GetIncrementalUpdate() const { return m_bIncrementalUpdate; }
+	void SetWallDistanceRatio(double _dRatio);	// Sets the ratio of verlet distance of particle-wall contacts to the one of particle-particle contacts.
+	double GetWallDistanceRatio() const { return m_dVerletWallRatio; }
+	// Selects single precision for checks of candidate pairs during sweep-and-prune. Found pairs are a superset of the ones found in double precision.
+	void SetMixedPrecision(bool _bMixed) { m_bMixedPrecision = _bMixed; }
+	bool GetMixedPrecision() const { return m_bMixedPrecision; }
+
+	/* Returns true if verlet list needs to be updated at the current step. Particle-particle and particle-wall contacts are checked separately:
+	 * contacts with walls of each geometry become outdated, when the geometry together with particles may have moved by its verlet distance.
+	 * _vMaxGeometryVel contains max velocities of walls of each geometry, as they are stored in CSimplifiedScene::m_vGeometryWalls. */
+	bool IsNeedToBeUpdated(double _dTimeStep, double _dMaxPartDist, const std::vector<double>& _vMaxGeometryVel);
+	/* Updates the lists. Returns true if they have been completely rebuilt, so verlet coordinates of all particles must be saved.
+	 * In case of incremental update, verlet coordinates of updated particles are saved here and false is returned.
+	 * If only contacts with some geometries are outdated, only walls of these geometries are placed into the grid again and false is returned. */
+	bool UpdateList(double _dCurrTime);
+	/* Calculates intersections of the particle with all walls from its list. Candidates are culled with cheap tests first, and only the rest is tested exactly.
+	 * All vectors are used as buffers, so no memory is allocated if their capacity is sufficient. Returns the number of exactly tested walls. */
+	size_t GetPWContacts(size_t _iP, std::vector<EIntersectionType>& _vIntersectionType, std::vector<CVector3>& _vContactPoint, std::vector<unsigned>& _vSelected) const;
 	void ReassignVirtualContacts();
-	void AddDisregardingTimeInterval(const clock_t& _interval);
+	void AddDisregardingTimeInterval(double _interval);	// Wall time [s], which is not taken into account during adjustment of verlet distance.
+	void AddPhaseTime(CVerletDistanceTuner::EPhase _phase, double _time);	// Adds wall time [s] spent in the phase of simulation, to adjust verlet distance.
+	const CVerletDistanceTuner::SStatus& GetAutoAdjustStatus() const { return m_tuner.GetStatus(); }
 
 private:
 	void AutoAdjustVerletDistance( double _dCurrentTime );
 	void RecalculateGrid();	// recalculates whole grids
+	void RebuildList();		// rebuilds lists of all particles
+	/* Updates only particles, which have moved far from their verlet coordinates: moves them between cells and recalculates their possible contacts.
+	 * Returns false if the incremental update is not possible, so the full rebuild is needed. */
+	bool UpdateListIncremental();
+	/* Places walls of geometries, which have moved by their verlet distance, into the grid again and recalculates contacts of particles with these walls.
+	 * Returns false if it is not possible, so the full rebuild is needed. */
+	bool UpdateListWalls();
 	void EmptyGrid();
 	void SortList();		// Sorts current PP verlet list so that the src is always smaller as the dst.
 
 	void RecalcPositions();
 	void RecalcParticlesPositions();
+	void RecalcSparseParticlesPositions(const std::vector<unsigned>& _vGridLevel);
 	void RecalcWallsPositions();
+	// Calls the function with the index and the reference of each cell, where the wall with given coordinates must be placed: cells, near which it passes.
+	template<typename F> void ForEachWallCell(SGridLevel& _gridLevel, const SWallStruct::SCoordinates& _coords, F&& _function) const;
+	/* Calls the function with each cell and each wall from the list, which must be placed into this cell according to its verlet coordinates.
+	 * Walls are processed in parallel, but each cell is accessed by one thread only and receives walls in the order of the list. */
+	template<typename F> void ForEachWallCellParallel(SGridLevel& _gridLevel, const std::vector<unsigned>& _vWallIDs, F&& _function);
 	void ClearOldPositions();
-
-	void CheckCollisionPP( const SGridLevel& _gridLevel, unsigned _nX1, unsigned _nY1, unsigned _nZ1, unsigned _nX2, unsigned _nY2, unsigned _nZ2, bool _bSameCell = false );
-	void CheckCollisionPPSorted(const SGridLevel& _gridLevel, unsigned _nX1, unsigned _nY1, unsigned _nZ1, unsigned _nX2, unsigned _nY2, unsigned _nZ2, ESortCoord _dim);
+	void ClearWallsPositions();
+	void SortCellEntries();	// Sorts m_vCellEntries by keys using stable radix sort.
+
+	size_t CellsNumber(const SGridLevel& _gridLevel) const;	// Number of cells of the dense grid or of occupied cells of the sparse grid.
+	SGridCell& CellByIndex(SGridLevel& _gridLevel, size_t _index) const;	// Cell with the given linear index of the dense grid or the index in the array of occupied cells of the sparse grid.
+	static uint64_t CellKey(const SGridLevel& _gridLevel, uint64_t _nX, uint64_t _nY, uint64_t _nZ);
+	// Calculates indices of the cell, into which the point falls.
+	void GetCellIndices(const SGridLevel& _gridLevel, const CVector3& _coord, unsigned& _nX, unsigned& _nY, unsigned& _nZ) const;
+	// Returns the cell with the given indices or nullptr if it is outside the grid or empty.
+	const SGridCell* GetCell(const SGridLevel& _gridLevel, int _nX, int _nY, int _nZ) const;
+	SGridCell* GetCell(SGridLevel& _gridLevel, int _nX, int _nY, int _nZ);
+
+	void CheckCell(const SGridLevel& _gridLevel, unsigned _nX, unsigned _nY, unsigned _nZ, const SGridCell& _gridCell);	// Checks all contacts of particles from the given cell.
+	void CheckCollisionPP(const SGridCell& _cell1, const SGridCell& _cell2, bool _bSameCell = false);
+	void CheckCollisionPPSorted(const SGridLevel& _gridLevel, const SGridCell& _cell1, const SGridCell& _cell2, unsigned _axis, bool _bSameCell = false);	// Checks main-main pairs with sweep-and-prune along the axis.
+	template<typename T> void CheckCollisionPPSortedT(const SGridLevel& _gridLevel, const SGridCell& _cell1, const SGridCell& _cell2, unsigned _axis, bool _bSameCell);
+	void CheckCollisionPPSecondary(const SGridCell& _cell1, const SGridCell& _cell2, bool _bSameCell);	// Checks main-secondary pairs.
 	void CheckCollisionPW(const SGridLevel& _gridLevel, const SGridCell& _gridCell);
 
 	void AddPossibleContactPP(unsigned _iPart1, unsigned _iPart2);	// Add possible contacts into the list
@@ -124,7 +244,11 @@ private:
 
 	// remove contacts between particles "directly" connected with bonds
 	void RemoveSBContacts();
+	size_t CountActiveSolidBonds() const;
 
-	// for improved contact detection
-	void InsertParticlesToVector(std::vector<SEntry>& _vec, const std::vector<unsigned>& _partIDs, ESortCoord _dim, ESortDir _dir) const;
+	/* Decides whether sweep-and-prune is used on the grid level and, if so, sorts main particles of each cell once along each axis,
+	 * so that all pairs of cells reuse the sorted arrays. The arrays are kept in cells to reuse allocated memory between rebuilds. */
+	void PresortCells(SGridLevel& _gridLevel);
+	// Fills sorted arrays in cells of the grid level with the given precision. In single precision, coordinates are taken relative to the working domain and the margin is set.
+	template<typename T> void PresortCellsT(SGridLevel& _gridLevel);
 };
\ No newline at end of file
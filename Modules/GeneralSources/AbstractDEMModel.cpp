@@ -107,6 +107,11 @@ bool CAbstractDEMModel::HasGPUSupport() const
 	return m_hasGPUSupport;
 }
 
+bool CAbstractDEMModel::HasMixedPrecisionSupport() const
+{
+	return m_hasMixedPrecisionSupport;
+}
+
 bool CAbstractDEMModel::AddParameter(const SModelParameter& _parameter)
 {
 	if (_parameter.uniqueName.find_first_of("\t\n ") != std::string::npos) // name contains spaces
@@ -197,7 +202,15 @@ void CParticleWallModel::Precalculate(double _time, double _timeStep)
 
 void CParticleWallModel::Calculate(double _time, double _timeStep, SCollision* _collision) const
 {
-	CalculatePW(_time, _timeStep, _collision->nSrcID, _collision->nDstID, InteractionProperty(_collision->nInteractProp), _collision);
+	if (m_mixedPrecision)
+		CalculatePWMixed(_time, _timeStep, _collision->nSrcID, _collision->nDstID, InteractionProperty(_collision->nInteractProp), _collision);
+	else
+		CalculatePW(_time, _timeStep, _collision->nSrcID, _collision->nDstID, InteractionProperty(_collision->nInteractProp), _collision);
+}
+
+void CParticleWallModel::CalculatePWMixed(double _time, double _timeStep, size_t _iWall, size_t _iPart, const SInteractProps& _interactProp, SCollision* _collision) const
+{
+	CalculatePW(_time, _timeStep, _iWall, _iPart, _interactProp, _collision);
 }
 
 void CParticleWallModel::ConsolidatePart(double _time, double _timeStep, SParticleStruct& _particles, const SCollision* _collision) const
@@ -269,9 +282,9 @@ void CLiquidBondModel::Calculate(double _time, double _timeStep, size_t _iBond,
 	CalculateLB(_time, _timeStep, _bonds.LeftID(_iBond), _bonds.RightID(_iBond), _iBond, _bonds, _pBrokenBondsNum);
 }
 
-void CLiquidBondModel::Consolidate(double _time, double _timeStep, size_t _iBond, SParticleStruct& _particles) const
+void CLiquidBondModel::Consolidate(double _time, double _timeStep, size_t _iBond, size_t _iPart, SParticleStruct& _particles) const
 {
-	ConsolidatePart(_time, _timeStep, _iBond, _particles);
+	ConsolidatePart(_time, _timeStep, _iBond, _iPart, _particles);
 }
 
 
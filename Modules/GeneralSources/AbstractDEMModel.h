@@ -13,9 +13,9 @@
 #include "MUSENHelperDefines.h"
 
 #ifdef _DEBUG
-#define MUSEN_CREATE_MODEL_FUN MusenCreateModelV10Debug
+#define MUSEN_CREATE_MODEL_FUN MusenCreateModelV12Debug
 #else
-#define MUSEN_CREATE_MODEL_FUN MusenCreateModelV10
+#define MUSEN_CREATE_MODEL_FUN MusenCreateModelV12
 #endif
 #define MUSEN_CREATE_MODEL_FUN_NAME MACRO_TOSTRING(MUSEN_CREATE_MODEL_FUN)
 
@@ -79,6 +79,7 @@ public:
 	virtual void Precalculate(double _time, double _timeStep) = 0;
 
 	bool HasGPUSupport() const;
+	bool HasMixedPrecisionSupport() const;
 
 protected:
 	EMusenModelType m_type;		// Type of the model.
@@ -88,6 +89,7 @@ protected:
 	std::vector<SModelParameter> m_parameters;	// Model parameters.
 
 	bool m_hasGPUSupport;	// Indicates that this model has GPU support.
+	bool m_hasMixedPrecisionSupport{ false };	// Indicates that this model has a single-precision variant of its contact calculation.
 	SPBC m_PBC;				// Current PBC.
 
 	const CCUDADefines* m_cudaDefines{ nullptr };	// Needed to call cuda code.
@@ -106,10 +108,20 @@ class CParticleParticleModel : public CAbstractDEMModel
 {
 	SParticleStruct* m_particles{ nullptr };
 	std::vector<SInteractProps>* m_interactProps{ nullptr };
+	SCollisionFields* m_collisionFields{ nullptr };
+	bool m_mixedPrecision{ false };	// Whether the single-precision variant of the contact calculation is used.
 
 public:
 	CParticleParticleModel();
 
+	// Sets storage of optional fields of contacts, which have been requested in m_requieredVariables.
+	void SetCollisionFields(SCollisionFields* _fields) { m_collisionFields = _fields; }
+	// Selects the single-precision variant of the contact calculation. Has effect only for models with mixed precision support.
+	// For particle-particle models, this variant is provided by CParticleParticleBatchModel::CalculatePPBatchMixed().
+	void SetMixedPrecision(bool _enable) { m_mixedPrecision = _enable && m_hasMixedPrecisionSupport; }
+	// Returns whether the single-precision variant of the contact calculation is used.
+	bool IsMixedPrecision() const { return m_mixedPrecision; }
+
 	bool Initialize(SParticleStruct* _particles, SWallStruct* _walls, SSolidBondStruct* _solidBinds, SLiquidBondStruct* _liquidBonds, std::vector<SInteractProps>* _interactProps) override;
 	void Precalculate(double _time, double _timeStep) override;
 	void Calculate(double _time, double _timeStep, SCollision* _collision) const;
@@ -121,6 +133,7 @@ public:
 protected:
 	const SParticleStruct& Particles() const { return *m_particles; }
 	const SInteractProps& InteractionProperty(const size_t _i) const { return (*m_interactProps)[_i]; }
+	SCollisionFields& CollisionFields() const { return *m_collisionFields; }
 
 	virtual void PrecalculatePP(double _time, double _timeStep, SParticleStruct* _particles) {}
 	virtual void CalculatePP(double _time, double _timeStep, size_t _iSrc, size_t _iDst, const SInteractProps& _interactProp, SCollision* _collision) const = 0;
@@ -129,15 +142,47 @@ protected:
 };
 
 
+// A range of particle-particle contacts, which are calculated at once.
+// Allows models to gather the needed data into local arrays and to process them in a vectorizable loop.
+struct SPPContactsBatch
+{
+	static constexpr size_t MAX_SIZE = 64;	// Maximum number of contacts in a batch.
+
+	size_t size{ 0 };						// Current number of contacts.
+	SCollision* collisions[MAX_SIZE];		// Contacts.
+};
+
+// Optional interface of particle-particle models, which can calculate a batch of contacts at once.
+// Implemented in addition to CParticleParticleModel, so the layout of CParticleParticleModel and all models built against it remain unchanged.
+// Used by the CPU simulator only if calculation in batches or mixed precision is enabled.
+class CParticleParticleBatchModel
+{
+public:
+	virtual ~CParticleParticleBatchModel() = default;
+
+	// Calculates a batch of contacts. Must give the same results as calling CalculatePP() for each contact.
+	virtual void CalculatePPBatch(double _time, double _timeStep, const SPPContactsBatch& _batch) const = 0;
+	// Calculates a batch of contacts with relative positions, velocities and all per-contact values in single precision. By default, calls CalculatePPBatch().
+	virtual void CalculatePPBatchMixed(double _time, double _timeStep, const SPPContactsBatch& _batch) const { CalculatePPBatch(_time, _timeStep, _batch); }
+};
+
+
 class CParticleWallModel : public CAbstractDEMModel
 {
 	SParticleStruct* m_particles{ nullptr };
 	SWallStruct* m_walls{ nullptr };
 	std::vector<SInteractProps>* m_interactProps{ nullptr };
+	SCollisionFields* m_collisionFields{ nullptr };
+	bool m_mixedPrecision{ false };	// Whether the single-precision variant of the contact calculation is used.
 
 public:
 	CParticleWallModel();
 
+	// Sets storage of optional fields of contacts, which have been requested in m_requieredVariables.
+	void SetCollisionFields(SCollisionFields* _fields) { m_collisionFields = _fields; }
+	// Selects the single-precision variant of the contact calculation. Has effect only for models with mixed precision support.
+	void SetMixedPrecision(bool _enable) { m_mixedPrecision = _enable && m_hasMixedPrecisionSupport; }
+
 	bool Initialize(SParticleStruct* _particles, SWallStruct* _walls, SSolidBondStruct* _solidBinds, SLiquidBondStruct* _liquidBonds, std::vector<SInteractProps>* _interactProps) override;
 	void Precalculate(double _time, double _timeStep) override;
 	void Calculate(double _time, double _timeStep, SCollision* _collision) const;
@@ -150,9 +195,12 @@ protected:
 	const SParticleStruct& Particles() const { return *m_particles; }
 	const SWallStruct& Walls() const { return *m_walls; };
 	const SInteractProps& InteractionProperty(const size_t _i) const { return (*m_interactProps)[_i]; }
+	SCollisionFields& CollisionFields() const { return *m_collisionFields; }
 
 	virtual void PrecalculatePW(double _time, double _timeStep, SParticleStruct* _particles, SWallStruct* _walls) {}
 	virtual void CalculatePW(double _time, double _timeStep, size_t _iWall, size_t _iPart, const SInteractProps& _interactProp, SCollision* _collision) const = 0;
+	// Calculates the contact with relative positions, velocities and all per-contact values in single precision. By default, calls CalculatePW().
+	virtual void CalculatePWMixed(double _time, double _timeStep, size_t _iWall, size_t _iPart, const SInteractProps& _interactProp, SCollision* _collision) const;
 	virtual void ConsolidatePart(double _time, double _timeStep, size_t _iPart, SParticleStruct& _particles, const SCollision* _collision) const {}
 	virtual void ConsolidateWall(double _time, double _timeStep, size_t _iWall, SWallStruct& _walls, const SCollision* _collision) const {}
 };
@@ -194,7 +242,7 @@ public:
 	bool Initialize(SParticleStruct* _particles, SWallStruct* _walls, SSolidBondStruct* _solidBinds, SLiquidBondStruct* _liquidBonds, std::vector<SInteractProps>* _interactProps) override;
 	void Precalculate(double _time, double _timeStep) override;
 	void Calculate(double _time, double _timeStep, size_t _iBond, SLiquidBondStruct& _bonds, unsigned* _pBrokenBondsNum) const;
-	void Consolidate(double _time, double _timeStep, size_t _iBond, SParticleStruct& _particles) const;
+	void Consolidate(double _time, double _timeStep, size_t _iBond, size_t _iPart, SParticleStruct& _particles) const;
 
 protected:
 	const SParticleStruct& Particles() const { return *m_particles; }
@@ -202,7 +250,7 @@ protected:
 
 	virtual void PrecalculateLB(double _time, double _timeStep, SParticleStruct* _particles, SLiquidBondStruct* _bonds) {}
 	virtual void CalculateLB(double _time, double _timeStep, size_t _iLeft, size_t _iRight, size_t _iBond, SLiquidBondStruct& _bonds, unsigned* _pBrokenBondsNum) const = 0;
-	virtual void ConsolidatePart(double _time, double _timeStep, size_t _iBond, SParticleStruct& _particles) const {}
+	virtual void ConsolidatePart(double _time, double _timeStep, size_t _iBond, size_t _iPart, SParticleStruct& _particles) const {}
 };
 
 
@@ -0,0 +1,53 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/*
+ * Allocator for arrays, which are processed in tight loops. The memory block starts at the boundary of a cache line and is padded up to the
+ * whole number of cache lines, so that vector loads never cross the beginning or the end of the allocated block and arrays of different
+ * objects never share a cache line.
+ */
+template<typename T, size_t Alignment = 64>
+class CAlignedAllocator
+{
+	static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two, not less than alignment of T");
+
+public:
+	using value_type = T;
+
+	template<typename U>
+	struct rebind { using other = CAlignedAllocator<U, Alignment>; };
+
+	CAlignedAllocator() noexcept = default;
+	template<typename U>
+	CAlignedAllocator(const CAlignedAllocator<U, Alignment>&) noexcept {}
+
+	// Allocates memory for _n objects, rounded up to the whole number of alignment blocks.
+	T* allocate(size_t _n)
+	{
+		return static_cast<T*>(::operator new(PaddedSize(_n), std::align_val_t{ Alignment }));
+	}
+
+	void deallocate(T* _p, size_t _n) noexcept
+	{
+		::operator delete(_p, PaddedSize(_n), std::align_val_t{ Alignment });
+	}
+
+	template<typename U>
+	bool operator==(const CAlignedAllocator<U, Alignment>&) const noexcept { return true; }
+	template<typename U>
+	bool operator!=(const CAlignedAllocator<U, Alignment>&) const noexcept { return false; }
+
+private:
+	static size_t PaddedSize(size_t _n) { return (_n * sizeof(T) + Alignment - 1) / Alignment * Alignment; }
+};
+
+// Vector with cache line aligned and padded storage.
+template<typename T>
+using aligned_vector = std::vector<T, CAlignedAllocator<T>>;
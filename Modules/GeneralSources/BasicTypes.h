@@ -26,6 +26,7 @@ struct SSelectiveSavingFlags
 	bool bForce         = true;
 	bool bTensor        = true;
 	bool bTemperature   = false;
+	unsigned nTensorStep = 1;	// stress tensors are calculated and saved only at every N-th saved time point
 	// solid bonds
 	bool bSBForce       = true;
 	bool bSBTangOverlap = true;
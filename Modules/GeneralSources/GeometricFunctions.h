@@ -256,6 +256,17 @@ enum class EIntersectionType : int8_t
 	VERTEX_CONTACT = 3,
 };
 
+// returns false if the sphere does not intersect the triangle: it is outside the extended bounding box or too far from the plane of the triangle.
+// the conditions are the same as the first checks in IsSphereIntersectTriangle(), but are evaluated without branches, to cull candidates in batches
+inline bool IsSphereNearTriangle(const SWallStruct::SCoordinates& _wallCoords, const CVector3& _wallNormalVec, const CVector3& _partCoord, const double _partRadius)
+{
+	const CVector3 center = (_wallCoords.vert1 + _wallCoords.vert2 + _wallCoords.vert3) / 3.0;
+	const double ppd = DotProduct(_partCoord - center, _wallNormalVec);
+	return (_partCoord.x > _wallCoords.minCoord.x - _partRadius) & (_partCoord.y > _wallCoords.minCoord.y - _partRadius) & (_partCoord.z > _wallCoords.minCoord.z - _partRadius)
+		 & (_partCoord.x < _wallCoords.maxCoord.x + _partRadius) & (_partCoord.y < _wallCoords.maxCoord.y + _partRadius) & (_partCoord.z < _wallCoords.maxCoord.z + _partRadius)
+		 & (std::fabs(ppd) < _partRadius);
+}
+
 // return 0 - no contact, 1 - face contact, 2 - edge contact, 3 - vertices contact
 // from publication of Su et al. Discrete element simulation of particle flow
 inline std::pair<EIntersectionType, CVector3> IsSphereIntersectTriangle(const SWallStruct::SCoordinates& _wallCoords, const CVector3& _wallNormalVec,
@@ -319,6 +330,35 @@ inline std::pair<EIntersectionType, CVector3> IsSphereIntersectTriangle(const SW
 	}
 }
 
+// checks whether an axis-aligned box intersects a triangle, using the separating axis test of Akenine-Moeller:
+// axes of the box, normal of the triangle and cross products of axes of the box with edges of the triangle
+inline bool IsBoxIntersectTriangle(const CVector3& _boxCenter, const CVector3& _boxHalfSize, const SWallStruct::SCoordinates& _wallCoords)
+{
+	if (_wallCoords.minCoord.x > _boxCenter.x + _boxHalfSize.x || _wallCoords.maxCoord.x < _boxCenter.x - _boxHalfSize.x
+	 || _wallCoords.minCoord.y > _boxCenter.y + _boxHalfSize.y || _wallCoords.maxCoord.y < _boxCenter.y - _boxHalfSize.y
+	 || _wallCoords.minCoord.z > _boxCenter.z + _boxHalfSize.z || _wallCoords.maxCoord.z < _boxCenter.z - _boxHalfSize.z)
+		return false;
+
+	const CVector3 v0 = _wallCoords.vert1 - _boxCenter;
+	const CVector3 v1 = _wallCoords.vert2 - _boxCenter;
+	const CVector3 v2 = _wallCoords.vert3 - _boxCenter;
+	// returns true if projections of the triangle and the box onto the axis do not overlap
+	const auto IsSeparated = [&](const CVector3& _axis)
+	{
+		const double p0 = DotProduct(_axis, v0), p1 = DotProduct(_axis, v1), p2 = DotProduct(_axis, v2);
+		const double r = _boxHalfSize.x * std::fabs(_axis.x) + _boxHalfSize.y * std::fabs(_axis.y) + _boxHalfSize.z * std::fabs(_axis.z);
+		return std::min({ p0, p1, p2 }) > r || std::max({ p0, p1, p2 }) < -r;
+	};
+
+	const CVector3 edges[3]{ v1 - v0, v2 - v1, v0 - v2 };
+	if (IsSeparated(edges[0] * edges[1]))
+		return false;
+	for (const CVector3& e : edges)
+		if (IsSeparated(CVector3{ 0, -e.z, e.y }) || IsSeparated(CVector3{ e.z, 0, -e.x }) || IsSeparated(CVector3{ -e.y, e.x, 0 }))
+			return false;
+	return true;
+}
+
 namespace
 {
 	CUDA_DEVICE bool IsPointInDomain(const SVolumeType& _vDomain, const CVector3& _vPoint)
@@ -4,7 +4,7 @@
 
 #pragma once
 
-#define MDEM_FILE_VERSION 2		// Current version of .mdem-file (+quaternion, +stress tensor, -angles, -accelerations).
+#define MDEM_FILE_VERSION 3		// Current version of .mdem-file (+quaternion, +stress tensor, -angles, -accelerations, +columnar blocks).
 
 #define PI          3.14159265358979323846
 #define PI_180      0.0174532925
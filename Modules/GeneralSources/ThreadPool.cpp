@@ -4,8 +4,9 @@
 
 #include "ThreadPool.h"
 #include "MUSENVectorFunctions.h"
+#include <algorithm>
+#include <chrono>
 #include <limits>
-#include <future>
 #include <iostream>
 #include <string>
 #ifdef __linux__
@@ -19,6 +20,25 @@
 #endif
 
 constexpr size_t MIN_NONDEDICATED_THREADS = 8;
+constexpr size_t LANE_BITS = 24;											// Number of bits to store begin and end of the range in a lane.
+constexpr uint64_t LANE_MASK = (uint64_t{ 1 } << LANE_BITS) - 1;			// Mask to extract begin and end of the range from a lane.
+constexpr size_t MAX_BATCH_SIZE = static_cast<size_t>(LANE_MASK);		// Maximum number of indices distributed at once; larger jobs are split into several batches.
+constexpr size_t CHUNK_DIVISOR = 16;										// A worker takes 1/CHUNK_DIVISOR of the remaining own range at once.
+constexpr size_t SPIN_COUNT = 128;											// Number of yields before a thread goes to sleep while waiting.
+
+namespace
+{
+	thread_local size_t t_threadIndex = 0;								// Index of the worker thread.
+	thread_local const ThreadPool::CThreadPool* t_threadPool = nullptr;	// Pool the worker thread belongs to.
+
+	uint64_t PackLane(uint64_t _epoch, uint64_t _begin, uint64_t _end)
+	{
+		return (_epoch & 0xFFFF) << 2 * LANE_BITS | _begin << LANE_BITS | _end;
+	}
+	uint64_t LaneEpoch(uint64_t _lane) { return _lane >> 2 * LANE_BITS; }
+	size_t LaneBegin(uint64_t _lane) { return static_cast<size_t>(_lane >> LANE_BITS & LANE_MASK); }
+	size_t LaneEnd(uint64_t _lane) { return static_cast<size_t>(_lane & LANE_MASK); }
+}
 
 size_t ThreadPool::CThreadPool::m_globalThreadsLimit = std::numeric_limits<size_t>::max();
 bool ThreadPool::CThreadPool::m_isSystemAffinities = false;
@@ -46,8 +66,10 @@ ThreadPool::CThreadPool::CThreadPool(size_t _threads)
 #endif
 	// create threads
 	std::cout << " Creating thread pool ... ";
+	m_lanes = std::make_unique<SLane[]>(_threads);
+	m_busyTimes = std::make_unique<SBusyTime[]>(_threads);
 	for (size_t i = 0; i < _threads; ++i)
-		m_threads.emplace_back(&CThreadPool::Worker, this);
+		m_threads.emplace_back(&CThreadPool::Worker, this, i);
 	std::cout << "successful" << std::endl;
 	// print info
 	PrintCPUListsInfo();
@@ -60,8 +82,12 @@ ThreadPool::CThreadPool::CThreadPool(size_t _threads)
 
 ThreadPool::CThreadPool::~CThreadPool()
 {
-	// invalidate the queue
-	m_workQueue.Invalidate();
+	// signal all threads to finish
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_stop = true;
+	}
+	m_wakeEvent.notify_all();
 	// join all running threads
 	for (auto& thread : m_threads)
 		if (thread.joinable())
@@ -91,59 +117,173 @@ size_t ThreadPool::CThreadPool::GetCurrentThreadsNumber() const
 	return m_threads.size();
 }
 
-void ThreadPool::CThreadPool::SubmitParallelJobs(size_t _count, const std::function<void(size_t)>& _fun)
+size_t ThreadPool::CThreadPool::GetCurrentThreadIndex()
 {
-	using FunType = std::function<void()>;
+	return t_threadIndex;
+}
 
-	// number of available threads
-	const size_t threadsNumber = m_threads.size();
-	// number of tasks per thread
-	const size_t tasksPerThread = _count / threadsNumber;
-	// additional tasks, arising if the number of tasks is not evenly distributable by all threads
-	const size_t additionalTasks = _count % threadsNumber;
+void ThreadPool::CThreadPool::SetBusyTimeMeasurement(bool _enable)
+{
+	m_measureBusyTime.store(_enable, std::memory_order_relaxed);
+}
 
-	int result_counter{ 0 };
-	std::mutex wait_mutex;
-	std::unique_lock<std::mutex> lock(wait_mutex);
-	std::condition_variable wait_event;
+void ThreadPool::CThreadPool::GetBusyTimes(std::vector<double>& _times) const
+{
+	_times.resize(m_threads.size());
+	for (size_t i = 0; i < m_threads.size(); ++i)
+		_times[i] = static_cast<double>(m_busyTimes[i].time.load(std::memory_order_relaxed)) * 1e-9;
+}
 
-	for (size_t iThread = 0; iThread < threadsNumber; ++iThread)
+void ThreadPool::CThreadPool::Execute(size_t _count, RangeFunction _function, void* _context)
+{
+	if (_count == 0) return;
+	// nested call from a worker of this pool: execute serially on the calling thread
+	if (t_threadPool == this || m_threads.empty())
 	{
-		size_t size = tasksPerThread;
-		if (additionalTasks > iThread) ++size;
-		if (size == 0) break;
+		_function(_context, 0, _count);
+		return;
+	}
 
-		result_counter++;
+	// only one job at a time can be distributed among the workers
+	std::lock_guard<std::mutex> submitLock(m_submitMutex);
+	const size_t lanesNumber = m_threads.size();
+	for (size_t offset = 0; offset < _count; offset += MAX_BATCH_SIZE)
+	{
+		const size_t size = std::min(_count - offset, MAX_BATCH_SIZE);
+		m_jobFunction = _function;
+		m_jobContext = _context;
+		m_jobOffset = offset;
+		m_pending.store(size, std::memory_order_relaxed);
+
+		// split the batch into contiguous lanes of equal size
+		const uint32_t epoch = m_epoch.load(std::memory_order_relaxed) + 1;
+		for (size_t i = 0; i < lanesNumber; ++i)
+			m_lanes[i].range.store(PackLane(epoch, size * i / lanesNumber, size * (i + 1) / lanesNumber), std::memory_order_release);
+
+		// wake up workers
+		{
+			std::lock_guard<std::mutex> lock(m_wakeMutex);
+			m_epoch.store(epoch, std::memory_order_release);
+		}
+		m_wakeEvent.notify_all();
+
+		// wait until all indices are executed
+		for (size_t i = 0; i < SPIN_COUNT && m_pending.load(std::memory_order_acquire) != 0; ++i)
+			std::this_thread::yield();
+		if (m_pending.load(std::memory_order_acquire) != 0)
+		{
+			std::unique_lock<std::mutex> lock(m_wakeMutex);
+			m_doneEvent.wait(lock, [this] { return m_pending.load(std::memory_order_acquire) == 0; });
+		}
+	}
+}
 
-		// the batch task
-		FunType task = [iThread, threadsNumber, size, &_fun, &result_counter, &wait_event, &wait_mutex]()
+void ThreadPool::CThreadPool::ProcessLanes(size_t _iThread)
+{
+	size_t begin, end;
+	uint64_t epoch;
+	while (true)
+	{
+		if (PopChunk(_iThread, begin, end))
+		{
+			RunChunk(begin, end);
+			continue;
+		}
+		if (!StealChunk(_iThread, begin, end, epoch))
+			return;
+		// publish the stolen range in the own empty lane, so that other workers can steal from it as well
+		uint64_t own = m_lanes[_iThread].range.load(std::memory_order_acquire);
+		if (end - begin > 1 && LaneEpoch(own) == epoch && LaneBegin(own) >= LaneEnd(own)
+			&& m_lanes[_iThread].range.compare_exchange_strong(own, PackLane(epoch, begin, end), std::memory_order_acq_rel))
+			continue;
+		// the own lane has been meanwhile reassigned - execute the stolen range directly
+		RunChunk(begin, end);
+	}
+}
+
+bool ThreadPool::CThreadPool::PopChunk(size_t _iLane, size_t& _begin, size_t& _end) const
+{
+	std::atomic<uint64_t>& lane = m_lanes[_iLane].range;
+	uint64_t curr = lane.load(std::memory_order_acquire);
+	while (true)
+	{
+		const size_t begin = LaneBegin(curr);
+		const size_t end = LaneEnd(curr);
+		if (begin >= end) return false;
+		// take a part of the remaining range, so that chunks become smaller towards the end and can be better balanced
+		const size_t chunk = std::max(size_t{ 1 }, (end - begin) / CHUNK_DIVISOR);
+		if (lane.compare_exchange_weak(curr, PackLane(LaneEpoch(curr), begin + chunk, end), std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			_begin = begin;
+			_end = begin + chunk;
+			return true;
+		}
+	}
+}
+
+bool ThreadPool::CThreadPool::StealChunk(size_t _iThread, size_t& _begin, size_t& _end, uint64_t& _epoch) const
+{
+	const size_t lanesNumber = m_threads.size();
+	for (size_t i = 1; i < lanesNumber; ++i)
+	{
+		std::atomic<uint64_t>& lane = m_lanes[(_iThread + i) % lanesNumber].range;
+		uint64_t curr = lane.load(std::memory_order_acquire);
+		while (true)
 		{
-			// call the _fun tasksPerThread times increasing the parameter
-			for (size_t j = 0; j < size; ++j)
-				_fun(threadsNumber*j + iThread);
-
-			std::unique_lock<std::mutex> lock_task(wait_mutex);
-			--result_counter;
-			if (result_counter == 0)
-				wait_event.notify_all();
-		};
-
-		// submit the batch task
-		m_workQueue.Push(std::make_unique<CThreadTask<const FunType>>(std::move(task)));
+			const size_t begin = LaneBegin(curr);
+			const size_t end = LaneEnd(curr);
+			if (begin >= end) break;
+			// take the back half of the victim's range
+			const size_t middle = begin + (end - begin) / 2;
+			if (lane.compare_exchange_weak(curr, PackLane(LaneEpoch(curr), begin, middle), std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				_begin = middle;
+				_end = end;
+				_epoch = LaneEpoch(curr);
+				return true;
+			}
+		}
 	}
+	return false;
+}
 
-	// wait all batch tasks to finish
-	while (result_counter != 0)
-		wait_event.wait(lock);
+void ThreadPool::CThreadPool::RunChunk(size_t _begin, size_t _end)
+{
+	if (m_measureBusyTime.load(std::memory_order_relaxed))
+	{
+		const auto start = std::chrono::steady_clock::now();
+		m_jobFunction(m_jobContext, m_jobOffset + _begin, m_jobOffset + _end);
+		// published before the chunk is marked as done, so the submitting thread sees it after the job is finished
+		const auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		m_busyTimes[t_threadIndex].time.fetch_add(static_cast<uint64_t>(time), std::memory_order_relaxed);
+	}
+	else
+		m_jobFunction(m_jobContext, m_jobOffset + _begin, m_jobOffset + _end);
+	// the last finished chunk wakes up the submitting thread
+	if (m_pending.fetch_sub(_end - _begin, std::memory_order_acq_rel) == _end - _begin)
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_doneEvent.notify_one();
+	}
 }
 
-void ThreadPool::CThreadPool::Worker()
+void ThreadPool::CThreadPool::Worker(size_t _iThread)
 {
+	t_threadIndex = _iThread;
+	t_threadPool = this;
+	uint32_t epoch = 0;
 	while (true)
 	{
-		std::unique_ptr<IThreadTask> task{ nullptr };
-		if (!m_workQueue.WaitPop(task)) break; // if the queue has been invalidated, finish queuing jobs
-		task->Execute();
+		// wait for a new batch: first actively, then go to sleep
+		for (size_t i = 0; i < SPIN_COUNT && m_epoch.load(std::memory_order_acquire) == epoch && !m_stop; ++i)
+			std::this_thread::yield();
+		{
+			std::unique_lock<std::mutex> lock(m_wakeMutex);
+			m_wakeEvent.wait(lock, [&] { return m_stop || m_epoch.load(std::memory_order_acquire) != epoch; });
+			if (m_stop) return;
+			epoch = m_epoch.load(std::memory_order_acquire);
+		}
+		ProcessLanes(_iThread);
 	}
 }
 
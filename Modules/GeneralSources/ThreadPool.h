@@ -4,18 +4,58 @@
 
 #pragma once
 
-#include "ThreadSafeQueue.h"
-#include "ThreadTask.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace ThreadPool
 {
+	/*
+	 * Pool of threads executing parallel loops.
+	 * Each submitted range of indices is split into contiguous parts, one per worker (lane). Workers take chunks from the front of their own lanes
+	 * and, when their lanes are empty, steal the back half of the lane of another worker. All lanes are single atomic words, so no locks are needed
+	 * while executing a loop; the mutex and condition variables are only used to put idle threads to sleep and to wake them up.
+	 */
 	class CThreadPool
 	{
-		static size_t m_globalThreadsLimit;							/// Maximum number of threads available for this instance of program.
-		CThreadSafeQueue<std::unique_ptr<IThreadTask>> m_workQueue;	/// Queue of submitted works.
-		std::vector<std::thread> m_threads;							/// List of available threads.
+		/// Function executing the submitted job for indices [_begin; _end).
+		using RangeFunction = void(*)(void* _context, size_t _begin, size_t _end);
+
+		/// State of a single lane: [epoch:16 | begin:24 | end:24]. Aligned to avoid false sharing between workers.
+		struct alignas(64) SLane
+		{
+			std::atomic<uint64_t> range{ 0 };
+		};
+
+		/// Time [ns] a worker has spent executing jobs. Written only by its owner. Aligned to avoid false sharing between workers.
+		struct alignas(64) SBusyTime
+		{
+			std::atomic<uint64_t> time{ 0 };
+		};
+
+		static size_t m_globalThreadsLimit;			/// Maximum number of threads available for this instance of program.
+		std::vector<std::thread> m_threads;			/// List of available threads.
+
+		std::unique_ptr<SLane[]> m_lanes;			/// Per-thread ranges of indices still to be executed.
+		std::unique_ptr<SBusyTime[]> m_busyTimes;	/// Per-thread time spent executing jobs, if measured.
+		std::atomic<bool> m_measureBusyTime{ false };	/// Whether to measure the time each thread spends executing jobs.
+		RangeFunction m_jobFunction{ nullptr };		/// Function of the currently executed job.
+		void* m_jobContext{ nullptr };				/// Context passed to the function of the currently executed job.
+		size_t m_jobOffset{ 0 };					/// Offset of the current batch of indices within the whole job.
+		std::atomic<size_t> m_pending{ 0 };			/// Number of indices of the current batch, which are not yet executed.
+		std::atomic<uint32_t> m_epoch{ 0 };			/// Counter of submitted batches, used to wake up workers.
+		std::atomic<bool> m_stop{ false };			/// Signals workers to finish.
+		std::mutex m_submitMutex;					/// Serializes jobs submitted from different threads.
+		std::mutex m_wakeMutex;						/// Protects sleeping and waking up of threads.
+		std::condition_variable m_wakeEvent;		/// Wakes up workers when a new batch is submitted.
+		std::condition_variable m_doneEvent;		/// Wakes up the submitting thread when the batch is finished.
 
 		static bool m_isSystemAffinities;			/// Master process successfully set affinities taken from system. Takes precedence over user settings.
 		static bool m_isUserAffinities;				/// User has specified cores that system is supposed to run on.
@@ -50,12 +90,46 @@ namespace ThreadPool
 		/// Returns the supposed list of cores to run on. Information is taken from the system or starting parameters.
 		static std::vector<int> GetSystemCPUList();
 
+		/// Returns index of the calling worker thread in range [0; GetCurrentThreadsNumber()). Returns 0 for threads not belonging to the pool.
+		static size_t GetCurrentThreadIndex();
+
+		/// Turns on or off measuring of the time each thread spends executing jobs.
+		void SetBusyTimeMeasurement(bool _enable);
+		/// Returns the total time [s] each thread has spent executing jobs while the measurement was on.
+		void GetBusyTimes(std::vector<double>& _times) const;
+
 		/// Submits _count of identical jobs, running _fun(i) _count times with i = [0; count).
-		void SubmitParallelJobs(size_t _count, const std::function<void(size_t)>& _fun);
+		template<typename F>
+		void SubmitParallelJobs(size_t _count, F&& _fun)
+		{
+			using FunType = std::remove_reference_t<F>;
+			auto* context = const_cast<void*>(static_cast<const void*>(std::addressof(_fun)));
+			Execute(_count, &RunRange<FunType>, context);
+		}
 
 	private:
-		/// Constantly running function, which each thread uses to acquire work items from the queue.
-		void Worker();
+		/// Calls _fun(i) for all i = [_begin; _end).
+		template<typename F>
+		static void RunRange(void* _context, size_t _begin, size_t _end)
+		{
+			F& fun = *static_cast<F*>(_context);
+			for (size_t i = _begin; i < _end; ++i)
+				fun(i);
+		}
+
+		/// Runs _function on all indices [0; _count), distributing them among workers, and waits for the result.
+		void Execute(size_t _count, RangeFunction _function, void* _context);
+		/// Executes chunks from the own lane and steals from other lanes until no work remains.
+		void ProcessLanes(size_t _iThread);
+		/// Tries to take a chunk from the front of the lane. Returns false if the lane is empty.
+		bool PopChunk(size_t _iLane, size_t& _begin, size_t& _end) const;
+		/// Tries to take the back half of the lane of another worker. Returns false if nothing could be stolen.
+		bool StealChunk(size_t _iThread, size_t& _begin, size_t& _end, uint64_t& _epoch) const;
+		/// Executes the job for indices [_begin; _end) of the current batch and marks them as done.
+		void RunChunk(size_t _begin, size_t _end);
+
+		/// Constantly running function, which each thread uses to acquire work items.
+		void Worker(size_t _iThread);
 
 		/// Creates the list of cores to run on. Information is taken from the system or starting parameters.
 		static void SetSystemCPUList();
@@ -94,15 +168,17 @@ inline void RestartThreadPool()
 }
 
 /// Submits _count of identical jobs, running function _fun(i) _count times with i = [0; _count).
-inline void ParallelFor(size_t _count, const std::function<void(size_t)>& _fun)
+template<typename F>
+void ParallelFor(size_t _count, F&& _fun)
 {
-	return GetThreadPool().SubmitParallelJobs(_count, _fun);
+	GetThreadPool().SubmitParallelJobs(_count, std::forward<F>(_fun));
 }
 
 /// Submits identical jobs, in an amount equal to the number of available threads (N), running function _fun(i) N times with i = [0; N).
-inline void ParallelFor(const std::function<void(size_t)>& _fun)
+template<typename F>
+void ParallelFor(F&& _fun)
 {
-	return GetThreadPool().SubmitParallelJobs(GetThreadPool().GetCurrentThreadsNumber(), _fun);
+	GetThreadPool().SubmitParallelJobs(GetThreadPool().GetCurrentThreadsNumber(), std::forward<F>(_fun));
 }
 
 /// Returns number of defined threads.
@@ -110,3 +186,71 @@ inline size_t GetThreadsNumber()
 {
 	return GetThreadPool().GetCurrentThreadsNumber();
 }
+
+/// Returns index of the current worker thread in range [0; GetThreadsNumber()), to be used for per-thread buffers inside ParallelFor.
+inline size_t GetCurrentThreadIndex()
+{
+	return ThreadPool::CThreadPool::GetCurrentThreadIndex();
+}
+
+/// Reduces values _map(i) for i = [0; _count) with the binary operation _reduce, starting from _init.
+/// The range is split into blocks of a fixed size, which are reduced in parallel into own partial results and then combined in their order.
+/// So no atomics are needed, and the result does not depend on the number of threads, also for non-associative operations, like sums of doubles.
+template<typename T, typename M, typename R>
+T ParallelReduce(size_t _count, T _init, M&& _map, R&& _reduce)
+{
+	constexpr size_t blockSize = 4096;
+	const size_t blocksNumber = (_count + blockSize - 1) / blockSize;
+	// reduces a non-empty block without _init, so that _init enters the result only once
+	const auto ReduceBlock = [&](size_t _begin, size_t _end)
+	{
+		T res = _map(_begin);
+		for (size_t i = _begin + 1; i < _end; ++i)
+			res = _reduce(res, _map(i));
+		return res;
+	};
+	if (_count == 0)
+		return _init;
+	// with a single thread, blocks are reduced in place, in the same order, to avoid dispatching to the pool
+	if (blocksNumber == 1 || GetThreadsNumber() <= 1)
+	{
+		T res = _init;
+		for (size_t iBlock = 0; iBlock < blocksNumber; ++iBlock)
+			res = _reduce(res, ReduceBlock(iBlock * blockSize, std::min((iBlock + 1) * blockSize, _count)));
+		return res;
+	}
+	// partial results of small ranges are kept on the stack to avoid allocation at each call
+	constexpr size_t maxStackBlocks = 256;
+	std::array<T, maxStackBlocks> stackPartials;
+	std::vector<T> heapPartials(blocksNumber > maxStackBlocks ? blocksNumber : 0);
+	T* partials = blocksNumber > maxStackBlocks ? heapPartials.data() : stackPartials.data();
+	ParallelFor(blocksNumber, [&](size_t iBlock)
+	{
+		partials[iBlock] = ReduceBlock(iBlock * blockSize, std::min((iBlock + 1) * blockSize, _count));
+	});
+	T res = _init;
+	for (size_t iBlock = 0; iBlock < blocksNumber; ++iBlock)
+		res = _reduce(res, partials[iBlock]);
+	return res;
+}
+
+/// Returns the maximum of _init and all values _map(i) for i = [0; _count), calculated in parallel.
+template<typename T, typename M>
+T ParallelMax(size_t _count, T _init, M&& _map)
+{
+	return ParallelReduce(_count, _init, std::forward<M>(_map), [](const T& _a, const T& _b) { return std::max(_a, _b); });
+}
+
+/// Returns the minimum of _init and all values _map(i) for i = [0; _count), calculated in parallel.
+template<typename T, typename M>
+T ParallelMin(size_t _count, T _init, M&& _map)
+{
+	return ParallelReduce(_count, _init, std::forward<M>(_map), [](const T& _a, const T& _b) { return std::min(_a, _b); });
+}
+
+/// Returns the sum of _init and all values _map(i) for i = [0; _count), calculated in parallel.
+template<typename T, typename M>
+T ParallelSum(size_t _count, T _init, M&& _map)
+{
+	return ParallelReduce(_count, _init, std::forward<M>(_map), [](const T& _a, const T& _b) { return _a + _b; });
+}
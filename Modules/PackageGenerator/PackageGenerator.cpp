@@ -399,6 +399,7 @@ void CPackageGenerator::SetupSimulator(SPackage& _generator, CSystemStructure& _
 	_generator.simulator->SetEndTime(1.0);									// simulation time
 	_generator.simulator->SetVerletCoeff(m_verletCoeff);					// verlet coefficient
 	_generator.simulator->SetAutoAdjustFlag(false);							// auto adjust verlet distance flag
+	_generator.simulator->SetSavingBuffers(0);								// save synchronously, results are read right after saving
 }
 
 void CPackageGenerator::SaveGeneratedObjects(SPackage& _generator) const
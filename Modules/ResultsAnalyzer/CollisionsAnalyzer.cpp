@@ -39,7 +39,7 @@ void CCollisionsAnalyzer::Finalize()
 		m_Storage.FlushAndCloseFile();
 }
 
-void CCollisionsAnalyzer::AddCollisions(const std::vector<SCollision*>& _vCollisionsPP, const std::vector<SCollision*>& _vCollisionsPW)
+void CCollisionsAnalyzer::AddCollisions(const std::vector<SCollision*>& _vCollisionsPP, const std::vector<SCollision*>& _vCollisionsPW, const SCollisionFields& _fields)
 {
 	if (!m_Storage.IsValid()) return;	// nowhere to save
 	if (_vCollisionsPP.empty() && _vCollisionsPW.empty()) return;	// nothing to save
@@ -52,27 +52,28 @@ void CCollisionsAnalyzer::AddCollisions(const std::vector<SCollision*>& _vCollis
 	vAllCollisions.insert(vAllCollisions.end(), _vCollisionsPP.begin(), _vCollisionsPP.end());
 	vAllCollisions.insert(vAllCollisions.end(), _vCollisionsPW.begin(), _vCollisionsPW.end());
 
-	double dMinTime = vAllCollisions.front()->pSave->dTimeStart;	// minimum start time of collision in current block
-	double dMaxTime = vAllCollisions.front()->pSave->dTimeStart;	// maximum end time of collision in current block
+	double dMinTime = _fields.Save(vAllCollisions.front())->dTimeStart;	// minimum start time of collision in current block
+	double dMaxTime = _fields.Save(vAllCollisions.front())->dTimeStart;	// maximum end time of collision in current block
 	for (size_t i = 0; i < vAllCollisions.size(); ++i)
 	{
-		if (vAllCollisions[i]->pSave->dTimeStart < dMinTime)
-			dMinTime = vAllCollisions[i]->pSave->dTimeStart;
-		if (vAllCollisions[i]->pSave->dTimeEnd > dMaxTime)
-			dMaxTime = vAllCollisions[i]->pSave->dTimeEnd;
+		const SSavedCollision* save = _fields.Save(vAllCollisions[i]);
+		if (save->dTimeStart < dMinTime)
+			dMinTime = save->dTimeStart;
+		if (save->dTimeEnd > dMaxTime)
+			dMaxTime = save->dTimeEnd;
 
 		ProtoCollision *pCurrColl = data.add_collisions();
 
 		pCurrColl->set_src_id(vAllCollisions[i]->nSrcID);
 		pCurrColl->set_dst_id(vAllCollisions[i]->nDstID);
-		pCurrColl->set_time_start(vAllCollisions[i]->pSave->dTimeStart);
-		pCurrColl->set_time_end(vAllCollisions[i]->pSave->dTimeEnd);
-		Val2Proto(pCurrColl->mutable_max_total_force(), vAllCollisions[i]->pSave->vMaxTotalForce);
-		Val2Proto(pCurrColl->mutable_max_norm_force(), vAllCollisions[i]->pSave->vMaxNormForce);
-		Val2Proto(pCurrColl->mutable_max_tang_force(), vAllCollisions[i]->pSave->vMaxTangForce);
-		Val2Proto(pCurrColl->mutable_norm_velocity(), vAllCollisions[i]->pSave->vNormVelocity);
-		Val2Proto(pCurrColl->mutable_tang_velocity(), vAllCollisions[i]->pSave->vTangVelocity);
-		Val2Proto(pCurrColl->mutable_contact_point(), vAllCollisions[i]->pSave->vContactPoint);
+		pCurrColl->set_time_start(save->dTimeStart);
+		pCurrColl->set_time_end(save->dTimeEnd);
+		Val2Proto(pCurrColl->mutable_max_total_force(), save->vMaxTotalForce);
+		Val2Proto(pCurrColl->mutable_max_norm_force(), save->vMaxNormForce);
+		Val2Proto(pCurrColl->mutable_max_tang_force(), save->vMaxTangForce);
+		Val2Proto(pCurrColl->mutable_norm_velocity(), save->vNormVelocity);
+		Val2Proto(pCurrColl->mutable_tang_velocity(), save->vTangVelocity);
+		Val2Proto(pCurrColl->mutable_contact_point(), save->vContactPoint);
 	}
 
 	descr.set_time_min(dMinTime);
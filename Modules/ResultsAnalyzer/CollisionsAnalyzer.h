@@ -32,7 +32,7 @@ public:
 	void Finalize();
 
 	// Add new set of collisions to analyzer.
-	void AddCollisions(const std::vector<SCollision*>& _vCollisionsPP, const std::vector<SCollision*>& _vCollisionsPW);
+	void AddCollisions(const std::vector<SCollision*>& _vCollisionsPP, const std::vector<SCollision*>& _vCollisionsPW, const SCollisionFields& _fields);
 
 	// Save some data into text file
 	bool Export() override;
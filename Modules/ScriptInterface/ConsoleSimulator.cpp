@@ -164,6 +164,8 @@ void CConsoleSimulator::SetupSimulationManager()
 
 	if (m_simulatorManager.GetSimulatorPtr()->GetType() == ESimulatorType::CPU && m_job.saveCollsionsFlag == true)
 		dynamic_cast<CCPUSimulator*>(m_simulatorManager.GetSimulatorPtr())->EnableCollisionsAnalysis(m_job.saveCollsionsFlag.ToBool());
+	if (m_simulatorManager.GetSimulatorPtr()->GetType() == ESimulatorType::CPU && m_job.batchContactsFlag.IsDefined())
+		dynamic_cast<CCPUSimulator*>(m_simulatorManager.GetSimulatorPtr())->EnableBatchContacts(m_job.batchContactsFlag.ToBool());
 
 	// Converts a time factor relative to a recommended time step to a time value
 	auto FactorToTime = [&](double _factor) {
@@ -185,6 +187,13 @@ void CConsoleSimulator::SetupSimulationManager()
 	else if (m_job.dEndSimulationTime != 0.0)
 		m_simulatorManager.GetSimulatorPtr()->SetEndTime(m_job.dEndSimulationTime);
 
+	// set saving in background
+	if (m_job.savingBuffers >= 0)		m_simulatorManager.GetSimulatorPtr()->SetSavingBuffers(static_cast<size_t>(m_job.savingBuffers));
+
+	// set profiling
+	if (!m_job.profileFileName.empty())	m_simulatorManager.GetSimulatorPtr()->SetProfilingFile(m_job.profileFileName);
+	if (m_job.profileInterval >= 0)		m_simulatorManager.GetSimulatorPtr()->SetProfilingInterval(m_job.profileInterval);
+
 	// set acceleration
 	if (!m_job.vExtAccel.IsInf())		m_simulatorManager.GetSimulatorPtr()->SetExternalAccel(m_job.vExtAccel);
 
@@ -192,12 +201,31 @@ void CConsoleSimulator::SetupSimulationManager()
 	if (m_job.verletAutoFlag.IsDefined())	m_simulatorManager.GetSimulatorPtr()->SetAutoAdjustFlag(m_job.verletAutoFlag.ToBool());
 	if (m_job.verletCoef != 0)				m_simulatorManager.GetSimulatorPtr()->SetVerletCoeff(m_job.verletCoef);
 	if (m_job.iVerletMaxCells != 0)			m_simulatorManager.GetSimulatorPtr()->SetMaxCells(m_job.iVerletMaxCells);
+	if (m_job.verletSparseGrid.IsDefined())	m_simulatorManager.GetSimulatorPtr()->SetVerletGridType(m_job.verletSparseGrid.ToBool() ? EVerletGridType::SPARSE : EVerletGridType::DENSE);
+	if (m_job.verletIncremental.IsDefined())	m_simulatorManager.GetSimulatorPtr()->SetIncrementalVerletFlag(m_job.verletIncremental.ToBool());
+	if (m_job.verletWallRatio != 0)			m_simulatorManager.GetSimulatorPtr()->SetVerletWallRatio(m_job.verletWallRatio);
+
+	// set summation of forces
+	if (m_job.deterministicForces.IsDefined())	m_simulatorManager.GetSimulatorPtr()->SetDeterministicForcesFlag(m_job.deterministicForces.ToBool());
+
+	// set precision of contact models
+	if (m_job.mixedPrecision.IsDefined())	m_simulatorManager.GetSimulatorPtr()->SetMixedPrecisionFlag(m_job.mixedPrecision.ToBool());
 
 	// set parameters of variable time step if they were redefined
 	if (m_job.variableTimeStepFlag.IsDefined()) m_simulatorManager.GetSimulatorPtr()->SetVariableTimeStep(m_job.variableTimeStepFlag.ToBool());
 	if (m_job.maxPartMove != 0)					m_simulatorManager.GetSimulatorPtr()->SetPartMoveLimit(m_job.maxPartMove);
 	if (m_job.stepIncFactor != 0)				m_simulatorManager.GetSimulatorPtr()->SetTimeStepFactor(m_job.stepIncFactor);
 
+	// set time integration
+	if (m_job.timeIntegrator != -1)		m_simulatorManager.GetSimulatorPtr()->SetIntegrator(static_cast<CBaseSimulator::EIntegrator>(m_job.timeIntegrator));
+	if (m_job.solidBondSubsteps != 0)	m_simulatorManager.GetSimulatorPtr()->SetSolidBondSubsteps(m_job.solidBondSubsteps);
+
+	// set sleeping of quasi-static particles
+	if (m_job.sleepingFlag.IsDefined())	m_simulatorManager.GetSimulatorPtr()->SetSleepingFlag(m_job.sleepingFlag.ToBool());
+	if (m_job.sleepVelocity != 0)		m_simulatorManager.GetSimulatorPtr()->SetSleepVelocity(m_job.sleepVelocity);
+	if (m_job.sleepAcceleration != 0)	m_simulatorManager.GetSimulatorPtr()->SetSleepAcceleration(m_job.sleepAcceleration);
+	if (m_job.sleepSteps != 0)			m_simulatorManager.GetSimulatorPtr()->SetSleepSteps(m_job.sleepSteps);
+
 	// set selective saving flags
 	if (m_job.selectiveSavingFlag.IsDefined())
 	{
@@ -246,6 +274,41 @@ bool CConsoleSimulator::SimulationPrecheck() const
 
 	m_systemStructure.ClearAllStatesFrom(0.0);
 	AddErrorMessage(m_simulatorManager.GetSimulatorPtr()->IsDataCorrect());
+	if (m_simulatorManager.GetSimulatorPtr()->GetDeterministicForcesFlag())
+	{
+		if (m_simulatorManager.GetSimulatorPtr()->GetType() != ESimulatorType::CPU)
+			warningMessage += "Warning: Deterministic summation of forces is available only on CPU\n";
+		else if (m_simulatorManager.GetSimulatorPtr()->GetAutoAdjustFlag())
+			warningMessage += "Warning: Auto-adjusted verlet distance depends on measured timings, so results may still differ between runs\n";
+	}
+	if (m_simulatorManager.GetSimulatorPtr()->GetMixedPrecisionFlag())
+	{
+		if (m_simulatorManager.GetSimulatorPtr()->GetType() != ESimulatorType::CPU)
+			warningMessage += "Warning: Mixed precision of contact models is available only on CPU\n";
+		else
+			for (const auto type : { EMusenModelType::PP, EMusenModelType::PW })
+				for (const auto& model : m_modelManager.GetActiveModelsDescriptors(type))
+					if (!model->GetModel()->HasMixedPrecisionSupport())
+						warningMessage += "Warning: Model " + model->GetModel()->GetName() + " has no mixed precision variant and is calculated in double precision\n";
+	}
+	if (m_simulatorManager.GetSimulatorPtr()->GetType() != ESimulatorType::CPU)
+	{
+		if (m_simulatorManager.GetSimulatorPtr()->GetIntegrator() != CBaseSimulator::EIntegrator::LEAPFROG)
+			warningMessage += "Warning: Time integration schemes other than leapfrog are available only on CPU\n";
+		if (m_simulatorManager.GetSimulatorPtr()->GetSolidBondSubsteps() > 1)
+			warningMessage += "Warning: Sub-cycling of solid bonds is available only on CPU\n";
+	}
+	else if (m_simulatorManager.GetSimulatorPtr()->GetSolidBondSubsteps() > 1 && m_simulatorManager.GetSimulatorPtr()->GetIntegrator() != CBaseSimulator::EIntegrator::LEAPFROG)
+		warningMessage += "Warning: Sub-cycling of solid bonds is available only with leapfrog time integration\n";
+	if (m_simulatorManager.GetSimulatorPtr()->GetSleepingFlag())
+	{
+		if (m_simulatorManager.GetSimulatorPtr()->GetType() != ESimulatorType::CPU)
+			warningMessage += "Warning: Sleeping of particles is available only on CPU\n";
+		else if (m_systemStructure.GetPBC().bEnabled)
+			warningMessage += "Warning: Sleeping of particles is not applied with periodic boundary conditions\n";
+		else if (m_modelManager.GetUtilizedVariables().bThermals)
+			warningMessage += "Warning: Sleeping of particles is not applied with heat transfer\n";
+	}
 
 	// check geometries
 	for (const auto& g : m_systemStructure.AllGeometries())
@@ -295,6 +358,21 @@ void CConsoleSimulator::PrintSimulationInfo()
 		PrintFormatted("Max allowed particles movement [m]", simulator->GetPartMoveLimit());
 		PrintFormatted("Time step increase factor", simulator->GetTimeStepFactor());
 	}
+	switch (simulator->GetIntegrator())
+	{
+	case CBaseSimulator::EIntegrator::LEAPFROG:			PrintFormatted("Time integrator", "LEAPFROG");			break;
+	case CBaseSimulator::EIntegrator::VELOCITY_VERLET:	PrintFormatted("Time integrator", "VELOCITY_VERLET");	break;
+	case CBaseSimulator::EIntegrator::GEAR:				PrintFormatted("Time integrator", "GEAR");				break;
+	}
+	if (simulator->GetSolidBondSubsteps() > 1)
+		PrintFormatted("Solid bond sub-steps", simulator->GetSolidBondSubsteps());
+	PrintFormatted("Sleeping of particles", B2S(simulator->GetSleepingFlag()));
+	if (simulator->GetSleepingFlag())
+	{
+		PrintFormatted("Sleep velocity [m/s]", simulator->GetSleepVelocity());
+		PrintFormatted("Sleep acceleration [m/s2]", simulator->GetSleepAcceleration());
+		PrintFormatted("Sleep steps", simulator->GetSleepSteps());
+	}
 	if (!simulator->GetStopCriteria().empty())
 		for (const auto& criterion : simulator->GetStopCriteria())
 			switch (criterion)
@@ -308,10 +386,23 @@ void CConsoleSimulator::PrintSimulationInfo()
 	PrintFormatted("Auto-adjust Verlet distance", B2S(simulator->GetAutoAdjustFlag()));
 	PrintFormatted(simulator->GetAutoAdjustFlag() ? "Initial Verlet coefficient" : "Verlet coefficient", simulator->GetVerletCoeff());
 	PrintFormatted("Max Verlet cell number", simulator->GetMaxCells());
+	PrintFormatted("Verlet grid", simulator->GetVerletGridType() == EVerletGridType::SPARSE ? "SPARSE" : "DENSE");
+	PrintFormatted("Incremental Verlet update", B2S(simulator->GetIncrementalVerletFlag()));
+	PrintFormatted("Verlet wall ratio", simulator->GetVerletWallRatio());
+	PrintFormatted("Deterministic forces", B2S(simulator->GetDeterministicForcesFlag()));
+	PrintFormatted("Mixed precision", B2S(simulator->GetMixedPrecisionFlag()));
 	PrintFormatted("Consider particles anisotropy", B2S(m_systemStructure.IsAnisotropyEnabled()));
 	PrintFormatted("Extended contact radius", B2S(m_systemStructure.IsContactRadiusEnabled()));
 	PrintFormatted("Collisions saving", B2S(simType == ESimulatorType::CPU && dynamic_cast<const CCPUSimulator*>(simulator)->IsCollisionsAnalysisEnabled()));
+	PrintFormatted("Contacts in batches", B2S(simType == ESimulatorType::CPU && dynamic_cast<const CCPUSimulator*>(simulator)->IsBatchContactsEnabled()));
 	PrintFormatted("Selective saving", B2S(simulator->IsSelectiveSavingEnabled()));
+	PrintFormatted("Time points saved in background", simulator->GetSavingBuffers());
+	if (!simulator->GetProfilingFile().empty())
+	{
+		PrintFormatted("Profiling results file", simulator->GetProfilingFile());
+		if (simulator->GetProfilingInterval() > 0)
+			PrintFormatted(" Profiling results writing interval [s]", simulator->GetProfilingInterval());
+	}
 	PrintFormatted("Periodic boundaries", B2S(pbc.bEnabled));
 	if (pbc.bEnabled)
 	{
@@ -8,6 +8,13 @@
 CResultsComparer::CResultsComparer()
 {
 	m_dRelTolerance = 1e-3;
+	m_bCompareParticles = false;
+}
+
+void CResultsComparer::SetTolerance(double _dRelTolerance)
+{
+	m_dRelTolerance = _dRelTolerance;
+	m_bCompareParticles = true;
 }
 
 
@@ -66,7 +73,7 @@ bool CResultsComparer::CompareWallForces(double _dTime)
 		for (auto plane : m_pScene1->Geometry(i)->Planes())
 			vForce1 += m_pScene1->GetObjectByIndex(plane)->GetForce(dMaxTime);
 		for (auto plane : m_pScene2->Geometry(i)->Planes())
-			vForce2 += m_pScene1->GetObjectByIndex(plane)->GetForce(dMaxTime);
+			vForce2 += m_pScene2->GetObjectByIndex(plane)->GetForce(dMaxTime);
 		if (!CompareTwoValues("forces on walls", vForce1, vForce2, m_dRelTolerance)) return false;
 	}
 	return true;
@@ -121,22 +128,41 @@ bool CResultsComparer::CompareInterparticleContacts(double _dTime)
 	return true;
 }
 
-void CResultsComparer::CompareScenes(std::ofstream& _outStream, CSystemStructure* _pScene1, CSystemStructure* _pScene2)
+bool CResultsComparer::CompareScenes(std::ofstream& _outStream, CSystemStructure* _pScene1, CSystemStructure* _pScene2)
 {
 	m_pScene1 = _pScene1;
 	m_pScene2 = _pScene2;
 	m_pOutStream = &_outStream;
-	if (!CompareTimeIndependentData()) return;
+	if (!CompareTimeIndependentData()) return false;
 
 	// for init time point
-	if (!CompareWallForces(0)) return;
-	if (!CompareKineticEnergies(0)) return;
-	if (!CompareCoordinates(0)) return;
-	if (!CompareInterparticleContacts(0)) return;
+	if (!CompareWallForces(0)) return false;
+	if (!CompareKineticEnergies(0)) return false;
+	if (!CompareCoordinates(0)) return false;
+	if (!CompareInterparticleContacts(0)) return false;
 
 	// for last time point
-	if (!CompareWallForces(m_pScene1->GetMaxTime())) return;
-	if (!CompareKineticEnergies(m_pScene1->GetMaxTime())) return;
-	if (!CompareCoordinates(m_pScene1->GetMaxTime())) return;
-	if (!CompareInterparticleContacts(m_pScene1->GetMaxTime())) return;
-}
\ No newline at end of file
+	if (!CompareWallForces(m_pScene1->GetMaxTime())) return false;
+	if (!CompareKineticEnergies(m_pScene1->GetMaxTime())) return false;
+	if (!CompareCoordinates(m_pScene1->GetMaxTime())) return false;
+	if (!CompareInterparticleContacts(m_pScene1->GetMaxTime())) return false;
+	if (m_bCompareParticles && !CompareParticles(m_pScene1->GetMaxTime())) return false;
+	return true;
+}
+
+bool CResultsComparer::CompareParticles(double _dTime)
+{
+	for (const CSphere* pSphere1 : m_pScene1->GetAllSpheres(_dTime))
+	{
+		const CPhysicalObject* pSphere2 = m_pScene2->GetObjectByIndex(pSphere1->m_lObjectID);
+		const std::string sID = std::to_string(pSphere1->m_lObjectID);
+		if (!pSphere2 || !pSphere2->IsActive(_dTime))
+		{
+			(*m_pOutStream) << m_pScene1->GetFileName() << " vs " << m_pScene2->GetFileName() << " || Different activity of particle " << sID << std::endl;
+			return false;
+		}
+		if (!CompareTwoValues("coordinates of particle " + sID, pSphere1->GetCoordinates(_dTime), pSphere2->GetCoordinates(_dTime), m_dRelTolerance)) return false;
+		if (!CompareTwoValues("velocities of particle " + sID, pSphere1->GetVelocity(_dTime), pSphere2->GetVelocity(_dTime), m_dRelTolerance)) return false;
+	}
+	return true;
+}
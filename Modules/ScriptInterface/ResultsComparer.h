@@ -9,10 +9,14 @@ class CResultsComparer
 {
 public:
 	CResultsComparer();
-	void CompareScenes(std::ofstream& _outStream, CSystemStructure* _pScene1, CSystemStructure* _pScene2);
+	// Compares two scenes and writes found differences into _outStream. Returns true if no differences were found.
+	bool CompareScenes(std::ofstream& _outStream, CSystemStructure* _pScene1, CSystemStructure* _pScene2);
+	// Sets the relative tolerance of comparison. If set, also coordinates and velocities of each particle are compared; 0 requires them to be identical.
+	void SetTolerance(double _dRelTolerance);
 
 private:
 	double m_dRelTolerance; // max relative tolerance 
+	bool m_bCompareParticles; // compare each particle separately
 	CSystemStructure* m_pScene1; 
 	CSystemStructure* m_pScene2;
 	std::ofstream* m_pOutStream;
@@ -27,4 +31,5 @@ private:
 	bool CompareKineticEnergies(double _dTime);
 	bool CompareCoordinates(double _dTime);
 	bool CompareInterparticleContacts(double _dTime);
+	bool CompareParticles(double _dTime);
 };
@@ -65,6 +65,7 @@ void CScriptAnalyzer::ProcessLine(const std::string& _line, std::ostream& _out /
 			else if (value == "SNAPSHOT_GENERATOR")	m_jobs.back().component = SJob::EComponent::SNAPSHOT_GENERATOR;
 			else if (value == "EXPORT_TO_TEXT")		m_jobs.back().component = SJob::EComponent::EXPORT_TO_TEXT;
 			else if (value == "IMPORT_FROM_TEXT")	m_jobs.back().component = SJob::EComponent::IMPORT_FROM_TEXT;
+			else if (value == "COMPARE_FILES")		m_jobs.back().component = SJob::EComponent::COMPARE_FILES;
 		}
 	}
 	else if (key == "AGGLOMERATES_DB")	m_jobs.back().agglomeratesDBFileName = GetRestOfLine(&ss);
@@ -108,7 +109,11 @@ void CScriptAnalyzer::ProcessLine(const std::string& _line, std::ostream& _out /
 	else if (key == "SIMULATION_STEP_FACTOR")						ss >> m_jobs.back().simulationStepFactor;
 	else if (key == "SAVING_STEP_FACTOR")							ss >> m_jobs.back().savingStepFactor;
 	else if (key == "END_TIME_FACTOR")								ss >> m_jobs.back().endTimeFactor;
+	else if (key == "SAVING_BUFFERS")								ss >> m_jobs.back().savingBuffers;
+	else if (key == "PROFILE_FILE")									m_jobs.back().profileFileName = GetRestOfLine(&ss);
+	else if (key == "PROFILE_INTERVAL")								ss >> m_jobs.back().profileInterval;
 	else if (key == "SAVE_COLLISIONS")		ss >> m_jobs.back().saveCollsionsFlag;
+	else if (key == "BATCH_CONTACTS")		ss >> m_jobs.back().batchContactsFlag;
 	else if (key == "CONNECTED_PP_CONTACT")	ss >> m_jobs.back().connectedPPContactFlag;
 	else if (key == "ANISOTROPY")			ss >> m_jobs.back().anisotropyFlag;
 	else if (key == "DIFF_CONTACT_RADIUS")	ss >> m_jobs.back().contactRadiusFlag;
@@ -118,15 +123,38 @@ void CScriptAnalyzer::ProcessLine(const std::string& _line, std::ostream& _out /
 	else if (key == "PBC_FLAGS")            ss >> m_jobs.back().pbcFlags[0] >> m_jobs.back().pbcFlags[1] >> m_jobs.back().pbcFlags[2];
 	else if (key == "PBC_DOMAIN")           ss >> m_jobs.back().pbcDomain;
 	else if (key == "SELECTIVE_SAVING_P")  { m_jobs.back().selectiveSavingFlag = true; ss >> m_jobs.back().selectiveSavingFlags.bAngVelocity >> m_jobs.back().selectiveSavingFlags.bCoordinates >> m_jobs.back().selectiveSavingFlags.bForce >> m_jobs.back().selectiveSavingFlags.bQuaternion >> m_jobs.back().selectiveSavingFlags.bVelocity >> m_jobs.back().selectiveSavingFlags.bTensor >> m_jobs.back().selectiveSavingFlags.bTemperature; }
+	else if (key == "SELECTIVE_SAVING_TENSOR_STEP") { m_jobs.back().selectiveSavingFlag = true; ss >> m_jobs.back().selectiveSavingFlags.nTensorStep; }
 	else if (key == "SELECTIVE_SAVING_SB") { m_jobs.back().selectiveSavingFlag = true; ss >> m_jobs.back().selectiveSavingFlags.bSBForce >> m_jobs.back().selectiveSavingFlags.bSBTangOverlap >> m_jobs.back().selectiveSavingFlags.bSBTotTorque; }
 	else if (key == "SELECTIVE_SAVING_LB") { m_jobs.back().selectiveSavingFlag = true; ss >> m_jobs.back().selectiveSavingFlags.bLBForce; }
 	else if (key == "SELECTIVE_SAVING_TW") { m_jobs.back().selectiveSavingFlag = true; ss >> m_jobs.back().selectiveSavingFlags.bTWPlaneCoord >> m_jobs.back().selectiveSavingFlags.bTWForce >> m_jobs.back().selectiveSavingFlags.bTWVelocity; }
 	else if (key == "VERLET_AUTO")			ss >> m_jobs.back().verletAutoFlag;
 	else if (key == "VERLET_COEF")			ss >> m_jobs.back().verletCoef;
 	else if (key == "VERLET_MAX_CELLS")		ss >> m_jobs.back().iVerletMaxCells;
+	else if (key == "VERLET_GRID")
+	{
+		const std::string type = ToUpperCase(GetValueFromStream<std::string>(&ss));
+		if (type == "DENSE")	m_jobs.back().verletSparseGrid = false;
+		if (type == "SPARSE")	m_jobs.back().verletSparseGrid = true;
+	}
+	else if (key == "VERLET_INCREMENTAL")	ss >> m_jobs.back().verletIncremental;
+	else if (key == "VERLET_WALL_RATIO")	ss >> m_jobs.back().verletWallRatio;
+	else if (key == "DETERMINISTIC_FORCES")	ss >> m_jobs.back().deterministicForces;
+	else if (key == "MIXED_PRECISION")		ss >> m_jobs.back().mixedPrecision;
 	else if (key == "VARIABLE_TIME_STEP")	ss >> m_jobs.back().variableTimeStepFlag;
 	else if (key == "MAX_PART_MOVE")		ss >> m_jobs.back().maxPartMove;
 	else if (key == "STEP_INC_FACTOR")		ss >> m_jobs.back().stepIncFactor;
+	else if (key == "TIME_INTEGRATOR")
+	{
+		const std::string type = ToUpperCase(GetValueFromStream<std::string>(&ss));
+		if (type == "LEAPFROG")								m_jobs.back().timeIntegrator = E2I(CBaseSimulator::EIntegrator::LEAPFROG);
+		if (type == "VELOCITY_VERLET" || type == "VERLET")	m_jobs.back().timeIntegrator = E2I(CBaseSimulator::EIntegrator::VELOCITY_VERLET);
+		if (type == "GEAR")									m_jobs.back().timeIntegrator = E2I(CBaseSimulator::EIntegrator::GEAR);
+	}
+	else if (key == "SOLID_BOND_SUBSTEPS")	ss >> m_jobs.back().solidBondSubsteps;
+	else if (key == "SLEEPING")				ss >> m_jobs.back().sleepingFlag;
+	else if (key == "SLEEP_VELOCITY")		ss >> m_jobs.back().sleepVelocity;
+	else if (key == "SLEEP_ACCELERATION")	ss >> m_jobs.back().sleepAcceleration;
+	else if (key == "SLEEP_STEPS")			ss >> m_jobs.back().sleepSteps;
 	else if (key == "STOP_CRITERION")
 	{
 		const auto criterion = ToUpperCase(GetValueFromStream<std::string>(&ss));
@@ -279,6 +307,7 @@ void CScriptAnalyzer::ProcessLine(const std::string& _line, std::ostream& _out /
 	{
 		m_jobs.back().txtPrecision = GetValueFromStream<int>(&ss);
 	}
+	else if (key == "COMPARE_TOLERANCE")	ss >> m_jobs.back().compareTolerance;
 	else if (key == "TIME_INTERVAL")
 	{
 		m_jobs.back().timeBeg = GetValueFromStream<double>(&ss);
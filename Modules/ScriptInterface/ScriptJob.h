@@ -115,7 +115,15 @@ struct SJob
 	double savingStepFactor{ 0.0 };
 	double endTimeFactor{ 0.0 };
 
+	// saving
+	int64_t savingBuffers{ -1 };	// Number of time points saved in background; -1 - not defined.
+
+	// profiling
+	std::string profileFileName;	// File to write profiling results; empty - no profiling.
+	double profileInterval{ -1 };	// Wall time interval [s] to write profiling results during the simulation; -1 - not defined.
+
 	CTriState saveCollsionsFlag{ CTriState::EState::UNDEFINED };
+	CTriState batchContactsFlag{ CTriState::EState::UNDEFINED };	// calculate PP contacts in batches
 	CTriState connectedPPContactFlag{ CTriState::EState::UNDEFINED };	// calculate force between connected particles
 	CTriState anisotropyFlag{ CTriState::EState::UNDEFINED };
 	CTriState contactRadiusFlag{ CTriState::EState::UNDEFINED };
@@ -134,12 +142,31 @@ struct SJob
 	CTriState verletAutoFlag{ CTriState::EState::UNDEFINED };
 	double verletCoef{ 0 };
 	uint32_t iVerletMaxCells{ 0 };
+	CTriState verletSparseGrid{ CTriState::EState::UNDEFINED };
+	CTriState verletIncremental{ CTriState::EState::UNDEFINED };
+	double verletWallRatio{ 0 };
+
+	// summation of forces
+	CTriState deterministicForces{ CTriState::EState::UNDEFINED };
+
+	// precision of contact models
+	CTriState mixedPrecision{ CTriState::EState::UNDEFINED };
 
 	// variable time step
 	CTriState variableTimeStepFlag;
 	double maxPartMove{ 0. };
 	double stepIncFactor{ 0. };
 
+	// time integration
+	int timeIntegrator{ -1 };		// Scheme of time integration as CBaseSimulator::EIntegrator; -1 - not defined.
+	uint32_t solidBondSubsteps{ 0 };	// Number of sub-steps of solid bonds; 0 - not defined.
+
+	// sleeping of quasi-static particles
+	CTriState sleepingFlag{ CTriState::EState::UNDEFINED };
+	double sleepVelocity{ 0 };
+	double sleepAcceleration{ 0 };
+	uint32_t sleepSteps{ 0 };
+
 	// package generator, <index, generator>
 	std::map<size_t, SPackageGenerator> packageGenerators;
 
@@ -152,6 +179,9 @@ struct SJob
 	double timeEnd{ -1 };
 	int txtPrecision{ 6 };
 
+	// files comparison
+	double compareTolerance{ -1 };	// Maximum relative difference of compared values; default tolerance if negative.
+
 	// additional stop criteria
 	std::vector<CBaseSimulator::EStopCriteria> stopCriteria;
 	CBaseSimulator::SStopValues stopValues;
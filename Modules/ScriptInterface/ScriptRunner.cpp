@@ -312,8 +312,11 @@ void CScriptRunner::CompareFiles()
 		m_err << "Unable to load two files." << std::endl;
 		return;
 	}
-	m_resultsComparer.CompareScenes(outStream, &scene1, &scene2);
+	if (m_job.compareTolerance >= 0)
+		m_resultsComparer.SetTolerance(m_job.compareTolerance);
+	const bool equal = m_resultsComparer.CompareScenes(outStream, &scene1, &scene2);
 	outStream.close();
+	m_out << (equal ? "Files are equal" : "Files are different") << std::endl;
 }
 
 bool CScriptRunner::LoadAndResaveSystemStructure()
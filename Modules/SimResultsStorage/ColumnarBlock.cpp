@@ -0,0 +1,300 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+#include "ColumnarBlock.h"
+#include "DisableWarningHelper.h"
+#include <cmath>
+#include <cstring>
+#include <utility>
+PRAGMA_WARNING_PUSH
+PRAGMA_WARNING_DISABLE
+#include "SimulationDescription.pb.h"
+#include <zlib.h>
+PRAGMA_WARNING_POP
+
+namespace
+{
+	using Props = ProtoTimeDependentProperties;
+
+	const uint32_t c_version = 1;	// Version of the columnar layout.
+
+	// Header of the encoded block, followed by meta data and shuffled values.
+	struct SHeader
+	{
+		uint32_t version;		// Version of the layout.
+		uint32_t valueSize;		// Size of each value in bytes: 8 for doubles, 4 for floats.
+		uint32_t timePoints;	// Number of time points.
+		uint32_t metaSize;		// Size of meta data in bytes: times, numbers of objects and presence of properties.
+		uint64_t valuesNumber;	// Total number of stored values.
+	};
+
+	// Presence of a property in objects of a time point.
+	enum EPresence : uint8_t
+	{
+		NONE    = 0,	// Absent in all objects; no values are stored.
+		ALL     = 1,	// Present in all objects.
+		PARTIAL = 2		// Present in some objects, marked in the following bitmap.
+	};
+
+	// Description of a stored property.
+	struct SField
+	{
+		uint32_t components;							// Number of values.
+		bool (*has)(const Props&);						// Presence of the property in the object; nullptr for scalars, which are stored if not zero.
+		void (*get)(const Props&, double*);				// Gets all components.
+		void (*set)(Props&, const double*);				// Sets all components.
+	};
+
+	void GetVector(const ProtoVector& _v, double* _d) { _d[0] = _v.x(); _d[1] = _v.y(); _d[2] = _v.z(); }
+	void SetVector(ProtoVector* _v, const double* _d) { _v->set_x(_d[0]); _v->set_y(_d[1]); _v->set_z(_d[2]); }
+
+	// All stored properties. The order defines the layout, so new properties may only be appended together with a new version.
+	const SField c_fields[] = {
+		{ 3, [](const Props& _p) { return _p.has_coord(); },      [](const Props& _p, double* _d) { GetVector(_p.coord(), _d); },      [](Props& _p, const double* _d) { SetVector(_p.mutable_coord(), _d); } },
+		{ 3, [](const Props& _p) { return _p.has_angles(); },     [](const Props& _p, double* _d) { GetVector(_p.angles(), _d); },     [](Props& _p, const double* _d) { SetVector(_p.mutable_angles(), _d); } },
+		{ 3, [](const Props& _p) { return _p.has_vel(); },        [](const Props& _p, double* _d) { GetVector(_p.vel(), _d); },        [](Props& _p, const double* _d) { SetVector(_p.mutable_vel(), _d); } },
+		{ 3, [](const Props& _p) { return _p.has_angle_vel(); },  [](const Props& _p, double* _d) { GetVector(_p.angle_vel(), _d); },  [](Props& _p, const double* _d) { SetVector(_p.mutable_angle_vel(), _d); } },
+		{ 3, [](const Props& _p) { return _p.has_angle_accl(); }, [](const Props& _p, double* _d) { GetVector(_p.angle_accl(), _d); }, [](Props& _p, const double* _d) { SetVector(_p.mutable_angle_accl(), _d); } },
+		{ 3, [](const Props& _p) { return _p.has_force(); },      [](const Props& _p, double* _d) { GetVector(_p.force(), _d); },      [](Props& _p, const double* _d) { SetVector(_p.mutable_force(), _d); } },
+		{ 4, [](const Props& _p) { return _p.has_quaternion(); },
+			[](const Props& _p, double* _d) { const auto& q = _p.quaternion(); _d[0] = q.q0(); _d[1] = q.q1(); _d[2] = q.q2(); _d[3] = q.q3(); },
+			[](Props& _p, const double* _d) { auto* q = _p.mutable_quaternion(); q->set_q0(_d[0]); q->set_q1(_d[1]); q->set_q2(_d[2]); q->set_q3(_d[3]); } },
+		{ 9, [](const Props& _p) { return _p.has_stress_tensor(); },
+			[](const Props& _p, double* _d) { const auto& m = _p.stress_tensor(); GetVector(m.v1(), _d); GetVector(m.v2(), _d + 3); GetVector(m.v3(), _d + 6); },
+			[](Props& _p, const double* _d) { auto* m = _p.mutable_stress_tensor(); SetVector(m->mutable_v1(), _d); SetVector(m->mutable_v2(), _d + 3); SetVector(m->mutable_v3(), _d + 6); } },
+		{ 1, nullptr, [](const Props& _p, double* _d) { _d[0] = _p.total_torque(); },     [](Props& _p, const double* _d) { _p.set_total_torque(_d[0]); } },
+		{ 1, nullptr, [](const Props& _p, double* _d) { _d[0] = _p.temperature(); },      [](Props& _p, const double* _d) { _p.set_temperature(_d[0]); } },
+		{ 1, nullptr, [](const Props& _p, double* _d) { _d[0] = _p.liquid_film_mass(); }, [](Props& _p, const double* _d) { _p.set_liquid_film_mass(_d[0]); } },
+	};
+
+	const uint32_t c_maxComponents = 9;
+
+	template<typename T>
+	void Append(std::vector<char>& _buf, const T& _val)
+	{
+		const size_t size = _buf.size();
+		_buf.resize(size + sizeof(T));
+		std::memcpy(_buf.data() + size, &_val, sizeof(T));
+	}
+
+	// Sequential reader with bounds checking.
+	class CReader
+	{
+		const char* m_pos;
+		const char* m_end;
+	public:
+		CReader(const char* _data, size_t _size) : m_pos{ _data }, m_end{ _data + _size } {}
+		template<typename T>
+		bool Read(T& _val)
+		{
+			if (static_cast<size_t>(m_end - m_pos) < sizeof(T)) return false;
+			std::memcpy(&_val, m_pos, sizeof(T));
+			m_pos += sizeof(T);
+			return true;
+		}
+		const char* Skip(size_t _size)
+		{
+			if (static_cast<size_t>(m_end - m_pos) < _size) return nullptr;
+			const char* res = m_pos;
+			m_pos += _size;
+			return res;
+		}
+	};
+
+	// Groups bytes of values by their significance: byte b of value i goes to position b * n + i.
+	void Shuffle(const char* _src, char* _dst, size_t _n, size_t _size)
+	{
+		for (size_t i = 0; i < _n; ++i)
+			for (size_t b = 0; b < _size; ++b)
+				_dst[b * _n + i] = _src[i * _size + b];
+	}
+
+	void Unshuffle(const char* _src, char* _dst, size_t _n, size_t _size)
+	{
+		for (size_t b = 0; b < _size; ++b)
+			for (size_t i = 0; i < _n; ++i)
+				_dst[i * _size + b] = _src[b * _n + i];
+	}
+
+	bool IsBitSet(const char* _bitmap, size_t _i) { return (static_cast<uint8_t>(_bitmap[_i / 8]) >> (_i % 8)) & 1; }
+}
+
+uint32_t CColumnarBlock::Encode(const ProtoBlockOfTimePoints& _block, ECodec& _codec, bool _singlePrecision, std::vector<char>& _buffer)
+{
+	// gather meta data and columns of values
+	std::vector<char> meta;
+	std::vector<double> values;
+	std::vector<uint8_t> present;
+	double tmp[c_maxComponents];
+	for (const auto& timePoint : _block.time_points())
+	{
+		const auto n = static_cast<uint32_t>(timePoint.particles_size());
+		Append(meta, timePoint.time());
+		Append(meta, n);
+		for (const auto& field : c_fields)
+		{
+			// determine presence
+			present.assign(n, 0);
+			size_t count = 0;
+			if (field.has)
+				for (uint32_t i = 0; i < n; ++i)
+					count += present[i] = field.has(timePoint.particles(static_cast<int>(i)));
+			else
+				for (uint32_t i = 0; i < n && count == 0; ++i)
+				{
+					field.get(timePoint.particles(static_cast<int>(i)), tmp);
+					count = tmp[0] != 0 || std::signbit(tmp[0]) ? n : 0;
+				}
+			if (count == n && !field.has)
+				present.assign(n, 1);
+
+			const EPresence presence = count == 0 ? NONE : count == n ? ALL : PARTIAL;
+			Append(meta, static_cast<uint8_t>(presence));
+			if (presence == NONE) continue;
+			if (presence == PARTIAL)
+			{
+				std::vector<char> bitmap((n + 7) / 8, 0);
+				for (uint32_t i = 0; i < n; ++i)
+					if (present[i])
+						bitmap[i / 8] = static_cast<char>(bitmap[i / 8] | (1 << (i % 8)));
+				meta.insert(meta.end(), bitmap.begin(), bitmap.end());
+			}
+
+			// one column per component
+			const size_t base = values.size();
+			values.resize(base + field.components * count);
+			size_t k = 0;
+			for (uint32_t i = 0; i < n; ++i)
+			{
+				if (!present[i]) continue;
+				field.get(timePoint.particles(static_cast<int>(i)), tmp);
+				for (uint32_t c = 0; c < field.components; ++c)
+					values[base + c * count + k] = tmp[c];
+				++k;
+			}
+		}
+	}
+
+	// build the uncompressed block
+	const SHeader header{ c_version, _singlePrecision ? 4u : 8u, static_cast<uint32_t>(_block.time_points_size()), static_cast<uint32_t>(meta.size()), values.size() };
+	const size_t rawSize = sizeof(SHeader) + meta.size() + values.size() * header.valueSize;
+	std::vector<char> raw;
+	std::vector<char>& dst = _codec == ECodec::NONE ? _buffer : raw;
+	dst.resize(rawSize);
+	std::memcpy(dst.data(), &header, sizeof(SHeader));
+	std::memcpy(dst.data() + sizeof(SHeader), meta.data(), meta.size());
+	char* shuffled = dst.data() + sizeof(SHeader) + meta.size();
+	if (_singlePrecision)
+	{
+		const std::vector<float> floats(values.begin(), values.end());
+		Shuffle(reinterpret_cast<const char*>(floats.data()), shuffled, floats.size(), sizeof(float));
+	}
+	else
+		Shuffle(reinterpret_cast<const char*>(values.data()), shuffled, values.size(), sizeof(double));
+
+	// compress
+	if (_codec == ECodec::ZLIB)
+	{
+		uLongf size = compressBound(static_cast<uLong>(rawSize));
+		_buffer.resize(size);
+		if (compress2(reinterpret_cast<Bytef*>(_buffer.data()), &size, reinterpret_cast<const Bytef*>(raw.data()), static_cast<uLong>(rawSize), Z_BEST_SPEED) == Z_OK)
+			_buffer.resize(size);
+		else
+		{
+			// store the block uncompressed
+			_codec = ECodec::NONE;
+			_buffer = std::move(raw);
+		}
+	}
+
+	return static_cast<uint32_t>(rawSize);
+}
+
+bool CColumnarBlock::Decode(const char* _data, uint32_t _size, uint32_t _uncompressedSize, ECodec _codec, ProtoBlockOfTimePoints& _block)
+{
+	_block.Clear();
+
+	// decompress
+	std::vector<char> buffer;
+	const char* raw = _data;
+	switch (_codec)
+	{
+	case ECodec::NONE:
+		if (_size != _uncompressedSize) return false;
+		break;
+	case ECodec::ZLIB:
+	{
+		buffer.resize(_uncompressedSize);
+		uLongf size = _uncompressedSize;
+		if (uncompress(reinterpret_cast<Bytef*>(buffer.data()), &size, reinterpret_cast<const Bytef*>(_data), _size) != Z_OK || size != _uncompressedSize) return false;
+		raw = buffer.data();
+		break;
+	}
+	default:
+		return false;
+	}
+
+	// read header
+	CReader reader{ raw, _uncompressedSize };
+	SHeader header{};
+	if (!reader.Read(header) || header.version != c_version || (header.valueSize != 4 && header.valueSize != 8)) return false;
+	const char* metaData = reader.Skip(header.metaSize);
+	const char* shuffled = reader.Skip(header.valuesNumber * header.valueSize);
+	if (!metaData || !shuffled) return false;
+
+	// restore values
+	std::vector<double> values(header.valuesNumber);
+	if (header.valueSize == 4)
+	{
+		std::vector<float> floats(header.valuesNumber);
+		Unshuffle(shuffled, reinterpret_cast<char*>(floats.data()), floats.size(), sizeof(float));
+		std::copy(floats.begin(), floats.end(), values.begin());
+	}
+	else
+		Unshuffle(shuffled, reinterpret_cast<char*>(values.data()), values.size(), sizeof(double));
+
+	// restore time points
+	CReader meta{ metaData, header.metaSize };
+	size_t pos = 0;
+	double tmp[c_maxComponents];
+	for (uint32_t t = 0; t < header.timePoints; ++t)
+	{
+		double time;
+		uint32_t n;
+		if (!meta.Read(time) || !meta.Read(n)) return false;
+		ProtoTimePoint* timePoint = _block.add_time_points();
+		timePoint->set_time(time);
+		timePoint->mutable_particles()->Reserve(static_cast<int>(n));
+		for (uint32_t i = 0; i < n; ++i)
+			timePoint->add_particles();
+		for (const auto& field : c_fields)
+		{
+			uint8_t presence;
+			if (!meta.Read(presence) || presence > PARTIAL) return false;
+			if (presence == NONE) continue;
+			const char* bitmap = presence == PARTIAL ? meta.Skip((n + 7) / 8) : nullptr;
+			if (presence == PARTIAL && !bitmap) return false;
+			size_t count = n;
+			if (bitmap)
+			{
+				count = 0;
+				for (uint32_t i = 0; i < n; ++i)
+					count += IsBitSet(bitmap, i);
+			}
+			if (pos + field.components * count > values.size()) return false;
+			size_t k = 0;
+			for (uint32_t i = 0; i < n; ++i)
+			{
+				if (bitmap && !IsBitSet(bitmap, i)) continue;
+				for (uint32_t c = 0; c < field.components; ++c)
+					tmp[c] = values[pos + c * count + k];
+				field.set(*timePoint->mutable_particles(static_cast<int>(i)), tmp);
+				++k;
+			}
+			pos += field.components * count;
+		}
+	}
+
+	return pos == values.size();
+}
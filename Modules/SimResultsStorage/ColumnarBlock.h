@@ -0,0 +1,30 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+#pragma once
+#include <cstdint>
+#include <vector>
+
+class ProtoBlockOfTimePoints;
+
+/* Columnar representation of a block of time points.
+ * Each property of all objects in a time point is stored as a column of raw values, one column per component; objects without
+ * this property are marked in a bitmap. All values are byte-shuffled, so that equal bytes of neighbouring values, like signs and
+ * exponents, follow each other, and then compressed with the selected codec. Values are stored with the native byte order
+ * of little-endian platforms, as either doubles or floats. */
+class CColumnarBlock
+{
+public:
+	// Compression of the encoded block. Values coincide with ProtoBlockDescriptor::Codec.
+	enum class ECodec : uint32_t
+	{
+		NONE = 0,
+		ZLIB = 1
+	};
+
+	// Encodes the block into the buffer. Returns the size of the encoded data before compression. If compression fails, the block is stored uncompressed and _codec is set to NONE.
+	static uint32_t Encode(const ProtoBlockOfTimePoints& _block, ECodec& _codec, bool _singlePrecision, std::vector<char>& _buffer);
+	// Decodes the block from the buffer. _uncompressedSize is a value returned by Encode(). Returns false if the data are corrupted.
+	static bool Decode(const char* _data, uint32_t _size, uint32_t _uncompressedSize, ECodec _codec, ProtoBlockOfTimePoints& _block);
+};
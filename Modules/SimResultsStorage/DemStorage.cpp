@@ -66,6 +66,13 @@ void CDemStorage::SetFileVersion(uint32_t _nFileVersion) const
 	m_pMDEMFile->SetFileVersion(_nFileVersion);
 }
 
+void CDemStorage::SetBlockFormat(bool _columnar, CColumnarBlock::ECodec _codec, bool _singlePrecision)
+{
+	m_columnar = _columnar;
+	m_codec = _codec;
+	m_singlePrecision = _singlePrecision;
+}
+
 void CDemStorage::OpenFile(const std::string& _sFileName)
 {
 	// open file
@@ -422,6 +429,22 @@ void CDemStorage::SaveLastBlock()
 	ProtoBlockOfTimePoints* pProtoBlockOfTimePoints = &*m_blocksOfTimePoints.back();
 	ProtoBlockDescriptor* pBlockDescriptor = &*m_simStorage.mutable_data_blocks()->rbegin();
 
+	if (m_columnar)
+	{
+		// encode time-dependent data block into columns and compress them
+		CColumnarBlock::ECodec codec = m_codec;
+		const uint32_t nRawSize = CColumnarBlock::Encode(*pProtoBlockOfTimePoints, codec, m_singlePrecision, m_blockBuffer);
+		pBlockDescriptor->set_format(ProtoBlockDescriptor::kColumnar);
+		pBlockDescriptor->set_codec(static_cast<ProtoBlockDescriptor::Codec>(codec));
+		pBlockDescriptor->set_uncompressed_size(nRawSize);
+		pBlockDescriptor->set_size(static_cast<int32_t>(m_blockBuffer.size()));
+
+		// set pointer to current offset in file and write time-dependent data block
+		m_pMDEMFile->FileThreadSetPointerTo(TIME_DEPENDENT_DATA, pBlockDescriptor->offset_in_file());
+		m_pMDEMFile->FileThreadWrite(TIME_DEPENDENT_DATA, m_blockBuffer.data(), static_cast<uint32_t>(m_blockBuffer.size()));
+		return;
+	}
+
 	// uncompressed size of block with time-dependena data and value of time points
 #if GOOGLE_PROTOBUF_VERSION < 3001000
 	uint32_t nBinSize = (uint32_t)pProtoBlockOfTimePoints->ByteSize();
@@ -431,6 +454,7 @@ void CDemStorage::SaveLastBlock()
 
 	// set type saved time-dependent data block and uncompressed size
 	pBlockDescriptor->set_format(ProtoBlockDescriptor::kZippedProtoBuff);
+	pBlockDescriptor->clear_codec();
 	pBlockDescriptor->set_uncompressed_size(nBinSize);
 
 	// serialize time-dependent data block and save compressed size
@@ -499,7 +523,10 @@ bool CDemStorage::LoadBlockInternal(uint32_t _iBlock)
 
 	// read current proto block of time points from file to memory
 	m_pMDEMFile->FileThreadRead(TIME_DEPENDENT_DATA, pTmpBuffer.get(), nBlockSize);
-	const bool bRes = ReadFromBuf(static_cast<const char*>(pTmpBuffer.get()), *m_blocksOfTimePoints[_iBlock], nBlockSize, m_simStorage.data_blocks(_iBlock).uncompressed_size());
+	const ProtoBlockDescriptor& descriptor = m_simStorage.data_blocks(_iBlock);
+	const bool bRes = descriptor.format() == ProtoBlockDescriptor::kColumnar
+		? CColumnarBlock::Decode(static_cast<const char*>(pTmpBuffer.get()), nBlockSize, descriptor.uncompressed_size(), static_cast<CColumnarBlock::ECodec>(descriptor.codec()), *m_blocksOfTimePoints[_iBlock])
+		: ReadFromBuf(static_cast<const char*>(pTmpBuffer.get()), *m_blocksOfTimePoints[_iBlock], nBlockSize, descriptor.uncompressed_size());
 	if (!bRes) m_sLastError = "protobuf can not be parsed";
 
 	return bRes;
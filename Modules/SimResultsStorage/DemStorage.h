@@ -3,6 +3,7 @@
    See LICENSE file for license and warranty information. */
 
 #pragma once
+#include "ColumnarBlock.h"
 #include "MDEMFile.h"
 #include "TimePointR.h"
 #include "TimePointW.h"
@@ -53,6 +54,12 @@ private:
 	CTimePointR m_timePointR; // Time point for write access.
 	CTimePointW m_timePointW; // Time point for write access.
 
+	// Format of saved blocks of time-dependent data.
+	bool m_columnar{ false };									// Save blocks in columnar format; otherwise as zipped protobuf.
+	CColumnarBlock::ECodec m_codec{ CColumnarBlock::ECodec::ZLIB };	// Compression of columnar blocks.
+	bool m_singlePrecision{ false };							// Store values of columnar blocks as floats.
+	std::vector<char> m_blockBuffer;							// Buffer to encode blocks, reused between savings.
+
 public:
 	CDemStorage();
 
@@ -74,6 +81,8 @@ public:
 	uint32_t GetFileVersion() const;
 	// Sets file version to file header. OpenFile() function has to be called before.
 	void SetFileVersion(uint32_t _nFileVersion) const;
+	// Sets format to save new blocks of time-dependent data: columnar with the given codec and precision, or zipped protobuf. Blocks of all formats can be read.
+	void SetBlockFormat(bool _columnar, CColumnarBlock::ECodec _codec = CColumnarBlock::ECodec::ZLIB, bool _singlePrecision = false);
 
 	// Returns pointer to mutable simulation info in protofile.
 	ProtoSimulationInfo* SimulationInfo();
@@ -9,10 +9,22 @@ struct SOptionalVariables
 	bool bThermals = false;
 	bool bTangentialPlasticity = false;
 
+	// optional fields of contacts
+	bool bContactEquivalents = false;	// equivalent mass and radius
+	bool bContactMoments = false;		// moments acting on both contact partners
+	bool bContactHeatFlux = false;		// heat flux
+	bool bContactInitOverlap = false;	// initial normal overlap
+	bool bContactTangForce = false;		// tangential force from the previous time step
+
 	SOptionalVariables& operator|=(const SOptionalVariables &b)
 	{
 		bThermals = bThermals || b.bThermals;
 		bTangentialPlasticity = bTangentialPlasticity || b.bTangentialPlasticity;
+		bContactEquivalents = bContactEquivalents || b.bContactEquivalents;
+		bContactMoments = bContactMoments || b.bContactMoments;
+		bContactHeatFlux = bContactHeatFlux || b.bContactHeatFlux;
+		bContactInitOverlap = bContactInitOverlap || b.bContactInitOverlap;
+		bContactTangForce = bContactTangForce || b.bContactTangForce;
 		return *this;
 	};
 };
@@ -32,7 +32,9 @@ void SBasicParticleStruct::AddBasicParticle(bool _active, CVector3 _coord, doubl
 {
 	AddObject(_active, _initIndex);
 
-	contactInfo.emplace_back(_coord, _contactRadius, CVector3{ 0 });
+	coord.emplace_back(_coord);
+	contactRadius.emplace_back(_contactRadius);
+	coordVerlet.emplace_back(0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -43,12 +45,18 @@ void SParticleStruct::AddParticle(bool _active, const CVector3& _coord, double _
 {
 	AddBasicParticle(_active, _coord, _radius, _initIndex);
 
-	kinematicsInfo.emplace_back(_radius, _mass, _inertiaMoment, _vel, _anglVel, CVector3{ 0 }, CVector3{ 0 });
+	radius.emplace_back(_radius);
+	mass.emplace_back(_mass);
+	inertiaMoment.emplace_back(_inertiaMoment);
+	vel.emplace_back(_vel);
+	anglVel.emplace_back(_anglVel);
+	force.emplace_back(0);
+	moment.emplace_back(0);
 }
 
 void SParticleStruct::AddContactRadius(double _contactRadius)
 {
-	contactInfo.back().contactRadius = _contactRadius;
+	contactRadius.back() = _contactRadius;
 }
 
 void SParticleStruct::AddQuaternion(const CQuaternion& _quaternion)
@@ -70,8 +78,16 @@ void SParticleStruct::Resize(size_t n)
 {
 	SGeneralObject::Resize(n);
 
-	contactInfo.resize(n);
-	kinematicsInfo.resize(n);
+	coord.resize(n);
+	contactRadius.resize(n);
+	coordVerlet.resize(n);
+	radius.resize(n);
+	mass.resize(n);
+	inertiaMoment.resize(n);
+	vel.resize(n);
+	anglVel.resize(n);
+	force.resize(n);
+	moment.resize(n);
 	if (!quaternion.empty())		quaternion.resize(n);
 	if (!multiSphIndex.empty())		multiSphIndex.resize(n);
 	if (!thermalInfo.empty())		thermalInfo.resize(n);
@@ -87,7 +103,9 @@ void SWallStruct::AddWall(bool _active, unsigned _initIndex, const CVector3& _ve
 
 	coordInfo.emplace_back(_vert1, _vert2, _vert3);
 	normalVector.emplace_back(_normalVector);
-	movementInfo.emplace_back(_vel, _rotVel, _rotCenter);
+	vel.emplace_back(_vel);
+	rotVel.emplace_back(_rotVel);
+	rotCenter.emplace_back(_rotCenter);
 	force.emplace_back(0);
 }
 
@@ -97,7 +115,9 @@ void SWallStruct::Resize(size_t n)
 
 	coordInfo.resize(n);
 	normalVector.resize(n);
-	movementInfo.resize(n);
+	vel.resize(n);
+	rotVel.resize(n);
+	rotCenter.resize(n);
 	force.resize(n);
 }
 
@@ -126,9 +146,21 @@ void SSolidBondStruct::AddSolidBond(bool _active, unsigned _initIndex, size_t _l
 {
 	AddBond(_active, _initIndex, _leftID, _rightID);
 
-	baseInfo.emplace_back(_diameter, _crossCut, _initialLength, _axialMoment, _normalStiffness, _tangentialStiffness, _vTangOverlap);
-	strengthInfo.emplace_back(_normalStrength, _tangentialStrength);
-	kinematicsInfo.emplace_back();
+	diameter.emplace_back(_diameter);
+	crossCut.emplace_back(_crossCut);
+	initialLength.emplace_back(_initialLength);
+	axialMoment.emplace_back(_axialMoment);
+	normalStiffness.emplace_back(_normalStiffness);
+	tangentialStiffness.emplace_back(_tangentialStiffness);
+	tangentialOverlap.emplace_back(_vTangOverlap);
+	tangentialForce.emplace_back(0);
+	prevBond.emplace_back(0);
+	normalStrength.emplace_back(_normalStrength);
+	tangentialStrength.emplace_back(_tangentialStrength);
+	totalForce.emplace_back(0);
+	normalMoment.emplace_back(0);
+	tangentialMoment.emplace_back(0);
+	unsymMoment.emplace_back(0);
 }
 
 void SSolidBondStruct::AddViscosity(double _viscosity)
@@ -165,9 +197,21 @@ void SSolidBondStruct::Resize(size_t n)
 {
 	SBondStruct::Resize(n);
 
-	baseInfo.resize(n);
-	strengthInfo.resize(n);
-	kinematicsInfo.resize(n);
+	diameter.resize(n);
+	crossCut.resize(n);
+	initialLength.resize(n);
+	axialMoment.resize(n);
+	normalStiffness.resize(n);
+	tangentialStiffness.resize(n);
+	tangentialOverlap.resize(n);
+	tangentialForce.resize(n);
+	prevBond.resize(n);
+	normalStrength.resize(n);
+	tangentialStrength.resize(n);
+	totalForce.resize(n);
+	normalMoment.resize(n);
+	tangentialMoment.resize(n);
+	unsymMoment.resize(n);
 
 	if (!viscosity.empty())					viscosity.resize(n);
 	if (!timeThermExpCoeff.empty())			timeThermExpCoeff.resize(n);
@@ -196,6 +240,35 @@ void SLiquidBondStruct::Resize(size_t n)
 	kinematicsInfo.resize(n);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////// SParticlesToBonds
+
+void SParticlesToBonds::Build(const SParticleStruct& _particles, const SBondStruct& _bonds)
+{
+	const auto IsConnected = [&](size_t i) { return _bonds.Active(i) && _particles.Active(_bonds.LeftID(i)) && _particles.Active(_bonds.RightID(i)); };
+
+	// count bonds of each particle
+	offsets.assign(_particles.Size() + 1, 0);
+	for (size_t i = 0; i < _bonds.Size(); ++i)
+		if (IsConnected(i))
+		{
+			offsets[_bonds.LeftID(i) + 1]++;
+			offsets[_bonds.RightID(i) + 1]++;
+		}
+	for (size_t i = 1; i < offsets.size(); ++i)
+		offsets[i] += offsets[i - 1];
+
+	// fill lists, keeping bonds of each particle sorted
+	bonds.resize(offsets.back());
+	std::vector<unsigned> positions(offsets.begin(), offsets.end() - 1);
+	for (size_t i = 0; i < _bonds.Size(); ++i)
+		if (IsConnected(i))
+		{
+			bonds[positions[_bonds.LeftID(i)]++] = static_cast<unsigned>(i);
+			bonds[positions[_bonds.RightID(i)]++] = static_cast<unsigned>(i);
+		}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////// SMultiSphere
 
@@ -213,3 +286,74 @@ void SMultiSphere::Resize(size_t n)
 	matrices.resize(n);
 	props.resize(n);
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+////////// SCollisionFields
+
+void SCollisionFields::SetActive(const SOptionalVariables& _vars, bool _analyzeCollisions)
+{
+	equivMass.SetActive(_vars.bContactEquivalents);
+	equivRadius.SetActive(_vars.bContactEquivalents);
+	resultMoment1.SetActive(_vars.bContactMoments);
+	resultMoment2.SetActive(_vars.bContactMoments);
+	heatFlux.SetActive(_vars.bContactHeatFlux);
+	initNormalOverlap.SetActive(_vars.bContactInitOverlap);
+	tangForce.SetActive(_vars.bContactTangForce || _analyzeCollisions);
+	save.SetActive(_analyzeCollisions);
+}
+
+void SCollisionFields::Reserve(size_t _n)
+{
+	equivMass.Reserve(_n);
+	equivRadius.Reserve(_n);
+	resultMoment1.Reserve(_n);
+	resultMoment2.Reserve(_n);
+	heatFlux.Reserve(_n);
+	initNormalOverlap.Reserve(_n);
+	tangForce.Reserve(_n);
+	save.Reserve(_n);
+}
+
+void SCollisionFields::Reset(size_t _slot)
+{
+	if (equivMass.Active())			equivMass[_slot] = 0;
+	if (equivRadius.Active())		equivRadius[_slot] = 0;
+	if (resultMoment1.Active())		resultMoment1[_slot].Init(0);
+	if (resultMoment2.Active())		resultMoment2[_slot].Init(0);
+	if (heatFlux.Active())			heatFlux[_slot] = 0;
+	if (initNormalOverlap.Active())	initNormalOverlap[_slot] = 0;
+	if (tangForce.Active())			tangForce[_slot].Init(0);
+	if (save.Active())				save[_slot] = nullptr;
+}
+
+void SCollisionFields::Copy(size_t _dstSlot, const SCollisionFields& _src, size_t _srcSlot)
+{
+	if (equivMass.Active())			equivMass[_dstSlot] = _src.equivMass[_srcSlot];
+	if (equivRadius.Active())		equivRadius[_dstSlot] = _src.equivRadius[_srcSlot];
+	if (resultMoment1.Active())		resultMoment1[_dstSlot] = _src.resultMoment1[_srcSlot];
+	if (resultMoment2.Active())		resultMoment2[_dstSlot] = _src.resultMoment2[_srcSlot];
+	if (heatFlux.Active())			heatFlux[_dstSlot] = _src.heatFlux[_srcSlot];
+	if (initNormalOverlap.Active())	initNormalOverlap[_dstSlot] = _src.initNormalOverlap[_srcSlot];
+	if (tangForce.Active())			tangForce[_dstSlot] = _src.tangForce[_srcSlot];
+	if (save.Active())				save[_dstSlot] = _src.save[_srcSlot];
+}
+
+size_t SCollisionFields::BytesPerContact() const
+{
+	size_t res = sizeof(SCollision);
+	if (equivMass.Active())			res += sizeof(decltype(equivMass)::value_type);
+	if (equivRadius.Active())		res += sizeof(decltype(equivRadius)::value_type);
+	if (resultMoment1.Active())		res += sizeof(decltype(resultMoment1)::value_type);
+	if (resultMoment2.Active())		res += sizeof(decltype(resultMoment2)::value_type);
+	if (heatFlux.Active())			res += sizeof(decltype(heatFlux)::value_type);
+	if (initNormalOverlap.Active())	res += sizeof(decltype(initNormalOverlap)::value_type);
+	if (tangForce.Active())			res += sizeof(decltype(tangForce)::value_type);
+	if (save.Active())				res += sizeof(decltype(save)::value_type);
+	return res;
+}
+
+size_t SCollisionFields::Memory() const
+{
+	return equivMass.Memory() + equivRadius.Memory() + resultMoment1.Memory() + resultMoment2.Memory()
+		+ heatFlux.Memory() + initNormalOverlap.Memory() + tangForce.Memory() + save.Memory();
+}
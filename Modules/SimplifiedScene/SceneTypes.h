@@ -3,7 +3,10 @@
    See LICENSE file for license and warranty information. */
 
 #pragma once
+#include "AlignedAllocator.h"
 #include "Quaternion.h"
+#include "SceneOptionalVariables.h"
+#include <memory>
 #include <vector>
 
 #define _EXPAND(x) x
@@ -15,6 +18,9 @@ decltype(var_name)::reference		fun_name(const size_t i)       { return var_name[
 decltype(var_name)::const_reference fun_name(const size_t i) const { return var_name[i]; }
 #define _RESOLVE_MACRO(_1,_2,_3,NAME,...) NAME
 #define ADD_GET_SET(...) _EXPAND(_RESOLVE_MACRO(__VA_ARGS__, _ADD_GET_SET_3, _ADD_GET_SET_2)(__VA_ARGS__))
+#define ADD_COLLISION_FIELD(fun_name, var_name) \
+	  decltype(var_name)::value_type& fun_name(const SCollision* c)		  { return var_name[c->nSlot]; } \
+const decltype(var_name)::value_type& fun_name(const SCollision* c) const { return var_name[c->nSlot]; }
 
 struct SGeneralObject
 {
@@ -43,22 +49,15 @@ protected:
 struct SBasicParticleStruct : SGeneralObject
 {
 protected:
-	struct SContactInformation
-	{
-		CVector3	coord;
-		double		contactRadius{};
-		CVector3	coordVerlet;
-
-		SContactInformation() = default;
-		SContactInformation(const CVector3& _coord, double _contactRadius, const CVector3& _coordVerlet)
-			: coord{ _coord }, contactRadius{ _contactRadius }, coordVerlet{ _coordVerlet } {}
-	};
-	std::vector<SContactInformation> contactInfo;
+	// contact information: each field is stored in a separate aligned array
+	aligned_vector<CVector3>	coord;
+	aligned_vector<double>		contactRadius;
+	aligned_vector<CVector3>	coordVerlet;
 
 public:
-	ADD_GET_SET(Coord,			contactInfo, coord)
-	ADD_GET_SET(ContactRadius,	contactInfo, contactRadius)
-	ADD_GET_SET(CoordVerlet,	contactInfo, coordVerlet)		// coordinates of particles, which was used for last verlet calculation
+	ADD_GET_SET(Coord,			coord)
+	ADD_GET_SET(ContactRadius,	contactRadius)
+	ADD_GET_SET(CoordVerlet,	coordVerlet)		// coordinates of particles, which was used for last verlet calculation
 
 	void AddBasicParticle(bool _active, CVector3 _coord, double _contactRadius, unsigned _initIndex);
 };
@@ -66,21 +65,6 @@ public:
 struct SParticleStruct : SBasicParticleStruct
 {
 private:
-	struct SKinematics
-	{
-		double		radius{};
-		double		mass{};
-		double		inertiaMoment{};
-		CVector3	vel;
-		CVector3	anglVel;
-		CVector3	force;
-		CVector3	moment;
-
-		SKinematics() = default;
-		SKinematics(double _radius, double _mass, double _inertiaMoment, const CVector3& _vel, const CVector3& _anglVel, const CVector3& _force, const CVector3& _moment)
-			: radius{ _radius }, mass{ _mass }, inertiaMoment{ _inertiaMoment }, vel{ _vel }, anglVel{ _anglVel }, force{ _force }, moment{ _moment } {}
-	};
-
 	struct SThermals
 	{
 		double temperature;
@@ -92,8 +76,14 @@ private:
 			: temperature{ _temperature }, heatCapacity{ _heatCapacity }, heatFlux{ _heatFlux } {}
 	};
 
-	// required variables
-	std::vector<SKinematics> kinematicsInfo;
+	// required variables: each field is stored in a separate aligned array
+	aligned_vector<double>		radius;
+	aligned_vector<double>		mass;
+	aligned_vector<double>		inertiaMoment;
+	aligned_vector<CVector3>	vel;
+	aligned_vector<CVector3>	anglVel;
+	aligned_vector<CVector3>	force;
+	aligned_vector<CVector3>	moment;
 
 	// optional variables
 	std::vector<CQuaternion>	quaternion;
@@ -101,13 +91,13 @@ private:
 	std::vector<SThermals>		thermalInfo;
 
 public:
-	ADD_GET_SET(Radius,			kinematicsInfo, radius)
-	ADD_GET_SET(Mass,			kinematicsInfo, mass)
-	ADD_GET_SET(InertiaMoment,	kinematicsInfo, inertiaMoment)
-	ADD_GET_SET(Vel,			kinematicsInfo, vel)
-	ADD_GET_SET(AnglVel,		kinematicsInfo, anglVel)
-	ADD_GET_SET(Force,			kinematicsInfo, force)
-	ADD_GET_SET(Moment,			kinematicsInfo, moment)
+	ADD_GET_SET(Radius,			radius)
+	ADD_GET_SET(Mass,			mass)
+	ADD_GET_SET(InertiaMoment,	inertiaMoment)
+	ADD_GET_SET(Vel,			vel)
+	ADD_GET_SET(AnglVel,		anglVel)
+	ADD_GET_SET(Force,			force)
+	ADD_GET_SET(Moment,			moment)
 
 	// Get optional variables. Warning: no bounds check. Caller needs to ensure existence.
 	ADD_GET_SET(Quaternion,		quaternion)
@@ -145,21 +135,12 @@ public:
 	};
 
 private:
-	struct SMovement
-	{
-		CVector3 vel;
-		CVector3 rotVel;
-		CVector3 rotCenter;
-
-		SMovement() = default;
-		SMovement(const CVector3& _vel, const CVector3& _rotVel, const CVector3& _rotCenter)
-			: vel{ _vel }, rotVel{ _rotVel }, rotCenter{ _rotCenter } {}
-	};
-
-	std::vector<SCoordinates>	coordInfo;
-	std::vector<CVector3>		normalVector;   // TODO: maybe put into SCoordinates
-	std::vector<SMovement>		movementInfo;
-	std::vector<CVector3>		force;
+	aligned_vector<SCoordinates>	coordInfo;		// vertices and bounding box are always used together in contact detection
+	aligned_vector<CVector3>		normalVector;   // TODO: maybe put into SCoordinates
+	aligned_vector<CVector3>		vel;
+	aligned_vector<CVector3>		rotVel;
+	aligned_vector<CVector3>		rotCenter;
+	aligned_vector<CVector3>		force;
 
 public:
 	ADD_GET_SET(Coordinates, coordInfo)
@@ -172,9 +153,9 @@ public:
 
 	ADD_GET_SET(NormalVector,	normalVector)
 
-	ADD_GET_SET(Vel,		movementInfo, vel)
-	ADD_GET_SET(RotVel,		movementInfo, rotVel)
-	ADD_GET_SET(RotCenter,	movementInfo, rotCenter)
+	ADD_GET_SET(Vel,		vel)
+	ADD_GET_SET(RotVel,		rotVel)
+	ADD_GET_SET(RotCenter,	rotCenter)
 
 	ADD_GET_SET(Force, force)
 
@@ -208,41 +189,6 @@ public:
 struct SSolidBondStruct : SBondStruct
 {
 private:
-	struct SBaseInfo
-	{
-		double		diameter{};
-		double		crossCut{};
-		double		initialLength{};
-		double		axialMoment{};
-		double		normalStiffness{};
-		double		tangentialStiffness{};
-		CVector3	tangentialOverlap{ 0 };
-		CVector3	tangentialForce{ 0 };
-		CVector3	prevBond{ 0 };
-
-		SBaseInfo() = default;
-		SBaseInfo(double _diameter, double _crossCut, double _initialLength, double _axialMoment, double _normalStiffness, double _tangentialStiffness, const CVector3& _vTangOverlap)
-			: diameter{ _diameter }, crossCut{ _crossCut }, initialLength{ _initialLength }, axialMoment{ _axialMoment },
-			normalStiffness{ _normalStiffness }, tangentialStiffness{ _tangentialStiffness }, tangentialOverlap{ _vTangOverlap }{}
-	};
-
-	struct SStrength
-	{
-		double normalStrength;
-		double tangentialStrength;
-
-		SStrength() = default;
-		SStrength(double _normalStrength, double _tangentialStrength) : normalStrength{ _normalStrength }, tangentialStrength{ _tangentialStrength } {}
-	};
-
-	struct SKinematics
-	{
-		CVector3 totalForce{ 0 };		// normal + tangential
-		CVector3 normalMoment{ 0 };
-		CVector3 tangentialMoment{ 0 };
-		CVector3 unsymMoment{ 0 };		// unsymmetrical moment
-	};
-
 	struct SThermals
 	{
 		double heatFlux;
@@ -253,10 +199,22 @@ private:
 			: heatFlux{ _heatFlux }, thermalConductivity{ _thermalConductivity } {}
 	};
 
-	// required variables
-	std::vector<SBaseInfo>		baseInfo;
-	std::vector<SStrength>		strengthInfo;
-	std::vector<SKinematics>	kinematicsInfo;
+	// required variables: each field is stored in a separate aligned array
+	aligned_vector<double>		diameter;
+	aligned_vector<double>		crossCut;
+	aligned_vector<double>		initialLength;
+	aligned_vector<double>		axialMoment;
+	aligned_vector<double>		normalStiffness;
+	aligned_vector<double>		tangentialStiffness;
+	aligned_vector<CVector3>	tangentialOverlap;
+	aligned_vector<CVector3>	tangentialForce;
+	aligned_vector<CVector3>	prevBond;
+	aligned_vector<double>		normalStrength;
+	aligned_vector<double>		tangentialStrength;
+	aligned_vector<CVector3>	totalForce;			// normal + tangential
+	aligned_vector<CVector3>	normalMoment;
+	aligned_vector<CVector3>	tangentialMoment;
+	aligned_vector<CVector3>	unsymMoment;		// unsymmetrical moment
 
 	// optional variables
 	std::vector<double>		viscosity;
@@ -267,23 +225,23 @@ private:
 	std::vector<SThermals>	thermalInfo;
 
 public:
-	ADD_GET_SET(Diameter,				baseInfo, diameter)
-	ADD_GET_SET(CrossCut,				baseInfo, crossCut)
-	ADD_GET_SET(InitialLength,			baseInfo, initialLength)
-	ADD_GET_SET(AxialMoment,			baseInfo, axialMoment)
-	ADD_GET_SET(NormalStiffness,		baseInfo, normalStiffness)
-	ADD_GET_SET(TangentialStiffness,	baseInfo, tangentialStiffness)
-	ADD_GET_SET(TangentialOverlap,		baseInfo, tangentialOverlap)
-	ADD_GET_SET(TangentialForce,		baseInfo, tangentialForce)
-	ADD_GET_SET(PrevBond,				baseInfo, prevBond)
-
-	ADD_GET_SET(NormalStrength,		strengthInfo, normalStrength)
-	ADD_GET_SET(TangentialStrength, strengthInfo, tangentialStrength)
-
-	ADD_GET_SET(TotalForce,			kinematicsInfo, totalForce)
-	ADD_GET_SET(NormalMoment,		kinematicsInfo, normalMoment)
-	ADD_GET_SET(TangentialMoment,	kinematicsInfo, tangentialMoment)
-	ADD_GET_SET(UnsymMoment,		kinematicsInfo, unsymMoment)
+	ADD_GET_SET(Diameter,				diameter)
+	ADD_GET_SET(CrossCut,				crossCut)
+	ADD_GET_SET(InitialLength,			initialLength)
+	ADD_GET_SET(AxialMoment,			axialMoment)
+	ADD_GET_SET(NormalStiffness,		normalStiffness)
+	ADD_GET_SET(TangentialStiffness,	tangentialStiffness)
+	ADD_GET_SET(TangentialOverlap,		tangentialOverlap)
+	ADD_GET_SET(TangentialForce,		tangentialForce)
+	ADD_GET_SET(PrevBond,				prevBond)
+
+	ADD_GET_SET(NormalStrength,		normalStrength)
+	ADD_GET_SET(TangentialStrength, tangentialStrength)
+
+	ADD_GET_SET(TotalForce,			totalForce)
+	ADD_GET_SET(NormalMoment,		normalMoment)
+	ADD_GET_SET(TangentialMoment,	tangentialMoment)
+	ADD_GET_SET(UnsymMoment,		unsymMoment)
 
 	ADD_GET_SET(Viscosity,					viscosity)
 	ADD_GET_SET(TimeThermExpCoeff,			timeThermExpCoeff)
@@ -349,6 +307,20 @@ public:
 	void Resize(size_t n);
 };
 
+// Adjacency of particles to bonds in compressed sparse row format: indices of bonds connected to particle i are stored in bonds[offsets[i]...offsets[i+1]).
+struct SParticlesToBonds
+{
+	std::vector<unsigned> offsets;	// Beginning of the list of each particle in bonds; the last element is the total number of entries.
+	std::vector<unsigned> bonds;	// Indices of bonds, grouped by particles.
+
+	// Builds adjacency of all particles to active bonds, which connect active particles.
+	void Build(const SParticleStruct& _particles, const SBondStruct& _bonds);
+
+	size_t Size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+	const unsigned* Begin(size_t i) const { return bonds.data() + offsets[i]; }
+	const unsigned* End(size_t i) const { return bonds.data() + offsets[i + 1]; }
+};
+
 struct SMultiSphere
 {
 private:
@@ -414,6 +386,7 @@ struct SSavedCollision
 };
 
 // Used to describe particle-particle and particle-wall collision.
+// Contains only the data used by all contact models; optional data are stored in SCollisionFields.
 struct SCollision
 {
 	bool bContactStillExist{};      // this flag is used to determine if the contact still exist in compare to previous step
@@ -421,20 +394,85 @@ struct SCollision
 	uint16_t nInteractProp{};       // index of interaction property
 	unsigned nSrcID{};			    // identifier of first contact partner or wall (nWallID)
 	unsigned nDstID{};			    // identifier of second contact partner
+	unsigned nSlot{};				// index of the contact in the arrays of optional fields
 	double dNormalOverlap{};	    //
-	double dEquivMass{};		    // equivalent mass
-	double dEquivRadius{};	        // equivalent radius
-	double dInitNormalOverlap{};    // used for modeling of sintering process
-	double dHeatFlux{};		        // heat flux to this particle caused
 	CVector3 vTangOverlap{ 0.0 };   // old tangential overlap
-	CVector3 vTangForce{ 0.0 };	    // total tangential force
 	CVector3 vTotalForce{ 0.0 };
-	CVector3 vResultMoment1{ 0.0 }; // moment which acts on first particle
-	CVector3 vResultMoment2{ 0.0 }; // moment which acts on first particle
 	CVector3 vContactVector{ 0.0 }; // For PP contact: dstCoord - srcCoord. For PW contact: contact point.
-	SSavedCollision *pSave{};
 };
 
+// Optional fields of contacts, which are needed only by some contact models or by the analysis of collisions.
+// Each field is stored in a separate array, which is allocated only if the field is active. Fields of a contact are addressed by SCollision::nSlot.
+struct SCollisionFields
+{
+private:
+	// Array, which grows by chunks without moving existing elements, so it can be read by other threads while growing.
+	template<typename T>
+	class CChunkedArray
+	{
+		static constexpr size_t CHUNK_SIZE = 4096;
+		static constexpr size_t MAX_CHUNKS = 1 << 16;
+		std::vector<std::unique_ptr<T[]>> m_chunks;
+		bool m_active{ false };
+
+	public:
+		using value_type = T;
+
+		T& operator[](size_t i) { return m_chunks[i / CHUNK_SIZE][i % CHUNK_SIZE]; }
+		const T& operator[](size_t i) const { return m_chunks[i / CHUNK_SIZE][i % CHUNK_SIZE]; }
+
+		bool Active() const { return m_active; }
+		void SetActive(bool _active) { m_active = _active; m_chunks.clear(); }
+		// Allocates memory for at least _n elements, if the array is active.
+		void Reserve(size_t _n)
+		{
+			if (!m_active) return;
+			if (m_chunks.capacity() < MAX_CHUNKS) m_chunks.reserve(MAX_CHUNKS); // the list of chunks itself must not be reallocated
+			while (m_chunks.size() * CHUNK_SIZE < _n)
+				m_chunks.emplace_back(new T[CHUNK_SIZE]{});
+		}
+		// Size of allocated memory in bytes.
+		size_t Memory() const { return m_chunks.size() * CHUNK_SIZE * sizeof(T); }
+	};
+
+	CChunkedArray<double>			equivMass;			// equivalent mass
+	CChunkedArray<double>			equivRadius;		// equivalent radius
+	CChunkedArray<CVector3>			resultMoment1;		// moment which acts on first contact partner
+	CChunkedArray<CVector3>			resultMoment2;		// moment which acts on second contact partner
+	CChunkedArray<double>			heatFlux;			// heat flux to the particle
+	CChunkedArray<double>			initNormalOverlap;	// used for modeling of sintering process
+	CChunkedArray<CVector3>			tangForce;			// total tangential force
+	CChunkedArray<SSavedCollision*>	save;				// data for analysis of collisions
+
+public:
+	ADD_COLLISION_FIELD(EquivMass,			equivMass)
+	ADD_COLLISION_FIELD(EquivRadius,		equivRadius)
+	ADD_COLLISION_FIELD(ResultMoment1,		resultMoment1)
+	ADD_COLLISION_FIELD(ResultMoment2,		resultMoment2)
+	ADD_COLLISION_FIELD(HeatFlux,			heatFlux)
+	ADD_COLLISION_FIELD(InitNormalOverlap,	initNormalOverlap)
+	ADD_COLLISION_FIELD(TangForce,			tangForce)
+	ADD_COLLISION_FIELD(Save,				save)
+
+	bool EquivalentsExist() const { return equivMass.Active(); }
+	// Tangential force is stored only for analysis of collisions or if a model has requested it, so other models must check its existence before writing it.
+	bool TangForceExist() const { return tangForce.Active(); }
+
+	// Selects fields to be stored, according to the requirements of models and analysis of collisions. Releases all memory.
+	void SetActive(const SOptionalVariables& _vars, bool _analyzeCollisions);
+	// Allocates memory of all active fields for contacts with slots [0, _n).
+	void Reserve(size_t _n);
+	// Sets all active fields of the contact in the slot to their default values.
+	void Reset(size_t _slot);
+	// Copies all active fields of the contact from the slot of another storage with the same set of active fields.
+	void Copy(size_t _dstSlot, const SCollisionFields& _src, size_t _srcSlot);
+	// Returns the number of bytes per contact: in the compact record and in all active fields.
+	size_t BytesPerContact() const;
+	// Returns the size of allocated memory in bytes.
+	size_t Memory() const;
+};
+
+#undef ADD_COLLISION_FIELD
 #undef ADD_GET_SET
 #undef _RESOLVE_MACRO
 #undef _ADD_GET_SET_2
@@ -12,6 +12,8 @@ CSimplifiedScene::CSimplifiedScene()
 	m_Objects.vLiquidBonds = std::make_shared<SLiquidBondStruct>();
 	m_Objects.vWalls = std::make_shared<SWallStruct>();
 	m_Objects.vMultiSpheres = std::make_shared<SMultiSphere>();
+	m_Objects.nVirtualParticles = 0;
+	m_PBC.SetDefaultValues();
 
 	m_vInteractProps = std::make_shared<std::vector<SInteractProps>>();
 	m_vParticlesToSolidBonds = std::make_shared<std::vector<std::vector<unsigned>>>();
@@ -72,12 +74,14 @@ void CSimplifiedScene::InitializeScene(double _dStartTime, const SOptionalVariab
 		viParticles.push_back(pair.second);
 
 	// add geometrical objects
+	std::vector<size_t> viGeometryWallsEnd;
 	for (size_t i = 0; i < m_pSystemStructure->GeometriesNumber(); ++i)
 	{
 		CRealGeometry* pGeom = m_pSystemStructure->Geometry(i);
 		for (const auto& plane : pGeom->Planes())
 			if (m_pSystemStructure->GetObjectByIndex(plane))
 				viWalls.push_back(plane);
+		viGeometryWallsEnd.push_back(viWalls.size());
 		pGeom->Motion()->ResetMotionInfo();
 	}
 
@@ -94,9 +98,14 @@ void CSimplifiedScene::InitializeScene(double _dStartTime, const SOptionalVariab
 	for (size_t i = 0; i < viLiquidBonds.size(); ++i)
 		AddLiquidBond(viLiquidBonds[i], _dStartTime);
 
-	// fill in memory for walls bonds
-	for (size_t i = 0; i < viWalls.size(); ++i)
-		AddWall(viWalls[i], _dStartTime);
+	// fill in memory for walls, keeping walls of each geometry together
+	m_vGeometryWalls.assign(1, 0);
+	for (size_t iGeom = 0, i = 0; iGeom < viGeometryWallsEnd.size(); ++iGeom)
+	{
+		for (; i < viGeometryWallsEnd[iGeom]; ++i)
+			AddWall(viWalls[i], _dStartTime);
+		m_vGeometryWalls.push_back(m_Objects.vWalls->Size());
+	}
 
 	// fill in memory for multispheres
 	for (unsigned i = 0; i < m_pSystemStructure->GetMultispheresNumber(); ++i)
@@ -125,6 +134,8 @@ void CSimplifiedScene::UpdateParticlesToBonds()
 			}
 		}
 	}
+	m_particlesToSolidBonds.Build(*m_Objects.vParticles, *m_Objects.vSolidBonds);
+	m_particlesToLiquidBonds.Build(*m_Objects.vParticles, *m_Objects.vLiquidBonds);
 }
 
 void CSimplifiedScene::AddParticle(size_t _index, double _dTime)
@@ -452,17 +463,51 @@ void CSimplifiedScene::AddVirtualParticles(double _dVerletDistance)
 		m_PBC.currentDomain.coordBeg + _dVerletDistance + dMaxContactRadius,
 		m_PBC.currentDomain.coordEnd - _dVerletDistance - dMaxContactRadius
 	};
-	const CVector3& t = m_PBC.boundaryShift;
+	// until the next update of verlet lists, particles move less than the verlet distance and boundaries less than half of it,
+	// so only particles within the cross slab can cross boundaries, and only particles within the contact slab can be in contact with them
+	const double dCrossSlab = 2 * _dVerletDistance;
+	const double dContactSlab = dCrossSlab + _dVerletDistance + 2 * dMaxContactRadius;
+
+	// flags of particles
+	enum : uint8_t { X_L = 1, Y_L = 2, Z_L = 4, X_G = 8, Y_G = 16, CROSS_SLAB = 32, CONTACT_SLAB = 64 };
 	const size_t nRealPartCount = m_Objects.vParticles->Size();
-	for (size_t i = 0; i < nRealPartCount; ++i)
+	std::vector<uint8_t> vFlags(nRealPartCount);
+	ParallelFor(nRealPartCount, [&](size_t i)
 	{
 		const CVector3& coord = m_Objects.vParticles->Coord(i);
-		const bool xL = m_PBC.bX && (coord.x - m_Objects.vParticles->ContactRadius(i) <= virtDomain.coordBeg.x);
-		const bool yL = m_PBC.bY && (coord.y - m_Objects.vParticles->ContactRadius(i) <= virtDomain.coordBeg.y);
-		const bool zL = m_PBC.bZ && (coord.z - m_Objects.vParticles->ContactRadius(i) <= virtDomain.coordBeg.z);
+		const double dRadius = m_Objects.vParticles->ContactRadius(i);
+		const SVolumeType& domain = m_PBC.currentDomain;
+		double dDistance = std::numeric_limits<double>::max(); // distance to the nearest periodic boundary
+		if (m_PBC.bX) dDistance = std::min({ dDistance, coord.x - domain.coordBeg.x, domain.coordEnd.x - coord.x });
+		if (m_PBC.bY) dDistance = std::min({ dDistance, coord.y - domain.coordBeg.y, domain.coordEnd.y - coord.y });
+		if (m_PBC.bZ) dDistance = std::min({ dDistance, coord.z - domain.coordBeg.z, domain.coordEnd.z - coord.z });
+		uint8_t flags = 0;
+		if (m_PBC.bX && (coord.x - dRadius <= virtDomain.coordBeg.x)) flags |= X_L;
+		if (m_PBC.bY && (coord.y - dRadius <= virtDomain.coordBeg.y)) flags |= Y_L;
+		if (m_PBC.bZ && (coord.z - dRadius <= virtDomain.coordBeg.z)) flags |= Z_L;
+		if (m_PBC.bX && (coord.x + dRadius >= virtDomain.coordEnd.x)) flags |= X_G;
+		if (m_PBC.bY && (coord.y + dRadius >= virtDomain.coordEnd.y)) flags |= Y_G;
+		if (dDistance <= dCrossSlab)   flags |= CROSS_SLAB;
+		if (dDistance <= dContactSlab) flags |= CONTACT_SLAB;
+		vFlags[i] = flags;
+	});
 
-		const bool xG = m_PBC.bX && (coord.x + m_Objects.vParticles->ContactRadius(i) >= virtDomain.coordEnd.x);
-		const bool yG = m_PBC.bY && (coord.y + m_Objects.vParticles->ContactRadius(i) >= virtDomain.coordEnd.y);
+	// virtual particles are added in the order of real ones
+	m_vPBCCrossCandidates.clear();
+	m_vPBCSlabParticles.clear();
+	const CVector3& t = m_PBC.boundaryShift;
+	for (size_t i = 0; i < nRealPartCount; ++i)
+	{
+		const uint8_t flags = vFlags[i];
+		if (!flags) continue;
+		if (flags & CROSS_SLAB)   m_vPBCCrossCandidates.push_back(static_cast<unsigned>(i));
+		if (flags & CONTACT_SLAB) m_vPBCSlabParticles.push_back(static_cast<unsigned>(i));
+
+		const bool xL = flags & X_L;
+		const bool yL = flags & Y_L;
+		const bool zL = flags & Z_L;
+		const bool xG = flags & X_G;
+		const bool yG = flags & Y_G;
 
 		if (xL)				AddVirtualParticleBox(i, CVector3(t.x, 0, 0));
 		if (yL)				AddVirtualParticleBox(i, CVector3(0, t.y, 0));
@@ -482,8 +527,6 @@ void CSimplifiedScene::AddVirtualParticles(double _dVerletDistance)
 	}
 }
 
-
-
 void CSimplifiedScene::GetAllParticlesInVolume(const SVolumeType& _volume, std::vector<unsigned>* _pvIndexes) const
 {
 	_pvIndexes->clear();
@@ -525,35 +568,21 @@ void CSimplifiedScene::SaveVerletCoords()
 
 double CSimplifiedScene::GetMaxPartVerletDistance()
 {
-	static std::vector<double> vTempBuffer;
-	vTempBuffer.resize(m_Objects.vParticles->Size());
-	ParallelFor(m_Objects.vParticles->Size(), [&](size_t i)
+	const SParticleStruct& particles = *m_Objects.vParticles;
+	return sqrt(ParallelMax(particles.Size(), 0.0, [&](size_t i)
 	{
-		if (m_Objects.vParticles->Active(i))
-			vTempBuffer[i] = SquaredLength(m_Objects.vParticles->Coord(i) - m_Objects.vParticles->CoordVerlet(i));
-		else
-			vTempBuffer[i] = 0;
-	});
-	return sqrt(VectorMax(vTempBuffer));
+		return particles.Active(i) ? SquaredLength(particles.Coord(i) - particles.CoordVerlet(i)) : 0.0;
+	}));
 }
 
 
 double CSimplifiedScene::GetMaxParticleVelocity() const
 {
-	size_t nThreadsNumber = GetThreadsNumber();
-	std::vector<double> vMaxVel(nThreadsNumber, 0);
-	ParallelFor(m_Objects.vParticles->Size(), [&](size_t i)
+	const SParticleStruct& particles = *m_Objects.vParticles;
+	return sqrt(ParallelMax(particles.Size(), 0.0, [&](size_t i)
 	{
-		const size_t nIndex = i % nThreadsNumber;
-		if (m_Objects.vParticles->Active(i))
-		{
-			const double dTemp = m_Objects.vParticles->Vel(i).SquaredLength();
-			if (vMaxVel[nIndex] < dTemp)
-				vMaxVel[nIndex] = dTemp;
-		}
-	});
-
-	return sqrt(VectorMax(vMaxVel));
+		return particles.Active(i) ? particles.Vel(i).SquaredLength() : 0.0;
+	}));
 }
 
 double CSimplifiedScene::GetMaxParticleTemperature() const
@@ -562,7 +591,7 @@ double CSimplifiedScene::GetMaxParticleTemperature() const
 	std::vector<double> maxTemps(nThreads, 0);
 	ParallelFor(m_Objects.vParticles->Size(), [&](size_t i)
 	{
-		const size_t index = i % nThreads;
+		const size_t index = GetCurrentThreadIndex();
 		if (m_Objects.vParticles->Active(i))
 		{
 			const double temp = m_Objects.vParticles->Temperature(i);
@@ -617,25 +646,34 @@ double CSimplifiedScene::GetMinParticleContactRadius() const
 	return dMinContactRadius;
 }
 
+double CSimplifiedScene::GetWallVelocity(size_t _iWall) const
+{
+	const SWallStruct& walls = *m_Objects.vWalls;
+	const double dLinVel = walls.Vel(_iWall).SquaredLength();
+	const double dSquaredRotVel = walls.RotVel(_iWall).SquaredLength();
+	double dMaxSquaredRotVel = 0;
+	if (dSquaredRotVel > 0)
+		dMaxSquaredRotVel = dSquaredRotVel * std::max({ SquaredLength(walls.Vert1(_iWall) - walls.RotCenter(_iWall)), SquaredLength(walls.Vert2(_iWall) - walls.RotCenter(_iWall)), SquaredLength(walls.Vert3(_iWall) - walls.RotCenter(_iWall)) });
+	return sqrt(dLinVel) + sqrt(dMaxSquaredRotVel);
+}
+
 double CSimplifiedScene::GetMaxWallVelocity() const
 {
-	double* pTemp = new  double[m_Objects.vWalls->Size()];
-	ParallelFor(m_Objects.vWalls->Size(), [&](size_t i)
+	return ParallelMax(m_Objects.vWalls->Size(), 0.0, [&](size_t i)
 	{
-		const double dLinVel = m_Objects.vWalls->Vel(i).SquaredLength();
-		const double dSquaredRotVel = m_Objects.vWalls->RotVel(i).SquaredLength();
-		double dMaxSquaredRotVel = 0;
-		if (dSquaredRotVel > 0)
-			dMaxSquaredRotVel = dSquaredRotVel * std::max({ SquaredLength(m_Objects.vWalls->Vert1(i) - m_Objects.vWalls->RotCenter(i)), SquaredLength(m_Objects.vWalls->Vert2(i) - m_Objects.vWalls->RotCenter(i)), SquaredLength(m_Objects.vWalls->Vert3(i) - m_Objects.vWalls->RotCenter(i)) });
-		pTemp[i] = sqrt(dLinVel) + sqrt(dMaxSquaredRotVel);
+		return GetWallVelocity(i);
 	});
+}
 
-	double dMaxVelocity = 0;
-	for (size_t i = 0; i < m_Objects.vWalls->Size(); ++i)
-		if (pTemp[i] > dMaxVelocity)
-			dMaxVelocity = pTemp[i];
-	delete[] pTemp;
-	return dMaxVelocity;
+std::vector<double> CSimplifiedScene::GetMaxGeometryVelocities() const
+{
+	std::vector<double> res(m_vGeometryWalls.empty() ? 0 : m_vGeometryWalls.size() - 1);
+	for (size_t i = 0; i < res.size(); ++i)
+		res[i] = ParallelMax(m_vGeometryWalls[i + 1] - m_vGeometryWalls[i], 0.0, [&](size_t j)
+		{
+			return GetWallVelocity(m_vGeometryWalls[i] + j);
+		});
+	return res;
 }
 
 double   CSimplifiedScene::GetParticleTemperature(size_t _index) const
@@ -654,6 +692,7 @@ void CSimplifiedScene::ClearAllData()
 	m_Objects.vLiquidBonds->Resize(0);
 	m_Objects.vMultiSpheres->Resize(0);
 	m_Objects.vWalls->Resize(0);
+	m_vGeometryWalls.clear();
 }
 
 void CSimplifiedScene::InitializeLiquidBondsCharacteristics(double _dTime)
@@ -20,6 +20,8 @@ private:
 	// precalculated properties of compounds' interactions. this is a 2D symmetric matrix stored as 1D array
 	std::shared_ptr<std::vector<SInteractProps>> m_vInteractProps;
 	std::shared_ptr<std::vector<std::vector<unsigned>>> m_vParticlesToSolidBonds; // array contain information about indexes of bonds which are connected to specific particle
+	SParticlesToBonds m_particlesToSolidBonds;	// Compressed adjacency of particles to solid bonds.
+	SParticlesToBonds m_particlesToLiquidBonds;	// Compressed adjacency of particles to liquid bonds.
 
 	SObjects m_Objects;	// all objects for consideration in the scene, including virtual ones (in case of periodic boundary conditions)
 public:
@@ -29,9 +31,12 @@ public:
 	// Periodic Boundary Conditions
 	SPBC m_PBC;							   // Information about periodic boundary conditions
 	std::vector<uint8_t> m_vPBCVirtShift; // Information to shift real particle in order to find position of its virtual one. For BOX: {x, y, z}, for CYLINDER: {cos(a), sin (a), 0}. The vector length is equal to the number of virtual particles.
+	std::vector<unsigned> m_vPBCCrossCandidates;	// Real particles in boundary slabs, which may cross PBC boundaries before the next update of verlet lists.
+	std::vector<unsigned> m_vPBCSlabParticles;	// Real particles in boundary slabs, which may have contacts with crossing particles before the next update of verlet lists.
 	//////////////////////////////////////////////////////////////////////////
 
 	std::vector<std::vector<unsigned>> m_adjacentWalls; // Contains list of adjacent walls for each wall.
+	std::vector<size_t> m_vGeometryWalls; // Walls of each geometry are stored contiguously: geometry i has walls [m_vGeometryWalls[i], m_vGeometryWalls[i + 1]).
 
 private:
 	CSystemStructure* m_pSystemStructure;
@@ -77,6 +82,7 @@ public:
 	double GetMaxParticleContactRadius() const;
 	double GetMinParticleContactRadius() const;
 	double GetMaxWallVelocity() const;
+	std::vector<double> GetMaxGeometryVelocities() const; // Returns maximal velocity of walls of each geometry.
 
 	void UpdateParticlesToBonds();
 
@@ -113,6 +119,8 @@ public:
 
 
 	std::shared_ptr<std::vector<std::vector<unsigned>>> GetPointerToPartToSolidBonds() { return m_vParticlesToSolidBonds; }
+	const SParticlesToBonds& GetParticlesToSolidBonds() const { return m_particlesToSolidBonds; }
+	const SParticlesToBonds& GetParticlesToLiquidBonds() const { return m_particlesToLiquidBonds; }
 
 	size_t GetTotalParticlesNumber() const { return m_Objects.vParticles->Size(); }
 	size_t GetVirtualParticlesNumber()const { return m_Objects.nVirtualParticles;  }
@@ -131,6 +139,7 @@ protected:
 	void AddVirtualParticleBox(size_t _nSourceID, const CVector3& _vShift);
 
 	void FindAdjacentWalls(); // Constructs a list of adjacent walls for each wall.
+	double GetWallVelocity(size_t _iWall) const; // Returns maximal velocity of points of the wall.
 };
 
 
@@ -32,10 +32,25 @@ void CBaseSimulator::LoadConfiguration()
 		SetMaxCells(sim.max_cells_number());
 		SetVerletCoeff(sim.verlet_dist_coeff());
 		SetAutoAdjustFlag(sim.verlet_auto_adjust());
+		SetVerletGridType(static_cast<EVerletGridType>(sim.verlet_grid_type()));
+		SetIncrementalVerletFlag(sim.verlet_incremental());
+		if (sim.verlet_wall_ratio() != 0)
+			SetVerletWallRatio(sim.verlet_wall_ratio());
 	}
+	SetDeterministicForcesFlag(sim.deterministic_forces());
+	SetMixedPrecisionFlag(sim.mixed_precision());
 	SetVariableTimeStep(sim.flexible_time_step());
 	SetPartMoveLimit(sim.part_move_limit());
 	SetTimeStepFactor(sim.time_step_factor());
+	SetIntegrator(static_cast<EIntegrator>(sim.time_integrator()));
+	SetSolidBondSubsteps(sim.solid_bond_substeps());
+	SetSleepingFlag(sim.sleeping());
+	if (sim.sleep_velocity() != 0)
+		SetSleepVelocity(sim.sleep_velocity());
+	if (sim.sleep_acceleration() != 0)
+		SetSleepAcceleration(sim.sleep_acceleration());
+	if (sim.sleep_steps() != 0)
+		SetSleepSteps(sim.sleep_steps());
 
 	// load selective saving parameters
 	m_selectiveSaving = m_pSystemStructure->GetSimulationInfo()->selective_saving();
@@ -50,6 +65,7 @@ void CBaseSimulator::LoadConfiguration()
 		m_selectiveSavingFlags.bForce         = selectiveSaving.p_force();
 		m_selectiveSavingFlags.bTensor        = selectiveSaving.p_tensor();
 		m_selectiveSavingFlags.bTemperature =	selectiveSaving.p_temperature();
+		m_selectiveSavingFlags.nTensorStep    = std::max(selectiveSaving.p_tensor_step(), 1u);
 		// solid bonds
 		m_selectiveSavingFlags.bSBForce       = selectiveSaving.sb_force();
 		m_selectiveSavingFlags.bSBTangOverlap = selectiveSaving.sb_tangoverlap();
@@ -84,9 +100,20 @@ void CBaseSimulator::SaveConfiguration()
 	pSim->set_max_cells_number(m_cellsMax);
 	pSim->set_verlet_dist_coeff(m_verletDistanceCoeff);
 	pSim->set_verlet_auto_adjust(m_autoAdjustVerletDistance);
+	pSim->set_verlet_grid_type(E2I(m_verletGridType));
+	pSim->set_verlet_incremental(m_incrementalVerlet);
+	pSim->set_verlet_wall_ratio(m_verletWallRatio);
+	pSim->set_deterministic_forces(m_deterministicForces);
+	pSim->set_mixed_precision(m_mixedPrecision);
 	pSim->set_flexible_time_step(m_variableTimeStep);
 	pSim->set_part_move_limit(m_partMoveLimit);
 	pSim->set_time_step_factor(m_timeStepFactor);
+	pSim->set_time_integrator(E2I(m_integrator));
+	pSim->set_solid_bond_substeps(m_solidBondSubsteps);
+	pSim->set_sleeping(m_sleeping);
+	pSim->set_sleep_velocity(m_sleepVelocity);
+	pSim->set_sleep_acceleration(m_sleepAcceleration);
+	pSim->set_sleep_steps(m_sleepSteps);
 
 	// save selective saving parameters
 	m_pSystemStructure->GetSimulationInfo()->set_selective_saving(m_selectiveSaving);
@@ -99,6 +126,7 @@ void CBaseSimulator::SaveConfiguration()
 	selectiveSaving->set_p_force(m_selectiveSavingFlags.bForce);
 	selectiveSaving->set_p_tensor(m_selectiveSavingFlags.bTensor);
 	selectiveSaving->set_p_temperature(m_selectiveSavingFlags.bTemperature);
+	selectiveSaving->set_p_tensor_step(m_selectiveSavingFlags.nTensorStep);
 	// solid bonds
 	selectiveSaving->set_sb_force(m_selectiveSavingFlags.bSBForce);
 	selectiveSaving->set_sb_tangoverlap(m_selectiveSavingFlags.bSBTangOverlap);
@@ -153,6 +181,72 @@ void CBaseSimulator::SetTimeStepFactor(double _factor)
 	m_timeStepFactor = _factor;
 }
 
+CBaseSimulator::EIntegrator CBaseSimulator::GetIntegrator() const
+{
+	return m_integrator;
+}
+
+void CBaseSimulator::SetIntegrator(EIntegrator _integrator)
+{
+	if (m_status != ERunningStatus::IDLE && m_status != ERunningStatus::PAUSED) return;
+	m_integrator = _integrator;
+}
+
+uint32_t CBaseSimulator::GetSolidBondSubsteps() const
+{
+	return m_solidBondSubsteps;
+}
+
+void CBaseSimulator::SetSolidBondSubsteps(uint32_t _number)
+{
+	if (m_status != ERunningStatus::IDLE && m_status != ERunningStatus::PAUSED) return;
+	m_solidBondSubsteps = std::max(_number, 1u);
+}
+
+bool CBaseSimulator::GetSleepingFlag() const
+{
+	return m_sleeping;
+}
+
+void CBaseSimulator::SetSleepingFlag(bool _bFlag)
+{
+	if (m_status != ERunningStatus::IDLE && m_status != ERunningStatus::PAUSED) return;
+	m_sleeping = _bFlag;
+}
+
+double CBaseSimulator::GetSleepVelocity() const
+{
+	return m_sleepVelocity;
+}
+
+void CBaseSimulator::SetSleepVelocity(double _velocity)
+{
+	if (m_status != ERunningStatus::IDLE && m_status != ERunningStatus::PAUSED) return;
+	m_sleepVelocity = _velocity;
+}
+
+double CBaseSimulator::GetSleepAcceleration() const
+{
+	return m_sleepAcceleration;
+}
+
+void CBaseSimulator::SetSleepAcceleration(double _acceleration)
+{
+	if (m_status != ERunningStatus::IDLE && m_status != ERunningStatus::PAUSED) return;
+	m_sleepAcceleration = _acceleration;
+}
+
+uint32_t CBaseSimulator::GetSleepSteps() const
+{
+	return m_sleepSteps;
+}
+
+void CBaseSimulator::SetSleepSteps(uint32_t _number)
+{
+	if (m_status != ERunningStatus::IDLE && m_status != ERunningStatus::PAUSED) return;
+	m_sleepSteps = std::max(_number, 1u);
+}
+
 bool CBaseSimulator::IsSelectiveSavingEnabled() const
 {
 	return m_selectiveSaving;
@@ -266,6 +360,31 @@ bool CBaseSimulator::GetAutoAdjustFlag() const
 	return m_autoAdjustVerletDistance;
 }
 
+EVerletGridType CBaseSimulator::GetVerletGridType() const
+{
+	return m_verletGridType;
+}
+
+bool CBaseSimulator::GetIncrementalVerletFlag() const
+{
+	return m_incrementalVerlet;
+}
+
+double CBaseSimulator::GetVerletWallRatio() const
+{
+	return m_verletWallRatio;
+}
+
+bool CBaseSimulator::GetDeterministicForcesFlag() const
+{
+	return m_deterministicForces;
+}
+
+bool CBaseSimulator::GetMixedPrecisionFlag() const
+{
+	return m_mixedPrecision;
+}
+
 size_t CBaseSimulator::GetNumberOfInactiveParticles() const
 {
 	return m_nInactiveParticles;
@@ -286,6 +405,16 @@ size_t CBaseSimulator::GetNumberOfGeneratedObjects() const
 	return m_nGeneratedObjects;
 }
 
+size_t CBaseSimulator::GetNumberOfSleepingParticles() const
+{
+	return m_nSleepingParticles;
+}
+
+double CBaseSimulator::GetStressTensorsTime() const
+{
+	return m_stressTensorsTime;
+}
+
 double CBaseSimulator::GetMaxParticleVelocity() const
 {
 	return m_maxParticleVelocity;
@@ -338,6 +467,36 @@ void CBaseSimulator::SetAutoAdjustFlag(bool _bFlag)
 	m_autoAdjustVerletDistance = _bFlag;
 }
 
+void CBaseSimulator::SetVerletGridType(EVerletGridType _type)
+{
+	if (m_status != ERunningStatus::IDLE && m_status != ERunningStatus::PAUSED) return;
+	m_verletGridType = _type;
+}
+
+void CBaseSimulator::SetIncrementalVerletFlag(bool _bFlag)
+{
+	if (m_status != ERunningStatus::IDLE && m_status != ERunningStatus::PAUSED) return;
+	m_incrementalVerlet = _bFlag;
+}
+
+void CBaseSimulator::SetVerletWallRatio(double _ratio)
+{
+	if (m_status != ERunningStatus::IDLE && m_status != ERunningStatus::PAUSED) return;
+	m_verletWallRatio = _ratio;
+}
+
+void CBaseSimulator::SetDeterministicForcesFlag(bool _bFlag)
+{
+	if (m_status != ERunningStatus::IDLE && m_status != ERunningStatus::PAUSED) return;
+	m_deterministicForces = _bFlag;
+}
+
+void CBaseSimulator::SetMixedPrecisionFlag(bool _bFlag)
+{
+	if (m_status != ERunningStatus::IDLE && m_status != ERunningStatus::PAUSED) return;
+	m_mixedPrecision = _bFlag;
+}
+
 CVector3 CBaseSimulator::GetExternalAccel() const
 {
 	return m_externalAcceleration;
@@ -359,70 +518,120 @@ std::string CBaseSimulator::IsDataCorrect() const
 
 void CBaseSimulator::p_SaveData()
 {
+	// the writer must not access the system structure while new objects are added
+	if (!m_generatedObjectsDiff.empty())
+		m_resultsSaver.Flush();
 	AddGeneratedObjectsToSystemStructure();
 
-	if (m_selectiveSaving)
-		m_pSystemStructure->GetSimulationInfo()->set_selective_saving(true);
-	else
-		m_pSystemStructure->GetSimulationInfo()->set_selective_saving(false);
-
-	if (!m_selectiveSaving || m_selectiveSavingFlags.bTensor)
+	// with selective saving, stress tensors may be calculated and saved only at every N-th time point
+	bool saveTensors = !m_selectiveSaving || m_selectiveSavingFlags.bTensor;
+	if (saveTensors && m_selectiveSaving)
+		saveTensors = m_nTensorTimePoints++ % m_selectiveSavingFlags.nTensorStep == 0;
+	if (saveTensors)
 	{
+		const auto scope = m_profiler.Scope(CStepProfiler::EPhase::STRESS_TENSORS);
+		const auto start = std::chrono::steady_clock::now();
 		m_additionalSavingData.resize(m_scene.GetTotalParticlesNumber());
 		PrepareAdditionalSavingData();
+		m_stressTensorsTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 	}
 
-	m_pSystemStructure->PrepareTimePointForWrite(m_currentTime);
-
-	// save particles properties
-	SParticleStruct& particles = m_scene.GetRefToParticles();
-	ParallelFor(m_scene.GetTotalParticlesNumber(), [&](size_t i)
+	// copy current state into a snapshot, which is then written into the system structure
+	CResultsSaver::SSnapshot& snapshot = m_resultsSaver.Acquire();
+	snapshot.time = m_currentTime;
+	snapshot.selective = m_selectiveSaving;
+	snapshot.flags = m_selectiveSavingFlags;
+	snapshot.flags.bTensor = saveTensors;
+	const SSelectiveSavingFlags& flags = snapshot.flags;
+	// resizes the vector of the snapshot to the required size, if this property must be saved, or clears it otherwise
+	const auto Select = [&](auto& _vector, bool _save, size_t _size) { _vector.resize(_save ? _size : 0); };
+
+	// particles properties
+	const SParticleStruct& particles = m_scene.GetRefToParticles();
+	auto& sp = snapshot.particles;
+	const size_t nParticles = m_scene.GetTotalParticlesNumber();
+	sp.Resize(nParticles);
+	Select(sp.coord,        snapshot.IsSaved(flags.bCoordinates), nParticles);
+	Select(sp.vel,          snapshot.IsSaved(flags.bVelocity), nParticles);
+	Select(sp.anglVel,      snapshot.IsSaved(flags.bAngVelocity), nParticles);
+	Select(sp.force,        snapshot.IsSaved(flags.bForce), nParticles);
+	Select(sp.quaternion,   snapshot.IsSaved(flags.bQuaternion) && particles.QuaternionExist(), nParticles);
+	Select(sp.stressTensor, snapshot.IsSaved(flags.bTensor), nParticles);
+	Select(sp.temperature,  snapshot.IsSaved(flags.bTemperature) && particles.ThermalsExist(), nParticles);
+	ParallelFor(nParticles, [&](size_t i)
 	{
-		CPhysicalObject* pPart = m_pSystemStructure->GetObjectByIndex(particles.InitIndex(i));
-		if (!particles.Active(i) && !pPart->IsActive(m_currentTime)) return;
-		if (!m_selectiveSaving || m_selectiveSavingFlags.bCoordinates) pPart->SetCoordinates(m_scene.GetObjectCoord(i));
-		if (!m_selectiveSaving || m_selectiveSavingFlags.bVelocity)    pPart->SetVelocity(m_scene.GetObjectVel(i));
-		if (!m_selectiveSaving || m_selectiveSavingFlags.bAngVelocity) pPart->SetAngleVelocity(m_scene.GetObjectAnglVel(i));
-		if (!m_selectiveSaving || m_selectiveSavingFlags.bForce)       pPart->SetForce(particles.Force(i));
-		if ((!m_selectiveSaving || m_selectiveSavingFlags.bQuaternion) && particles.QuaternionExist()) pPart->SetOrientation(particles.Quaternion(i));
-		if (!m_selectiveSaving || m_selectiveSavingFlags.bTensor)      pPart->SetStressTensor(m_additionalSavingData[i].stressTensor);
-		if ((!m_selectiveSaving || m_selectiveSavingFlags.bTemperature) && particles.ThermalsExist()) pPart->SetTemperature(particles.Temperature(i));
-
-		pPart->SetObjectActivity(particles.Active(i) ? m_currentTime : particles.EndActivity(i), particles.Active(i));
+		sp.initIndex[i] = particles.InitIndex(i);
+		sp.active[i] = particles.Active(i);
+		sp.endActivity[i] = particles.EndActivity(i);
+		if (!sp.coord.empty())        sp.coord[i] = particles.Coord(i);
+		if (!sp.vel.empty())          sp.vel[i] = particles.Vel(i);
+		if (!sp.anglVel.empty())      sp.anglVel[i] = particles.AnglVel(i);
+		if (!sp.force.empty())        sp.force[i] = particles.Force(i);
+		if (!sp.quaternion.empty())   sp.quaternion[i] = particles.Quaternion(i);
+		if (!sp.stressTensor.empty()) sp.stressTensor[i] = m_additionalSavingData[i].stressTensor;
+		if (!sp.temperature.empty())  sp.temperature[i] = particles.Temperature(i);
 	});
 
-	// save solid bonds properties
-	SSolidBondStruct& solidBonds = m_scene.GetRefToSolidBonds();
-	ParallelFor(m_scene.GetBondsNumber(), [&](size_t i)
+	// solid bonds properties
+	const SSolidBondStruct& solidBonds = m_scene.GetRefToSolidBonds();
+	auto& ssb = snapshot.solidBonds;
+	const size_t nSolidBonds = m_scene.GetBondsNumber();
+	ssb.Resize(nSolidBonds);
+	Select(ssb.force,       snapshot.IsSaved(flags.bSBForce), nSolidBonds);
+	Select(ssb.tangOverlap, snapshot.IsSaved(flags.bSBTangOverlap), nSolidBonds);
+	Select(ssb.totalTorque, snapshot.IsSaved(flags.bSBTotTorque), nSolidBonds);
+	ParallelFor(nSolidBonds, [&](size_t i)
 	{
-		auto* pSBond = dynamic_cast<CSolidBond*>(m_pSystemStructure->GetObjectByIndex(solidBonds.InitIndex(i)));
-		if (!solidBonds.Active(i) && !pSBond->IsActive(m_currentTime)) return;
-		if (!m_selectiveSaving || m_selectiveSavingFlags.bSBForce)       pSBond->SetForce(solidBonds.TotalForce(i));
-		if (!m_selectiveSaving || m_selectiveSavingFlags.bSBTangOverlap) pSBond->SetTangentialOverlap(solidBonds.TangentialOverlap(i));
-		if (!m_selectiveSaving || m_selectiveSavingFlags.bSBTotTorque)   pSBond->SetTotalTorque(Length(solidBonds.NormalMoment(i) + solidBonds.TangentialMoment(i)));
-		pSBond->SetObjectActivity(solidBonds.Active(i) ? m_currentTime : solidBonds.EndActivity(i), solidBonds.Active(i));
+		ssb.initIndex[i] = solidBonds.InitIndex(i);
+		ssb.active[i] = solidBonds.Active(i);
+		ssb.endActivity[i] = solidBonds.EndActivity(i);
+		if (!ssb.force.empty())       ssb.force[i] = solidBonds.TotalForce(i);
+		if (!ssb.tangOverlap.empty()) ssb.tangOverlap[i] = solidBonds.TangentialOverlap(i);
+		if (!ssb.totalTorque.empty()) ssb.totalTorque[i] = Length(solidBonds.NormalMoment(i) + solidBonds.TangentialMoment(i));
 	});
 
-	// save liquid bonds properties
-	SLiquidBondStruct& liqbond = m_scene.GetRefToLiquidBonds();
-	ParallelFor(m_scene.GetLiquidBondsNumber(), [&](size_t i)
+	// liquid bonds properties
+	const SLiquidBondStruct& liquidBonds = m_scene.GetRefToLiquidBonds();
+	auto& slb = snapshot.liquidBonds;
+	const size_t nLiquidBonds = m_scene.GetLiquidBondsNumber();
+	slb.Resize(nLiquidBonds);
+	Select(slb.force, snapshot.IsSaved(flags.bLBForce), nLiquidBonds);
+	ParallelFor(nLiquidBonds, [&](size_t i)
 	{
-		CPhysicalObject* pLBond = m_pSystemStructure->GetObjectByIndex(liqbond.InitIndex(i));
-		if (!liqbond.Active(i) && !pLBond->IsActive(m_currentTime)) return;
-		if (!m_selectiveSaving || m_selectiveSavingFlags.bLBForce) pLBond->SetForce(liqbond.NormalForce(i) + liqbond.TangentialForce(i));
-		pLBond->SetObjectActivity(liqbond.Active(i) ? m_currentTime : liqbond.EndActivity(i), liqbond.Active(i));
+		slb.initIndex[i] = liquidBonds.InitIndex(i);
+		slb.active[i] = liquidBonds.Active(i);
+		slb.endActivity[i] = liquidBonds.EndActivity(i);
+		if (!slb.force.empty()) slb.force[i] = liquidBonds.NormalForce(i) + liquidBonds.TangentialForce(i);
 	});
 
-	// save wall properties
-	SWallStruct& walls = m_scene.GetRefToWalls();
-	ParallelFor(walls.Size(), [&](size_t i)
+	// wall properties
+	const SWallStruct& walls = m_scene.GetRefToWalls();
+	auto& sw = snapshot.walls;
+	const size_t nWalls = walls.Size();
+	sw.initIndex.resize(nWalls);
+	Select(sw.vert1, snapshot.IsSaved(flags.bTWPlaneCoord), nWalls);
+	Select(sw.vert2, snapshot.IsSaved(flags.bTWPlaneCoord), nWalls);
+	Select(sw.vert3, snapshot.IsSaved(flags.bTWPlaneCoord), nWalls);
+	Select(sw.force, snapshot.IsSaved(flags.bTWForce), nWalls);
+	Select(sw.vel,   snapshot.IsSaved(flags.bTWVelocity), nWalls);
+	ParallelFor(nWalls, [&](size_t i)
 	{
-		auto* pWall = dynamic_cast<CTriangularWall*>(m_pSystemStructure->GetObjectByIndex(walls.InitIndex(i)));
-		if (!m_selectiveSaving || m_selectiveSavingFlags.bTWPlaneCoord) pWall->SetPlaneCoord(walls.Vert1(i), walls.Vert2(i), walls.Vert3(i));
-		if (!m_selectiveSaving || m_selectiveSavingFlags.bTWForce)      pWall->SetForce(walls.Force(i));
-		if (!m_selectiveSaving || m_selectiveSavingFlags.bTWVelocity)   pWall->SetVelocity(walls.Vel(i));
+		sw.initIndex[i] = walls.InitIndex(i);
+		if (!sw.vert1.empty())
+		{
+			sw.vert1[i] = walls.Vert1(i);
+			sw.vert2[i] = walls.Vert2(i);
+			sw.vert3[i] = walls.Vert3(i);
+		}
+		if (!sw.force.empty()) sw.force[i] = walls.Force(i);
+		if (!sw.vel.empty())   sw.vel[i] = walls.Vel(i);
 	});
 
+	m_resultsSaver.Submit();
+
+	// additional steps may read saved data from the system structure
+	if (!m_additionalSavingSteps.empty())
+		m_resultsSaver.Flush();
 	for (const auto& function : m_additionalSavingSteps)
 		function();
 }
@@ -441,9 +650,31 @@ void CBaseSimulator::PrintStatus() const
 	*p_out << "Current time [s]: " << m_currentTime << std::endl;
 	*p_out << "\tMax particle velocity [m/s]:  " << m_maxParticleVelocity << std::endl;
 	*p_out << "\tMax particle temperature [K]: " << m_maxParticleTemperature << std::endl;
+	if (m_sleeping)
+	{
+		const size_t activeParticles = m_scene.GetRealParticlesNumber() - std::min(m_nInactiveParticles, m_scene.GetRealParticlesNumber());
+		*p_out << "\tAwake particles:              " << activeParticles - std::min(m_nSleepingParticles, activeParticles) << " of " << activeParticles
+			<< " (" << Double2Percent(activeParticles != 0 ? 1 - static_cast<double>(m_nSleepingParticles) / static_cast<double>(activeParticles) : 1) << ")" << std::endl;
+	}
 	*p_out << "\tCurrent progress:             " << Double2Percent(currProgress) << std::endl;
 	*p_out << "\tTime left [d:h:m:s]:          " << MsToTimeSpan(remainingMs) << std::endl;
 	*p_out << "\tWill finish at [d.m.y h:m:s]: " << std::put_time(std::localtime(&finishTimeTimePointC), "%d.%m.%y %H:%M:%S") << std::endl;
+
+	// print out state of verlet distance adjustment
+	const auto& tuner = m_verletList.GetAutoAdjustStatus();
+	if (m_autoAdjustVerletDistance && tuner.evaluations != 0)
+	{
+		using EPhase = CVerletDistanceTuner::EPhase;
+		*p_out << "\tVerlet coefficient:           " << tuner.coeff;
+		if (tuner.state == CVerletDistanceTuner::EState::HOLD)
+			*p_out << " (chosen, cost " << tuner.optimalCost << ")" << std::endl;
+		else
+			*p_out << " (searching in " << tuner.lowerCoeff << " - " << tuner.upperCoeff << ")" << std::endl;
+		*p_out << "\tVerlet cost [s/s]:            " << tuner.cost
+			<< " = rebuild " << tuner.phases[E2I(EPhase::REBUILD)]
+			<< " + contacts " << tuner.phases[E2I(EPhase::CONTACTS)]
+			<< " + forces " << tuner.phases[E2I(EPhase::FORCES)] << std::endl;
+	}
 }
 
 void CBaseSimulator::MoveObjectsStep(double _timeStep, bool _predictionStep)
@@ -452,6 +683,44 @@ void CBaseSimulator::MoveObjectsStep(double _timeStep, bool _predictionStep)
 	MoveWalls(_timeStep);
 }
 
+size_t CBaseSimulator::GetSavingBuffers() const
+{
+	return m_resultsSaver.GetBuffersNumber();
+}
+
+void CBaseSimulator::SetSavingBuffers(size_t _number)
+{
+	if (m_status != ERunningStatus::IDLE && m_status != ERunningStatus::PAUSED) return;
+	m_resultsSaver.SetBuffersNumber(_number);
+}
+
+std::string CBaseSimulator::GetProfilingFile() const
+{
+	return m_profiler.GetFileName();
+}
+
+void CBaseSimulator::SetProfilingFile(const std::string& _fileName)
+{
+	if (m_status != ERunningStatus::IDLE && m_status != ERunningStatus::PAUSED) return;
+	m_profiler.SetFileName(_fileName);
+}
+
+double CBaseSimulator::GetProfilingInterval() const
+{
+	return m_profiler.GetInterval();
+}
+
+void CBaseSimulator::SetProfilingInterval(double _interval)
+{
+	if (m_status != ERunningStatus::IDLE && m_status != ERunningStatus::PAUSED) return;
+	m_profiler.SetInterval(_interval);
+}
+
+const CStepProfiler& CBaseSimulator::GetProfiler() const
+{
+	return m_profiler;
+}
+
 void CBaseSimulator::SetSelectiveSaving(bool _bSelectiveSaving)
 {
 	m_selectiveSaving = _bSelectiveSaving;
@@ -460,6 +729,7 @@ void CBaseSimulator::SetSelectiveSaving(bool _bSelectiveSaving)
 void CBaseSimulator::SetSelectiveSavingParameters(const SSelectiveSavingFlags& _SSelectiveSavingFlags)
 {
 	m_selectiveSavingFlags = _SSelectiveSavingFlags;
+	m_selectiveSavingFlags.nTensorStep = std::max(m_selectiveSavingFlags.nTensorStep, 1u);
 }
 
 std::list<std::function<void()>>::iterator CBaseSimulator::AddSavingStep(const std::function<void()>& _function)
@@ -505,10 +775,16 @@ void CBaseSimulator::Initialize()
 	m_nBrokenBonds = 0;
 	m_nBrokenLiquidBonds = 0;
 	m_nGeneratedObjects = 0;
+	m_nSleepingParticles = 0;
+	m_nTensorTimePoints = 0;
+	m_stressTensorsTime = 0;
 
 	// settings
 	m_considerAnisotropy = m_pSystemStructure->IsAnisotropyEnabled();
 
+	// saving
+	m_resultsSaver.Initialize(m_pSystemStructure);
+
 	// delete old data
 	m_pSystemStructure->ClearAllStatesFrom(m_currentTime);
 	m_generatedObjectsDiff.clear();
@@ -523,6 +799,8 @@ void CBaseSimulator::Initialize()
 
 	// verlet list
 	m_verletList.InitializeList();
+	m_verletList.SetGridType(m_verletGridType);
+	m_verletList.SetWallDistanceRatio(m_verletWallRatio);
 	m_verletList.SetSceneInfo(m_pSystemStructure->GetSimulationDomain(), m_scene.GetMinParticleContactRadius(), m_scene.GetMaxParticleContactRadius(), m_cellsMax, m_verletDistanceCoeff, m_autoAdjustVerletDistance);
 	m_verletList.ResetCurrentData();
 
@@ -576,20 +854,37 @@ void CBaseSimulator::Simulate()
 	RandomSeed(); // needed for some contact models
 
 	if (m_status == ERunningStatus::IDLE)
+	{
 		Initialize();
+		m_profiler.Reset();
+	}
 
 	// start simulation
 	m_status = ERunningStatus::RUNNING;
+	m_profiler.Resume();
 	StartSimulation();
+	m_profiler.Suspend();
 
 	// performance measurement
 	if (m_status == ERunningStatus::TO_BE_PAUSED)
+	{
+		m_resultsSaver.Flush(); // results must be available during the pause
 		m_chronoPauseStart = std::chrono::system_clock::now();
+	}
 	else if (m_status == ERunningStatus::TO_BE_STOPPED)
 	{
 		// output performance statistic
 		const auto elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - m_chronoSimStart).count();
 		*p_out << "Elapsed time [d:h:m:s]: " << MsToTimeSpan(elapsedTime) << std::endl;
+		const auto& saving = m_resultsSaver.GetStatistics();
+		*p_out << "Saving time [s]: " << saving.copyTime + saving.waitTime + saving.writeTime - saving.backgroundTime;
+		if (saving.backgroundTime != 0)
+			*p_out << " (written in background: " << saving.backgroundTime << ", saved for simulation: " << saving.backgroundTime - saving.copyTime - saving.waitTime << ")";
+		*p_out << std::endl;
+		if (m_stressTensorsTime != 0)
+			*p_out << "Stress tensors time [s]: " << m_stressTensorsTime << std::endl;
+		if (m_profiler.IsEnabled())
+			*p_out << (m_profiler.Write() ? "Profiling results written to: " : "Error: Cannot write profiling results to: ") << m_profiler.GetFileName() << std::endl;
 	}
 
 	// set status
@@ -604,9 +899,15 @@ void CBaseSimulator::StartSimulation()
 	while (m_status != ERunningStatus::TO_BE_STOPPED && m_status != ERunningStatus::TO_BE_PAUSED)
 	{
 		PreCalculationStep();
-		UpdateCollisionsStep(m_currSimulationStep);
+		{
+			const auto scope = m_profiler.Scope(CStepProfiler::EPhase::UPDATE_COLLISIONS);
+			UpdateCollisionsStep(m_currSimulationStep);
+		}
 		CalculateForcesStep(m_currSimulationStep);
-		MoveObjectsStep(m_currSimulationStep, m_isPredictionStep);
+		{
+			const auto scope = m_profiler.Scope(CStepProfiler::EPhase::MOVE_OBJECTS);
+			MoveObjectsStep(m_currSimulationStep, m_isPredictionStep);
+		}
 		if (m_optionalSceneVars.bThermals)
 			UpdateTemperatures(m_isPredictionStep);
 
@@ -615,6 +916,8 @@ void CBaseSimulator::StartSimulation()
 		else
 			m_currentTime += m_currSimulationStep;
 
+		m_profiler.EndStep(m_currentTime);
+
 		// analyze about possible end of interval
 		if (m_currentTime >= m_endTime || g_extSignal != 0)
 			m_status = ERunningStatus::TO_BE_STOPPED;
@@ -627,7 +930,11 @@ void CBaseSimulator::StartSimulation()
 void CBaseSimulator::FinalizeSimulation()
 {
 	if (!g_extSignal)	// if stopped by signal, only close file properly; do not save current time point, as this does not coincide with savings step
+	{
+		const auto scope = m_profiler.Scope(CStepProfiler::EPhase::SAVE_DATA);
 		SaveData();
+	}
+	m_resultsSaver.Stop();
 	m_pSystemStructure->SaveToFile();
 }
 
@@ -637,7 +944,10 @@ void CBaseSimulator::PreCalculationStep()
 
 	if (std::fabs(m_currentTime - m_lastSavingTime) + 0.1 * m_currSimulationStep > m_savingStep)
 	{
-		SaveData();
+		{
+			const auto scope = m_profiler.Scope(CStepProfiler::EPhase::SAVE_DATA);
+			SaveData();
+		}
 		m_lastSavingTime = m_currentTime;
 		PrintStatus();
 		if (AdditionalStopCriterionMet())
@@ -676,16 +986,33 @@ void CBaseSimulator::CopySimulatorData(const CBaseSimulator& _other)
 	SetMaxCells(_other.m_cellsMax);
 	SetVerletCoeff(_other.m_verletDistanceCoeff);
 	SetAutoAdjustFlag(_other.m_autoAdjustVerletDistance);
+	SetVerletGridType(_other.m_verletGridType);
+	SetIncrementalVerletFlag(_other.m_incrementalVerlet);
+	SetVerletWallRatio(_other.m_verletWallRatio);
+	SetDeterministicForcesFlag(_other.m_deterministicForces);
+	SetMixedPrecisionFlag(_other.m_mixedPrecision);
+	SetSavingBuffers(_other.GetSavingBuffers());
+	SetProfilingFile(_other.GetProfilingFile());
+	SetProfilingInterval(_other.GetProfilingInterval());
 	SetSelectiveSaving(_other.m_selectiveSaving);
 	SetSelectiveSavingParameters(_other.m_selectiveSavingFlags);
 	SetVariableTimeStep(_other.m_variableTimeStep);
 	SetPartMoveLimit(_other.m_partMoveLimit);
 	SetTimeStepFactor(_other.m_timeStepFactor);
+	SetIntegrator(_other.m_integrator);
+	SetSolidBondSubsteps(_other.m_solidBondSubsteps);
+	SetSleepingFlag(_other.m_sleeping);
+	SetSleepVelocity(_other.m_sleepVelocity);
+	SetSleepAcceleration(_other.m_sleepAcceleration);
+	SetSleepSteps(_other.m_sleepSteps);
 
 	m_nInactiveParticles = _other.m_nInactiveParticles;
 	m_nBrokenBonds = _other.m_nBrokenBonds;
 	m_nBrokenLiquidBonds = _other.m_nBrokenLiquidBonds;
 	m_nGeneratedObjects = _other.m_nGeneratedObjects;
+	m_nSleepingParticles = _other.m_nSleepingParticles;
+	m_nTensorTimePoints = _other.m_nTensorTimePoints;
+	m_stressTensorsTime = _other.m_stressTensorsTime;
 
 	SetSystemStructure(_other.m_pSystemStructure);
 	SetCurrentStatus(_other.m_status);
@@ -6,6 +6,8 @@
 #include "GenerationManager.h"
 #include "ModelManager.h"
 #include "VerletList.h"
+#include "ResultsSaver.h"
+#include "StepProfiler.h"
 #include <list>
 #include <csignal>
 
@@ -27,6 +29,12 @@ public:
 	{
 		size_t maxBrokenBonds{ 0 }; // EStopCriteria::BROKEN_BONDS
 	};
+	enum class EIntegrator : unsigned // Schemes of time integration of particles motion.
+	{
+		LEAPFROG        = 0,	// Velocities are shifted by a half of time step relative to coordinates.
+		VELOCITY_VERLET = 1,	// Coordinates and velocities are synchronized; forces are calculated with predicted velocities.
+		GEAR            = 2,	// Gear predictor-corrector of the 3rd order.
+	};
 
 protected:
 	struct SAdditionalSavingData
@@ -50,6 +58,9 @@ protected:
 	size_t m_nBrokenBonds{ 0 };									// Number of the broken bonds.
 	size_t m_nBrokenLiquidBonds{ 0 };								// Number of the ruptured liquid bonds.
 	size_t m_nGeneratedObjects{ 0 };								// Number of generated objects.
+	size_t m_nSleepingParticles{ 0 };								// Number of currently sleeping particles.
+	size_t m_nTensorTimePoints{ 0 };								// Number of saved time points, at which stress tensors were selected for saving.
+	double m_stressTensorsTime{ 0 };								// Wall time [s] spent to calculate stress tensors.
 	double m_maxParticleVelocity{ 0 };								// Maximal velocity of particle which is used to calculate verlet list.
 	double m_maxParticleTemperature{ 0 };							// Maximal temperature of particles.
 	double m_maxWallVelocity{ 0 };									// Maximal velocity of walls.
@@ -57,10 +68,21 @@ protected:
 	uint32_t m_cellsMax{ DEFAULT_MAX_CELLS };						// Maximum allowed number of cells in each direction of verlet list.
 	double m_verletDistanceCoeff{ DEFAULT_VERLET_DISTANCE_COEFF };	// A coefficient to calculate verlet distance within a verlet list.
 	bool m_autoAdjustVerletDistance{ true };						// If set to true - the verlet distance will be automatically adjusted during the simulation.
+	EVerletGridType m_verletGridType{ EVerletGridType::DENSE };		// Type of the spatial index used in verlet list.
+	bool m_incrementalVerlet{ false };								// If set to true - verlet list is updated only for particles, which moved far enough, when possible.
+	double m_verletWallRatio{ DEFAULT_VERLET_WALL_RATIO };			// Ratio of verlet distance of particle-wall contacts to the one of particle-particle contacts.
+	bool m_deterministicForces{ false };							// If set to true - contributions of contacts are summed up in a fixed order, so results do not depend on the number of threads.
+	bool m_mixedPrecision{ false };									// If set to true - contact models evaluate per-contact values in single precision, while coordinates and time integration stay in double precision.
 	bool m_considerAnisotropy{ false };								// Consider anisotropy of non-spherical objects during the simulation.
 	bool m_variableTimeStep{ false };								// Use variable or constant simulation time step.
 	double m_partMoveLimit{ 1e-8 };									// Max movement of particles over a single time step; is used to calculate flexible time step.
 	double m_timeStepFactor{ 1.01 };								// Factor used to increase current simulation time step if flexible time step is used.
+	EIntegrator m_integrator{ EIntegrator::LEAPFROG };				// Scheme of time integration of particles motion.
+	uint32_t m_solidBondSubsteps{ 1 };								// Number of sub-steps, in which solid bonds are calculated within one simulation time step; 1 - no sub-cycling.
+	bool m_sleeping{ false };										// If set to true - islands of quasi-static particles are put to sleep and are not calculated until woken.
+	double m_sleepVelocity{ 1e-3 };									// Max translational and rotational surface velocity [m/s] of a quasi-static particle.
+	double m_sleepAcceleration{ 1.0 };								// Max acceleration [m/s2] of a quasi-static particle due to the unbalanced force.
+	uint32_t m_sleepSteps{ 1000 };									// Number of consecutive time steps, during which a particle must stay quasi-static to fall asleep.
 
 	CGenerationManager* m_generationManager{ nullptr };
 	CSimplifiedScene m_scene;				// simplified scene
@@ -77,6 +99,8 @@ protected:
 	SOptionalVariables m_optionalSceneVars;
 	std::vector<SGeneratedObject> m_generatedObjectsDiff;		// Objects generated since last save in simplified scene, but not yet added to system structure.
 
+	CStepProfiler m_profiler; // Measures wall time of simulation phases.
+
 	// For performance analysis in console
 	std::chrono::system_clock::time_point m_chronoSimStart;
 	std::chrono::system_clock::time_point m_chronoPauseStart;
@@ -93,6 +117,8 @@ private:
 	// additional saving steps
 	std::list<std::function<void()>> m_additionalSavingSteps; // List of additional steps called during saving.
 
+	CResultsSaver m_resultsSaver; // Writes saved time points into the system structure in background.
+
 	// additional stop criteria
 	std::vector<EStopCriteria> m_stopCriteria;	// Active additional simulation stop criteria.
 	SStopValues m_stopValues;					// Values for additional simulation stop criteria.
@@ -140,12 +166,34 @@ public:
 	void SetVerletCoeff(double _dCoeff);
 	bool GetAutoAdjustFlag() const;
 	void SetAutoAdjustFlag(bool _bFlag);
+	EVerletGridType GetVerletGridType() const;
+	void SetVerletGridType(EVerletGridType _type);
+	bool GetIncrementalVerletFlag() const;
+	void SetIncrementalVerletFlag(bool _bFlag);
+	double GetVerletWallRatio() const;
+	void SetVerletWallRatio(double _ratio);
+	bool GetDeterministicForcesFlag() const;
+	void SetDeterministicForcesFlag(bool _bFlag);
+	bool GetMixedPrecisionFlag() const;
+	void SetMixedPrecisionFlag(bool _bFlag);
 	bool GetVariableTimeStep() const;
 	void SetVariableTimeStep(bool _bFlag);
 	double GetPartMoveLimit() const;
 	virtual void SetPartMoveLimit(double _dx);
 	double GetTimeStepFactor() const;
 	virtual void SetTimeStepFactor(double _factor);
+	EIntegrator GetIntegrator() const;
+	void SetIntegrator(EIntegrator _integrator);
+	uint32_t GetSolidBondSubsteps() const;
+	void SetSolidBondSubsteps(uint32_t _number);
+	bool GetSleepingFlag() const;
+	void SetSleepingFlag(bool _bFlag);
+	double GetSleepVelocity() const;
+	void SetSleepVelocity(double _velocity);
+	double GetSleepAcceleration() const;
+	void SetSleepAcceleration(double _acceleration);
+	uint32_t GetSleepSteps() const;
+	void SetSleepSteps(uint32_t _number);
 
 	// selective saving
 	bool IsSelectiveSavingEnabled() const;
@@ -155,6 +203,8 @@ public:
 	size_t GetNumberOfBrokenBonds() const;
 	size_t GetNumberOfBrokenLiquidBonds() const;
 	size_t GetNumberOfGeneratedObjects() const;
+	size_t GetNumberOfSleepingParticles() const;
+	double GetStressTensorsTime() const; // Returns wall time [s] spent to calculate stress tensors during the simulation.
 	double GetMaxParticleVelocity() const;
 	// Returns all current maximal and average overlap between particles with particle indexes smaller than _nMaxParticleID.
 	virtual void GetOverlapsInfo(double& _dMaxOverlap, double& _dAverageOverlap, size_t _nMaxParticleID) {}
@@ -190,6 +240,13 @@ public:
 
 	virtual void PrepareAdditionalSavingData() {}
 
+	size_t GetSavingBuffers() const;
+	void SetSavingBuffers(size_t _number); // Sets the max number of time points being saved in background; 0 - save synchronously.
+	std::string GetProfilingFile() const;
+	void SetProfilingFile(const std::string& _fileName); // Sets the file to write profiling results; empty - no profiling.
+	double GetProfilingInterval() const;
+	void SetProfilingInterval(double _interval); // Sets wall time interval [s] to write profiling results during the simulation; 0 - only at the end.
+	const CStepProfiler& GetProfiler() const; // Returns results of profiling of the last simulation.
 	void SetSelectiveSaving(bool _bSelectiveSaving);
 	void SetSelectiveSavingParameters(const SSelectiveSavingFlags& _SSelectiveSavingFlags);
 
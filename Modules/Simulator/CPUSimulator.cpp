@@ -29,6 +29,18 @@ bool CCPUSimulator::IsCollisionsAnalysisEnabled() const
 	return m_analyzeCollisions;
 }
 
+void CCPUSimulator::EnableBatchContacts(bool _enable)
+{
+	if (m_status != ERunningStatus::IDLE) return;
+
+	m_batchContacts = _enable;
+}
+
+bool CCPUSimulator::IsBatchContactsEnabled() const
+{
+	return m_batchContacts;
+}
+
 void CCPUSimulator::Initialize()
 {
 	CBaseSimulator::Initialize();
@@ -36,11 +48,39 @@ void CCPUSimulator::Initialize()
 	// delete collisions data
 	m_collisionsCalculator.ClearCollMatrixes();
 	m_collisionsCalculator.ClearFinishedCollisionMatrixes();
+	m_collisionsCalculator.SetContactFields(m_optionalSceneVars);
 	if (m_analyzeCollisions)
 		m_collisionsAnalyzer.ResetAndClear();
 
+	// the thread pool may have been restarted with another number of threads since the last simulation
+	m_nThreads = GetThreadsNumber();
+	m_tempCollPPArray.assign(m_nThreads, std::vector<std::vector<SCollision*>>(m_nThreads));
+	m_tempCollPWArray.assign(m_nThreads, std::vector<std::vector<SCollision*>>(m_nThreads));
+	m_tempSegmentsPP.assign(m_nThreads, std::vector<std::vector<SBucketSegment>>(m_nThreads));
+	m_tempSegmentsPW.assign(m_nThreads, std::vector<std::vector<SBucketSegment>>(m_nThreads));
+	m_orderedSegments.assign(m_nThreads, std::vector<SBucketSegment>{});
+
 	// store particle coordinates
 	m_scene.SaveVerletCoords();
+	m_pbcSlabsValid = false;
+	m_verletList.SetIncrementalUpdate(m_incrementalVerlet);
+	m_verletList.SetMixedPrecision(m_mixedPrecision);
+
+	// only leapfrog needs a prediction step to shift velocities by a half of time step; other schemes initialize their state at the first step
+	m_integratedParticles = 0;
+	m_lastIntegrationStep = m_currSimulationStep;
+	if (m_integrator != EIntegrator::LEAPFROG)
+		m_isPredictionStep = false;
+
+	// heat transfer and periodic boundaries would need contacts of sleeping particles, so sleeping is not applied with them
+	m_sleepingEnabled = m_sleeping && !m_scene.m_PBC.bEnabled && !m_optionalSceneVars.bThermals;
+	m_asleep.clear();
+	m_calmSteps.clear();
+	m_islands.clear();
+	m_stepsToIslandsCheck = 0;
+	m_touchedIslands.assign(m_nThreads, {});
+	m_sleepCounters.assign(m_nThreads, 0);
+	m_collisionsCalculator.SetFrozenParticles(m_sleepingEnabled ? &m_asleep : nullptr);
 }
 
 void CCPUSimulator::InitializeModels()
@@ -54,6 +94,16 @@ void CCPUSimulator::InitializeModels()
 			m_scene.GetPointerToSolidBonds().get(),
 			m_scene.GetPointerToLiquidBonds().get(),
 			m_scene.GetPointerToInteractProperties().get());
+	for (auto& model : m_PPModels)
+	{
+		model->SetCollisionFields(m_collisionsCalculator.GetContactFields());
+		model->SetMixedPrecision(m_mixedPrecision);
+	}
+	for (auto& model : m_PWModels)
+	{
+		model->SetCollisionFields(m_collisionsCalculator.GetContactFields());
+		model->SetMixedPrecision(m_mixedPrecision);
+	}
 }
 
 void CCPUSimulator::FinalizeSimulation()
@@ -76,28 +126,68 @@ void CCPUSimulator::UpdateCollisionsStep(double _dTimeStep)
 {
 	m_scene.ClearState();
 	CheckParticlesInDomain();
+	if (m_sleepingEnabled)
+		ResizeSleepingState();
 
 	// if there is no contact model, then there is no necessity to calculate contacts
 	if (!m_PPModels.empty() || !m_PWModels.empty())
 	{
 		UpdateVerletLists(_dTimeStep); // between PP and PW
+		const auto scope = m_profiler.Scope(CStepProfiler::EPhase::CONTACT_DETECTION);
+		const auto start = std::chrono::steady_clock::now();
 		m_collisionsCalculator.UpdateCollisionMatrixes(_dTimeStep, m_currentTime);
+		m_verletList.AddPhaseTime(CVerletDistanceTuner::EPhase::CONTACTS, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		if (m_profiler.IsEnabled())
+		{
+			const auto stat = m_collisionsCalculator.GetPWStatistics();
+			m_profiler.AddDetectionPW(stat.candidates, stat.tested, stat.contacts, stat.allocations);
+		}
 	}
+
+	if (m_sleepingEnabled)
+		WakeParticles();
 }
 
 void CCPUSimulator::CalculateForcesStep(double _dTimeStep)
 {
-	if (!m_EFModels.empty()) CalculateForcesEF(_dTimeStep);
-	if (!m_PPModels.empty()) CalculateForcesPP(_dTimeStep);
-	if (!m_PWModels.empty()) CalculateForcesPW(_dTimeStep);
-	if (!m_SBModels.empty()) CalculateForcesSB(_dTimeStep);
-	if (!m_LBModels.empty()) CalculateForcesLB(_dTimeStep);
+	using EPhase = CStepProfiler::EPhase;
+	if (!m_EFModels.empty()) { const auto scope = m_profiler.Scope(EPhase::FORCES_EF); CalculateForcesEF(_dTimeStep); }
+	const auto start = std::chrono::steady_clock::now();
+	if (!m_PPModels.empty()) { const auto scope = m_profiler.Scope(EPhase::FORCES_PP); CalculateForcesPP(_dTimeStep); }
+	if (!m_PWModels.empty()) { const auto scope = m_profiler.Scope(EPhase::FORCES_PW); CalculateForcesPW(_dTimeStep); }
+	m_verletList.AddPhaseTime(CVerletDistanceTuner::EPhase::FORCES, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	if (!m_SBModels.empty() && !SubcycleSolidBonds()) { const auto scope = m_profiler.Scope(EPhase::FORCES_SB); CalculateForcesSB(_dTimeStep); }
+	if (!m_LBModels.empty()) { const auto scope = m_profiler.Scope(EPhase::FORCES_LB); CalculateForcesLB(_dTimeStep); }
 	m_collisionsCalculator.CalculateTotalStatisticsInfo();
 }
 
+void CCPUSimulator::AddToBucket(std::vector<SCollision*>& _bucket, std::vector<SBucketSegment>& _segments, size_t _iBlock, size_t _iThread, SCollision* _collision) const
+{
+	// all rows of a block are processed by the same thread, so its contacts form a single range in each bucket
+	if (_segments.empty() || _segments.back().block != _iBlock)
+		_segments.push_back(SBucketSegment{ _iBlock, _iThread, _bucket.size(), _bucket.size() });
+	_segments.back().end++;
+	_bucket.push_back(_collision);
+}
+
+template<typename F>
+void CCPUSimulator::ConsolidateBucket(const std::vector<std::vector<std::vector<SCollision*>>>& _buckets, const std::vector<std::vector<std::vector<SBucketSegment>>>& _segments, size_t _iBucket, F&& _consolidate)
+{
+	// contributions to each object come in the order of rows, independent of which thread has gathered them and of how objects are distributed among buckets
+	auto& ordered = m_orderedSegments[_iBucket];
+	ordered.clear();
+	for (size_t j = 0; j < m_nThreads; ++j)
+		ordered.insert(ordered.end(), _segments[j][_iBucket].begin(), _segments[j][_iBucket].end());
+	std::sort(ordered.begin(), ordered.end(), [](const SBucketSegment& _l, const SBucketSegment& _r) { return _l.block < _r.block; });
+	for (const auto& segment : ordered)
+		for (size_t k = segment.begin; k < segment.end; ++k)
+			_consolidate(_buckets[segment.thread][_iBucket][k]);
+}
+
 void CCPUSimulator::CalculateForcesPP(double _timeStep)
 {
 	SParticleStruct& particles = m_scene.GetRefToParticles();
+	const uint8_t* asleep = SleepingParticles();
 
 	for (auto* model : m_PPModels)
 	{
@@ -106,25 +196,74 @@ void CCPUSimulator::CalculateForcesPP(double _timeStep)
 		for (auto& collisions : m_tempCollPPArray)
 			for (auto& coll : collisions)
 				coll.clear();
-
-		ParallelFor(m_collisionsCalculator.m_vCollMatrixPP.size(), [&](size_t i)
-		{
-			const size_t index = i % m_nThreads;
-			for (auto& coll : m_collisionsCalculator.m_vCollMatrixPP[i])
+		for (auto& segments : m_tempSegmentsPP)
+			for (auto& segment : segments)
+				segment.clear();
+
+		// models implementing the batch interface calculate contacts in batches if it is enabled; their single-precision variant is available only in batches
+		const bool mixedPrecision = model->IsMixedPrecision();
+		const auto* batchModel = m_batchContacts || mixedPrecision ? dynamic_cast<const CParticleParticleBatchModel*>(model) : nullptr;
+		if (!batchModel)
+			ParallelFor(m_collisionsCalculator.m_vCollMatrixPP.size(), [&](size_t i)
 			{
-				model->Calculate(m_currentTime, _timeStep, coll);
-				model->ConsolidateSrc(m_currentTime, _timeStep, particles, coll);
+				const size_t index = GetCurrentThreadIndex();
+				for (auto& coll : m_collisionsCalculator.m_vCollMatrixPP[i])
+				{
+					if (asleep && asleep[coll->nSrcID] && asleep[coll->nDstID]) continue; // frozen contact
+					model->Calculate(m_currentTime, _timeStep, coll);
+					model->ConsolidateSrc(m_currentTime, _timeStep, particles, coll);
 
-				m_tempCollPPArray[index][coll->nDstID % m_nThreads].push_back(coll);
-			}
-		});
+					const size_t iBucket = coll->nDstID % m_nThreads;
+					AddToBucket(m_tempCollPPArray[index][iBucket], m_tempSegmentsPP[index][iBucket], i, index, coll);
+				}
+			});
+		else
+			// batches are collected over several consecutive rows of the collision matrix
+			ParallelFor((m_collisionsCalculator.m_vCollMatrixPP.size() + PP_BATCH_ROWS - 1) / PP_BATCH_ROWS, [&](size_t iBlock)
+			{
+				const auto& collisions = m_collisionsCalculator.m_vCollMatrixPP;
+				const size_t index = GetCurrentThreadIndex();
+				SPPContactsBatch batch;
+				const auto CalculateBatch = [&]
+				{
+					if (mixedPrecision)
+						batchModel->CalculatePPBatchMixed(m_currentTime, _timeStep, batch);
+					else
+						batchModel->CalculatePPBatch(m_currentTime, _timeStep, batch);
+					for (size_t j = 0; j < batch.size; ++j)
+					{
+						model->ConsolidateSrc(m_currentTime, _timeStep, particles, batch.collisions[j]);
+						const size_t iBucket = batch.collisions[j]->nDstID % m_nThreads;
+						AddToBucket(m_tempCollPPArray[index][iBucket], m_tempSegmentsPP[index][iBucket], iBlock, index, batch.collisions[j]);
+					}
+					batch.size = 0;
+				};
+
+				const size_t iEnd = std::min((iBlock + 1) * PP_BATCH_ROWS, collisions.size());
+				for (size_t i = iBlock * PP_BATCH_ROWS; i < iEnd; ++i)
+					for (auto* coll : collisions[i])
+					{
+						if (asleep && asleep[coll->nSrcID] && asleep[coll->nDstID]) continue; // frozen contact
+						batch.collisions[batch.size++] = coll;
+						if (batch.size == SPPContactsBatch::MAX_SIZE)
+							CalculateBatch();
+					}
+				if (batch.size != 0)
+					CalculateBatch();
+			});
 
 		ParallelFor([&](size_t i)
 		{
-			for (size_t j = 0; j < m_nThreads; ++j)
-				for (const auto& coll : m_tempCollPPArray[j][i])
-					model->ConsolidateDst(m_currentTime, _timeStep, particles, coll);
+			ConsolidateBucket(m_tempCollPPArray, m_tempSegmentsPP, i, [&](SCollision* _coll)
+			{
+				model->ConsolidateDst(m_currentTime, _timeStep, particles, _coll);
+			});
 		});
+
+		if (m_profiler.IsEnabled())
+			for (const auto& collisions : m_tempCollPPArray)
+				for (const auto& coll : collisions)
+					m_profiler.AddContacts(CStepProfiler::EPhase::FORCES_PP, coll.size());
 	}
 }
 
@@ -132,6 +271,7 @@ void CCPUSimulator::CalculateForcesPW(double _timeStep)
 {
 	SParticleStruct& particles = m_scene.GetRefToParticles();
 	SWallStruct& walls = m_scene.GetRefToWalls();
+	const uint8_t* asleep = SleepingParticles();
 
 	for (auto* model : m_PWModels)
 	{
@@ -140,25 +280,39 @@ void CCPUSimulator::CalculateForcesPW(double _timeStep)
 		for (auto& collisions : m_tempCollPWArray)
 			for (auto& coll : collisions)
 				coll.clear();
+		for (auto& segments : m_tempSegmentsPW)
+			for (auto& segment : segments)
+				segment.clear();
 
 		ParallelFor(m_collisionsCalculator.m_vCollMatrixPW.size(), [&](size_t i)
 		{
-			const size_t index = i % m_nThreads;
+			const size_t index = GetCurrentThreadIndex();
 			for (auto& coll : m_collisionsCalculator.m_vCollMatrixPW[i])
 			{
-				model->Calculate(m_currentTime, _timeStep, coll);
-				model->ConsolidatePart(m_currentTime, _timeStep, particles, coll);
+				// contacts of sleeping particles are frozen, their last forces still act on walls
+				if (!asleep || !asleep[coll->nDstID])
+				{
+					model->Calculate(m_currentTime, _timeStep, coll);
+					model->ConsolidatePart(m_currentTime, _timeStep, particles, coll);
+				}
 
-				m_tempCollPWArray[index][coll->nSrcID % m_nThreads].push_back(coll);
+				const size_t iBucket = coll->nSrcID % m_nThreads;
+				AddToBucket(m_tempCollPWArray[index][iBucket], m_tempSegmentsPW[index][iBucket], i, index, coll);
 			}
 		});
 
 		ParallelFor([&](size_t i)
 		{
-			for (size_t j = 0; j < m_nThreads; ++j)
-				for (const auto& coll : m_tempCollPWArray[j][i])
-					model->ConsolidateWall(m_currentTime, _timeStep, walls, coll);
+			ConsolidateBucket(m_tempCollPWArray, m_tempSegmentsPW, i, [&](SCollision* _coll)
+			{
+				model->ConsolidateWall(m_currentTime, _timeStep, walls, _coll);
+			});
 		});
+
+		if (m_profiler.IsEnabled())
+			for (const auto& collisions : m_tempCollPWArray)
+				for (const auto& coll : collisions)
+					m_profiler.AddContacts(CStepProfiler::EPhase::FORCES_PW, coll.size());
 	}
 }
 
@@ -169,6 +323,7 @@ void CCPUSimulator::CalculateForcesSB(double _timeStep)
 	SParticleStruct& particles = m_scene.GetRefToParticles();
 	SSolidBondStruct& bonds = m_scene.GetRefToSolidBonds();
 	const auto& partToSolidBonds = *m_scene.GetPointerToPartToSolidBonds();
+	const uint8_t* asleep = SleepingParticles();
 
 	for (auto* model : m_SBModels)
 	{
@@ -178,13 +333,15 @@ void CCPUSimulator::CalculateForcesSB(double _timeStep)
 
 		ParallelFor(m_scene.GetBondsNumber(), [&](size_t iBond)
 		{
-			if (bonds.Active(iBond))
-				model->Calculate(m_currentTime, _timeStep, iBond, bonds, &brokenBonds[iBond % m_nThreads]);
+			if (!bonds.Active(iBond)) return;
+			if (asleep && asleep[bonds.LeftID(iBond)] && asleep[bonds.RightID(iBond)]) return; // frozen bond
+			model->Calculate(m_currentTime, _timeStep, iBond, bonds, &brokenBonds[GetCurrentThreadIndex()]);
 		});
 		m_nBrokenBonds += VectorSum(brokenBonds);
 
 		ParallelFor(partToSolidBonds.size(), [&](size_t iPart)
 		{
+			if (asleep && asleep[iPart]) return;
 			for (size_t j = 0; j < partToSolidBonds[iPart].size(); ++j)
 			{
 				const unsigned iBond = partToSolidBonds[iPart][j];
@@ -201,6 +358,8 @@ void CCPUSimulator::CalculateForcesLB(double _timeStep)
 
 	SLiquidBondStruct& bonds = m_scene.GetRefToLiquidBonds();
 	SParticleStruct& particles = m_scene.GetRefToParticles();
+	const SParticlesToBonds& partToBonds = m_scene.GetParticlesToLiquidBonds();
+	const uint8_t* asleep = SleepingParticles();
 
 	for (auto* model : m_LBModels)
 	{
@@ -210,20 +369,27 @@ void CCPUSimulator::CalculateForcesLB(double _timeStep)
 
 		ParallelFor(m_scene.GetLiquidBondsNumber(), [&](size_t i)
 		{
-			if (bonds.Active(i))
-				model->Calculate(m_currentTime, _timeStep, i, bonds, &brokenBonds[i % m_nThreads]);
+			if (!bonds.Active(i)) return;
+			if (asleep && asleep[bonds.LeftID(i)] && asleep[bonds.RightID(i)]) return; // frozen bond
+			model->Calculate(m_currentTime, _timeStep, i, bonds, &brokenBonds[GetCurrentThreadIndex()]);
 		});
 		m_nBrokenLiquidBonds += VectorSum(brokenBonds);
 
-		for (size_t iBond = 0; iBond < m_scene.GetLiquidBondsNumber(); ++iBond)
-			if (bonds.Active(iBond))
-				model->Consolidate(m_currentTime, _timeStep, iBond, particles);
+		// each particle gathers forces of its bonds in the order of their indices, so the result does not depend on the number of threads
+		ParallelFor(partToBonds.Size(), [&](size_t iPart)
+		{
+			if (asleep && asleep[iPart]) return;
+			for (const unsigned* it = partToBonds.Begin(iPart); it != partToBonds.End(iPart); ++it)
+				if (bonds.Active(*it))
+					model->Consolidate(m_currentTime, _timeStep, *it, iPart, particles);
+		});
 	}
 }
 
 void CCPUSimulator::CalculateForcesEF(double _timeStep)
 {
 	SParticleStruct& particles = m_scene.GetRefToParticles();
+	const uint8_t* asleep = SleepingParticles();
 
 	for (auto* model : m_EFModels)
 	{
@@ -231,7 +397,7 @@ void CCPUSimulator::CalculateForcesEF(double _timeStep)
 
 		ParallelFor(particles.Size(), [&](size_t iPart)
 		{
-			if (particles.Active(iPart))
+			if (particles.Active(iPart) && (!asleep || !asleep[iPart]))
 				model->Calculate(m_currentTime, _timeStep, iPart, particles);
 		});
 	}
@@ -241,63 +407,481 @@ void CCPUSimulator::MoveParticles(bool _bPredictionStep)
 {
 	SParticleStruct& particles = m_scene.GetRefToParticles();
 
-	// apply external acceleration
+	// apply external acceleration; quasi-static steps for sleeping are counted in the same pass
+	const bool sleeping = m_sleepingEnabled && !_bPredictionStep;
+	if (sleeping)
+		std::fill(m_sleepCounters.begin(), m_sleepCounters.end(), size_t{ 0 });
 	ParallelFor(m_scene.GetTotalParticlesNumber(), [&](size_t i)
 	{
-		if (!particles.Active(i)) return;
-		particles.Force(i) += m_externalAcceleration * particles.Mass(i);
+		if (particles.Active(i))
+			particles.Force(i) += m_externalAcceleration * particles.Mass(i);
+		if (sleeping && CountQuasiStaticStep(i))
+			m_sleepCounters[GetCurrentThreadIndex()]++;
 	});
 
+	if (sleeping)
+		PutParticlesToSleep(VectorSum(m_sleepCounters) != 0);
+
 	// change current simulation time step
 	if (m_variableTimeStep)
 	{
-		double maxStep = std::numeric_limits<double>::max();
-		for (size_t i = 0; i < particles.Size(); i++)
+		double maxStep = ParallelMin(particles.Size(), std::numeric_limits<double>::max(), [&](size_t i)
 		{
-			if (!particles.Force(i).IsZero())
-				maxStep = std::min(maxStep, std::pow(particles.Mass(i), 2.) / particles.Force(i).SquaredLength());
-		}
+			return !particles.Force(i).IsZero() ? std::pow(particles.Mass(i), 2.) / particles.Force(i).SquaredLength() : std::numeric_limits<double>::max();
+		});
 		maxStep = std::sqrt(std::sqrt(maxStep) * m_partMoveLimit);
 		if (m_currSimulationStep > maxStep)
 			m_currSimulationStep = maxStep;
 		else if (m_currSimulationStep < m_initSimulationStep)
 			m_currSimulationStep = std::min(m_currSimulationStep * m_timeStepFactor, m_initSimulationStep);
 	}
-	const double dTimeStep = !_bPredictionStep ? m_currSimulationStep : m_currSimulationStep / 2.;
+	// integration state has to be gathered anew after change of the scheme
+	if (m_stateIntegrator != m_integrator)
+	{
+		m_stateIntegrator = m_integrator;
+		m_integratedParticles = 0;
+	}
 
-	// move particles
-	ParallelFor(m_scene.GetTotalParticlesNumber(), [&](size_t i)
+	switch (m_integrator)
 	{
-		if (!particles.Active(i)) return;
+	case EIntegrator::LEAPFROG:
+		if (SubcycleSolidBonds())
+			MoveParticlesSubcycled(_bPredictionStep);
+		else
+		{
+			const double dTimeStep = !_bPredictionStep ? m_currSimulationStep : m_currSimulationStep / 2.;
 
-		particles.Vel(i) += particles.Force(i) / particles.Mass(i) * dTimeStep;
+			// move particles
+			ParallelFor(m_scene.GetTotalParticlesNumber(), [&](size_t i)
+			{
+				if (!particles.Active(i)) return;
 
-		if (m_considerAnisotropy)
+				particles.Vel(i) += particles.Force(i) / particles.Mass(i) * dTimeStep;
+
+				if (m_considerAnisotropy)
+				{
+					const CMatrix3 rotMatrix = particles.Quaternion(i).ToRotmat();
+					CVector3 vTemp = (rotMatrix.Transpose()*particles.Moment(i));
+					vTemp /= particles.InertiaMoment(i);
+					particles.AnglVel(i) += rotMatrix * vTemp * dTimeStep;
+					if (!_bPredictionStep)
+						RotateQuaternion(particles.Quaternion(i), particles.AnglVel(i), dTimeStep);
+				}
+				else
+					particles.AnglVel(i) += particles.Moment(i) / particles.InertiaMoment(i) * dTimeStep;
+				if (!_bPredictionStep)
+					particles.Coord(i) += particles.Vel(i)*dTimeStep;
+			});
+		}
+		break;
+	case EIntegrator::VELOCITY_VERLET:
+		MoveParticlesVerlet();
+		break;
+	case EIntegrator::GEAR:
+		MoveParticlesGear();
+		break;
+	}
+
+	MoveParticlesOverPBC(); // move virtual particles and check boundaries
+}
+
+bool CCPUSimulator::SubcycleSolidBonds() const
+{
+	return m_solidBondSubsteps > 1 && m_integrator == EIntegrator::LEAPFROG && !m_SBModels.empty() && m_scene.GetBondsNumber() != 0;
+}
+
+CVector3 CCPUSimulator::AngularAcceleration(size_t _iPart) const
+{
+	const SParticleStruct& particles = m_scene.GetRefToParticles();
+	if (!m_considerAnisotropy)
+		return particles.Moment(_iPart) / particles.InertiaMoment(_iPart);
+	const CMatrix3 rotMatrix = CQuaternion{ particles.Quaternion(_iPart) }.ToRotmat();
+	return rotMatrix * (rotMatrix.Transpose() * particles.Moment(_iPart) / particles.InertiaMoment(_iPart));
+}
+
+void CCPUSimulator::RotateQuaternion(CQuaternion& _quaternion, const CVector3& _angVel, double _timeStep)
+{
+	CQuaternion quaternTemp;
+	quaternTemp.q0 = 0.5*_timeStep*(-_quaternion.q1*_angVel.x - _quaternion.q2*_angVel.y - _quaternion.q3*_angVel.z);
+	quaternTemp.q1 = 0.5*_timeStep*(_quaternion.q0*_angVel.x + _quaternion.q3*_angVel.y - _quaternion.q2*_angVel.z);
+	quaternTemp.q2 = 0.5*_timeStep*(-_quaternion.q3*_angVel.x + _quaternion.q0*_angVel.y + _quaternion.q1*_angVel.z);
+	quaternTemp.q3 = 0.5*_timeStep*(_quaternion.q2*_angVel.x - _quaternion.q1*_angVel.y + _quaternion.q0*_angVel.z);
+	_quaternion += quaternTemp;
+	_quaternion.Normalize();
+}
+
+void CCPUSimulator::MoveParticlesSubcycled(bool _bPredictionStep)
+{
+	SParticleStruct& particles = m_scene.GetRefToParticles();
+	const size_t number = m_scene.GetTotalParticlesNumber();
+	m_slowForces.resize(number);
+	m_slowMoments.resize(number);
+	m_bondForces.resize(number);
+	m_bondMoments.resize(number);
+
+	// all forces except of solid bonds act over the whole time step; at the prediction step, velocities are shifted by a half of the step
+	const double slowStep = !_bPredictionStep ? m_currSimulationStep : m_currSimulationStep / 2.;
+	ParallelFor(number, [&](size_t i)
+	{
+		if (!particles.Active(i)) return;
+		particles.Vel(i) += particles.Force(i) / particles.Mass(i) * slowStep;
+		particles.AnglVel(i) += AngularAcceleration(i) * slowStep;
+		m_slowForces[i] = particles.Force(i);
+		m_slowMoments[i] = particles.Moment(i);
+		m_bondForces[i].Init(0);
+		m_bondMoments[i].Init(0);
+		particles.Force(i).Init(0);
+		particles.Moment(i).Init(0);
+	});
+
+	// solid bonds are calculated and integrated with a smaller step; at the prediction step, only a half of the first sub-step is made
+	const double subStep = m_currSimulationStep / m_solidBondSubsteps;
+	const size_t substeps = !_bPredictionStep ? m_solidBondSubsteps : 1;
+	const double kickStep = !_bPredictionStep ? subStep : subStep / 2.;
+	for (size_t k = 0; k < substeps; ++k)
+	{
+		{
+			const auto scope = m_profiler.Scope(CStepProfiler::EPhase::FORCES_SB);
+			CalculateForcesSB(subStep);
+		}
+		ParallelFor(number, [&](size_t i)
 		{
-			const CMatrix3 rotMatrix = particles.Quaternion(i).ToRotmat();
-			CVector3 vTemp = (rotMatrix.Transpose()*particles.Moment(i));
-			vTemp /= particles.InertiaMoment(i);
-			particles.AnglVel(i) += rotMatrix * vTemp * dTimeStep;
+			if (!particles.Active(i)) return;
+			particles.Vel(i) += particles.Force(i) / particles.Mass(i) * kickStep;
+			particles.AnglVel(i) += AngularAcceleration(i) * kickStep;
 			if (!_bPredictionStep)
 			{
-				const CVector3& angVel = particles.AnglVel(i);
-				CQuaternion& quart = particles.Quaternion(i);
-				CQuaternion quaternTemp;
-				quaternTemp.q0 = 0.5*dTimeStep*(-quart.q1*angVel.x - quart.q2*angVel.y - quart.q3*angVel.z);
-				quaternTemp.q1 = 0.5*dTimeStep*(quart.q0*angVel.x + quart.q3*angVel.y - quart.q2*angVel.z);
-				quaternTemp.q2 = 0.5*dTimeStep*(-quart.q3*angVel.x + quart.q0*angVel.y + quart.q1*angVel.z);
-				quaternTemp.q3 = 0.5*dTimeStep*(quart.q2*angVel.x - quart.q1*angVel.y + quart.q0*angVel.z);
-				quart += quaternTemp;
-				quart.Normalize();
+				particles.Coord(i) += particles.Vel(i) * subStep;
+				if (m_considerAnisotropy)
+					RotateQuaternion(particles.Quaternion(i), particles.AnglVel(i), subStep);
 			}
+			m_bondForces[i] += particles.Force(i);
+			m_bondMoments[i] += particles.Moment(i);
+			particles.Force(i).Init(0);
+			particles.Moment(i).Init(0);
+		});
+	}
+
+	// resulting forces are kept for saving
+	ParallelFor(number, [&](size_t i)
+	{
+		if (!particles.Active(i)) return;
+		particles.Force(i) = m_slowForces[i] + m_bondForces[i] / static_cast<double>(substeps);
+		particles.Moment(i) = m_slowMoments[i] + m_bondMoments[i] / static_cast<double>(substeps);
+	});
+}
+
+void CCPUSimulator::MoveParticlesVerlet()
+{
+	// Velocities used to calculate forces are predicted as v(t) = v(t-dt) + a(t-dt)*dt and are corrected here with the newly calculated accelerations.
+	// Coordinates follow the usual scheme x(t+dt) = x(t) + v(t)*dt + a(t)*dt^2/2.
+	SParticleStruct& particles = m_scene.GetRefToParticles();
+	const size_t number = m_scene.GetTotalParticlesNumber();
+	m_integrationAcc.resize(number);
+	m_integrationAnglAcc.resize(number);
+	const double dt = m_currSimulationStep;
+	const double dtLast = m_lastIntegrationStep;
+
+	ParallelFor(number, [&](size_t i)
+	{
+		if (!particles.Active(i)) return;
+
+		const CVector3 acc = particles.Force(i) / particles.Mass(i);
+		const CVector3 anglAcc = AngularAcceleration(i);
+		// correct velocities; the state of new particles is initialized with their current values
+		if (i < m_integratedParticles)
+		{
+			particles.Vel(i) += (acc - m_integrationAcc[i]) * (0.5 * dtLast);
+			particles.AnglVel(i) += (anglAcc - m_integrationAnglAcc[i]) * (0.5 * dtLast);
+		}
+
+		particles.Coord(i) += (particles.Vel(i) + acc * (0.5 * dt)) * dt;
+		if (m_considerAnisotropy)
+			RotateQuaternion(particles.Quaternion(i), particles.AnglVel(i) + anglAcc * (0.5 * dt), dt);
+
+		// predict velocities
+		particles.Vel(i) += acc * dt;
+		particles.AnglVel(i) += anglAcc * dt;
+		m_integrationAcc[i] = acc;
+		m_integrationAnglAcc[i] = anglAcc;
+	});
+
+	m_integratedParticles = number;
+	m_lastIntegrationStep = dt;
+}
+
+void CCPUSimulator::MoveParticlesGear()
+{
+	// Translational motion is described by coordinates, velocities, accelerations and their derivatives (jerks), rotational motion - by angular velocities,
+	// accelerations and jerks. Forces are calculated with predicted values, and the difference between calculated and predicted accelerations corrects all of them.
+	// Coefficients of the corrector are for a second-order equation with four values and for a first-order equation with three values.
+	static constexpr double GEAR_C0 = 1. / 6.;
+	static constexpr double GEAR_C1 = 5. / 6.;
+	static constexpr double GEAR_C3 = 1. / 3.;
+	static constexpr double GEAR_ANGL_C0 = 5. / 12.;
+	static constexpr double GEAR_ANGL_C2 = 1. / 2.;
+
+	SParticleStruct& particles = m_scene.GetRefToParticles();
+	const size_t number = m_scene.GetTotalParticlesNumber();
+	m_integrationAcc.resize(number);
+	m_integrationAnglAcc.resize(number);
+	m_integrationJerk.resize(number);
+	m_integrationAnglJerk.resize(number);
+	const double dt = m_currSimulationStep;
+	const double dtLast = m_lastIntegrationStep;
+
+	ParallelFor(number, [&](size_t i)
+	{
+		if (!particles.Active(i)) return;
+
+		CVector3& acc = m_integrationAcc[i];
+		CVector3& anglAcc = m_integrationAnglAcc[i];
+		CVector3& jerk = m_integrationJerk[i];
+		CVector3& anglJerk = m_integrationAnglJerk[i];
+		const CVector3 newAcc = particles.Force(i) / particles.Mass(i);
+		const CVector3 newAnglAcc = AngularAcceleration(i);
+
+		// correct predicted values; the state of new particles is initialized with their current values
+		if (i < m_integratedParticles)
+		{
+			const CVector3 dAcc = newAcc - acc;
+			const CVector3 dAnglAcc = newAnglAcc - anglAcc;
+			particles.Coord(i) += dAcc * (GEAR_C0 * dtLast * dtLast / 2.);
+			particles.Vel(i) += dAcc * (GEAR_C1 * dtLast / 2.);
+			jerk += dAcc * (GEAR_C3 * 3. / dtLast);
+			particles.AnglVel(i) += dAnglAcc * (GEAR_ANGL_C0 * dtLast);
+			anglJerk += dAnglAcc * (GEAR_ANGL_C2 * 2. / dtLast);
 		}
 		else
-			particles.AnglVel(i) += particles.Moment(i) / particles.InertiaMoment(i) * dTimeStep;
-		if (!_bPredictionStep)
-			particles.Coord(i) += particles.Vel(i)*dTimeStep;
+		{
+			jerk.Init(0);
+			anglJerk.Init(0);
+		}
+		acc = newAcc;
+		anglAcc = newAnglAcc;
+
+		// predict values for the next step
+		if (m_considerAnisotropy)
+			RotateQuaternion(particles.Quaternion(i), particles.AnglVel(i) + anglAcc * (0.5 * dt), dt);
+		particles.Coord(i) += (particles.Vel(i) + (acc / 2. + jerk * (dt / 6.)) * dt) * dt;
+		particles.Vel(i) += (acc + jerk * (dt / 2.)) * dt;
+		acc += jerk * dt;
+		particles.AnglVel(i) += (anglAcc + anglJerk * (dt / 2.)) * dt;
+		anglAcc += anglJerk * dt;
 	});
 
-	MoveParticlesOverPBC(); // move virtual particles and check boundaries
+	m_integratedParticles = number;
+	m_lastIntegrationStep = dt;
+}
+
+const uint8_t* CCPUSimulator::SleepingParticles() const
+{
+	return m_nSleepingParticles != 0 ? m_asleep.data() : nullptr;
+}
+
+void CCPUSimulator::ResizeSleepingState()
+{
+	const size_t number = m_scene.GetTotalParticlesNumber();
+	if (m_asleep.size() == number) return;
+	m_asleep.resize(number, 0);
+	m_calmSteps.resize(number, 0);
+	m_islands.resize(number, 0);
+	m_islandParents.resize(number);
+	m_islandFlags.resize(number);
+}
+
+void CCPUSimulator::WakeParticles()
+{
+	if (m_nSleepingParticles == 0) return;
+
+	const SWallStruct& walls = m_scene.GetRefToWalls();
+	const auto& collisionsPP = m_collisionsCalculator.m_vCollMatrixPP;
+	const auto& collisionsPW = m_collisionsCalculator.m_vCollMatrixPW;
+
+	// an awake particle disturbs sleeping ones, if it did not stay quasi-static at the last step; this also holds for newly generated particles
+	const auto Disturbs = [&](size_t _iPart) { return !m_asleep[_iPart] && m_calmSteps[_iPart] == 0; };
+	const auto IsMoving = [&](size_t _iWall) { return !walls.Vel(_iWall).IsZero() || !walls.RotVel(_iWall).IsZero(); };
+
+	// gather islands, touched by disturbing particles or by moving walls
+	for (auto& islands : m_touchedIslands)
+		islands.clear();
+	ParallelFor(collisionsPP.size(), [&](size_t i)
+	{
+		auto& islands = m_touchedIslands[GetCurrentThreadIndex()];
+		for (const auto* coll : collisionsPP[i])
+		{
+			if (m_asleep[coll->nSrcID] && Disturbs(coll->nDstID))
+				islands.push_back(m_islands[coll->nSrcID]);
+			else if (m_asleep[coll->nDstID] && Disturbs(coll->nSrcID))
+				islands.push_back(m_islands[coll->nDstID]);
+		}
+		if (m_asleep[i])
+			for (const auto* coll : collisionsPW[i])
+				if (IsMoving(coll->nSrcID))
+				{
+					islands.push_back(m_islands[i]);
+					break;
+				}
+	});
+	const auto GatherBonds = [&](const SBondStruct& _bonds)
+	{
+		ParallelFor(_bonds.Size(), [&](size_t i)
+		{
+			if (!_bonds.Active(i)) return;
+			const unsigned left = _bonds.LeftID(i);
+			const unsigned right = _bonds.RightID(i);
+			if (m_asleep[left] && Disturbs(right))
+				m_touchedIslands[GetCurrentThreadIndex()].push_back(m_islands[left]);
+			else if (m_asleep[right] && Disturbs(left))
+				m_touchedIslands[GetCurrentThreadIndex()].push_back(m_islands[right]);
+		});
+	};
+	GatherBonds(m_scene.GetRefToSolidBonds());
+	GatherBonds(m_scene.GetRefToLiquidBonds());
+
+	bool anyTouched = false;
+	std::fill(m_islandFlags.begin(), m_islandFlags.end(), uint8_t{ 0 });
+	for (const auto& islands : m_touchedIslands)
+		for (const unsigned island : islands)
+		{
+			m_islandFlags[island] = 1;
+			anyTouched = true;
+		}
+	if (!anyTouched) return;
+
+	// wake whole islands
+	std::fill(m_sleepCounters.begin(), m_sleepCounters.end(), size_t{ 0 });
+	ParallelFor(m_asleep.size(), [&](size_t i)
+	{
+		if (!m_asleep[i] || !m_islandFlags[m_islands[i]]) return;
+		m_asleep[i] = 0;
+		m_calmSteps[i] = 0;
+		m_sleepCounters[GetCurrentThreadIndex()]++;
+	});
+	m_nSleepingParticles -= VectorSum(m_sleepCounters);
+}
+
+bool CCPUSimulator::CountQuasiStaticStep(size_t _iPart)
+{
+	SParticleStruct& particles = m_scene.GetRefToParticles();
+	if (m_asleep[_iPart])
+	{
+		// sleeping particles stay at rest
+		particles.Force(_iPart).Init(0);
+		particles.Moment(_iPart).Init(0);
+		return false;
+	}
+	if (!particles.Active(_iPart))
+	{
+		m_calmSteps[_iPart] = 0;
+		return false;
+	}
+	// both velocities and the acceleration due to the unbalanced force are small;
+	// moments are not checked, since rolling resistance does not vanish at rest and changes its sign from step to step
+	const double maxVel2 = m_sleepVelocity * m_sleepVelocity;
+	const double radius2 = particles.Radius(_iPart) * particles.Radius(_iPart);
+	const bool calm = particles.Vel(_iPart).SquaredLength() < maxVel2
+		&& particles.AnglVel(_iPart).SquaredLength() * radius2 < maxVel2
+		&& particles.Force(_iPart).SquaredLength() < m_sleepAcceleration * m_sleepAcceleration * particles.Mass(_iPart) * particles.Mass(_iPart);
+	m_calmSteps[_iPart] = calm ? std::min(m_calmSteps[_iPart] + 1, m_sleepSteps) : 0;
+	return m_calmSteps[_iPart] == m_sleepSteps;
+}
+
+void CCPUSimulator::PutParticlesToSleep(bool _anyReady)
+{
+	SParticleStruct& particles = m_scene.GetRefToParticles();
+	const SWallStruct& walls = m_scene.GetRefToWalls();
+	const auto& collisionsPP = m_collisionsCalculator.m_vCollMatrixPP;
+	const auto& collisionsPW = m_collisionsCalculator.m_vCollMatrixPW;
+
+	// islands are searched with a delay of a fraction of the required quasi-static steps, which is negligible compared to them
+	if (m_stepsToIslandsCheck != 0)
+		m_stepsToIslandsCheck--;
+	if (m_stepsToIslandsCheck == 0 && _anyReady)
+	{
+		m_stepsToIslandsCheck = std::max(m_sleepSteps / 8, 1u);
+
+		// islands are connected through contacts and bonds of particles, which are ready to sleep or already asleep;
+		// an island is disturbed if any of its particles touches another awake particle or a moving wall
+		const auto IsReady = [&](size_t _iPart) { return m_asleep[_iPart] || m_calmSteps[_iPart] == m_sleepSteps; };
+		const auto Link = [&](unsigned _iPart1, unsigned _iPart2)
+		{
+			const bool ready1 = IsReady(_iPart1);
+			const bool ready2 = IsReady(_iPart2);
+			if (ready1 && ready2)
+			{
+				const unsigned root1 = FindIsland(_iPart1);
+				const unsigned root2 = FindIsland(_iPart2);
+				if (root1 != root2)
+					m_islandParents[std::max(root1, root2)] = std::min(root1, root2);
+			}
+			else if (ready1)
+				m_islandFlags[_iPart1] = 1;
+			else if (ready2)
+				m_islandFlags[_iPart2] = 1;
+		};
+
+		// the search is serial: it runs rarely and takes a negligible share of the simulation time, so it is not worth a concurrent disjoint-set forest
+		std::iota(m_islandParents.begin(), m_islandParents.end(), 0u);
+		std::fill(m_islandFlags.begin(), m_islandFlags.end(), uint8_t{ 0 });
+		for (const auto& collisions : collisionsPP)
+			for (const auto* coll : collisions)
+				Link(coll->nSrcID, coll->nDstID);
+		for (size_t i = 0; i < collisionsPW.size(); ++i)
+			if (IsReady(i))
+				for (const auto* coll : collisionsPW[i])
+					if (!walls.Vel(coll->nSrcID).IsZero() || !walls.RotVel(coll->nSrcID).IsZero())
+						m_islandFlags[i] = 1;
+		const auto LinkBonds = [&](const SBondStruct& _bonds)
+		{
+			for (size_t i = 0; i < _bonds.Size(); ++i)
+				if (_bonds.Active(i))
+					Link(_bonds.LeftID(i), _bonds.RightID(i));
+		};
+		LinkBonds(m_scene.GetRefToSolidBonds());
+		LinkBonds(m_scene.GetRefToLiquidBonds());
+
+		// disturbance of a particle spreads to its island
+		for (size_t i = 0; i < m_asleep.size(); ++i)
+			if (m_islandFlags[i] & 1)
+				m_islandFlags[FindIsland(static_cast<unsigned>(i))] |= 2;
+
+		// undisturbed islands fall asleep; already sleeping particles join the new island
+		for (size_t i = 0; i < m_asleep.size(); ++i)
+		{
+			if (!IsReady(i)) continue;
+			const unsigned island = FindIsland(static_cast<unsigned>(i));
+			if (m_islandFlags[island] & 2) continue;
+			m_islands[i] = island;
+			if (m_asleep[i]) continue;
+			m_asleep[i] = 1;
+			m_nSleepingParticles++;
+			particles.Vel(i).Init(0);
+			particles.AnglVel(i).Init(0);
+			particles.Force(i).Init(0);
+			particles.Moment(i).Init(0);
+			if (i < m_integratedParticles)
+			{
+				m_integrationAcc[i].Init(0);
+				m_integrationAnglAcc[i].Init(0);
+				if (m_stateIntegrator == EIntegrator::GEAR)
+				{
+					m_integrationJerk[i].Init(0);
+					m_integrationAnglJerk[i].Init(0);
+				}
+			}
+		}
+	}
+}
+
+unsigned CCPUSimulator::FindIsland(unsigned _iPart)
+{
+	while (m_islandParents[_iPart] != _iPart)
+	{
+		m_islandParents[_iPart] = m_islandParents[m_islandParents[_iPart]];
+		_iPart = m_islandParents[_iPart];
+	}
+	return _iPart;
 }
 
 void CCPUSimulator::MoveWalls(double _timeStep)
@@ -507,53 +1091,83 @@ void CCPUSimulator::MoveMultispheres(double _dTimeStep, bool _bPredictionStep)
 
 void CCPUSimulator::PrepareAdditionalSavingData()
 {
-	SParticleStruct& particles = m_scene.GetRefToParticles();
-
-	// reset previously calculated stresses
-	for (auto& data : m_additionalSavingData)
-		data.stressTensor.Init(0);
-
-	// save stresses caused by solid bonds
-	SSolidBondStruct& solidBonds = m_scene.GetRefToSolidBonds();
-	for (size_t i = 0; i < solidBonds.Size(); ++i)
+	const SParticleStruct& particles = m_scene.GetRefToParticles();
+	const SSolidBondStruct& solidBonds = m_scene.GetRefToSolidBonds();
+	const SParticlesToBonds& particlesToBonds = m_scene.GetParticlesToSolidBonds();
+	const auto& collisionsPP = m_collisionsCalculator.m_vCollMatrixPP;
+	const auto& collisionsPW = m_collisionsCalculator.m_vCollMatrixPW;
+
+	// gather PP collisions of each particle as a destination one, keeping the order of the collision matrix
+	m_stressDstOffsets.assign(m_additionalSavingData.size() + 1, 0);
+	for (const auto& collisions : collisionsPP)
+		for (const auto* collision : collisions)
+			m_stressDstOffsets[collision->nDstID + 1]++;
+	for (size_t i = 1; i < m_stressDstOffsets.size(); ++i)
+		m_stressDstOffsets[i] += m_stressDstOffsets[i - 1];
+	m_stressDstCollisions.resize(m_stressDstOffsets.back());
+	m_stressDstPositions.assign(m_stressDstOffsets.begin(), m_stressDstOffsets.end() - 1);
+	for (const auto& collisions : collisionsPP)
+		for (const auto* collision : collisions)
+			m_stressDstCollisions[m_stressDstPositions[collision->nDstID]++] = collision;
+
+	// each particle accumulates only its own stress tensor, so the contributions are summed up in the same order as in a serial loop over all bonds and collisions
+	ParallelFor(m_additionalSavingData.size(), [&](size_t i)
 	{
-		if (!solidBonds.Active(i) && !m_pSystemStructure->GetObjectByIndex(solidBonds.InitIndex(i))->IsActive(m_currentTime)) continue;
-		const size_t leftID  = solidBonds.LeftID(i);
-		const size_t rightID = solidBonds.RightID(i);
-		CVector3 connVec = (particles.Coord(leftID) - particles.Coord(rightID)).Normalized();
-		m_additionalSavingData[leftID ].AddStress(-1 * connVec * particles.Radius(leftID ),      solidBonds.TotalForce(i), PI * pow(2 * particles.Radius(leftID ), 3) / 6);
-		m_additionalSavingData[rightID].AddStress(     connVec * particles.Radius(rightID), -1 * solidBonds.TotalForce(i), PI * pow(2 * particles.Radius(rightID), 3) / 6);
-	}
+		SAdditionalSavingData& data = m_additionalSavingData[i];
+		data.stressTensor.Init(0);
+		const double radius = particles.Radius(i);
+		const double volume = PI * pow(2 * radius, 3) / 6;
 
-	// save stresses caused by particle-particle contact
-	for (auto& collisions : m_collisionsCalculator.m_vCollMatrixPP)
-		for (auto& collision : collisions)
-		{
-			const size_t srcID = collision->nSrcID;
-			const size_t dstID = collision->nDstID;
-			CVector3 connVec = (particles.Coord(srcID) - particles.Coord(dstID)).Normalized();
-			const double srcRadius = particles.Radius(srcID);
-			const double dstRadius = particles.Radius(dstID);
-			m_additionalSavingData[collision->nSrcID].AddStress(-1 * connVec * srcRadius,      collision->vTotalForce, PI * pow(2 * srcRadius, 3) / 6);
-			m_additionalSavingData[collision->nDstID].AddStress(     connVec * dstRadius, -1 * collision->vTotalForce, PI * pow(2 * dstRadius, 3) / 6);
-		}
+		// stresses caused by solid bonds
+		if (i < particlesToBonds.Size())
+			for (const unsigned* it = particlesToBonds.Begin(i); it != particlesToBonds.End(i); ++it)
+			{
+				const size_t iBond = *it;
+				// bonds broken after the last saving are still active in the system structure; it is not accessed here, since it is not thread-safe and the results saver may be writing into it
+				if (!solidBonds.Active(iBond) && solidBonds.EndActivity(iBond) <= m_lastSavingTime) continue;
+				CVector3 connVec = (particles.Coord(solidBonds.LeftID(iBond)) - particles.Coord(solidBonds.RightID(iBond))).Normalized();
+				if (solidBonds.LeftID(iBond) == i)
+					data.AddStress(-1 * connVec * radius, solidBonds.TotalForce(iBond), volume);
+				else
+					data.AddStress(connVec * radius, -1 * solidBonds.TotalForce(iBond), volume);
+			}
 
-	// save stresses caused by particle-wall contacts
-	for (auto& collisions : m_collisionsCalculator.m_vCollMatrixPW)
-		for (auto& collision : collisions)
+		// stresses caused by particle-particle contacts: first from rows of the collision matrix before the own one, then from the own row, then from the rest
+		const SCollision* const* dst = m_stressDstCollisions.data() + m_stressDstOffsets[i];
+		const SCollision* const* dstEnd = m_stressDstCollisions.data() + m_stressDstOffsets[i + 1];
+		const auto AddDstStress = [&](const SCollision* _collision)
 		{
-			CVector3 connVec = (collision->vContactVector - particles.Coord(collision->nDstID)).Normalized();
-			m_additionalSavingData[collision->nDstID].AddStress(connVec * particles.Radius(collision->nDstID), collision->vTotalForce, PI * pow(2 * particles.Radius(collision->nDstID), 3) / 6);
-		}
+			CVector3 connVec = (particles.Coord(_collision->nSrcID) - particles.Coord(i)).Normalized();
+			data.AddStress(connVec * radius, -1 * _collision->vTotalForce, volume);
+		};
+		for (; dst != dstEnd && (*dst)->nSrcID < i; ++dst)
+			AddDstStress(*dst);
+		if (i < collisionsPP.size())
+			for (const auto* collision : collisionsPP[i])
+			{
+				CVector3 connVec = (particles.Coord(i) - particles.Coord(collision->nDstID)).Normalized();
+				data.AddStress(-1 * connVec * radius, collision->vTotalForce, volume);
+			}
+		for (; dst != dstEnd; ++dst)
+			AddDstStress(*dst);
+
+		// stresses caused by particle-wall contacts
+		if (i < collisionsPW.size())
+			for (const auto* collision : collisionsPW[i])
+			{
+				CVector3 connVec = (collision->vContactVector - particles.Coord(i)).Normalized();
+				data.AddStress(connVec * radius, collision->vTotalForce, volume);
+			}
+	});
 }
 
 void CCPUSimulator::SaveData()
 {
-	const clock_t t = clock();
+	const auto start = std::chrono::steady_clock::now();
 	if (m_scene.GetRefToParticles().ThermalsExist())
 		m_maxParticleTemperature = m_scene.GetMaxParticleTemperature();
 	p_SaveData();
-	m_verletList.AddDisregardingTimeInterval(clock() - t);
+	m_verletList.AddDisregardingTimeInterval(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
 }
 
 void CCPUSimulator::UpdateVerletLists(double _dTimeStep)
@@ -561,11 +1175,16 @@ void CCPUSimulator::UpdateVerletLists(double _dTimeStep)
 	// update max velocity
 	m_maxParticleVelocity = m_scene.GetMaxParticleVelocity();
 	if (m_wallsVelocityChanged)
-		m_maxWallVelocity = m_scene.GetMaxWallVelocity();
-	if (m_verletList.IsNeedToBeUpdated(_dTimeStep, m_scene.GetMaxPartVerletDistance(), m_maxWallVelocity))
+		m_maxGeometryVelocities = m_scene.GetMaxGeometryVelocities();
+	if (m_verletList.IsNeedToBeUpdated(_dTimeStep, m_scene.GetMaxPartVerletDistance(), m_maxGeometryVelocities))
 	{
-		m_verletList.UpdateList(m_currentTime);
-		m_scene.SaveVerletCoords();
+		const auto scope = m_profiler.Scope(CStepProfiler::EPhase::VERLET_REBUILD);
+		const auto start = std::chrono::steady_clock::now();
+		if (m_verletList.UpdateList(m_currentTime))
+			m_scene.SaveVerletCoords();
+		m_pbcSlabsValid = true;
+		m_collisionsCalculator.CompactCollMatrixes();
+		m_verletList.AddPhaseTime(CVerletDistanceTuner::EPhase::REBUILD, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
 	}
 }
 
@@ -573,35 +1192,47 @@ void CCPUSimulator::CheckParticlesInDomain()
 {
 	SVolumeType simDomain = m_pSystemStructure->GetSimulationDomain();
 	SParticleStruct& particles = m_scene.GetRefToParticles();
-	SSolidBondStruct& solidBonds = m_scene.GetRefToSolidBonds();
-	SLiquidBondStruct& liquidBonds = m_scene.GetRefToLiquidBonds();
-	std::vector<size_t> vInactiveParticlesNum(m_scene.GetTotalParticlesNumber());
+	std::vector<uint8_t> vIsLeft(m_scene.GetTotalParticlesNumber(), 0);
 	ParallelFor(m_scene.GetTotalParticlesNumber(), [&](size_t i)
 	{
 		if ((particles.Active(i)) && (!IsPointInDomain(simDomain, particles.Coord(i)))) // remove particles situated not in the domain
 		{
 			particles.Active(i) = false;
 			particles.EndActivity(i) = m_currentTime;
-			vInactiveParticlesNum[i]++;
-			for (size_t j = 0; j < solidBonds.Size(); ++j) // delete all bonds that connected to this particle
-				if ((solidBonds.Active(j)) && ((solidBonds.LeftID(j) == i) || (solidBonds.RightID(j) == i)))
-				{
-					solidBonds.Active(j) = false;
-					solidBonds.EndActivity(j) = m_currentTime;
-				}
-			for (size_t j = 0; j < liquidBonds.Size(); ++j) // delete all bonds that connected to this particle
-				if ((liquidBonds.Active(j)) && ((liquidBonds.LeftID(j) == i) || (liquidBonds.RightID(j) == i)))
-				{
-					liquidBonds.Active(j) = false;
-					liquidBonds.EndActivity(j) = m_currentTime;
-				}
+			vIsLeft[i] = 1;
 		}
 	});
 
-	const size_t nNewInactiveParticles = VectorSum(vInactiveParticlesNum);
-	m_nInactiveParticles += nNewInactiveParticles;
-	if (nNewInactiveParticles > 0)
-		m_scene.UpdateParticlesToBonds();
+	std::vector<unsigned> vLeftParticles;
+	for (size_t i = 0; i < vIsLeft.size(); ++i)
+		if (vIsLeft[i])
+			vLeftParticles.push_back(static_cast<unsigned>(i));
+	if (vLeftParticles.empty()) return;
+	m_nInactiveParticles += vLeftParticles.size();
+
+	// delete all bonds that connected to these particles
+	// the adjacency is not rebuilt: it only gets entries of inactive bonds, which are skipped by all its users
+	DeactivateBonds(m_scene.GetRefToSolidBonds(), m_scene.GetParticlesToSolidBonds(), vLeftParticles, vIsLeft);
+	DeactivateBonds(m_scene.GetRefToLiquidBonds(), m_scene.GetParticlesToLiquidBonds(), vLeftParticles, vIsLeft);
+}
+
+void CCPUSimulator::DeactivateBonds(SBondStruct& _bonds, const SParticlesToBonds& _particlesToBonds, const std::vector<unsigned>& _leftParticles, const std::vector<uint8_t>& _isLeft) const
+{
+	if (_bonds.Size() == 0) return;
+	ParallelFor(_leftParticles.size(), [&](size_t i)
+	{
+		const unsigned iPart = _leftParticles[i];
+		if (iPart >= _particlesToBonds.Size()) return; // virtual particles have no bonds
+		for (const unsigned* it = _particlesToBonds.Begin(iPart); it != _particlesToBonds.End(iPart); ++it)
+		{
+			const size_t iBond = *it;
+			const size_t iOther = _bonds.LeftID(iBond) == iPart ? _bonds.RightID(iBond) : _bonds.LeftID(iBond);
+			if (_isLeft[iOther] && iOther < iPart) continue; // bonds between two leaving particles are treated by one of them
+			if (!_bonds.Active(iBond)) continue;
+			_bonds.Active(iBond) = false;
+			_bonds.EndActivity(iBond) = m_currentTime;
+		}
+	});
 }
 
 void CCPUSimulator::MoveParticlesOverPBC()
@@ -610,14 +1241,23 @@ void CCPUSimulator::MoveParticlesOverPBC()
 	if (!pbc.bEnabled) return;
 	SParticleStruct& particles = m_scene.GetRefToParticles();
 
-	//use <unsigned char> in order to avoid problems with simultaneous writing from several threads
-	//std::vector<unsigned char> vBoundaryCrossed(m_scene.GetTotalParticlesNumber());	// whether the particle crossed the PBC boundary
-	std::vector<uint8_t> vShifts(m_scene.GetTotalParticlesNumber(), 0);	// whether the particle crossed the PBC boundary
+	// after the update of verlet lists, only particles in boundary slabs are analyzed; otherwise - all particles
+	const std::vector<unsigned>& vCandidates = m_scene.m_vPBCCrossCandidates;
+	const std::vector<unsigned>& vSlab = m_scene.m_vPBCSlabParticles;
+	const size_t nCandidates = m_pbcSlabsValid ? vCandidates.size() : m_scene.GetTotalParticlesNumber();
+	const size_t nSlab = m_pbcSlabsValid ? vSlab.size() : m_scene.GetTotalParticlesNumber();
+	const auto Candidate = [&](size_t _i) -> size_t { return m_pbcSlabsValid ? vCandidates[_i] : _i; };
+	const auto Slab = [&](size_t _i) -> size_t { return m_pbcSlabsValid ? vSlab[_i] : _i; };
+
+	// use <uint8_t> in order to avoid problems with simultaneous writing from several threads
+	if (m_pbcShifts.size() != m_scene.GetTotalParticlesNumber())
+		m_pbcShifts.assign(m_scene.GetTotalParticlesNumber(), 0);
+	std::vector<uint8_t>& vShifts = m_pbcShifts;	// whether the particle crossed the PBC boundary
 
-	// TODO: It is unnecessary to analyze all particles for all crosses. Only those should be analyzed, who can cross boundary during current verlet step.
 	// shift particles if they crossed boundary
-	ParallelFor(m_scene.GetTotalParticlesNumber(), [&](size_t i)
+	const size_t nCrossed = ParallelSum(nCandidates, size_t{ 0 }, [&](size_t iCandidate)
 	{
+		const size_t i = Candidate(iCandidate);
 		CVector3& vCoord = particles.Coord(i);
 		// particle crossed left boundary
 		if (pbc.bX && vCoord.x <= pbc.currentDomain.coordBeg.x)  vShifts[i] = vShifts[i] | 32;
@@ -628,49 +1268,56 @@ void CCPUSimulator::MoveParticlesOverPBC()
 		if (pbc.bY && vCoord.y >= pbc.currentDomain.coordEnd.y) vShifts[i] = vShifts[i] | 4;
 		if (pbc.bZ && vCoord.z >= pbc.currentDomain.coordEnd.z) vShifts[i] = vShifts[i] | 1;
 
-		if (vShifts[i])
-		{
-			vCoord += GetVectorFromVirtShift(vShifts[i], m_scene.m_PBC.boundaryShift);
-			particles.CoordVerlet(i) += GetVectorFromVirtShift(vShifts[i], m_scene.m_PBC.boundaryShift);
-		}
+		if (!vShifts[i]) return size_t{ 0 };
+		vCoord += GetVectorFromVirtShift(vShifts[i], m_scene.m_PBC.boundaryShift);
+		particles.CoordVerlet(i) += GetVectorFromVirtShift(vShifts[i], m_scene.m_PBC.boundaryShift);
+		return size_t{ 1 };
 	});
 
-	// this can be in case when all contact models are turned off
-	if (m_verletList.m_PPList.empty() && m_verletList.m_PWList.empty()) return;
-
-	ParallelFor(m_scene.GetTotalParticlesNumber(), [&](size_t i)
-	{
-		// modify shift in possible particle-particle contacts
-		for (size_t j = 0; j < m_verletList.m_PPList[i].size(); j++)
+	// nothing to update if no particle crossed boundaries or if all contact models are turned off
+	if (nCrossed == 0) return;
+	if (!m_verletList.m_PPList.empty() || !m_verletList.m_PWList.empty())
+		// contacts of crossed particles are listed only by particles from boundary slabs
+		ParallelFor(nSlab, [&](size_t iSlab)
 		{
-			const size_t srcID = i;
-			const size_t dstID = m_verletList.m_PPList[i][j];
-			if (vShifts[srcID])
-				m_verletList.m_PPVirtShift[i][j] = AddVirtShift(m_verletList.m_PPVirtShift[i][j], vShifts[srcID]);
-			if (vShifts[dstID])
-				m_verletList.m_PPVirtShift[i][j] = SubstractVirtShift(m_verletList.m_PPVirtShift[i][j], vShifts[dstID]);
-		}
+			const size_t i = Slab(iSlab);
+			// modify shift in possible particle-particle contacts
+			for (size_t j = 0; j < m_verletList.m_PPList[i].size(); j++)
+			{
+				const size_t srcID = i;
+				const size_t dstID = m_verletList.m_PPList[i][j];
+				if (vShifts[srcID])
+					m_verletList.m_PPVirtShift[i][j] = AddVirtShift(m_verletList.m_PPVirtShift[i][j], vShifts[srcID]);
+				if (vShifts[dstID])
+					m_verletList.m_PPVirtShift[i][j] = SubstractVirtShift(m_verletList.m_PPVirtShift[i][j], vShifts[dstID]);
+			}
 
-		// modify shift in existing particle-particle  collisions
-		for (size_t j = 0; j < m_collisionsCalculator.m_vCollMatrixPP[i].size(); j++)
-		{
-			const unsigned srcID = m_collisionsCalculator.m_vCollMatrixPP[i][j]->nSrcID;
-			const unsigned dstID = m_collisionsCalculator.m_vCollMatrixPP[i][j]->nDstID;
-			if (vShifts[srcID])
-				m_collisionsCalculator.m_vCollMatrixPP[i][j]->nVirtShift = AddVirtShift(m_collisionsCalculator.m_vCollMatrixPP[i][j]->nVirtShift, vShifts[srcID]);
-			if (vShifts[dstID])
-				m_collisionsCalculator.m_vCollMatrixPP[i][j]->nVirtShift = SubstractVirtShift(m_collisionsCalculator.m_vCollMatrixPP[i][j]->nVirtShift, vShifts[dstID]);
-		}
+			// modify shift in existing particle-particle  collisions
+			for (size_t j = 0; j < m_collisionsCalculator.m_vCollMatrixPP[i].size(); j++)
+			{
+				const unsigned srcID = m_collisionsCalculator.m_vCollMatrixPP[i][j]->nSrcID;
+				const unsigned dstID = m_collisionsCalculator.m_vCollMatrixPP[i][j]->nDstID;
+				if (vShifts[srcID])
+					m_collisionsCalculator.m_vCollMatrixPP[i][j]->nVirtShift = AddVirtShift(m_collisionsCalculator.m_vCollMatrixPP[i][j]->nVirtShift, vShifts[srcID]);
+				if (vShifts[dstID])
+					m_collisionsCalculator.m_vCollMatrixPP[i][j]->nVirtShift = SubstractVirtShift(m_collisionsCalculator.m_vCollMatrixPP[i][j]->nVirtShift, vShifts[dstID]);
+			}
 
-		// modify shift in possible particle-wall contacts
-		for (size_t j = 0; j < m_verletList.m_PWList[i].size(); j++)
-			if (vShifts[i])
-				m_verletList.m_PWVirtShift[i][j] = SubstractVirtShift(m_verletList.m_PWVirtShift[i][j], vShifts[i]);
+			// modify shift in possible particle-wall contacts
+			for (size_t j = 0; j < m_verletList.m_PWList[i].size(); j++)
+				if (vShifts[i])
+					m_verletList.m_PWVirtShift[i][j] = SubstractVirtShift(m_verletList.m_PWVirtShift[i][j], vShifts[i]);
 
-		// modify shift in existing particle-wall collisions
-		for (size_t j = 0; j < m_collisionsCalculator.m_vCollMatrixPW[i].size(); j++)
-			if (vShifts[i])
-				m_collisionsCalculator.m_vCollMatrixPW[i][j]->nVirtShift = SubstractVirtShift(m_collisionsCalculator.m_vCollMatrixPW[i][j]->nVirtShift, vShifts[i]);
+			// modify shift in existing particle-wall collisions
+			for (size_t j = 0; j < m_collisionsCalculator.m_vCollMatrixPW[i].size(); j++)
+				if (vShifts[i])
+					m_collisionsCalculator.m_vCollMatrixPW[i][j]->nVirtShift = SubstractVirtShift(m_collisionsCalculator.m_vCollMatrixPW[i][j]->nVirtShift, vShifts[i]);
+		});
+
+	// reset shifts for the next step
+	ParallelFor(nCandidates, [&](size_t iCandidate)
+	{
+		vShifts[Candidate(iCandidate)] = 0;
 	});
 }
 
@@ -683,6 +1330,7 @@ void CCPUSimulator::GenerateNewObjects()
 		m_verletList.ResetCurrentData();
 		m_nGeneratedObjects += nNewParticles;
 		m_scene.UpdateParticlesToBonds();
+		m_pbcSlabsValid = false;
 	}
 }
 
@@ -8,15 +8,63 @@
 
 class CCPUSimulator : public CBaseSimulator
 {
+	static constexpr size_t PP_BATCH_ROWS = 32;	// Number of rows of the collision matrix, processed by a thread at once to gather batches of contacts.
+
 	bool m_analyzeCollisions{ false };	// Statistic information about collisions should be saved.
+	bool m_batchContacts{ false };		// Particle-particle contacts are calculated in batches by models supporting it.
 
 	CCollisionsAnalyzer m_collisionsAnalyzer;
 	CCollisionsCalculator m_collisionsCalculator{ m_scene, m_verletList, m_collisionsAnalyzer };
 
+	// Range of contacts in a bucket of a thread, gathered from one block of rows of the collision matrix.
+	struct SBucketSegment
+	{
+		size_t block;	// Index of the block of rows.
+		size_t thread;	// Index of the thread, which has gathered the contacts.
+		size_t begin;	// Range of contacts in the bucket.
+		size_t end;
+	};
+
 	size_t m_nThreads{ GetThreadsNumber() };	// Number of available CPU threads.
 	// They are placed here to avoid memory reallocation.
 	std::vector<std::vector<std::vector<SCollision*>>> m_tempCollPPArray{ m_nThreads, std::vector<std::vector<SCollision*>>{ m_nThreads } };
 	std::vector<std::vector<std::vector<SCollision*>>> m_tempCollPWArray{ m_nThreads, std::vector<std::vector<SCollision*>>{ m_nThreads } };
+	// Segments of buckets of each thread, used to consolidate contacts in the order of rows of the collision matrix.
+	std::vector<std::vector<std::vector<SBucketSegment>>> m_tempSegmentsPP{ m_nThreads, std::vector<std::vector<SBucketSegment>>{ m_nThreads } };
+	std::vector<std::vector<std::vector<SBucketSegment>>> m_tempSegmentsPW{ m_nThreads, std::vector<std::vector<SBucketSegment>>{ m_nThreads } };
+	std::vector<std::vector<SBucketSegment>> m_orderedSegments{ m_nThreads };	// Segments of each bucket from all threads, sorted by blocks of rows.
+	// PP collisions of each particle as a destination one, used to calculate stress tensors in parallel over particles.
+	std::vector<size_t> m_stressDstOffsets;
+	std::vector<size_t> m_stressDstPositions;
+	std::vector<const SCollision*> m_stressDstCollisions;
+
+	std::vector<double> m_maxGeometryVelocities;	// Maximal velocity of walls of each geometry.
+	bool m_pbcSlabsValid{ false };	// Whether lists of particles in PBC boundary slabs in the scene correspond to the current verlet lists.
+	std::vector<uint8_t> m_pbcShifts;	// Shifts of particles, which crossed PBC boundaries at the current time step; zero for all other particles.
+
+	// State of time integration of each particle for velocity Verlet and Gear schemes.
+	std::vector<CVector3> m_integrationAcc;			// Translational acceleration: calculated at the previous step (velocity Verlet) or predicted for the current one (Gear).
+	std::vector<CVector3> m_integrationAnglAcc;		// Angular acceleration: calculated at the previous step (velocity Verlet) or predicted for the current one (Gear).
+	std::vector<CVector3> m_integrationJerk;		// Time derivative of translational acceleration (Gear).
+	std::vector<CVector3> m_integrationAnglJerk;	// Time derivative of angular acceleration (Gear).
+	size_t m_integratedParticles{ 0 };				// Number of particles with known integration state; the state of all others is initialized at the next step.
+	EIntegrator m_stateIntegrator{ EIntegrator::LEAPFROG };	// Scheme, for which the integration state has been gathered.
+	double m_lastIntegrationStep{ 0 };				// Time step, with which the current coordinates and velocities were predicted.
+	// Forces and moments acting on particles, gathered separately while solid bonds are sub-cycled.
+	std::vector<CVector3> m_slowForces;		// From contacts, liquid bonds, external fields and acceleration.
+	std::vector<CVector3> m_slowMoments;
+	std::vector<CVector3> m_bondForces;		// From solid bonds, summed over sub-steps.
+	std::vector<CVector3> m_bondMoments;
+	// Sleeping of quasi-static particles. Sleeping particles are not moved, and their contacts and bonds with each other are frozen.
+	bool m_sleepingEnabled{ false };		// Whether sleeping is applied in the current simulation.
+	std::vector<uint8_t> m_asleep;			// Whether each particle is asleep.
+	std::vector<uint32_t> m_calmSteps;		// Number of consecutive steps, during which each awake particle stayed quasi-static.
+	std::vector<unsigned> m_islands;		// Island of each sleeping particle, as index of its representative particle.
+	std::vector<unsigned> m_islandParents;	// Disjoint-set forest of particles, used to gather islands.
+	std::vector<uint8_t> m_islandFlags;		// Flags of particles and islands, used to gather islands to be put to sleep or woken.
+	uint32_t m_stepsToIslandsCheck{ 0 };	// Number of steps till the next search for islands, which can fall asleep.
+	std::vector<std::vector<unsigned>> m_touchedIslands;	// Islands of sleeping particles, touched by disturbing particles or walls, gathered by each thread.
+	std::vector<size_t> m_sleepCounters;				// Numbers of particles, which are ready to sleep or have been woken, counted by each thread.
 
 public:
 	CCPUSimulator() = default;
@@ -25,6 +73,8 @@ public:
 	void SetSystemStructure(CSystemStructure* _pSystemStructure) override;	// Sets pointer to a system structure.
 	void EnableCollisionsAnalysis(bool _bEnable);	// Enables analyzing of collisions.
 	bool IsCollisionsAnalysisEnabled() const;		// Returns true if analysis of collisions is currently enabled.
+	void EnableBatchContacts(bool _enable);		// Enables calculation of particle-particle contacts in batches by models implementing CParticleParticleBatchModel.
+	bool IsBatchContactsEnabled() const;		// Returns true if calculation of contacts in batches is enabled.
 
 	void Initialize() override;
 	void InitializeModels() override;
@@ -56,10 +106,46 @@ private:
 
 	void MoveMultispheres(double _dTimeStep, bool _bPredictionStep);
 
+	// Whether solid bonds are calculated in several sub-steps within each time step, while all other forces are calculated once per step.
+	bool SubcycleSolidBonds() const;
+	// Returns angular acceleration of the particle from its current moment.
+	CVector3 AngularAcceleration(size_t _iPart) const;
+	// Rotates the quaternion of a particle with the given angular velocity over the time step.
+	static void RotateQuaternion(CQuaternion& _quaternion, const CVector3& _angVel, double _timeStep);
+	// Moves particles with leapfrog scheme, calculating solid bonds in several sub-steps (impulse multiple time stepping).
+	void MoveParticlesSubcycled(bool _bPredictionStep);
+	// Moves particles with velocity Verlet scheme.
+	void MoveParticlesVerlet();
+	// Moves particles with Gear predictor-corrector scheme.
+	void MoveParticlesGear();
+
+	// Returns flags of sleeping particles, or nullptr if no particle is asleep.
+	const uint8_t* SleepingParticles() const;
+	// Resizes the state of sleeping to the current number of particles; new particles are awake.
+	void ResizeSleepingState();
+	// Wakes islands of sleeping particles, which are touched by moving particles or walls. Is called after contacts have been detected.
+	void WakeParticles();
+	// Counts the quasi-static step of an awake particle and returns true if it is ready to sleep. Stops the particle if it is asleep.
+	// Is called when forces have been calculated.
+	bool CountQuasiStaticStep(size_t _iPart);
+	// Puts to sleep islands, all particles of which stayed quasi-static long enough. Is called after steps of all particles have been counted.
+	void PutParticlesToSleep(bool _anyReady);
+	// Returns the representative particle of the island, to which the particle belongs, in the disjoint-set forest.
+	unsigned FindIsland(unsigned _iPart);
+
+	// Adds the contact to the bucket of the thread and extends the segment of the current block of rows or starts a new one.
+	void AddToBucket(std::vector<SCollision*>& _bucket, std::vector<SBucketSegment>& _segments, size_t _iBlock, size_t _iThread, SCollision* _collision) const;
+	// Calls _consolidate for all contacts in the bucket with index _iBucket of all threads.
+	// Contacts are taken in the order of blocks of rows, in which they were gathered, so the result does not depend on the number of threads or on scheduling.
+	template<typename F>
+	void ConsolidateBucket(const std::vector<std::vector<std::vector<SCollision*>>>& _buckets, const std::vector<std::vector<std::vector<SBucketSegment>>>& _segments, size_t _iBucket, F&& _consolidate);
+
 	void PrepareAdditionalSavingData() override;
 	void SaveData() override;
 	void UpdateVerletLists(double _dTimeStep);
 	void CheckParticlesInDomain();	// Check that all particles are remains in simulation domain.
+	// Deactivates all bonds connected to particles, which have just left the simulation domain, as listed in _leftParticles and flagged in _isLeft.
+	void DeactivateBonds(SBondStruct& _bonds, const SParticlesToBonds& _particlesToBonds, const std::vector<unsigned>& _leftParticles, const std::vector<uint8_t>& _isLeft) const;
 
 	// Check that all particles have correct coordinates and update coordinates of virtual particles.
 	// If some real particles crossed the PBC boundaries, returns true (meaning the need to update verlet lists).
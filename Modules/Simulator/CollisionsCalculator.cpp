@@ -20,6 +20,8 @@ CCollisionsCalculator::~CCollisionsCalculator()
 
 void CCollisionsCalculator::ClearCollMatrixes()
 {
+	// the thread pool may have been restarted with another number of threads since the last simulation
+	m_storage.UpdateThreadsNumber();
 	ClearCollisionMatrix( m_vCollMatrixPP );
 	ClearCollisionMatrix( m_vCollMatrixPW );
 }
@@ -36,7 +38,7 @@ void CCollisionsCalculator::ClearCollisionMatrix( std::vector<std::vector<SColli
 	{
 		for (size_t j = 0; j < _matrix[i].size(); j++)
 			if (_matrix[i][j] != nullptr)
-				delete _matrix[i][j]; 			// deallocate memory and remove first pointer
+				m_storage.Release(_matrix[i][j]);
 		_matrix[i].clear();
 	});
 	_matrix.clear();
@@ -57,46 +59,60 @@ void CCollisionsCalculator::RemoveOldCollisions( std::vector<std::vector<SCollis
 {
 	ParallelFor(_pMatrix.size(), [&](size_t i )
 	{
-		size_t j = 0;
-		while ( j < _pMatrix[ i ].size() )
+		auto& collisions = _pMatrix[i];
+		const auto last = std::remove_if(collisions.begin(), collisions.end(), [&](SCollision* _pCollision)
 		{
-			if ( _pMatrix[ i ][ j ] == nullptr )
-				_pMatrix[ i ].erase( _pMatrix[ i ].begin() + j );
-			else
-			{
-				if ( _pMatrix[ i ][ j ]->bContactStillExist == false )
-				{
-					if ( !m_bAnalyzeCollisions )	// otherwise will be really removed in ClearFinishedCollisionMatrix()
-						delete _pMatrix[ i ][ j ];
-					_pMatrix[ i ].erase( _pMatrix[ i ].begin() + j );
-				}
-				else
-					j = j + 1;
-			}
-		}
+			if (_pCollision == nullptr) return true;
+			if (_pCollision->bContactStillExist) return false;
+			if (!m_bAnalyzeCollisions)	// otherwise will be really removed in ClearFinishedCollisionMatrix()
+				m_storage.Release(_pCollision);
+			return true;
+		});
+		collisions.erase(last, collisions.end());
 	});
 }
 
+void CCollisionsCalculator::CompactCollMatrixes()
+{
+	// pointers to collisions are kept for analysis, so they cannot be moved
+	if (m_bAnalyzeCollisions) return;
+	m_storage.Rebuild({ &m_vCollMatrixPP, &m_vCollMatrixPW });
+}
+
 void CCollisionsCalculator::EnableCollisionsAnalysis( bool _bEnable )
 {
 	m_bAnalyzeCollisions = _bEnable;
 }
 
+void CCollisionsCalculator::SetFrozenParticles(const std::vector<uint8_t>* _pFrozen)
+{
+	m_pFrozen = _pFrozen;
+}
+
+void CCollisionsCalculator::SetContactFields(const SOptionalVariables& _vars)
+{
+	m_storage.SetActiveFields(_vars, m_bAnalyzeCollisions);
+}
+
 void CCollisionsCalculator::UpdateCollisionMatrixes( double _dTimeStep, double _dCurrentTime )
 {
 	ResizeCollMatrixes();
+	m_vPWScratch.resize(GetThreadsNumber());
+	for (auto& scratch : m_vPWScratch)
+		scratch.statistics = SPWStatistics{};
+	m_nSlabsBefore = m_storage.AllocatedSlabs();
 
 	if ( m_bAnalyzeCollisions )
 		ParallelFor(m_Scene.GetTotalParticlesNumber(), [&](size_t i)
 		{
 			for ( size_t j = 0; j < m_vCollMatrixPP[ i ].size(); j++ )
 			{
-				m_vCollMatrixPP[ i ][ j ]->pSave->dTimeEnd = _dCurrentTime;
-				m_vCollMatrixPP[ i ][ j ]->bContactStillExist = false;
+				Save(m_vCollMatrixPP[ i ][ j ])->dTimeEnd = _dCurrentTime;
+				m_vCollMatrixPP[ i ][ j ]->bContactStillExist = IsFrozenPair(i, m_vCollMatrixPP[ i ][ j ]->nDstID);
 			}
 			for ( size_t j = 0; j < m_vCollMatrixPW[ i ].size(); j++ )
 			{
-				m_vCollMatrixPW[ i ][ j ]->pSave->dTimeEnd = _dCurrentTime;
+				Save(m_vCollMatrixPW[ i ][ j ])->dTimeEnd = _dCurrentTime;
 				m_vCollMatrixPW[ i ][ j ]->bContactStillExist = false;
 			}
 		});
@@ -104,7 +120,7 @@ void CCollisionsCalculator::UpdateCollisionMatrixes( double _dTimeStep, double _
 		ParallelFor(m_Scene.GetTotalParticlesNumber(), [&](size_t i)
 		{
 			for ( size_t j = 0; j < m_vCollMatrixPP[ i ].size(); j++ )
-				m_vCollMatrixPP[ i ][ j ]->bContactStillExist = false;
+				m_vCollMatrixPP[ i ][ j ]->bContactStillExist = IsFrozenPair(i, m_vCollMatrixPP[ i ][ j ]->nDstID);
 			for (size_t j = 0; j < m_vCollMatrixPW[i].size(); j++)
 				m_vCollMatrixPW[i][j]->bContactStillExist = false;
 		});
@@ -127,6 +143,20 @@ void CCollisionsCalculator::UpdateCollisionMatrixes( double _dTimeStep, double _
 	RemoveOldCollisions( m_vCollMatrixPW );
 }
 
+CCollisionsCalculator::SPWStatistics CCollisionsCalculator::GetPWStatistics() const
+{
+	SPWStatistics res;
+	for (const auto& scratch : m_vPWScratch)
+	{
+		res.candidates += scratch.statistics.candidates;
+		res.tested += scratch.statistics.tested;
+		res.contacts += scratch.statistics.contacts;
+		res.allocations += scratch.statistics.allocations;
+	}
+	res.allocations += m_storage.AllocatedSlabs() - m_nSlabsBefore;
+	return res;
+}
+
 void CCollisionsCalculator::CheckPWCollisions( size_t _nParticle, double _dCurrentTime )
 {
 	if ( m_verletList.m_PWList[ _nParticle ].empty() ) return;
@@ -134,16 +164,31 @@ void CCollisionsCalculator::CheckPWCollisions( size_t _nParticle, double _dCurre
 	const SWallStruct& pWalls = m_Scene.GetRefToWalls();
 	if (!pParticles.Active(_nParticle)) return;
 
-	std::vector<EIntersectionType> vIntersectionType;
-	std::vector<CVector3> vContactPoint;
-	m_verletList.GetPWContacts( _nParticle, vIntersectionType, vContactPoint );
+	// a sleeping particle keeps its contacts with stationary walls as they are, and no new ones can appear
+	if (m_pFrozen != nullptr && (*m_pFrozen)[_nParticle] && std::none_of(m_verletList.m_PWList[_nParticle].begin(), m_verletList.m_PWList[_nParticle].end(),
+		[&](unsigned _iWall) { return !pWalls.Vel(_iWall).IsZero() || !pWalls.RotVel(_iWall).IsZero(); }))
+	{
+		for (auto* pCollision : m_vCollMatrixPW[_nParticle])
+			pCollision->bContactStillExist = true;
+		return;
+	}
 
+	// all temporary data are kept in buffers of the thread
+	SPWScratch& scratch = m_vPWScratch[GetCurrentThreadIndex()];
+	const std::vector<EIntersectionType>& vIntersectionType = scratch.types;
+	const std::vector<CVector3>& vContactPoint = scratch.points;
+	std::vector<size_t>& newColls = scratch.newColls; // list of collisions' ID that have been activated at this time step
 	auto& partColls = m_vCollMatrixPW[_nParticle]; // vector of collisions for particle _nParticle
+	const size_t nCapacity = scratch.Capacity() + partColls.capacity();
+
+	scratch.statistics.candidates += m_verletList.m_PWList[_nParticle].size();
+	scratch.statistics.tested += m_verletList.GetPWContacts(_nParticle, scratch.types, scratch.points, scratch.selected);
 
-	std::vector<size_t> newColls; // list of collisions' ID that have been activated at this time step
+	newColls.clear();
 	for (size_t iWall = 0; iWall < vIntersectionType.size(); ++iWall)
 	{
 		if (vIntersectionType[iWall] == EIntersectionType::NO_CONTACT) continue;
+		scratch.statistics.contacts++;
 		const unsigned nWall = m_verletList.m_PWList[_nParticle][iWall];
 		SCollision* pCollision = nullptr;
 		// check if this collision have been exists in the previous contact
@@ -161,10 +206,9 @@ void CCollisionsCalculator::CheckPWCollisions( size_t _nParticle, double _dCurre
 
 		if (pCollision == nullptr) // create new contact
 		{
-			pCollision = new SCollision();
+			pCollision = m_storage.Allocate();
 			pCollision->nSrcID = nWall;
 			pCollision->nDstID = static_cast<unsigned>(_nParticle);
-			pCollision->pSave = nullptr;
 			pCollision->nInteractProp = static_cast<uint16_t>(pWalls.CompoundIndex(nWall) * m_Scene.GetCompoundsNumber() + pParticles.CompoundIndex(_nParticle));
 			if (m_Scene.m_PBC.bEnabled)
 				pCollision->nVirtShift = m_verletList.m_PWVirtShift[_nParticle][iWall];
@@ -174,32 +218,33 @@ void CCollisionsCalculator::CheckPWCollisions( size_t _nParticle, double _dCurre
 			{
 				const int nGeomIndex = GetGeometryIndex( nWall );
 				for ( size_t i = 0; i < partColls.size(); ++i )
-					if (partColls[ i ]->pSave->nGeomID == nGeomIndex )
+					if (Save(partColls[ i ])->nGeomID == nGeomIndex )
 					{
 						// collision between these particle and geometry already exists
-						pCollision->pSave = partColls[ i ]->pSave;
-						pCollision->pSave->nCnt++;
-						pCollision->pSave->vPtr.push_back( pCollision );
-						if ( pCollision->pSave->dTimeStart == _dCurrentTime ) // it is another contact in first time point of collision
+						Save(pCollision) = Save(partColls[ i ]);
+						Save(pCollision)->nCnt++;
+						Save(pCollision)->vPtr.push_back( pCollision );
+						if ( Save(pCollision)->dTimeStart == _dCurrentTime ) // it is another contact in first time point of collision
 						{
 							CVector3 vecNormV, vecTangV;
 							CalculatePWContactVelocity( nWall, _nParticle, vContactPoint[ i ], vecNormV, vecTangV );
-							pCollision->pSave->vNormVelocity = MaxLength( vecNormV, pCollision->pSave->vNormVelocity );
-							pCollision->pSave->vTangVelocity = MaxLength(vecTangV, pCollision->pSave->vTangVelocity);
+							Save(pCollision)->vNormVelocity = MaxLength( vecNormV, Save(pCollision)->vNormVelocity );
+							Save(pCollision)->vTangVelocity = MaxLength(vecTangV, Save(pCollision)->vTangVelocity);
 						}
 						break;
 					}
 
 				// create completely new collision
-				if ( !pCollision->pSave )
+				if ( !Save(pCollision) )
 				{
-					pCollision->pSave = new SSavedCollision();
-					pCollision->pSave->nCnt = 1;
-					pCollision->pSave->vPtr.push_back( pCollision );
-					pCollision->pSave->nGeomID = nGeomIndex;
-					pCollision->pSave->dTimeStart = _dCurrentTime;
-					CalculatePWContactVelocity( nWall, _nParticle, vContactPoint[ iWall ], pCollision->pSave->vNormVelocity, pCollision->pSave->vTangVelocity );
-					pCollision->pSave->vContactPoint = vContactPoint[ iWall ];
+					Save(pCollision) = new SSavedCollision();
+					scratch.statistics.allocations++;
+					Save(pCollision)->nCnt = 1;
+					Save(pCollision)->vPtr.push_back( pCollision );
+					Save(pCollision)->nGeomID = nGeomIndex;
+					Save(pCollision)->dTimeStart = _dCurrentTime;
+					CalculatePWContactVelocity( nWall, _nParticle, vContactPoint[ iWall ], Save(pCollision)->vNormVelocity, Save(pCollision)->vTangVelocity );
+					Save(pCollision)->vContactPoint = vContactPoint[ iWall ];
 				}
 			}
 
@@ -213,7 +258,8 @@ void CCollisionsCalculator::CheckPWCollisions( size_t _nParticle, double _dCurre
 	if (!newColls.empty())
 	{
 		// gather deactivated collisions
-		std::vector<size_t> oldColls;
+		std::vector<size_t>& oldColls = scratch.oldColls;
+		oldColls.clear();
 		for (size_t i = 0; i < partColls.size(); ++i)
 			if (!partColls[i]->bContactStillExist)
 				oldColls.push_back(i);
@@ -236,6 +282,9 @@ void CCollisionsCalculator::CheckPWCollisions( size_t _nParticle, double _dCurre
 			}
 		}
 	}
+
+	if (scratch.Capacity() + partColls.capacity() != nCapacity)
+		scratch.statistics.allocations++;
 }
 
 void CCollisionsCalculator::CheckPPCollision(size_t _iPart1, size_t _iPart2, double _dCurrentTime)
@@ -245,6 +294,7 @@ void CCollisionsCalculator::CheckPPCollision(size_t _iPart1, size_t _iPart2, dou
 	const bool bVirtContact = m_Scene.m_PBC.bEnabled && (m_verletList.m_PPVirtShift[_iPart1][_iPart2] != 0);
 	const SParticleStruct& pParticles = m_Scene.GetRefToParticles();
 	if (!pParticles.Active(nPart1) || !pParticles.Active(nPart2)) return;
+	if (IsFrozenPair(nPart1, nPart2)) return; // the existing contact is kept as is, and no new one can appear
 
 	const CVector3 vContactVector = !bVirtContact ?
 		pParticles.Coord(nPart2) - pParticles.Coord(nPart1) :
@@ -267,22 +317,24 @@ void CCollisionsCalculator::CheckPPCollision(size_t _iPart1, size_t _iPart2, dou
 
 		if (pCollision == nullptr)  // allocate memory for a new collision
 		{
-			pCollision = new SCollision();
+			pCollision = m_storage.Allocate();
 			pCollision->nSrcID = static_cast<unsigned>(nPart1);
 			pCollision->nDstID = static_cast<unsigned>(nPart2);
-			pCollision->pSave = nullptr;
 			pCollision->nInteractProp = static_cast<uint16_t>(pParticles.CompoundIndex(nPart1) * m_Scene.GetCompoundsNumber() + pParticles.CompoundIndex(nPart2));
-			pCollision->dEquivRadius = pParticles.ContactRadius(nPart1)*pParticles.ContactRadius(nPart2) / (pParticles.ContactRadius(nPart1) + pParticles.ContactRadius(nPart2));
-			pCollision->dEquivMass = pParticles.Mass(nPart1)*pParticles.Mass(nPart2) / (pParticles.Mass(nPart1) + pParticles.Mass(nPart2));
+			if (m_storage.Fields().EquivalentsExist())
+			{
+				m_storage.Fields().EquivRadius(pCollision) = pParticles.ContactRadius(nPart1)*pParticles.ContactRadius(nPart2) / (pParticles.ContactRadius(nPart1) + pParticles.ContactRadius(nPart2));
+				m_storage.Fields().EquivMass(pCollision) = pParticles.Mass(nPart1)*pParticles.Mass(nPart2) / (pParticles.Mass(nPart1) + pParticles.Mass(nPart2));
+			}
 			if (m_Scene.m_PBC.bEnabled)
 				pCollision->nVirtShift = bVirtContact ? m_verletList.m_PPVirtShift[_iPart1][_iPart2] : 0;
 
 			// TODO: to conform with new PBC
 			if (m_bAnalyzeCollisions)
 			{
-				pCollision->pSave = new SSavedCollision();
-				pCollision->pSave->nCnt = 1;
-				pCollision->pSave->dTimeStart = _dCurrentTime;
+				Save(pCollision) = new SSavedCollision();
+				Save(pCollision)->nCnt = 1;
+				Save(pCollision)->dTimeStart = _dCurrentTime;
 
 				//obtain contact point
 				const CVector3 vecContactPoint = pParticles.Coord(nPart1) + (pParticles.Coord(nPart2) - pParticles.Coord(nPart1))*pParticles.ContactRadius(nPart1) / (pParticles.ContactRadius(nPart1) + pParticles.ContactRadius(nPart2));
@@ -294,9 +346,9 @@ void CCollisionsCalculator::CheckPPCollision(size_t _iPart1, size_t _iPart2, dou
 				const CVector3 vecRelVelNormal = vecNormalVector * (DotProduct(vecNormalVector, vecRelVelocity));
 				const CVector3 vecRelVelTang = vecRelVelocity - vecRelVelNormal;
 
-				pCollision->pSave->vNormVelocity = vecRelVelNormal;
-				pCollision->pSave->vTangVelocity = vecRelVelTang;
-				pCollision->pSave->vContactPoint = vecContactPoint;
+				Save(pCollision)->vNormVelocity = vecRelVelNormal;
+				Save(pCollision)->vTangVelocity = vecRelVelTang;
+				Save(pCollision)->vContactPoint = vecContactPoint;
 			}
 
 			m_vCollMatrixPP[nPart1].push_back(pCollision);
@@ -348,9 +400,9 @@ void CCollisionsCalculator::ClearFinishedCollisionMatrix( std::vector<SCollision
 	for (size_t i = 0; i < _matrix.size(); ++i)
 		if (_matrix[i])
 		{
-			if (_matrix[i]->pSave)
-				delete _matrix[i]->pSave;
-			delete _matrix[i];
+			if (Save(_matrix[i]))
+				delete Save(_matrix[i]);
+			m_storage.Release(_matrix[i]);
 		}
 	_matrix.clear();
 }
@@ -360,7 +412,7 @@ void CCollisionsCalculator::SaveCollisions()
 	if ( m_bAnalyzeCollisions && (m_vFinishedCollisionsPP.size() + m_vFinishedCollisionsPW.size() > COLLISIONS_NUMBER_TO_SAVE))
 	{
 		RecalculateSavedIDs();
-		m_collisionsAnalyzer.AddCollisions( m_vFinishedCollisionsPP, m_vFinishedCollisionsPW );
+		m_collisionsAnalyzer.AddCollisions( m_vFinishedCollisionsPP, m_vFinishedCollisionsPW, m_storage.Fields() );
 		ClearFinishedCollisionMatrix( m_vFinishedCollisionsPP );
 		ClearFinishedCollisionMatrix( m_vFinishedCollisionsPW );
 	}
@@ -373,12 +425,12 @@ void CCollisionsCalculator::SaveRestCollisions()
 	{
 		for ( size_t j = 0; j < m_vCollMatrixPP[ i ].size(); j++ )
 		{
-			m_vCollMatrixPP[ i ][ j ]->pSave->dTimeEnd = -1;	// not finished collision
+			Save(m_vCollMatrixPP[ i ][ j ])->dTimeEnd = -1;	// not finished collision
 			m_vCollMatrixPP[ i ][ j ]->bContactStillExist = false;
 		}
 		for ( size_t j = 0; j < m_vCollMatrixPW[ i ].size(); j++ )
 		{
-			m_vCollMatrixPW[ i ][ j ]->pSave->dTimeEnd = -1; 	// not finished collision
+			Save(m_vCollMatrixPW[ i ][ j ])->dTimeEnd = -1; 	// not finished collision
 			m_vCollMatrixPW[ i ][ j ]->bContactStillExist = false;
 		}
 	});
@@ -388,7 +440,7 @@ void CCollisionsCalculator::SaveRestCollisions()
 	RemoveOldCollisions( m_vCollMatrixPW );
 
 	RecalculateSavedIDs();
-	m_collisionsAnalyzer.AddCollisions( m_vFinishedCollisionsPP, m_vFinishedCollisionsPW );
+	m_collisionsAnalyzer.AddCollisions( m_vFinishedCollisionsPP, m_vFinishedCollisionsPW, m_storage.Fields() );
 	m_collisionsAnalyzer.Finalize();
 
 	ClearFinishedCollisionMatrix( m_vFinishedCollisionsPP );
@@ -401,7 +453,7 @@ void CCollisionsCalculator::CopyFinishedPPCollisions()
 	{
 		for (size_t i = 0; i < m_vCollMatrixPP.size(); ++i)
 			for (size_t j = 0; j < m_vCollMatrixPP[i].size(); ++j)
-				if ((!m_vCollMatrixPP[i][j]->bContactStillExist) && (m_vCollMatrixPP[i][j]->pSave->dTimeStart != m_vCollMatrixPP[i][j]->pSave->dTimeEnd))
+				if ((!m_vCollMatrixPP[i][j]->bContactStillExist) && (Save(m_vCollMatrixPP[i][j])->dTimeStart != Save(m_vCollMatrixPP[i][j])->dTimeEnd))
 					m_vFinishedCollisionsPP.push_back(m_vCollMatrixPP[i][j]);
 	}
 	// TODO: collisions saving with new PBC.
@@ -409,7 +461,7 @@ void CCollisionsCalculator::CopyFinishedPPCollisions()
 	{
 	//	for (size_t i = 0; i < m_vCollMatrixPP.size(); ++i)
 	//		for (size_t j = 0; j < m_vCollMatrixPP[i].size(); ++j)
-	//			if ((!m_vCollMatrixPP[i][j]->bContactStillExist) && (m_vCollMatrixPP[i][j]->pSave->dTimeStart != m_vCollMatrixPP[i][j]->pSave->dTimeEnd))
+	//			if ((!m_vCollMatrixPP[i][j]->bContactStillExist) && (Save(m_vCollMatrixPP[i][j])->dTimeStart != Save(m_vCollMatrixPP[i][j])->dTimeEnd))
 	//			{
 	//				unsigned iSrc = m_vCollMatrixPP[i][j]->nSrcID;
 	//				unsigned iDst = m_vCollMatrixPP[i][j]->nDstID;
@@ -438,19 +490,19 @@ void CCollisionsCalculator::CopyFinishedPWCollisions()
 		for (size_t j = 0; j < m_vCollMatrixPW[i].size(); ++j)
 		{
 			SCollision* coll = m_vCollMatrixPW[i][j];
-			if ((!coll->bContactStillExist) && (coll->pSave->dTimeStart != coll->pSave->dTimeEnd))
+			if ((!coll->bContactStillExist) && (Save(coll)->dTimeStart != Save(coll)->dTimeEnd))
 			{
-				if (coll->pSave->nCnt == 1)	// collision is ended
+				if (Save(coll)->nCnt == 1)	// collision is ended
 					m_vFinishedCollisionsPW.push_back(coll);
 				else	// not fully finished collision
 				{
-					coll->pSave->nCnt--;
+					Save(coll)->nCnt--;
 					// remove pointer to itself
-					std::vector<SCollision*>::iterator it = std::find(coll->pSave->vPtr.begin(), coll->pSave->vPtr.end(), coll);
-					if (it != coll->pSave->vPtr.end())
-						coll->pSave->vPtr.erase(it);
+					std::vector<SCollision*>::iterator it = std::find(Save(coll)->vPtr.begin(), Save(coll)->vPtr.end(), coll);
+					if (it != Save(coll)->vPtr.end())
+						Save(coll)->vPtr.erase(it);
 					// delete collision
-					delete m_vCollMatrixPW[i][j];
+					m_storage.Release(m_vCollMatrixPW[i][j]);
 					m_vCollMatrixPW[i][j] = nullptr;
 				}
 			}
@@ -478,25 +530,25 @@ void CCollisionsCalculator::CalculateStatisticInfo( std::vector<std::vector<SCol
 		for ( size_t j = 0; j < _matrix[ i ].size(); j++ )
 		{
 			SCollision* pColl = _matrix[i][j];
-			if (pColl->pSave->nCnt < 2 )
+			if (Save(pColl)->nCnt < 2 )
 			{
-				pColl->pSave->vMaxTotalForce = MaxLength(pColl->vTotalForce, pColl->pSave->vMaxTotalForce);
-				pColl->pSave->vMaxTangForce = MaxLength(pColl->vTangForce, pColl->pSave->vMaxTangForce);
-				CVector3 vNormF = pColl->vTotalForce - pColl->vTangForce;
-				pColl->pSave->vMaxNormForce = MaxLength(vNormF, pColl->pSave->vMaxNormForce);
+				Save(pColl)->vMaxTotalForce = MaxLength(pColl->vTotalForce, Save(pColl)->vMaxTotalForce);
+				Save(pColl)->vMaxTangForce = MaxLength(m_storage.Fields().TangForce(pColl), Save(pColl)->vMaxTangForce);
+				CVector3 vNormF = pColl->vTotalForce - m_storage.Fields().TangForce(pColl);
+				Save(pColl)->vMaxNormForce = MaxLength(vNormF, Save(pColl)->vMaxNormForce);
 			}
 			else
 			{
 				CVector3 vSumTotF(0), vSumTanF(0);
-				for ( size_t k = 0; k < pColl->pSave->vPtr.size(); ++k )
+				for ( size_t k = 0; k < Save(pColl)->vPtr.size(); ++k )
 				{
-					vSumTotF += pColl->pSave->vPtr[ k ]->vTotalForce;
-					vSumTanF += pColl->pSave->vPtr[ k ]->vTangForce;
+					vSumTotF += Save(pColl)->vPtr[ k ]->vTotalForce;
+					vSumTanF += m_storage.Fields().TangForce(Save(pColl)->vPtr[ k ]);
 				}
-				pColl->pSave->vMaxTotalForce = MaxLength(vSumTotF, pColl->pSave->vMaxTotalForce);
-				pColl->pSave->vMaxTangForce = MaxLength(vSumTanF, pColl->pSave->vMaxTangForce);
+				Save(pColl)->vMaxTotalForce = MaxLength(vSumTotF, Save(pColl)->vMaxTotalForce);
+				Save(pColl)->vMaxTangForce = MaxLength(vSumTanF, Save(pColl)->vMaxTangForce);
 				CVector3 vSumNormF = vSumTotF - vSumTanF;
-				pColl->pSave->vMaxNormForce = MaxLength(vSumNormF, pColl->pSave->vMaxNormForce);
+				Save(pColl)->vMaxNormForce = MaxLength(vSumNormF, Save(pColl)->vMaxNormForce);
 			}
 		}
 	});
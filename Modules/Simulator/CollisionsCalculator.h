@@ -9,17 +9,44 @@
 #include "ThreadPool.h"
 #include "VerletList.h"
 #include "CollisionsAnalyzer.h"
+#include "ContactStorage.h"
 
 class CCollisionsCalculator : public CMusenComponent
 {
+public:
+	// statistics of particle-wall contact detection
+	struct SPWStatistics
+	{
+		size_t candidates{ 0 };		// pairs of particles and walls from verlet lists
+		size_t tested{ 0 };			// pairs, which passed the culling and were tested exactly
+		size_t contacts{ 0 };		// pairs in contact
+		size_t allocations{ 0 };	// memory allocations during contact detection: growth of buffers and lists of contacts, new slabs of contacts, saved collisions
+	};
+
 protected:
 	std::vector<SCollision*> m_vFinishedCollisionsPP;	// list of finished particle-particle
 	std::vector<SCollision*> m_vFinishedCollisionsPW;	// list of finished particle-wall collisions
+	CContactStorage m_storage;							// memory for all collisions
 
 	CSimplifiedScene& m_Scene;
 	CVerletList& m_verletList;
 	CCollisionsAnalyzer& m_collisionsAnalyzer;
 	bool m_bAnalyzeCollisions{ false };
+	const std::vector<uint8_t>* m_pFrozen{ nullptr };	// flags of particles, which do not move; contacts between them are kept unchanged
+
+	// buffers used by each thread for particle-wall contact detection, kept between time steps to avoid allocations
+	struct SPWScratch
+	{
+		std::vector<EIntersectionType> types;	// intersection type with each wall from the verlet list of the particle
+		std::vector<CVector3> points;			// contact point with each wall from the verlet list of the particle
+		std::vector<unsigned> selected;			// walls from the verlet list, which passed the culling
+		std::vector<size_t> newColls;			// collisions, which have been activated at this time step
+		std::vector<size_t> oldColls;			// collisions, which have been deactivated at this time step
+		SPWStatistics statistics;				// statistics of the current time step
+		size_t Capacity() const { return types.capacity() + points.capacity() + selected.capacity() + newColls.capacity() + oldColls.capacity(); }
+	};
+	std::vector<SPWScratch> m_vPWScratch;				// buffers of each thread
+	size_t m_nSlabsBefore{ 0 };							// number of slabs of contacts before the current time step
 
 public:
 	std::vector< std::vector<SCollision*>> m_vCollMatrixPP;
@@ -33,6 +60,8 @@ private:
 	void RemoveOldCollisions( std::vector<std::vector<SCollision*>>& _pMatrix );
 
 	void CheckPPCollision(size_t _iPart1, size_t _iPart2, double _dCurrentTime); // check the collision between two particles
+	// whether both particles are frozen, so the contact between them cannot change
+	bool IsFrozenPair(size_t _iPart1, size_t _iPart2) const { return m_pFrozen != nullptr && (*m_pFrozen)[_iPart1] && (*m_pFrozen)[_iPart2]; }
 	void CheckPWCollisions( size_t _nParticle, double _dCurrentTime ); // check the between particle and wall
 
 	/// Return index of a geometry, which contains triangular wall with index _nWallIndex.
@@ -46,17 +75,32 @@ private:
 	void CopyFinishedPPCollisions();
 	void CopyFinishedPWCollisions();
 
+	// returns data of the collision for analysis
+	SSavedCollision*& Save(const SCollision* _collision) { return m_storage.Fields().Save(_collision); }
+
 public:
 	CCollisionsCalculator(CSimplifiedScene& _scene, CVerletList& _list, CCollisionsAnalyzer& _analyzer);
 	~CCollisionsCalculator();
 
 	void ClearCollMatrixes();
 	void ResizeCollMatrixes();
+	// place all existing collisions contiguously in memory, ordered by source; should be called after the verlet list has been rebuilt
+	void CompactCollMatrixes();
 
 	// update the matrix of collision between particles
 	void UpdateCollisionMatrixes( double _dTimeStep, double _dCurrentTime );
+	// returns statistics of particle-wall contact detection at the last call of UpdateCollisionMatrixes()
+	SPWStatistics GetPWStatistics() const;
 
 	void EnableCollisionsAnalysis( bool _bEnable );
+	// set flags of particles, which do not move, with a size of the number of particles; nullptr - all particles may move
+	void SetFrozenParticles(const std::vector<uint8_t>* _pFrozen);
+	// select optional fields of contacts, required by models; all existing contacts are removed
+	void SetContactFields(const SOptionalVariables& _vars);
+	// optional fields of all contacts
+	SCollisionFields* GetContactFields() { return &m_storage.Fields(); }
+	// number of bytes per contact, including optional fields
+	size_t GetBytesPerContact() const { return m_storage.BytesPerContact(); }
 	void ClearFinishedCollisionMatrixes();
 
 	void CalculateTotalStatisticsInfo();
@@ -0,0 +1,149 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+#include "ContactStorage.h"
+#include "ThreadPool.h"
+
+CContactStorage::CContactStorage()
+{
+	m_threadFreeLists.resize(GetThreadsNumber());
+}
+
+SCollision* CContactStorage::Allocate()
+{
+	std::vector<SCollision*>& list = ThreadFreeList();
+	if (list.empty())
+		Refill(list);
+	SCollision* collision = list.back();
+	list.pop_back();
+	const unsigned slot = collision->nSlot;
+	*collision = SCollision{};
+	collision->nSlot = slot;
+	m_fields.Reset(slot);
+	return collision;
+}
+
+void CContactStorage::Release(SCollision* _collision)
+{
+	std::vector<SCollision*>& list = ThreadFreeList();
+	list.push_back(_collision);
+	// return the excess to the common pool
+	if (list.size() > 2 * BATCH_SIZE)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_freeList.insert(m_freeList.end(), list.end() - BATCH_SIZE, list.end());
+		list.resize(list.size() - BATCH_SIZE);
+	}
+}
+
+void CContactStorage::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_slabs.clear();
+	m_capacity = 0;
+	m_allocatedSlabs = 0;
+	m_freeList.clear();
+	m_threadFreeLists.clear();
+	m_threadFreeLists.resize(GetThreadsNumber());
+	m_fields.SetActive(m_activeFields, m_analyzeCollisions);
+}
+
+void CContactStorage::SetActiveFields(const SOptionalVariables& _vars, bool _analyzeCollisions)
+{
+	m_activeFields = _vars;
+	m_analyzeCollisions = _analyzeCollisions;
+	Clear();
+}
+
+void CContactStorage::UpdateThreadsNumber()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_threadFreeLists.size() == GetThreadsNumber()) return;
+	// free contacts of all threads are returned to the common pool
+	for (const auto& list : m_threadFreeLists)
+		m_freeList.insert(m_freeList.end(), list.begin(), list.end());
+	m_threadFreeLists.clear();
+	m_threadFreeLists.resize(GetThreadsNumber());
+}
+
+void CContactStorage::Rebuild(const std::vector<std::vector<std::vector<SCollision*>>*>& _matrices)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// offsets of all rows in the new slab
+	std::vector<size_t> offsets{ 0 };
+	for (const auto* matrix : _matrices)
+		for (const auto& row : *matrix)
+			offsets.push_back(offsets.back() + row.size());
+	const size_t number = offsets.back();
+
+	// leave some free space for new contacts until the next rebuild
+	const size_t capacity = number + std::max(SLAB_SIZE, number / 8);
+	std::unique_ptr<SCollision[]> slab{ new SCollision[capacity] };
+	SCollisionFields fields;
+	fields.SetActive(m_activeFields, m_analyzeCollisions);
+	InitSlab(slab.get(), capacity, 0, fields);
+
+	// move contacts to the new slab
+	size_t iRow = 0;
+	for (auto* matrix : _matrices)
+	{
+		ParallelFor(matrix->size(), [&](size_t i)
+		{
+			SCollision* dst = &slab[offsets[iRow + i]];
+			for (auto& collision : (*matrix)[i])
+			{
+				const unsigned slot = dst->nSlot;
+				fields.Copy(slot, m_fields, collision->nSlot);
+				*dst = *collision;
+				dst->nSlot = slot;
+				collision = dst++;
+			}
+		});
+		iRow += matrix->size();
+	}
+
+	// all the rest is free
+	m_slabs.clear();
+	m_slabs.push_back(std::move(slab));
+	m_capacity = capacity;
+	m_allocatedSlabs++;
+	m_fields = std::move(fields);
+	m_freeList.clear();
+	m_freeList.reserve(capacity - number);
+	for (size_t i = capacity; i > number; --i)
+		m_freeList.push_back(&m_slabs.back()[i - 1]);
+	for (auto& list : m_threadFreeLists)
+		list.clear();
+}
+
+void CContactStorage::Refill(std::vector<SCollision*>& _list)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_freeList.empty())
+	{
+		m_slabs.emplace_back(new SCollision[SLAB_SIZE]);
+		InitSlab(m_slabs.back().get(), SLAB_SIZE, m_capacity, m_fields);
+		m_capacity += SLAB_SIZE;
+		m_allocatedSlabs++;
+		// in reverse order to return contacts with increasing addresses
+		for (size_t i = SLAB_SIZE; i > 0; --i)
+			m_freeList.push_back(&m_slabs.back()[i - 1]);
+	}
+	const size_t number = std::min(BATCH_SIZE, m_freeList.size());
+	_list.insert(_list.end(), m_freeList.end() - number, m_freeList.end());
+	m_freeList.resize(m_freeList.size() - number);
+}
+
+void CContactStorage::InitSlab(SCollision* _slab, size_t _size, size_t _firstSlot, SCollisionFields& _fields)
+{
+	for (size_t i = 0; i < _size; ++i)
+		_slab[i].nSlot = static_cast<unsigned>(_firstSlot + i);
+	_fields.Reserve(_firstSlot + _size);
+}
+
+std::vector<SCollision*>& CContactStorage::ThreadFreeList()
+{
+	return m_threadFreeLists[GetCurrentThreadIndex()];
+}
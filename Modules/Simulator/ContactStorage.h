@@ -0,0 +1,70 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+#pragma once
+#include "SceneTypes.h"
+#include <memory>
+#include <mutex>
+
+/* Pooled storage of contacts.
+ * Contacts are placed into large slabs, so their addresses stay valid during their whole lifetime and can be used as handles.
+ * Released contacts are recycled through per-thread free-lists, which are refilled from and returned to a common pool in batches.
+ * With Rebuild(), all existing contacts are moved into one contiguous slab, ordered by their sources (CSR layout).
+ * Each contact has a fixed slot, which addresses its optional fields; these are allocated only for the active fields, in parallel with slabs. */
+class CContactStorage
+{
+	static constexpr size_t SLAB_SIZE = 4096;	// Number of contacts in a newly allocated slab.
+	static constexpr size_t BATCH_SIZE = 256;	// Number of free contacts moved at once between the common pool and a thread.
+
+	std::vector<std::unique_ptr<SCollision[]>> m_slabs;		// Allocated memory.
+	size_t m_capacity{ 0 };									// Total number of contacts in all slabs.
+	size_t m_allocatedSlabs{ 0 };							// Number of slabs allocated since the last clearing, including rebuilds.
+	std::vector<SCollision*> m_freeList;					// Common pool of free contacts.
+	std::vector<std::vector<SCollision*>> m_threadFreeLists;	// Free contacts owned by each thread.
+	std::mutex m_mutex;										// Protects slabs and the common pool.
+	SCollisionFields m_fields;								// Optional fields of all contacts.
+	SOptionalVariables m_activeFields;						// Optional fields required by models.
+	bool m_analyzeCollisions{ false };						// Whether fields for analysis of collisions are required.
+
+public:
+	CContactStorage();
+	CContactStorage(const CContactStorage& _other) = delete;
+	CContactStorage& operator=(const CContactStorage& _other) = delete;
+	CContactStorage(CContactStorage&& _other) = delete;
+	CContactStorage& operator=(CContactStorage&& _other) = delete;
+	~CContactStorage() = default;
+
+	// Returns a new default-initialized contact. Can be called in parallel from different threads of the pool.
+	SCollision* Allocate();
+	// Returns the contact to the storage. Can be called in parallel from different threads of the pool.
+	void Release(SCollision* _collision);
+	// Releases all memory. All previously allocated contacts become invalid.
+	void Clear();
+	// Adapts lists of free contacts of threads to the current number of threads in the pool. Must not be called in parallel with Allocate() or Release().
+	void UpdateThreadsNumber();
+	// Selects optional fields to be stored for each contact and releases all memory.
+	void SetActiveFields(const SOptionalVariables& _vars, bool _analyzeCollisions);
+	// Returns optional fields of contacts.
+	SCollisionFields& Fields() { return m_fields; }
+	const SCollisionFields& Fields() const { return m_fields; }
+
+	// Moves all contacts referenced from _matrices into a single contiguous slab, so that contacts of each row are placed one after another, and updates pointers in _matrices.
+	// All other contacts must have been released before. Pointers to contacts stored elsewhere become invalid.
+	void Rebuild(const std::vector<std::vector<std::vector<SCollision*>>*>& _matrices);
+
+	// Returns the number of contacts, for which memory is allocated.
+	size_t Capacity() const { return m_capacity; }
+	// Returns the number of slabs allocated since the storage was cleared.
+	size_t AllocatedSlabs() const { return m_allocatedSlabs; }
+	// Returns the number of bytes per contact, including active optional fields.
+	size_t BytesPerContact() const { return m_fields.BytesPerContact(); }
+
+private:
+	// Assigns slots to contacts of the slab and allocates memory for their optional fields.
+	void InitSlab(SCollision* _slab, size_t _size, size_t _firstSlot, SCollisionFields& _fields);
+	// Moves a batch of free contacts from the common pool to the given list, allocating a new slab if necessary.
+	void Refill(std::vector<SCollision*>& _list);
+	// Returns the list of free contacts of the calling thread.
+	std::vector<SCollision*>& ThreadFreeList();
+};
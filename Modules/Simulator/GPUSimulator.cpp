@@ -245,7 +245,8 @@ void CGPUSimulator::PrepareAdditionalSavingData()
 	// save stresses caused by solid bonds
 	for (size_t i = 0; i < bonds.Size(); ++i)
 	{
-		if (!bonds.Active(i) && !m_pSystemStructure->GetObjectByIndex(bonds.InitIndex(i))->IsActive(m_currentTime)) continue;
+		// bonds broken after the last saving are still active in the system structure; it is not accessed here, since the results saver may be writing into it
+		if (!bonds.Active(i) && bonds.EndActivity(i) <= m_lastSavingTime) continue;
 		const size_t leftID  = bonds.LeftID(i);
 		const size_t rightID = bonds.RightID(i);
 		CVector3 connVec = (particles.Coord(leftID) - particles.Coord(rightID)).Normalized();
@@ -275,7 +276,7 @@ void CGPUSimulator::PrepareAdditionalSavingData()
 
 void CGPUSimulator::SaveData()
 {
-	clock_t t = clock();
+	const auto start = std::chrono::steady_clock::now();
 	cudaDeviceSynchronize();
 	m_sceneGPU.CUDABondsGPU2CPU( m_scene );
 	m_sceneGPU.CUDAParticlesGPU2CPUAllData(m_scene);
@@ -286,16 +287,19 @@ void CGPUSimulator::SaveData()
 		m_maxParticleTemperature = m_sceneGPU.GetMaxPartTemperature();
 	p_SaveData();
 
-	m_verletList.AddDisregardingTimeInterval(clock() - t);
+	m_verletList.AddDisregardingTimeInterval(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
 }
 
 void CGPUSimulator::UpdateVerletLists(double _dTimeStep)
 {
 	CUDAUpdateGlobalCPUData();
-	if (m_verletList.IsNeedToBeUpdated(_dTimeStep, sqrt(m_pDispatchedResults_h->dMaxSquaredPartDist) , m_maxWallVelocity))
+	// lists are always completely rebuilt, so walls of all geometries are treated together
+	if (m_verletList.IsNeedToBeUpdated(_dTimeStep, sqrt(m_pDispatchedResults_h->dMaxSquaredPartDist), { m_maxWallVelocity }))
 	{
+		const auto scope = m_profiler.Scope(CStepProfiler::EPhase::VERLET_REBUILD);
 		m_sceneGPU.CUDAParticlesGPU2CPUVerletData(m_scene);
 		m_sceneGPU.CUDAWallsGPU2CPUVerletData(m_scene);
+		m_verletList.ResetCurrentData();
 		m_verletList.UpdateList(m_currentTime);
 
 		static STempStorage storePP, storePW; // to reuse memory
@@ -0,0 +1,189 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+#include "ResultsSaver.h"
+#include "ThreadPool.h"
+
+namespace
+{
+	// Calls _fun for each index in [0, _count), in parallel if requested. The writer thread must not use the thread pool, as it is busy with the simulation.
+	template<typename F>
+	void ForEach(size_t _count, bool _parallel, F&& _fun)
+	{
+		if (_parallel)
+			ParallelFor(_count, _fun);
+		else
+			for (size_t i = 0; i < _count; ++i)
+				_fun(i);
+	}
+}
+
+CResultsSaver::~CResultsSaver()
+{
+	Stop();
+}
+
+void CResultsSaver::SetBuffersNumber(size_t _number)
+{
+	if (_number == m_buffers) return;
+	Stop();
+	m_buffers = _number;
+}
+
+void CResultsSaver::Initialize(CSystemStructure* _systemStructure)
+{
+	Flush();
+	m_systemStructure = _systemStructure;
+	m_statistics = SStatistics{};
+}
+
+CResultsSaver::SSnapshot& CResultsSaver::Acquire()
+{
+	const auto start = clock_type::now();
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (m_snapshots.empty())
+		for (size_t i = 0; i < std::max(m_buffers, size_t{ 1 }); ++i)
+		{
+			m_snapshots.emplace_back(new SSnapshot{});
+			m_free.push_back(m_snapshots.back().get());
+		}
+	m_cvFree.wait(lock, [&] { return !m_free.empty(); });
+	m_acquired = m_free.back();
+	m_free.pop_back();
+	m_acquireTime = clock_type::now();
+	m_statistics.waitTime += std::chrono::duration<double>(m_acquireTime - start).count();
+	return *m_acquired;
+}
+
+void CResultsSaver::Submit()
+{
+	if (!m_acquired) return;
+	SSnapshot* snapshot = m_acquired;
+	m_acquired = nullptr;
+	m_statistics.savedPoints++;
+	m_statistics.copyTime += std::chrono::duration<double>(clock_type::now() - m_acquireTime).count();
+
+	if (m_buffers == 0) // synchronous writing
+	{
+		const auto start = clock_type::now();
+		Write(*snapshot, true);
+		m_statistics.writeTime += std::chrono::duration<double>(clock_type::now() - start).count();
+		m_free.push_back(snapshot);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_writer.joinable())
+	{
+		m_stop = false;
+		m_writer = std::thread{ &CResultsSaver::WriterLoop, this };
+	}
+	m_queue.push_back(snapshot);
+	m_cvQueue.notify_one();
+}
+
+void CResultsSaver::Flush()
+{
+	const auto start = clock_type::now();
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (m_queue.empty() && !m_writing) return;
+	m_cvFree.wait(lock, [&] { return m_queue.empty() && !m_writing; });
+	m_statistics.waitTime += std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+void CResultsSaver::Stop()
+{
+	Flush();
+	if (m_writer.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_cvQueue.notify_one();
+		m_writer.join();
+	}
+	m_free.clear();
+	m_snapshots.clear();
+}
+
+void CResultsSaver::WriterLoop()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true)
+	{
+		m_cvQueue.wait(lock, [&] { return m_stop || !m_queue.empty(); });
+		if (m_queue.empty()) return; // stop requested and nothing to write
+		SSnapshot* snapshot = m_queue.front();
+		m_queue.pop_front();
+		m_writing = true;
+		lock.unlock();
+
+		const auto start = clock_type::now();
+		Write(*snapshot, false);
+		const double time = std::chrono::duration<double>(clock_type::now() - start).count();
+
+		lock.lock();
+		m_writing = false;
+		m_statistics.writeTime += time;
+		m_statistics.backgroundTime += time;
+		m_free.push_back(snapshot);
+		m_cvFree.notify_all();
+	}
+}
+
+void CResultsSaver::Write(const SSnapshot& _snapshot, bool _parallel) const
+{
+	const double time = _snapshot.time;
+	m_systemStructure->GetSimulationInfo()->set_selective_saving(_snapshot.selective);
+	m_systemStructure->PrepareTimePointForWrite(time);
+
+	// save particles properties
+	const auto& particles = _snapshot.particles;
+	ForEach(particles.initIndex.size(), _parallel, [&](size_t i)
+	{
+		CPhysicalObject* pPart = m_systemStructure->GetObjectByIndex(particles.initIndex[i]);
+		if (!particles.active[i] && !pPart->IsActive(time)) return;
+		if (!particles.coord.empty())        pPart->SetCoordinates(particles.coord[i]);
+		if (!particles.vel.empty())          pPart->SetVelocity(particles.vel[i]);
+		if (!particles.anglVel.empty())      pPart->SetAngleVelocity(particles.anglVel[i]);
+		if (!particles.force.empty())        pPart->SetForce(particles.force[i]);
+		if (!particles.quaternion.empty())   pPart->SetOrientation(particles.quaternion[i]);
+		if (!particles.stressTensor.empty()) pPart->SetStressTensor(particles.stressTensor[i]);
+		if (!particles.temperature.empty())  pPart->SetTemperature(particles.temperature[i]);
+		pPart->SetObjectActivity(particles.active[i] ? time : particles.endActivity[i], particles.active[i]);
+	});
+
+	// save solid bonds properties
+	const auto& solidBonds = _snapshot.solidBonds;
+	ForEach(solidBonds.initIndex.size(), _parallel, [&](size_t i)
+	{
+		auto* pSBond = static_cast<CSolidBond*>(m_systemStructure->GetObjectByIndex(solidBonds.initIndex[i]));
+		if (!solidBonds.active[i] && !pSBond->IsActive(time)) return;
+		if (!solidBonds.force.empty())       pSBond->SetForce(solidBonds.force[i]);
+		if (!solidBonds.tangOverlap.empty()) pSBond->SetTangentialOverlap(solidBonds.tangOverlap[i]);
+		if (!solidBonds.totalTorque.empty()) pSBond->SetTotalTorque(solidBonds.totalTorque[i]);
+		pSBond->SetObjectActivity(solidBonds.active[i] ? time : solidBonds.endActivity[i], solidBonds.active[i]);
+	});
+
+	// save liquid bonds properties
+	const auto& liquidBonds = _snapshot.liquidBonds;
+	ForEach(liquidBonds.initIndex.size(), _parallel, [&](size_t i)
+	{
+		CPhysicalObject* pLBond = m_systemStructure->GetObjectByIndex(liquidBonds.initIndex[i]);
+		if (!liquidBonds.active[i] && !pLBond->IsActive(time)) return;
+		if (!liquidBonds.force.empty()) pLBond->SetForce(liquidBonds.force[i]);
+		pLBond->SetObjectActivity(liquidBonds.active[i] ? time : liquidBonds.endActivity[i], liquidBonds.active[i]);
+	});
+
+	// save wall properties
+	const auto& walls = _snapshot.walls;
+	ForEach(walls.initIndex.size(), _parallel, [&](size_t i)
+	{
+		auto* pWall = static_cast<CTriangularWall*>(m_systemStructure->GetObjectByIndex(walls.initIndex[i]));
+		if (!walls.vert1.empty()) pWall->SetPlaneCoord(walls.vert1[i], walls.vert2[i], walls.vert3[i]);
+		if (!walls.force.empty()) pWall->SetForce(walls.force[i]);
+		if (!walls.vel.empty())   pWall->SetVelocity(walls.vel[i]);
+	});
+}
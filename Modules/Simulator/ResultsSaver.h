@@ -0,0 +1,125 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+#pragma once
+#include "SystemStructure.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/* Writing of simulation results in background.
+ * The state of the simplified scene is copied into one of several reusable snapshots. A separate writer thread puts them into the
+ * system structure, where they are serialized, compressed and appended to the file, while the simulation goes on. The number of
+ * snapshots bounds the used memory: if all of them are still being written, the simulation thread waits for the writer.
+ * With zero snapshots, data are written directly by the simulation thread.
+ * The writer changes objects of the system structure and their storage, which is also modified by reading through CPhysicalObject.
+ * Therefore, after Submit() the simulation thread must not access objects of the system structure until Flush() is called:
+ * all data needed for saving, including stress tensors and activity of objects, must be taken from the simplified scene. */
+class CResultsSaver
+{
+public:
+	// Copy of all time-dependent data, which are saved in one time point. Only the fields selected for saving are filled.
+	struct SSnapshot
+	{
+		double time{ 0 };
+		bool selective{ false };
+		SSelectiveSavingFlags flags;
+
+		struct SObjects
+		{
+			std::vector<unsigned> initIndex;
+			std::vector<uint8_t> active;
+			std::vector<double> endActivity;
+			void Resize(size_t _n) { initIndex.resize(_n); active.resize(_n); endActivity.resize(_n); }
+		};
+
+		struct SParticles : SObjects
+		{
+			std::vector<CVector3> coord, vel, anglVel, force;
+			std::vector<CQuaternion> quaternion;
+			std::vector<CMatrix3> stressTensor;
+			std::vector<double> temperature;
+		} particles;
+
+		struct SSolidBonds : SObjects
+		{
+			std::vector<CVector3> force, tangOverlap;
+			std::vector<double> totalTorque;
+		} solidBonds;
+
+		struct SLiquidBonds : SObjects
+		{
+			std::vector<CVector3> force;
+		} liquidBonds;
+
+		struct SWalls
+		{
+			std::vector<unsigned> initIndex;
+			std::vector<CVector3> vert1, vert2, vert3, force, vel;
+		} walls;
+
+		// Returns true if the field with the given flag must be saved.
+		bool IsSaved(bool _flag) const { return !selective || _flag; }
+	};
+
+	struct SStatistics
+	{
+		size_t savedPoints{ 0 };	// Number of saved time points.
+		double copyTime{ 0 };		// Wall time [s], the simulation thread spent to fill snapshots.
+		double waitTime{ 0 };		// Wall time [s], the simulation thread waited for the writer.
+		double writeTime{ 0 };		// Wall time [s], spent to write snapshots into the system structure.
+		double backgroundTime{ 0 };	// Part of the writing time [s], spent in the writer thread.
+	};
+
+private:
+	using clock_type = std::chrono::steady_clock;
+
+	CSystemStructure* m_systemStructure{ nullptr };
+	size_t m_buffers{ 2 };							// Max number of snapshots in flight; 0 - synchronous writing.
+	std::vector<std::unique_ptr<SSnapshot>> m_snapshots;	// All allocated snapshots.
+	std::vector<SSnapshot*> m_free;					// Snapshots available to be filled.
+	std::deque<SSnapshot*> m_queue;					// Filled snapshots waiting for writing.
+	SSnapshot* m_acquired{ nullptr };				// Snapshot currently filled by the simulation thread.
+	clock_type::time_point m_acquireTime;			// Time point when the current snapshot was acquired.
+	bool m_writing{ false };						// The writer thread is busy with a snapshot.
+	bool m_stop{ false };							// Request to finish the writer thread.
+	std::thread m_writer;
+	std::mutex m_mutex;
+	std::condition_variable m_cvQueue;				// Notifies the writer about new snapshots.
+	std::condition_variable m_cvFree;				// Notifies the simulation thread about written snapshots.
+	SStatistics m_statistics;
+
+public:
+	CResultsSaver() = default;
+	CResultsSaver(const CResultsSaver& _other) = delete;
+	CResultsSaver& operator=(const CResultsSaver& _other) = delete;
+	CResultsSaver(CResultsSaver&& _other) = delete;
+	CResultsSaver& operator=(CResultsSaver&& _other) = delete;
+	~CResultsSaver();
+
+	// Sets the maximum number of snapshots in flight. 0 turns off background writing. Waits for all pending snapshots.
+	void SetBuffersNumber(size_t _number);
+	size_t GetBuffersNumber() const { return m_buffers; }
+	// Sets the system structure to write into and resets statistics. Waits for all pending snapshots.
+	void Initialize(CSystemStructure* _systemStructure);
+
+	// Returns a snapshot to be filled by the simulation thread. Waits if all snapshots are in flight.
+	SSnapshot& Acquire();
+	// Schedules the acquired snapshot for writing. In synchronous mode, writes it immediately.
+	void Submit();
+	// Waits until all pending snapshots are written into the system structure.
+	void Flush();
+	// Writes all pending snapshots, finishes the writer thread and releases the memory of snapshots.
+	void Stop();
+
+	const SStatistics& GetStatistics() const { return m_statistics; }
+
+private:
+	// Main function of the writer thread.
+	void WriterLoop();
+	// Puts the snapshot into the system structure. Objects are processed in parallel if requested.
+	void Write(const SSnapshot& _snapshot, bool _parallel) const;
+};
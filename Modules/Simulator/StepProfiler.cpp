@@ -0,0 +1,212 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+#include "StepProfiler.h"
+#include "MUSENFileFunctions.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <fstream>
+
+CStepProfiler::CScope::CScope(CStepProfiler* _profiler, EPhase _phase)
+	: m_profiler{ _profiler }
+	, m_phase{ _phase }
+{
+	if (!m_profiler) return;
+	m_profiler->Start(m_phase);
+	m_start = clock_type::now();
+}
+
+CStepProfiler::CScope::~CScope()
+{
+	if (!m_profiler) return;
+	m_profiler->Stop(m_phase, std::chrono::duration<double>(clock_type::now() - m_start).count());
+}
+
+void CStepProfiler::Reset()
+{
+	m_running = false;
+	m_threads = GetThreadsNumber();
+	m_steps = 0;
+	m_simulatedTime = 0;
+	m_wallTime = 0;
+	m_phases.fill(SPhase{});
+	m_detectionPW = SDetectionPW{};
+	for (auto& busy : m_busyStart)
+		busy.assign(m_threads, 0);
+	m_busyEnd.assign(m_threads, 0);
+}
+
+void CStepProfiler::Resume()
+{
+	if (!IsEnabled() || m_running) return;
+	m_running = true;
+	m_runStart = clock_type::now();
+	m_lastDump = m_runStart;
+	GetThreadPool().SetBusyTimeMeasurement(true);
+}
+
+void CStepProfiler::Suspend()
+{
+	if (!m_running) return;
+	GetThreadPool().SetBusyTimeMeasurement(false);
+	m_wallTime += std::chrono::duration<double>(clock_type::now() - m_runStart).count();
+	m_running = false;
+}
+
+void CStepProfiler::AddDetectionPW(size_t _candidates, size_t _tested, size_t _contacts, size_t _allocations)
+{
+	if (!m_running) return;
+	m_detectionPW.candidates += _candidates;
+	m_detectionPW.tested += _tested;
+	m_detectionPW.contacts += _contacts;
+	m_detectionPW.allocations += _allocations;
+}
+
+void CStepProfiler::EndStep(double _currentTime)
+{
+	if (!m_running) return;
+	m_steps++;
+	m_simulatedTime = _currentTime;
+	if (m_interval <= 0) return;
+	const auto now = clock_type::now();
+	if (std::chrono::duration<double>(now - m_lastDump).count() < m_interval) return;
+	m_lastDump = now;
+	Write();
+}
+
+std::string CStepProfiler::GetPhaseName(EPhase _phase)
+{
+	switch (_phase)
+	{
+	case EPhase::UPDATE_COLLISIONS:	return "update_collisions";
+	case EPhase::VERLET_REBUILD:	return "verlet_rebuild";
+	case EPhase::CONTACT_DETECTION:	return "contact_detection";
+	case EPhase::FORCES_PP:			return "forces_pp";
+	case EPhase::FORCES_PW:			return "forces_pw";
+	case EPhase::FORCES_SB:			return "forces_sb";
+	case EPhase::FORCES_LB:			return "forces_lb";
+	case EPhase::FORCES_EF:			return "forces_ef";
+	case EPhase::MOVE_OBJECTS:		return "move_objects";
+	case EPhase::SAVE_DATA:			return "save_data";
+	case EPhase::STRESS_TENSORS:	return "stress_tensors";
+	}
+	return "";
+}
+
+bool CStepProfiler::Write() const
+{
+	if (!IsEnabled()) return false;
+	std::ofstream file{ UnicodePath(m_fileName) };
+	if (!file) return false;
+	if (ToLowerCase(MUSENFileFunctions::getFileExt(m_fileName)) == "csv")
+		WriteCSV(file);
+	else
+		WriteJSON(file);
+	return file.good();
+}
+
+void CStepProfiler::Start(EPhase _phase)
+{
+	if (m_threads != 0)
+		GetThreadPool().GetBusyTimes(m_busyStart[static_cast<size_t>(_phase)]);
+}
+
+void CStepProfiler::Stop(EPhase _phase, double _wallTime)
+{
+	SPhase& phase = m_phases[static_cast<size_t>(_phase)];
+	phase.calls++;
+	phase.wallTime += _wallTime;
+	if (m_threads == 0) return;
+	const auto& start = m_busyStart[static_cast<size_t>(_phase)];
+	GetThreadPool().GetBusyTimes(m_busyEnd);
+	double maxBusy = 0;
+	for (size_t i = 0; i < m_threads; ++i)
+	{
+		const double busy = m_busyEnd[i] - start[i];
+		phase.busyTime += busy;
+		maxBusy = std::max(maxBusy, busy);
+	}
+	phase.maxBusyTime += maxBusy;
+}
+
+double CStepProfiler::TotalWallTime() const
+{
+	return m_wallTime + (m_running ? std::chrono::duration<double>(clock_type::now() - m_runStart).count() : 0);
+}
+
+namespace
+{
+	// Derived values of a phase.
+	struct SPhaseSummary
+	{
+		double share;			// Part of the total wall time.
+		double imbalance;		// Busy time of the most loaded thread relative to the average one; 1 - perfectly balanced.
+		double utilization;		// Part of the wall time the threads were busy in average.
+		double contactsPerSecond;	// Calculated contacts per second of wall time.
+	};
+
+	SPhaseSummary Summarize(const CStepProfiler::SPhase& _phase, double _totalWallTime, size_t _threads)
+	{
+		SPhaseSummary res{};
+		res.share = _totalWallTime != 0 ? _phase.wallTime / _totalWallTime : 0;
+		res.imbalance = _phase.busyTime != 0 ? _phase.maxBusyTime * static_cast<double>(_threads) / _phase.busyTime : 0;
+		res.utilization = _phase.wallTime != 0 && _threads != 0 ? _phase.busyTime / (_phase.wallTime * static_cast<double>(_threads)) : 0;
+		res.contactsPerSecond = _phase.wallTime != 0 ? static_cast<double>(_phase.contacts) / _phase.wallTime : 0;
+		return res;
+	}
+}
+
+void CStepProfiler::WriteJSON(std::ostream& _out) const
+{
+	const double wallTime = TotalWallTime();
+	_out << "{" << std::endl;
+	_out << "  \"threads\": " << m_threads << "," << std::endl;
+	_out << "  \"steps\": " << m_steps << "," << std::endl;
+	_out << "  \"simulated_time\": " << m_simulatedTime << "," << std::endl;
+	_out << "  \"wall_time\": " << wallTime << "," << std::endl;
+	_out << "  \"phases\": [" << std::endl;
+	for (size_t i = 0; i < PHASES_NUMBER; ++i)
+	{
+		const SPhase& phase = m_phases[i];
+		const SPhaseSummary summary = Summarize(phase, wallTime, m_threads);
+		_out << "    { \"name\": \"" << GetPhaseName(static_cast<EPhase>(i)) << "\""
+			<< ", \"calls\": " << phase.calls
+			<< ", \"wall_time\": " << phase.wallTime
+			<< ", \"share\": " << summary.share
+			<< ", \"busy_time\": " << phase.busyTime
+			<< ", \"imbalance\": " << summary.imbalance
+			<< ", \"utilization\": " << summary.utilization
+			<< ", \"contacts\": " << phase.contacts
+			<< ", \"contacts_per_second\": " << summary.contactsPerSecond
+			<< " }" << (i + 1 < PHASES_NUMBER ? "," : "") << std::endl;
+	}
+	_out << "  ]," << std::endl;
+	const double steps = m_steps != 0 ? static_cast<double>(m_steps) : 1;
+	_out << "  \"pw_detection\": { \"candidates\": " << m_detectionPW.candidates
+		<< ", \"tested\": " << m_detectionPW.tested
+		<< ", \"contacts\": " << m_detectionPW.contacts
+		<< ", \"allocations\": " << m_detectionPW.allocations
+		<< ", \"allocations_per_step\": " << static_cast<double>(m_detectionPW.allocations) / steps << " }" << std::endl;
+	_out << "}" << std::endl;
+}
+
+void CStepProfiler::WriteCSV(std::ostream& _out) const
+{
+	const double wallTime = TotalWallTime();
+	_out << "phase,calls,wall_time,share,busy_time,imbalance,utilization,contacts,contacts_per_second" << std::endl;
+	_out << "total," << m_steps << "," << wallTime << ",1,,,,," << std::endl;
+	for (size_t i = 0; i < PHASES_NUMBER; ++i)
+	{
+		const SPhase& phase = m_phases[i];
+		const SPhaseSummary summary = Summarize(phase, wallTime, m_threads);
+		_out << GetPhaseName(static_cast<EPhase>(i)) << "," << phase.calls << "," << phase.wallTime << "," << summary.share << ","
+			<< phase.busyTime << "," << summary.imbalance << "," << summary.utilization << "," << phase.contacts << "," << summary.contactsPerSecond << std::endl;
+	}
+	const double steps = m_steps != 0 ? static_cast<double>(m_steps) : 1;
+	_out << std::endl << "pw_detection,total,per_step" << std::endl;
+	_out << "candidates," << m_detectionPW.candidates << "," << static_cast<double>(m_detectionPW.candidates) / steps << std::endl;
+	_out << "tested," << m_detectionPW.tested << "," << static_cast<double>(m_detectionPW.tested) / steps << std::endl;
+	_out << "contacts," << m_detectionPW.contacts << "," << static_cast<double>(m_detectionPW.contacts) / steps << std::endl;
+	_out << "allocations," << m_detectionPW.allocations << "," << static_cast<double>(m_detectionPW.allocations) / steps << std::endl;
+}
@@ -0,0 +1,131 @@
+/* Copyright (c) 2013-2020, MUSEN Development Team. All rights reserved.
+   This file is part of MUSEN framework http://msolids.net/musen.
+   See LICENSE file for license and warranty information. */
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/* Profiler of simulation steps.
+ * Wall-clock time of each phase of a step is measured with scoped timers and accumulated together with the number of calls.
+ * Additionally, the thread pool measures the time each worker spends executing jobs; its increase during a phase gives the load
+ * imbalance of parallel loops within this phase. Statistics of particle-wall contact detection are accumulated as well. Results are written into a JSON or CSV file at the end of the simulation and,
+ * optionally, periodically during the simulation. When disabled, scoped timers do not access the clock. */
+class CStepProfiler
+{
+public:
+	enum class EPhase : size_t
+	{
+		UPDATE_COLLISIONS = 0,	// Whole UpdateCollisionsStep().
+		VERLET_REBUILD    = 1,	// Rebuild of verlet lists, part of UPDATE_COLLISIONS.
+		CONTACT_DETECTION = 2,	// Update of collision matrices, part of UPDATE_COLLISIONS.
+		FORCES_PP         = 3,
+		FORCES_PW         = 4,
+		FORCES_SB         = 5,	// Part of MOVE_OBJECTS, if solid bonds are sub-cycled.
+		FORCES_LB         = 6,
+		FORCES_EF         = 7,
+		MOVE_OBJECTS      = 8,	// Whole MoveObjectsStep().
+		SAVE_DATA         = 9,
+		STRESS_TENSORS    = 10,	// Calculation of stress tensors, part of SAVE_DATA.
+	};
+
+	static constexpr size_t PHASES_NUMBER = 11;
+
+	struct SPhase
+	{
+		size_t calls{ 0 };		// Number of measured calls.
+		double wallTime{ 0 };	// Total wall time [s].
+		double busyTime{ 0 };	// Total time [s] all threads of the pool were busy executing jobs.
+		double maxBusyTime{ 0 };// Sum over all calls of the busy time [s] of the most loaded thread.
+		size_t contacts{ 0 };	// Number of calculated contacts.
+	};
+
+	// Statistics of particle-wall contact detection.
+	struct SDetectionPW
+	{
+		size_t candidates{ 0 };	// Pairs of particles and walls from verlet lists.
+		size_t tested{ 0 };		// Pairs, which passed the culling and were tested exactly.
+		size_t contacts{ 0 };	// Pairs in contact.
+		size_t allocations{ 0 };// Memory allocations during contact detection.
+	};
+
+	// Measures the time from creation till destruction and adds it to the phase.
+	class CScope
+	{
+		CStepProfiler* m_profiler;
+		EPhase m_phase;
+		std::chrono::steady_clock::time_point m_start;
+	public:
+		CScope(CStepProfiler* _profiler, EPhase _phase);
+		~CScope();
+		CScope(const CScope& _other) = delete;
+		CScope& operator=(const CScope& _other) = delete;
+		CScope(CScope&& _other) = delete;
+		CScope& operator=(CScope&& _other) = delete;
+	};
+
+private:
+	using clock_type = std::chrono::steady_clock;
+
+	std::string m_fileName;		// File to write results; empty - profiling is disabled.
+	double m_interval{ 0 };		// Wall time interval [s] to write results during the simulation; 0 - only at the end.
+
+	bool m_running{ false };					// Profiling is currently active.
+	size_t m_threads{ 0 };						// Number of threads in the pool.
+	size_t m_steps{ 0 };						// Number of simulation steps.
+	double m_simulatedTime{ 0 };				// Simulated time [s], reached at the last step.
+	double m_wallTime{ 0 };						// Total wall time of all running periods [s].
+	clock_type::time_point m_runStart;			// Start of the current running period.
+	clock_type::time_point m_lastDump;			// Time point of the last writing of results.
+	std::array<SPhase, PHASES_NUMBER> m_phases{};
+	SDetectionPW m_detectionPW{};
+	std::array<std::vector<double>, PHASES_NUMBER> m_busyStart;	// Per-thread busy times at the start of each phase.
+	std::vector<double> m_busyEnd;								// Buffer for per-thread busy times at the end of a phase.
+
+public:
+	void SetFileName(const std::string& _fileName) { m_fileName = _fileName; }
+	const std::string& GetFileName() const { return m_fileName; }
+	void SetInterval(double _interval) { m_interval = _interval; }
+	double GetInterval() const { return m_interval; }
+	bool IsEnabled() const { return !m_fileName.empty(); }
+
+	// Resets all accumulated values. Must be called before the simulation starts.
+	void Reset();
+	// Starts a running period: turns on measuring of busy times in the thread pool.
+	void Resume();
+	// Finishes a running period: turns off measuring of busy times in the thread pool.
+	void Suspend();
+
+	// Returns an object, measuring the time of the phase during its lifetime.
+	CScope Scope(EPhase _phase) { return CScope{ m_running ? this : nullptr, _phase }; }
+	// Adds the number of calculated contacts to the phase.
+	void AddContacts(EPhase _phase, size_t _contacts) { if (m_running) m_phases[static_cast<size_t>(_phase)].contacts += _contacts; }
+	// Adds statistics of particle-wall contact detection of a step.
+	void AddDetectionPW(size_t _candidates, size_t _tested, size_t _contacts, size_t _allocations);
+	// Must be called at the end of each simulation step. Writes results if the interval has elapsed.
+	void EndStep(double _currentTime);
+
+	const SPhase& GetPhase(EPhase _phase) const { return m_phases[static_cast<size_t>(_phase)]; }
+	const SDetectionPW& GetDetectionPW() const { return m_detectionPW; }
+	size_t GetSteps() const { return m_steps; }
+	size_t GetThreads() const { return m_threads; }
+	// Returns total wall time [s] of all running periods.
+	double GetWallTime() const { return TotalWallTime(); }
+	// Returns the name of the phase as used in output files.
+	static std::string GetPhaseName(EPhase _phase);
+
+	// Writes accumulated results into the file. The format is selected by the extension of the file: CSV for '.csv', JSON otherwise.
+	bool Write() const;
+
+private:
+	// Called by scoped timers.
+	void Start(EPhase _phase);
+	void Stop(EPhase _phase, double _wallTime);
+
+	// Returns total wall time [s] including the current running period.
+	double TotalWallTime() const;
+	void WriteJSON(std::ostream& _out) const;
+	void WriteCSV(std::ostream& _out) const;
+};
@@ -104,6 +104,9 @@ void CSelectiveSavingTab::SetParameters()
 	else
 		m_SSelectiveSavingFlags.SetAllWalls(false);
 
+	// not editable here, keep the current value
+	m_SSelectiveSavingFlags.nTensorStep = m_pSimulatorManager->GetSimulatorPtr()->GetSelectiveSavingFlags().nTensorStep;
+
 	m_pSimulatorManager->GetSimulatorPtr()->SetSelectiveSaving(true);
 	m_pSimulatorManager->GetSimulatorPtr()->SetSelectiveSavingParameters(m_SSelectiveSavingFlags);
 
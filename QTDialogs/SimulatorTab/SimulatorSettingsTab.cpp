@@ -14,6 +14,7 @@ CSimulatorSettingsTab::CSimulatorSettingsTab(CSimulatorManager* _pSimulatorManag
 	const QRegExp regExpFloat("^[0-9]*[.]?[0-9]+(?:[eE][-+]?[0-9]+)?$");
 	// set regular expression for limitation of input in QLineEdits
 	ui.lineEditVerletCoeff->setValidator(new QRegExpValidator(regExpFloat, this));
+	ui.lineEditVerletWallRatio->setValidator(new QRegExpValidator(regExpFloat, this));
 
 	connect(ui.listCPU,					&QListWidget::itemChanged,   this, &CSimulatorSettingsTab::ThreadPoolChanged);
 	connect(ui.buttonBox,				&QDialogButtonBox::accepted, this, &CSimulatorSettingsTab::AcceptChanges);
@@ -26,9 +27,20 @@ void CSimulatorSettingsTab::UpdateWholeView()
 	ui.spinBoxCellsNumber->setValue(m_pSimulatorManager->GetSimulatorPtr()->GetMaxCells());
 	ui.lineEditVerletCoeff->setText(QString::number(m_pSimulatorManager->GetSimulatorPtr()->GetVerletCoeff()));
 	ui.checkBoxAutoAdjust->setChecked(m_pSimulatorManager->GetSimulatorPtr()->GetAutoAdjustFlag());
+	ui.checkBoxSparseGrid->setChecked(m_pSimulatorManager->GetSimulatorPtr()->GetVerletGridType() == EVerletGridType::SPARSE);
+	ui.checkBoxIncrementalVerlet->setChecked(m_pSimulatorManager->GetSimulatorPtr()->GetIncrementalVerletFlag());
+	ui.checkBoxDeterministicForces->setChecked(m_pSimulatorManager->GetSimulatorPtr()->GetDeterministicForcesFlag());
+	ui.checkBoxMixedPrecision->setChecked(m_pSimulatorManager->GetSimulatorPtr()->GetMixedPrecisionFlag());
+	ui.lineEditVerletWallRatio->setText(QString::number(m_pSimulatorManager->GetSimulatorPtr()->GetVerletWallRatio()));
 	ui.groupBoxVariableTimeStep->setChecked(m_pSimulatorManager->GetSimulatorPtr()->GetVariableTimeStep());
 	ui.lineEditPartMoveLimit->setText(QString::number(m_pSimulatorManager->GetSimulatorPtr()->GetPartMoveLimit()));
 	ui.lineEditTimeStepFactor->setText(QString::number(m_pSimulatorManager->GetSimulatorPtr()->GetTimeStepFactor()));
+	ui.comboBoxIntegrator->setCurrentIndex(static_cast<int>(m_pSimulatorManager->GetSimulatorPtr()->GetIntegrator()));
+	ui.spinBoxBondSubsteps->setValue(static_cast<int>(m_pSimulatorManager->GetSimulatorPtr()->GetSolidBondSubsteps()));
+	ui.groupBoxSleeping->setChecked(m_pSimulatorManager->GetSimulatorPtr()->GetSleepingFlag());
+	ui.lineEditSleepVelocity->setText(QString::number(m_pSimulatorManager->GetSimulatorPtr()->GetSleepVelocity()));
+	ui.lineEditSleepAcceleration->setText(QString::number(m_pSimulatorManager->GetSimulatorPtr()->GetSleepAcceleration()));
+	ui.spinBoxSleepSteps->setValue(static_cast<int>(m_pSimulatorManager->GetSimulatorPtr()->GetSleepSteps()));
 
 	const bool stopByBrokenBonds = VectorContains(m_pSimulatorManager->GetSimulatorPtr()->GetStopCriteria(), CBaseSimulator::EStopCriteria::BROKEN_BONDS);
 	ui.checkBoxStopBrokenBonds->setChecked(stopByBrokenBonds);
@@ -101,9 +113,20 @@ void CSimulatorSettingsTab::AcceptChanges()
 	m_pSimulatorManager->GetSimulatorPtr()->SetMaxCells(ui.spinBoxCellsNumber->value());
 	m_pSimulatorManager->GetSimulatorPtr()->SetVerletCoeff(ui.lineEditVerletCoeff->text().toDouble());
 	m_pSimulatorManager->GetSimulatorPtr()->SetAutoAdjustFlag(ui.checkBoxAutoAdjust->isChecked());
+	m_pSimulatorManager->GetSimulatorPtr()->SetVerletGridType(ui.checkBoxSparseGrid->isChecked() ? EVerletGridType::SPARSE : EVerletGridType::DENSE);
+	m_pSimulatorManager->GetSimulatorPtr()->SetIncrementalVerletFlag(ui.checkBoxIncrementalVerlet->isChecked());
+	m_pSimulatorManager->GetSimulatorPtr()->SetDeterministicForcesFlag(ui.checkBoxDeterministicForces->isChecked());
+	m_pSimulatorManager->GetSimulatorPtr()->SetMixedPrecisionFlag(ui.checkBoxMixedPrecision->isChecked());
+	m_pSimulatorManager->GetSimulatorPtr()->SetVerletWallRatio(ui.lineEditVerletWallRatio->text().toDouble());
 	m_pSimulatorManager->GetSimulatorPtr()->SetVariableTimeStep(ui.groupBoxVariableTimeStep->isChecked());
 	m_pSimulatorManager->GetSimulatorPtr()->SetPartMoveLimit(ui.lineEditPartMoveLimit->text().toDouble());
 	m_pSimulatorManager->GetSimulatorPtr()->SetTimeStepFactor(ui.lineEditTimeStepFactor->text().toDouble());
+	m_pSimulatorManager->GetSimulatorPtr()->SetIntegrator(static_cast<CBaseSimulator::EIntegrator>(ui.comboBoxIntegrator->currentIndex()));
+	m_pSimulatorManager->GetSimulatorPtr()->SetSolidBondSubsteps(static_cast<uint32_t>(ui.spinBoxBondSubsteps->value()));
+	m_pSimulatorManager->GetSimulatorPtr()->SetSleepingFlag(ui.groupBoxSleeping->isChecked());
+	m_pSimulatorManager->GetSimulatorPtr()->SetSleepVelocity(ui.lineEditSleepVelocity->text().toDouble());
+	m_pSimulatorManager->GetSimulatorPtr()->SetSleepAcceleration(ui.lineEditSleepAcceleration->text().toDouble());
+	m_pSimulatorManager->GetSimulatorPtr()->SetSleepSteps(static_cast<uint32_t>(ui.spinBoxSleepSteps->value()));
 
 	std::vector<CBaseSimulator::EStopCriteria> stopCriteria;
 	if (ui.checkBoxStopBrokenBonds->isChecked())